@@ -0,0 +1,798 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+/**
+ * V2X congestion control scenario with a persistent topology.
+ *
+ * One RSU and a grid of OBUs share an 802.11p channel (plus the CSMA
+ * backhaul used by the other V2X drivers).  Every OBU broadcasts BSMs
+ * with an OnOffApplication.  Instead of rebuilding the nodes and calling
+ * Simulator::Run once per second, the topology is built once and a
+ * periodic control epoch runs inside a single simulation:
+ *
+ *  1. the RSU reads the Channel Busy Ratio measured by its PHY,
+ *  2. selects the next ITT with a CongestionController,
+ *  3. broadcasts the ITT in a WSA,
+ *  4. every OBU receiving the WSA pushes the new rate to its running
+ *     BSM source.
+ *
+ * With --distributed, no WSA is sent: every OBU runs the controller
+ * locally against the CBR measured by its own PHY and the number of
+ * vehicles it heard BSMs from during the epoch.
+ *
+ * The controller is selected by TypeId with --controller and configured
+ * through its attributes, e.g.
+ * --ns3::LimericCongestionController::TargetCbr=0.6 or
+ * --ns3::TableCongestionController::TableFile=itt.csv
+ *
+ * One row is written per epoch with the columns time, CBR [%], WSA
+ * receive time, ITT; in distributed mode the CBR and the ITT are averaged
+ * over the OBUs.  The rows go through a ResultsSink, to a CSV file or,
+ * with --outputFormat=sqlite, to the "v2x" table of an SQLite database.
+ *
+ * usage:
+ *  ./waf --run "v2x-congestion-scenario --obuNodes=500 --initItt=0.145"
+ *  ./waf --run "v2x-congestion-scenario --obuNodes=2000 --distributed
+ *               --controller=ns3::J2945CongestionController"
+ *
+ * Grids of (obuNodes x initItt x seed) replacing the per-configuration
+ * copies of this driver are run in parallel by utils/v2x-sweep.py:
+ *  ./utils/v2x-sweep.py --grid obuNodes=100,200,300,500 --grid initItt=0.08,0.145 --runs 5
+ */
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/csma-module.h"
+#include "ns3/netanim-module.h"
+#include "ns3/stats-module.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/yans-wifi-phy.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-mac-header.h"
+#include "ns3/wifi-80211p-helper.h"
+#include "ns3/wave-mac-helper.h"
+#include "ns3/channel-busy-ratio-monitor.h"
+#include "ns3/congestion-controller.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("V2xCongestionScenario");
+
+/**
+ * \ingroup wave
+ * \brief A V2X congestion control experiment built once and driven by a
+ * periodic control epoch
+ */
+class V2xCongestionScenario
+{
+public:
+  /**
+   * \brief Constructor
+   */
+  V2xCongestionScenario ();
+
+  /**
+   * \brief Destructor
+   */
+  virtual ~V2xCongestionScenario ();
+
+  /**
+   * \brief Enacts the simulation
+   * \param argc program arguments count
+   * \param argv program arguments
+   */
+  void Simulate (int argc, char **argv);
+
+protected:
+  /**
+   * \brief Process command line arguments
+   * \param argc program arguments count
+   * \param argv program arguments
+   */
+  virtual void ParseCommandLineArguments (int argc, char **argv);
+
+  /**
+   * \brief Create the RSU and OBU nodes
+   */
+  virtual void ConfigureNodes ();
+
+  /**
+   * \brief Configure the 802.11p and CSMA devices
+   */
+  virtual void ConfigureDevices ();
+
+  /**
+   * \brief Place the nodes on the grid
+   */
+  virtual void ConfigureMobility ();
+
+  /**
+   * \brief Install the internet stack, sockets and BSM sources
+   */
+  virtual void ConfigureApplications ();
+
+  /**
+   * \brief Configure tracing
+   */
+  virtual void ConfigureTracing ();
+
+  /**
+   * \brief Run the simulation
+   */
+  virtual void RunSimulation ();
+
+  /**
+   * \brief Process outputs
+   */
+  virtual void ProcessOutputs ();
+
+private:
+  /**
+   * \brief Control epoch run by the RSU: measure the CBR, select the
+   * next ITT, log it and advertise it in a WSA
+   */
+  void ControlEpoch ();
+
+  /**
+   * \brief Control epoch of distributed mode: every OBU selects its own
+   * ITT from its own CBR and vehicle density
+   */
+  void DistributedControlEpoch ();
+
+  /**
+   * \brief Write the row of the current epoch
+   * \param cbr the channel busy ratio, in percent
+   */
+  void WriteEpoch (double cbr);
+
+  /**
+   * \brief Create a congestion controller of the configured type
+   * \return the controller, starting from the initial ITT
+   */
+  Ptr<CongestionController> CreateController () const;
+
+  /**
+   * \brief Receive BSMs at an OBU, in distributed mode, to count its neighbors
+   * \param socket the receiving socket
+   */
+  void ReceiveNeighborBsm (Ptr<Socket> socket);
+
+  /**
+   * \brief Receive a WSA at an OBU and apply the advertised rate to its BSM source
+   * \param socket the receiving socket
+   */
+  void ReceiveWsa (Ptr<Socket> socket);
+
+  /**
+   * \brief Receive BSMs at the RSU
+   * \param socket the receiving socket
+   */
+  void ReceiveBsm (Ptr<Socket> socket);
+
+  /**
+   * \brief Receive PVDs at the RSU
+   * \param socket the receiving socket
+   */
+  void ReceivePvd (Ptr<Socket> socket);
+
+  /**
+   * \brief Send one PVD snapshot from an OBU and schedule the next one
+   * \param socket the sending socket
+   */
+  void SendPvd (Ptr<Socket> socket);
+
+  /**
+   * \brief Capture filter accepting the packets of the RSU devices
+   * \param device the device
+   * \param packet the packet
+   * \return true if the packet is captured
+   */
+  bool CaptureRsu (Ptr<NetDevice> device, Ptr<const Packet> packet);
+
+  /**
+   * \brief Capture filter accepting the BSMs, i.e. the UDP datagrams to port 9
+   * \param device the device
+   * \param packet the packet
+   * \return true if the packet is captured
+   */
+  bool CaptureBsm (Ptr<NetDevice> device, Ptr<const Packet> packet);
+
+  /**
+   * \brief Convert an ITT to the BSM data rate
+   * \param itt the inter-transmit time, in seconds
+   * \return the data rate producing one BSM per ITT
+   */
+  DataRate IttToDataRate (double itt) const;
+
+  uint32_t m_obuNodes; ///< number of OBUs
+  uint32_t m_rowLine; ///< number of OBU rows on the grid
+  uint32_t m_totalTime; ///< number of control epochs
+  double m_epoch; ///< control epoch length, in seconds
+  double m_initItt; ///< ITT used before the first WSA, in seconds
+  uint32_t m_bsmPacketSize; ///< BSM size, in bytes
+  std::string m_phyMode; ///< 802.11p PHY mode
+  std::string m_outputFile; ///< CSV file or SQLite database
+  std::string m_outputFormat; ///< "csv" or "sqlite"
+  std::string m_animFile; ///< NetAnim output file, empty to disable
+  uint32_t m_animSampling; ///< one packet out of m_animSampling animated
+  double m_animMobilityThreshold; ///< minimum movement of an animated position, in meters
+  bool m_pcap; ///< enable Wi-Fi pcap
+  bool m_ascii; ///< enable CSMA ascii trace
+  std::string m_binaryTraceFile; ///< binary packet trace file, empty to disable
+  std::string m_pcapngFile; ///< pcapng capture file of all the devices, empty to disable
+  std::string m_pcapngFilter; ///< capture filter of the pcapng file: "all", "rsu" or "bsm"
+  bool m_verbose; ///< enable Wi-Fi logging
+  std::string m_controllerType; ///< TypeId of the congestion controller
+  bool m_distributed; ///< run the controller on every OBU instead of the RSU
+  bool m_cullReceivers; ///< skip the PHYs out of reception range in the channel
+  bool m_batchDelivery; ///< deliver the receptions of a transmission by one event per delay
+  bool m_cacheLinkBudget; ///< cache the RX power and delay between static nodes
+  bool m_errorRateTables; ///< interpolate the chunk success rates in precomputed tables
+
+  NodeContainer m_nodes; ///< RSU (index 0) followed by the OBUs
+  NetDeviceContainer m_wifiDevices; ///< 802.11p devices
+  NetDeviceContainer m_csmaDevices; ///< CSMA devices
+  YansWifiPhyHelper m_wifiPhy; ///< Wi-Fi PHY helper
+  CsmaHelper m_csma; ///< CSMA helper
+  AnimationInterface *m_anim; ///< NetAnim interface
+
+  Ptr<ChannelBusyRatioMonitor> m_rsuMonitor; ///< CBR measured by the RSU PHY
+  Ptr<CongestionController> m_rsuController; ///< ITT selection of the RSU
+  std::vector<Ptr<ChannelBusyRatioMonitor> > m_obuMonitors; ///< CBR measured by each node, distributed mode
+  std::vector<Ptr<CongestionController> > m_obuControllers; ///< ITT selection of each node, distributed mode
+  std::map<Ipv4Address, uint32_t> m_wifiNodes; ///< node ID of each 802.11p address
+  std::vector<std::set<uint32_t> > m_neighbors; ///< IDs of the nodes heard over 802.11p by each node during the epoch
+  Ptr<Socket> m_wsaSource; ///< RSU WSA socket
+  std::vector<Ptr<OnOffApplication> > m_bsmSources; ///< BSM source of each node, null for the RSU
+  uint32_t m_bsmRxCount; ///< BSMs received by the RSU during the current epoch
+  uint32_t m_pvdRxCount; ///< PVDs received by the RSU
+  double m_itt; ///< ITT advertised at the last epoch
+  double m_wsaRxTime; ///< time of the last WSA reception, in seconds
+  Ptr<ResultsSink> m_results; ///< epoch rows
+  Ptr<BinaryTraceRecorder> m_binaryTrace; ///< binary packet traces
+  Ptr<PcapngFileWriter> m_pcapng; ///< pcapng capture
+  uint32_t m_timeColumn; ///< time column of the epoch rows
+  uint32_t m_cbrColumn; ///< CBR column of the epoch rows
+  uint32_t m_wsaTimeColumn; ///< WSA receive time column of the epoch rows
+  uint32_t m_ittColumn; ///< ITT column of the epoch rows
+};
+
+V2xCongestionScenario::V2xCongestionScenario ()
+  : m_obuNodes (500),
+    m_rowLine (10),
+    m_totalTime (20),
+    m_epoch (1.0),
+    m_initItt (0.145),
+    m_bsmPacketSize (200),
+    m_phyMode ("OfdmRate6MbpsBW10MHz"),
+    m_outputFile ("v2x-congestion.csv"),
+    m_outputFormat ("csv"),
+    m_animFile (""),
+    m_animSampling (1),
+    m_animMobilityThreshold (0),
+    m_pcap (false),
+    m_ascii (false),
+    m_binaryTraceFile (""),
+    m_pcapngFile (""),
+    m_pcapngFilter ("all"),
+    m_verbose (false),
+    m_controllerType ("ns3::TableCongestionController"),
+    m_distributed (false),
+    m_cullReceivers (true),
+    m_batchDelivery (true),
+    m_cacheLinkBudget (true),
+    m_errorRateTables (false),
+    m_anim (0),
+    m_bsmRxCount (0),
+    m_pvdRxCount (0),
+    m_itt (0),
+    m_wsaRxTime (0)
+{
+}
+
+V2xCongestionScenario::~V2xCongestionScenario ()
+{
+  delete m_anim;
+}
+
+void
+V2xCongestionScenario::Simulate (int argc, char **argv)
+{
+  ParseCommandLineArguments (argc, argv);
+  ConfigureNodes ();
+  ConfigureDevices ();
+  ConfigureMobility ();
+  ConfigureApplications ();
+  ConfigureTracing ();
+  RunSimulation ();
+  ProcessOutputs ();
+}
+
+void
+V2xCongestionScenario::ParseCommandLineArguments (int argc, char **argv)
+{
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("obuNodes", "Number of OBUs", m_obuNodes);
+  cmd.AddValue ("rowLine", "Number of OBU rows on the grid", m_rowLine);
+  cmd.AddValue ("totalTime", "Number of control epochs", m_totalTime);
+  cmd.AddValue ("epoch", "Control epoch length, in seconds", m_epoch);
+  cmd.AddValue ("initItt", "ITT used before the first WSA, in seconds", m_initItt);
+  cmd.AddValue ("bsmPacketSize", "BSM size, in bytes", m_bsmPacketSize);
+  cmd.AddValue ("phyMode", "Wifi Phy mode", m_phyMode);
+  cmd.AddValue ("outputFile", "CSV file or SQLite database", m_outputFile);
+  cmd.AddValue ("outputFormat", "Output format, csv or sqlite", m_outputFormat);
+  cmd.AddValue ("animFile", "File Name for Animation Output, empty to disable, gzip compressed if ending with .gz", m_animFile);
+  cmd.AddValue ("animSampling", "Animate one packet out of animSampling", m_animSampling);
+  cmd.AddValue ("animMobilityThreshold", "Minimum movement of an animated node position, in meters", m_animMobilityThreshold);
+  cmd.AddValue ("pcap", "Enable Wi-Fi pcap traces", m_pcap);
+  cmd.AddValue ("ascii", "Enable CSMA ascii traces", m_ascii);
+  cmd.AddValue ("binaryTrace", "File of the binary packet traces of all the devices, empty to disable", m_binaryTraceFile);
+  cmd.AddValue ("pcapng", "Single pcapng capture file of all the devices, empty to disable", m_pcapngFile);
+  cmd.AddValue ("pcapngFilter", "Packets captured to the pcapng file: all, rsu or bsm", m_pcapngFilter);
+  cmd.AddValue ("verbose", "turn on all WifiNetDevice log components", m_verbose);
+  cmd.AddValue ("controller", "TypeId of the congestion controller", m_controllerType);
+  cmd.AddValue ("distributed", "Run the controller on every OBU instead of the RSU", m_distributed);
+  cmd.AddValue ("cullReceivers", "Skip the PHYs out of reception range in the Wi-Fi channel", m_cullReceivers);
+  cmd.AddValue ("batchDelivery", "Deliver the Wi-Fi receptions with the same delay, and the CSMA receptions, by one event", m_batchDelivery);
+  cmd.AddValue ("cacheLinkBudget", "Cache the RX power and delay between static nodes in the Wi-Fi channel", m_cacheLinkBudget);
+  cmd.AddValue ("errorRateTables", "Interpolate the Wi-Fi chunk success rates in precomputed tables", m_errorRateTables);
+  cmd.Parse (argc, argv);
+
+  m_itt = m_initItt;
+}
+
+void
+V2xCongestionScenario::ConfigureNodes ()
+{
+  m_nodes.Create (1 + m_obuNodes);
+}
+
+void
+V2xCongestionScenario::ConfigureDevices ()
+{
+  m_wifiPhy = YansWifiPhyHelper::Default ();
+  YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default ();
+  Ptr<YansWifiChannel> channel = wifiChannel.Create ();
+  if (m_cullReceivers)
+    {
+      // the default loss model is deterministic: no PHY beyond the range
+      // where the TX power falls below the sensitivity can receive anything
+      Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+      double range = channel->ComputeMaxRange (phy->GetTxPowerEnd (), phy->GetRxSensitivity ());
+      channel->SetAttribute ("MaxRange", DoubleValue (range));
+    }
+  channel->SetAttribute ("BatchDelivery", BooleanValue (m_batchDelivery));
+  channel->SetAttribute ("CacheLinkBudget", BooleanValue (m_cacheLinkBudget));
+  m_wifiPhy.SetChannel (channel);
+  if (m_errorRateTables)
+    {
+      m_wifiPhy.SetErrorRateModel ("ns3::NistErrorRateModel", "UseTables", BooleanValue (true));
+    }
+  m_wifiPhy.SetPcapDataLinkType (WifiPhyHelper::DLT_IEEE802_11);
+  NqosWaveMacHelper wifi80211pMac = NqosWaveMacHelper::Default ();
+  Wifi80211pHelper wifi80211p = Wifi80211pHelper::Default ();
+  if (m_verbose)
+    {
+      wifi80211p.EnableLogComponents ();      // Turn on all Wifi 802.11p logging
+    }
+  wifi80211p.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                      "DataMode",StringValue (m_phyMode),
+                                      "ControlMode",StringValue (m_phyMode));
+  m_wifiDevices = wifi80211p.Install (m_wifiPhy, wifi80211pMac, m_nodes);
+
+  m_csma.SetChannelAttribute ("DataRate", DataRateValue (DataRate (5000000)));
+  m_csma.SetChannelAttribute ("Delay", TimeValue (NanoSeconds (50)));
+  m_csma.SetChannelAttribute ("BatchDelivery", BooleanValue (m_batchDelivery));
+  m_csmaDevices = m_csma.Install (m_nodes);
+}
+
+void
+V2xCongestionScenario::ConfigureMobility ()
+{
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  // RSU in front of the middle of the grid
+  positionAlloc->Add (Vector (m_obuNodes / (2 * m_rowLine), 0.0, 0.0));
+  uint32_t perRow = (m_obuNodes + m_rowLine - 1) / m_rowLine;
+  for (uint32_t i = 0; i < m_obuNodes; i++)
+    {
+      positionAlloc->Add (Vector (i % perRow, 1 + i / perRow, 0.0));
+    }
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (m_nodes);
+}
+
+void
+V2xCongestionScenario::ConfigureApplications ()
+{
+  InternetStackHelper internet;
+  internet.Install (m_nodes);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.0.0.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (NetDeviceContainer (m_wifiDevices, m_csmaDevices));
+  for (uint32_t i = 0; i < m_wifiDevices.GetN (); i++)
+    {
+      m_wifiNodes[interfaces.GetAddress (i)] = m_wifiDevices.Get (i)->GetNode ()->GetId ();
+    }
+
+  TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+  Ptr<Node> rsu = m_nodes.Get (0);
+
+  // RSU: CBR measured over one epoch, WSA source, BSM and PVD sinks
+  m_rsuMonitor = CreateObject<ChannelBusyRatioMonitor> ();
+  m_rsuMonitor->SetAttribute ("Window", TimeValue (Seconds (m_epoch)));
+  m_rsuMonitor->Attach (m_wifiDevices.Get (0));
+  m_rsuController = CreateController ();
+
+  m_wsaSource = Socket::CreateSocket (rsu, tid);
+  m_wsaSource->SetAllowBroadcast (true);
+  m_wsaSource->Connect (InetSocketAddress (Ipv4Address ("255.255.255.255"), 80));
+
+  // the BSMs are broadcast on every interface: only count those heard over 802.11p,
+  // not the copies flooded on the CSMA backhaul
+  Ptr<Socket> bsmSink = Socket::CreateSocket (rsu, tid);
+  bsmSink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  bsmSink->BindToNetDevice (m_wifiDevices.Get (0));
+  bsmSink->SetRecvCallback (MakeCallback (&V2xCongestionScenario::ReceiveBsm, this));
+
+  Ptr<Socket> pvdSink = Socket::CreateSocket (rsu, tid);
+  pvdSink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 100));
+  pvdSink->SetRecvCallback (MakeCallback (&V2xCongestionScenario::ReceivePvd, this));
+
+  // OBUs: WSA sink, BSM source running for the whole simulation, PVD source
+  OnOffHelper onoff ("ns3::UdpSocketFactory",
+                     Address (InetSocketAddress (Ipv4Address ("255.255.255.255"), 9)));
+  onoff.SetConstantRate (IttToDataRate (m_initItt), m_bsmPacketSize);
+  // spread the first BSMs over one ITT: started together, the sources
+  // would all transmit at once and every BSM would collide on the air
+  Ptr<UniformRandomVariable> bsmStart = CreateObject<UniformRandomVariable> ();
+  bsmStart->SetAttribute ("Max", DoubleValue (m_initItt));
+
+  m_bsmSources.assign (m_nodes.GetN (), 0);
+  m_obuMonitors.assign (m_nodes.GetN (), 0);
+  m_obuControllers.assign (m_nodes.GetN (), 0);
+  m_neighbors.assign (m_nodes.GetN (), std::set<uint32_t> ());
+  for (uint32_t i = 1; i < m_nodes.GetN (); i++)
+    {
+      Ptr<Node> obu = m_nodes.Get (i);
+
+      if (m_distributed)
+        {
+          // CBR of its own PHY, neighbors from the BSMs it hears
+          Ptr<ChannelBusyRatioMonitor> monitor = CreateObject<ChannelBusyRatioMonitor> ();
+          monitor->SetAttribute ("Window", TimeValue (Seconds (m_epoch)));
+          monitor->Attach (m_wifiDevices.Get (i));
+          m_obuMonitors[obu->GetId ()] = monitor;
+          m_obuControllers[obu->GetId ()] = CreateController ();
+
+          Ptr<Socket> bsmSink = Socket::CreateSocket (obu, tid);
+          bsmSink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+          bsmSink->BindToNetDevice (m_wifiDevices.Get (i));
+          bsmSink->SetRecvCallback (MakeCallback (&V2xCongestionScenario::ReceiveNeighborBsm, this));
+        }
+      else
+        {
+          Ptr<Socket> wsaSink = Socket::CreateSocket (obu, tid);
+          wsaSink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 80));
+          wsaSink->SetRecvCallback (MakeCallback (&V2xCongestionScenario::ReceiveWsa, this));
+        }
+
+      ApplicationContainer app = onoff.Install (obu);
+      app.Start (Seconds (0.0001 + bsmStart->GetValue ()));
+      app.Stop (Seconds (m_totalTime * m_epoch + 0.0001));
+      m_bsmSources[obu->GetId ()] = DynamicCast<OnOffApplication> (app.Get (0));
+
+      Ptr<Socket> pvdSource = Socket::CreateSocket (obu, tid);
+      pvdSource->SetAllowBroadcast (true);
+      pvdSource->Connect (InetSocketAddress (Ipv4Address ("255.255.255.255"), 100));
+      Simulator::ScheduleWithContext (obu->GetId (), Seconds (m_epoch),
+                                      &V2xCongestionScenario::SendPvd, this, pvdSource);
+    }
+
+  for (uint32_t j = 1; j <= m_totalTime; j++)
+    {
+      if (m_distributed)
+        {
+          Simulator::Schedule (Seconds (j * m_epoch),
+                               &V2xCongestionScenario::DistributedControlEpoch, this);
+        }
+      else
+        {
+          Simulator::ScheduleWithContext (rsu->GetId (), Seconds (j * m_epoch),
+                                          &V2xCongestionScenario::ControlEpoch, this);
+        }
+    }
+}
+
+void
+V2xCongestionScenario::ConfigureTracing ()
+{
+  if (m_pcap)
+    {
+      m_wifiPhy.EnablePcap ("wave-simple-80211p", false);
+    }
+  if (m_ascii)
+    {
+      AsciiTraceHelper ascii;
+      m_csma.EnableAsciiAll (ascii.CreateFileStream ("WSA_example.tr"));
+    }
+  if (!m_binaryTraceFile.empty ())
+    {
+      m_binaryTrace = CreateObject<BinaryTraceRecorder> ();
+      m_binaryTrace->Open (m_binaryTraceFile);
+      m_binaryTrace->EnablePacketTraces (m_wifiDevices);
+      m_binaryTrace->EnablePacketTraces (m_csmaDevices);
+    }
+  if (!m_pcapngFile.empty ())
+    {
+      m_pcapng = CreateObject<PcapngFileWriter> ();
+      m_pcapng->Open (m_pcapngFile);
+      if (m_pcapngFilter == "rsu")
+        {
+          m_pcapng->SetCaptureFilter (MakeCallback (&V2xCongestionScenario::CaptureRsu, this));
+        }
+      else if (m_pcapngFilter == "bsm")
+        {
+          m_pcapng->SetCaptureFilter (MakeCallback (&V2xCongestionScenario::CaptureBsm, this));
+        }
+      else
+        {
+          NS_ABORT_MSG_UNLESS (m_pcapngFilter == "all", "Unknown pcapng filter " << m_pcapngFilter);
+        }
+      m_wifiPhy.EnablePcapng (m_pcapng, m_wifiDevices);
+      m_csma.EnablePcapng (m_pcapng, m_csmaDevices);
+    }
+  if (!m_animFile.empty ())
+    {
+      m_anim = new AnimationInterface (m_animFile);
+      m_anim->UpdateNodeSize (0, 3, 3);
+      m_anim->SetMaxPktsPerTraceFile (500000);
+      m_anim->SetPacketSampling (m_animSampling);
+      m_anim->SetMobilityThreshold (m_animMobilityThreshold);
+    }
+
+  m_results = CreateObject<ResultsSink> ();
+  m_results->SetAttribute ("FileName", StringValue (m_outputFile));
+  m_results->SetAttribute ("Format", EnumValue (m_outputFormat == "sqlite" ? ResultsSink::SQLITE : ResultsSink::CSV));
+  m_results->SetAttribute ("TableName", StringValue ("v2x"));
+  m_timeColumn = m_results->AddColumn ("time", ResultsSink::DOUBLE);
+  m_cbrColumn = m_results->AddColumn ("cbr", ResultsSink::DOUBLE);
+  m_wsaTimeColumn = m_results->AddColumn ("wsa_time", ResultsSink::DOUBLE);
+  m_ittColumn = m_results->AddColumn ("itt", ResultsSink::DOUBLE);
+}
+
+void
+V2xCongestionScenario::RunSimulation ()
+{
+  Simulator::Stop (Seconds (m_totalTime * m_epoch + 0.001));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+V2xCongestionScenario::ProcessOutputs ()
+{
+  m_results->Dispose ();
+  if (m_binaryTrace != 0)
+    {
+      m_binaryTrace->Close ();
+      std::cout << m_binaryTrace->GetRecordCount () << " packet events recorded to " << m_binaryTraceFile << std::endl;
+    }
+  if (m_pcapng != 0)
+    {
+      m_pcapng->Close ();
+      std::cout << m_pcapng->GetPacketCount () << " packets captured to " << m_pcapngFile << std::endl;
+    }
+  std::cout << "PVDs received by the RSU: " << m_pvdRxCount << std::endl;
+  if (m_anim != 0)
+    {
+      std::cout << "Animation Trace file created:" << m_animFile << std::endl;
+    }
+}
+
+void
+V2xCongestionScenario::ControlEpoch ()
+{
+  double cbr = m_rsuMonitor->GetChannelBusyRatio () * 100;
+  // J2945/1 density: the vehicles actually heard by the RSU during the epoch
+  m_itt = m_rsuController->Update (cbr / 100, m_neighbors[0].size ()).GetSeconds ();
+  m_neighbors[0].clear ();
+
+  std::cout << Simulator::Now ().GetSeconds () << "s>> Channel Busy Ratio: " << cbr << "[%], "
+            << m_bsmRxCount << " BSMs received, next ITT " << m_itt << "[s]" << std::endl;
+  m_bsmRxCount = 0;
+
+  WriteEpoch (cbr);
+
+  std::string payload = std::to_string (IttToDataRate (m_itt).GetBitRate ()) + "b/s";
+  m_wsaSource->Send (Create<Packet> (reinterpret_cast<const uint8_t *> (payload.c_str ()),
+                                     payload.size () + 1));
+}
+
+void
+V2xCongestionScenario::DistributedControlEpoch ()
+{
+  double cbrSum = 0;
+  double ittSum = 0;
+  for (uint32_t i = 1; i < m_nodes.GetN (); i++)
+    {
+      // each OBU decides alone from its own measurements
+      double cbr = m_obuMonitors[i]->GetChannelBusyRatio ();
+      Time itt = m_obuControllers[i]->Update (cbr, m_neighbors[i].size ());
+      m_neighbors[i].clear ();
+      // the BSM rescheduled by SetDataRate must run on the OBU, not in NO_CONTEXT
+      Simulator::ScheduleWithContext (m_nodes.Get (i)->GetId (), Seconds (0),
+                                      &OnOffApplication::SetDataRate, m_bsmSources[i],
+                                      IttToDataRate (itt.GetSeconds ()));
+      cbrSum += cbr;
+      ittSum += itt.GetSeconds ();
+    }
+  double cbr = 0;
+  if (m_obuNodes > 0)
+    {
+      cbr = cbrSum / m_obuNodes * 100;
+      m_itt = ittSum / m_obuNodes;
+    }
+
+  std::cout << Simulator::Now ().GetSeconds () << "s>> Mean Channel Busy Ratio: " << cbr << "[%], "
+            << m_bsmRxCount << " BSMs received, mean ITT " << m_itt << "[s]" << std::endl;
+  m_bsmRxCount = 0;
+
+  WriteEpoch (cbr);
+}
+
+void
+V2xCongestionScenario::WriteEpoch (double cbr)
+{
+  m_results->Set (m_timeColumn, Simulator::Now ());
+  m_results->Set (m_cbrColumn, cbr);
+  m_results->Set (m_wsaTimeColumn, m_wsaRxTime);
+  m_results->Set (m_ittColumn, m_itt);
+  m_results->CommitRow ();
+}
+
+Ptr<CongestionController>
+V2xCongestionScenario::CreateController () const
+{
+  ObjectFactory factory;
+  factory.SetTypeId (m_controllerType);
+  factory.Set ("InitialItt", TimeValue (Seconds (m_initItt)));
+  Ptr<CongestionController> controller = factory.Create<CongestionController> ();
+  NS_ABORT_MSG_IF (controller == 0, m_controllerType << " is not a CongestionController");
+  return controller;
+}
+
+bool
+V2xCongestionScenario::CaptureRsu (Ptr<NetDevice> device, Ptr<const Packet> packet)
+{
+  return device->GetNode () == m_nodes.Get (0);
+}
+
+bool
+V2xCongestionScenario::CaptureBsm (Ptr<NetDevice> device, Ptr<const Packet> packet)
+{
+  // link header: 802.11 MAC header and LLC/SNAP, or Ethernet II on the CSMA backhaul
+  uint32_t offset = 14;
+  if (DynamicCast<WifiNetDevice> (device) != 0)
+    {
+      WifiMacHeader hdr;
+      packet->PeekHeader (hdr);
+      if (!hdr.IsData ())
+        {
+          return false;
+        }
+      offset = hdr.GetSize () + 8;
+    }
+  // ethertype, IPv4 header without options and UDP ports
+  uint8_t buffer[128];
+  if (packet->CopyData (buffer, offset + 24) < offset + 24)
+    {
+      return false;
+    }
+  uint32_t ihl = (buffer[offset] & 0x0f) * 4;
+  if (buffer[offset - 2] != 0x08 || buffer[offset - 1] != 0x00 || buffer[offset + 9] != 17
+      || packet->CopyData (buffer, offset + ihl + 4) < offset + ihl + 4)
+    {
+      return false;
+    }
+  return ((buffer[offset + ihl + 2] << 8) | buffer[offset + ihl + 3]) == 9;
+}
+
+DataRate
+V2xCongestionScenario::IttToDataRate (double itt) const
+{
+  return DataRate (static_cast<uint64_t> (m_bsmPacketSize * 8 / itt));
+}
+
+void
+V2xCongestionScenario::ReceiveWsa (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      std::string payload (packet->GetSize (), '\0');
+      packet->CopyData (reinterpret_cast<uint8_t *> (&payload[0]), payload.size ());
+      payload.resize (payload.find ('\0'));
+
+      // push the advertised rate to the running BSM source of this OBU;
+      // the pending BSM is rescheduled at the new rate on the same socket
+      Ptr<OnOffApplication> source = m_bsmSources[socket->GetNode ()->GetId ()];
+      source->SetDataRate (DataRate (payload));
+      m_wsaRxTime = Simulator::Now ().GetSeconds ();
+    }
+}
+
+void
+V2xCongestionScenario::ReceiveBsm (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  Address from;
+  while ((packet = socket->RecvFrom (from)))
+    {
+      m_bsmRxCount++;
+      m_neighbors[socket->GetNode ()->GetId ()].insert (m_wifiNodes[InetSocketAddress::ConvertFrom (from).GetIpv4 ()]);
+    }
+}
+
+void
+V2xCongestionScenario::ReceiveNeighborBsm (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  Address from;
+  while ((packet = socket->RecvFrom (from)))
+    {
+      m_neighbors[socket->GetNode ()->GetId ()].insert (m_wifiNodes[InetSocketAddress::ConvertFrom (from).GetIpv4 ()]);
+    }
+}
+
+void
+V2xCongestionScenario::ReceivePvd (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_pvdRxCount++;
+    }
+}
+
+void
+V2xCongestionScenario::SendPvd (Ptr<Socket> socket)
+{
+  std::string message = "car_info";
+  socket->Send (Create<Packet> (reinterpret_cast<const uint8_t *> (message.c_str ()), message.size ()));
+  if (Simulator::Now () + Seconds (m_epoch) <= Seconds (m_totalTime * m_epoch))
+    {
+      Simulator::Schedule (Seconds (m_epoch), &V2xCongestionScenario::SendPvd, this, socket);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  V2xCongestionScenario scenario;
+  scenario.Simulate (argc, argv);
+  return 0;
+}
@@ -58,7 +58,8 @@ OnOffApplication::GetTypeId (void)
     .AddConstructor<OnOffApplication> ()
     .AddAttribute ("DataRate", "The data rate in on state.",
                    DataRateValue (DataRate ("500kb/s")),
-                   MakeDataRateAccessor (&OnOffApplication::m_cbrRate),
+                   MakeDataRateAccessor (&OnOffApplication::SetDataRate,
+                                         &OnOffApplication::GetDataRate),
                    MakeDataRateChecker ())
     .AddAttribute ("PacketSize", "The size of packets sent in on state",
                    UintegerValue (512),
@@ -108,6 +109,9 @@ OnOffApplication::GetTypeId (void)
     .AddTraceSource ("TxWithSeqTsSize", "A new packet is created with SeqTsSizeHeader",
                      MakeTraceSourceAccessor (&OnOffApplication::m_txTraceWithSeqTsSize),
                      "ns3::PacketSink::SeqTsSizeCallback")
+    .AddTraceSource ("DataRateChange", "The data rate in on state has changed",
+                     MakeTraceSourceAccessor (&OnOffApplication::m_dataRateChangeTrace),
+                     "ns3::OnOffApplication::DataRateChangeTracedCallback")
   ;
   return tid;
 }
@@ -136,6 +140,42 @@ OnOffApplication::SetMaxBytes (uint64_t maxBytes)
   m_maxBytes = maxBytes;
 }
 
+void
+OnOffApplication::SetDataRate (DataRate rate)
+{
+  NS_LOG_FUNCTION (this << rate);
+  DataRate oldRate = m_cbrRate;
+  if (oldRate == rate)
+    {
+      return;
+    }
+  if (m_sendEvent.IsRunning ())
+    {
+      // Bits generated at the old rate since the last packet are kept,
+      // and the pending packet is rescheduled at the new rate
+      Time delta (Simulator::Now () - m_lastStartTime);
+      int64x64_t bits = delta.To (Time::S) * m_cbrRate.GetBitRate ();
+      m_residualBits += bits.GetHigh ();
+      m_lastStartTime = Simulator::Now ();
+      m_cbrRate = rate;
+      m_cbrRateFailSafe = rate;
+      Simulator::Cancel (m_sendEvent);
+      ScheduleNextTx ();
+    }
+  else
+    {
+      m_cbrRate = rate;
+      m_cbrRateFailSafe = rate;
+    }
+  m_dataRateChangeTrace (oldRate, rate);
+}
+
+DataRate
+OnOffApplication::GetDataRate (void) const
+{
+  return m_cbrRate;
+}
+
 Ptr<Socket>
 OnOffApplication::GetSocket (void) const
 {
@@ -115,6 +115,31 @@ public:
    */
   void SetMaxBytes (uint64_t maxBytes);
 
+  /**
+   * \brief Set the data rate in on state.
+   *
+   * May be called while the application is running: the bits already
+   * generated at the previous rate are kept and the pending packet is
+   * rescheduled at the new rate, on the same socket.
+   *
+   * \param rate the data rate in on state
+   */
+  void SetDataRate (DataRate rate);
+
+  /**
+   * \brief Get the data rate in on state.
+   * \return the data rate in on state
+   */
+  DataRate GetDataRate (void) const;
+
+  /**
+   * TracedCallback signature for data rate changes.
+   *
+   * \param [in] oldRate The previous data rate.
+   * \param [in] newRate The new data rate.
+   */
+  typedef void (* DataRateChangeTracedCallback)(DataRate oldRate, DataRate newRate);
+
   /**
    * \brief Return a pointer to associated socket.
    * \return pointer to associated socket
@@ -187,6 +212,9 @@ private:
   /// Callback for tracing the packet Tx events, includes source, destination, the packet sent, and header
   TracedCallback<Ptr<const Packet>, const Address &, const Address &, const SeqTsSizeHeader &> m_txTraceWithSeqTsSize;
 
+  /// Traced Callback: data rate changes.
+  TracedCallback<DataRate, DataRate> m_dataRateChangeTrace;
+
 private:
   /**
    * \brief Schedule the next packet transmission
@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/nstime.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/application-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/string.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/onoff-application.h"
+#include "ns3/on-off-helper.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Checks that the data rate of a running OnOffApplication can be changed
+ * on the same socket, that the pending packet is rescheduled at the new
+ * rate, and that the DataRateChange trace fires once per change.
+ */
+class OnOffDataRateChangeTestCase : public TestCase
+{
+public:
+  OnOffDataRateChangeTestCase ();
+  virtual ~OnOffDataRateChangeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Record a packet sent
+   * \param p the packet
+   */
+  void SendTx (Ptr<const Packet> p);
+  /**
+   * Record a data rate change
+   * \param oldRate the previous rate
+   * \param newRate the new rate
+   */
+  void RateChange (DataRate oldRate, DataRate newRate);
+
+  std::vector<Time> m_txTimes;   //!< transmission times
+  uint32_t m_rateChanges {0};    //!< number of rate changes traced
+  Ptr<Socket> m_socket;          //!< socket used before the change
+  bool m_sameSocket {true};      //!< the socket was never recreated
+  Ptr<OnOffApplication> m_app;   //!< application under test
+};
+
+OnOffDataRateChangeTestCase::OnOffDataRateChangeTestCase ()
+  : TestCase ("Change the data rate of a running OnOffApplication")
+{
+}
+
+OnOffDataRateChangeTestCase::~OnOffDataRateChangeTestCase ()
+{
+}
+
+void
+OnOffDataRateChangeTestCase::SendTx (Ptr<const Packet> p)
+{
+  m_txTimes.push_back (Simulator::Now ());
+  if (m_socket == 0)
+    {
+      m_socket = m_app->GetSocket ();
+    }
+  m_sameSocket = m_sameSocket && (m_socket == m_app->GetSocket ());
+}
+
+void
+OnOffDataRateChangeTestCase::RateChange (DataRate oldRate, DataRate newRate)
+{
+  m_rateChanges++;
+}
+
+void
+OnOffDataRateChangeTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper simpleHelper;
+  NetDeviceContainer devices = simpleHelper.Install (nodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer i = ipv4.Assign (devices);
+
+  // 1000 bytes at 80 kb/s: one packet every 100 ms
+  OnOffHelper onoff ("ns3::UdpSocketFactory", InetSocketAddress (i.GetAddress (1), 9));
+  onoff.SetConstantRate (DataRate ("80kb/s"), 1000);
+  ApplicationContainer apps = onoff.Install (nodes.Get (0));
+  apps.Start (Seconds (0));
+  apps.Stop (Seconds (1));
+  m_app = DynamicCast<OnOffApplication> (apps.Get (0));
+  m_app->TraceConnectWithoutContext ("Tx", MakeCallback (&OnOffDataRateChangeTestCase::SendTx, this));
+  m_app->TraceConnectWithoutContext ("DataRateChange", MakeCallback (&OnOffDataRateChangeTestCase::RateChange, this));
+
+  // halfway to the packet due at 300 ms, double the rate: the 4000 bits
+  // generated so far are kept, the remaining 4000 bits take 25 ms
+  Simulator::Schedule (MilliSeconds (250), &OnOffApplication::SetDataRate, m_app, DataRate ("160kb/s"));
+  // setting the same rate again is not a change
+  Simulator::Schedule (MilliSeconds (260), &OnOffApplication::SetDataRate, m_app, DataRate ("160kb/s"));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_rateChanges, 1, "Unexpected number of rate changes");
+  NS_TEST_ASSERT_MSG_EQ (m_sameSocket, true, "Socket was recreated");
+  NS_TEST_ASSERT_MSG_GT (m_txTimes.size (), 3, "Too few packets sent");
+  NS_TEST_ASSERT_MSG_EQ (m_txTimes[0], MilliSeconds (100), "Unexpected time of the first packet");
+  NS_TEST_ASSERT_MSG_EQ (m_txTimes[1], MilliSeconds (200), "Unexpected time of the second packet");
+  // the residual bits are truncated, as in CancelEvents (), hence the tolerance
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_txTimes[2], MilliSeconds (275), MicroSeconds (10), "Pending packet not rescheduled at the new rate");
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_txTimes[3], MilliSeconds (325), MicroSeconds (10), "New rate not applied to the next packet");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief OnOffApplication TestSuite
+ */
+class OnOffApplicationTestSuite : public TestSuite
+{
+public:
+  OnOffApplicationTestSuite ();
+};
+
+OnOffApplicationTestSuite::OnOffApplicationTestSuite ()
+  : TestSuite ("applications-onoff", UNIT)
+{
+  AddTestCase (new OnOffDataRateChangeTestCase, TestCase::QUICK);
+}
+
+static OnOffApplicationTestSuite g_onOffApplicationTestSuite; //!< Static variable for test initialization
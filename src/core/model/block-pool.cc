@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "block-pool.h"
+
+#include <new>
+
+/**
+ * \file
+ * \ingroup ptr
+ * ns3::BlockPool implementation.
+ */
+
+namespace ns3 {
+
+BlockPool::BlockPool (State *state)
+  : m_state (state)
+{
+  for (std::size_t i = 0; i < N_CLASSES; i++)
+    {
+      m_free[i] = 0;
+    }
+  m_stats.allocations = 0;
+  m_stats.recycled = 0;
+  m_stats.releases = 0;
+  m_stats.cached = 0;
+  m_stats.cachedBytes = 0;
+  *m_state = ALIVE;
+}
+
+BlockPool::~BlockPool ()
+{
+  for (std::size_t i = 0; i < N_CLASSES; i++)
+    {
+      while (m_free[i] != 0)
+        {
+          Block *block = m_free[i];
+          m_free[i] = block->next;
+          ::operator delete (block);
+        }
+    }
+  *m_state = DESTROYED;
+}
+
+void *
+BlockPool::Allocate (std::size_t size)
+{
+  m_stats.allocations++;
+  std::size_t sizeClass = (size - 1) / GRANULARITY;
+  if (sizeClass >= N_CLASSES)
+    {
+      return ::operator new (size);
+    }
+  Block *block = m_free[sizeClass];
+  if (block == 0)
+    {
+      return ::operator new ((sizeClass + 1) * GRANULARITY);
+    }
+  m_free[sizeClass] = block->next;
+  m_stats.recycled++;
+  m_stats.cached--;
+  m_stats.cachedBytes -= (sizeClass + 1) * GRANULARITY;
+  return block;
+}
+
+void
+BlockPool::Deallocate (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  m_stats.releases++;
+  std::size_t sizeClass = (size - 1) / GRANULARITY;
+  if (sizeClass >= N_CLASSES)
+    {
+      ::operator delete (p);
+      return;
+    }
+  Block *block = static_cast<Block *> (p);
+  block->next = m_free[sizeClass];
+  m_free[sizeClass] = block;
+  m_stats.cached++;
+  m_stats.cachedBytes += (sizeClass + 1) * GRANULARITY;
+}
+
+BlockPool::Stats
+BlockPool::GetStats (void) const
+{
+  return m_stats;
+}
+
+} // namespace ns3
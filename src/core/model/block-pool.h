@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BLOCK_POOL_H
+#define BLOCK_POOL_H
+
+#include <stdint.h>
+#include <cstddef>
+
+/**
+ * \file
+ * \ingroup ptr
+ * ns3::BlockPool declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup ptr
+ * \brief Free lists of memory blocks of a few size classes.
+ *
+ * Used by the classes whose small objects are allocated and released at
+ * a high rate, such as EventImpl and CallbackImplBase, through their
+ * class-specific operator new and operator delete, with one pool per
+ * thread.  The blocks of up to MAX_SIZE bytes are allocated one by one
+ * from the heap, rounded up to a multiple of GRANULARITY bytes, and kept
+ * in the free lists when they are released, so a block may be released
+ * to the pool of any thread.  They are returned to the heap when the
+ * pool is destroyed.
+ *
+ * A thread_local pool is destroyed while its thread exits, before the
+ * objects released by the other destructors run at that time, and it
+ * must not be used afterwards.  The pool therefore records its State
+ * in a flag given to its constructor, which must be trivially
+ * destructible, such as a thread_local State, so it can still be read:
+ * the objects allocated or released once the State is DESTROYED go
+ * directly to the heap.
+ */
+class BlockPool
+{
+public:
+  /** The size classes are multiples of this size, in bytes. */
+  static const std::size_t GRANULARITY = 16;
+  /** The number of size classes. */
+  static const std::size_t N_CLASSES = 16;
+  /** The size of the largest blocks pooled; larger ones go to the heap. */
+  static const std::size_t MAX_SIZE = GRANULARITY * N_CLASSES;
+
+  /** Statistics of a pool. */
+  struct Stats
+  {
+    uint64_t allocations;  /**< The number of blocks allocated. */
+    uint64_t recycled;     /**< The number of blocks allocated from a free list. */
+    uint64_t releases;     /**< The number of blocks released. */
+    uint64_t cached;       /**< The number of blocks in the free lists. */
+    uint64_t cachedBytes;  /**< The size of the blocks in the free lists. */
+  };
+
+  /** The state of a pool. */
+  enum State
+  {
+    UNUSED = 0,  /**< The pool has not been constructed yet. */
+    ALIVE,       /**< The pool may be used. */
+    DESTROYED    /**< The pool has been destroyed. */
+  };
+
+  /**
+   * Constructor.
+   * \param [in] state The flag in which the state of the pool is recorded.
+   */
+  BlockPool (State *state);
+  ~BlockPool ();
+
+  /**
+   * Allocate a block, from a free list if possible.
+   * \param [in] size The size of the block.
+   * \returns The block.
+   */
+  void * Allocate (std::size_t size);
+  /**
+   * Release a block to a free list.
+   * \param [in] p The block, or 0.
+   * \param [in] size The size of the block, as given to Allocate().
+   */
+  void Deallocate (void *p, std::size_t size);
+  /**
+   * Get the statistics of the pool.
+   * \returns The statistics.
+   */
+  Stats GetStats (void) const;
+
+private:
+  /** A free block, linked to the next one of its size class. */
+  struct Block
+  {
+    Block *next;  /**< The next free block. */
+  };
+  /** The first free block of each size class. */
+  Block *m_free[N_CLASSES];
+  /** The statistics. */
+  Stats m_stats;
+  /** The state of the pool, kept outside of it. */
+  State *m_state;
+};
+
+} // namespace ns3
+
+#endif /* BLOCK_POOL_H */
@@ -31,6 +31,42 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Callback");
 
+/** The state of the CallbackImpl pool of the calling thread. */
+static thread_local BlockPool::State g_callbackPoolState = BlockPool::UNUSED;
+/** The CallbackImpl pool of the calling thread. */
+static thread_local BlockPool g_callbackPool (&g_callbackPoolState);
+
+void *
+CallbackImplBase::operator new (std::size_t size)
+{
+  if (g_callbackPoolState == BlockPool::DESTROYED)
+    {
+      return ::operator new (size);
+    }
+  return g_callbackPool.Allocate (size);
+}
+
+void
+CallbackImplBase::operator delete (void *p, std::size_t size)
+{
+  if (g_callbackPoolState == BlockPool::DESTROYED)
+    {
+      ::operator delete (p);
+      return;
+    }
+  g_callbackPool.Deallocate (p, size);
+}
+
+BlockPool::Stats
+CallbackImplBase::GetPoolStats (void)
+{
+  if (g_callbackPoolState == BlockPool::DESTROYED)
+    {
+      return BlockPool::Stats ();
+    }
+  return g_callbackPool.GetStats ();
+}
+
 CallbackValue::CallbackValue ()
   : m_value ()
 {
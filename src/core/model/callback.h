@@ -28,6 +28,7 @@
 #include "attribute.h"
 #include "attribute-helper.h"
 #include "simple-ref-count.h"
+#include "block-pool.h"
 #include <typeinfo>
 
 /**
@@ -103,6 +104,11 @@ struct CallbackTraits<T *>
  * \ingroup callbackimpl
  * Abstract base class for CallbackImpl
  * Provides reference counting and equality test.
+ *
+ * The CallbackImpl objects are allocated from a BlockPool per thread,
+ * so binding a callback whose bound state fits in BlockPool::MAX_SIZE
+ * bytes does not call the heap allocator once a block of its size has
+ * been released.  Copying a Callback only shares its CallbackImpl.
  */
 class CallbackImplBase : public SimpleRefCount<CallbackImplBase>
 {
@@ -110,6 +116,23 @@ public:
   /** Virtual destructor */
   virtual ~CallbackImplBase ()
   {}
+  /**
+   * Allocate a CallbackImpl, from a free list if possible.
+   * \param [in] size The size of the CallbackImpl.
+   * \returns The memory allocated.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Release a CallbackImpl to a free list.
+   * \param [in] p The CallbackImpl.
+   * \param [in] size The size of the CallbackImpl.
+   */
+  static void operator delete (void *p, std::size_t size);
+  /**
+   * Get the statistics of the CallbackImpl allocator of the calling thread.
+   * \returns The statistics.
+   */
+  static BlockPool::Stats GetPoolStats (void);
   /**
    * Equality test
    *
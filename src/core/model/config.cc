@@ -24,8 +24,10 @@
 #include "object-ptr-container.h"
 #include "names.h"
 #include "pointer.h"
+#include "simple-ref-count.h"
 #include "log.h"
 
+#include <map>
 #include <sstream>
 
 /**
@@ -40,6 +42,12 @@ NS_LOG_COMPONENT_DEFINE ("Config");
 
 namespace Config {
 
+/**
+ * \ingroup config-impl
+ * The maximum number of Config paths kept parsed.
+ */
+static const std::size_t MAX_COMPILED_PATHS = 1024;
+
 MatchContainer::MatchContainer ()
 {
   NS_LOG_FUNCTION (this);
@@ -182,6 +190,8 @@ MatchContainer::DisconnectWithoutContext (std::string name, const CallbackBase &
 /**
  * \ingroup config-impl
  * Helper to test if an array entry matches a config path specification.
+ *
+ * The specification is parsed once, into a list of index ranges.
  */
 class ArrayMatcher
 {
@@ -201,6 +211,12 @@ public:
   bool Matches (std::size_t i) const;
 
 private:
+  /**
+   * Add the ranges of indices matching a Config path specification.
+   *
+   * \param [in] element The Config path specification.
+   */
+  void Parse (std::string element);
   /**
    * Convert a string to an \c uint32_t.
    *
@@ -211,75 +227,79 @@ private:
   bool StringToUint32 (std::string str, uint32_t *value) const;
   /** The Config path element. */
   std::string m_element;
+  /** Whether all the indices match. */
+  bool m_all;
+  /** The bounds, inclusive, of the ranges of matching indices. */
+  std::vector<std::pair<uint32_t, uint32_t> > m_ranges;
 
 };  // class ArrayMatcher
 
 
 ArrayMatcher::ArrayMatcher (std::string element)
-  : m_element (element)
+  : m_element (element),
+    m_all (false)
 {
   NS_LOG_FUNCTION (this << element);
+  Parse (element);
 }
-bool
-ArrayMatcher::Matches (std::size_t i) const
+void
+ArrayMatcher::Parse (std::string element)
 {
-  NS_LOG_FUNCTION (this << i);
-  if (m_element == "*")
+  NS_LOG_FUNCTION (this << element);
+  if (element == "*")
     {
-      NS_LOG_DEBUG ("Array " << i << " matches *");
-      return true;
+      m_all = true;
+      return;
     }
   std::string::size_type tmp;
-  tmp = m_element.find ("|");
+  tmp = element.find ("|");
   if (tmp != std::string::npos)
     {
-      std::string left = m_element.substr (0, tmp - 0);
-      std::string right = m_element.substr (tmp + 1, m_element.size () - (tmp + 1));
-      ArrayMatcher matcher = ArrayMatcher (left);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array " << i << " matches " << left);
-          return true;
-        }
-      matcher = ArrayMatcher (right);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array " << i << " matches " << right);
-          return true;
-        }
-      NS_LOG_DEBUG ("Array " << i << " does not match " << m_element);
-      return false;
+      Parse (element.substr (0, tmp - 0));
+      Parse (element.substr (tmp + 1, element.size () - (tmp + 1)));
+      return;
     }
-  std::string::size_type leftBracket = m_element.find ("[");
-  std::string::size_type rightBracket = m_element.find ("]");
-  std::string::size_type dash = m_element.find ("-");
-  if (leftBracket == 0 && rightBracket == m_element.size () - 1
+  std::string::size_type leftBracket = element.find ("[");
+  std::string::size_type rightBracket = element.find ("]");
+  std::string::size_type dash = element.find ("-");
+  if (leftBracket == 0 && rightBracket == element.size () - 1
       && dash > leftBracket && dash < rightBracket)
     {
-      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
-      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
+      std::string lowerBound = element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = element.substr (dash + 1, rightBracket - (dash + 1));
       uint32_t min;
       uint32_t max;
       if (StringToUint32 (lowerBound, &min)
-          && StringToUint32 (upperBound, &max)
-          && i >= min && i <= max)
-        {
-          NS_LOG_DEBUG ("Array " << i << " matches " << m_element);
-          return true;
-        }
-      else
+          && StringToUint32 (upperBound, &max))
         {
-          NS_LOG_DEBUG ("Array " << i << " does not " << m_element);
-          return false;
+          m_ranges.push_back (std::make_pair (min, max));
         }
+      return;
     }
   uint32_t value;
-  if (StringToUint32 (m_element, &value)
-      && i == value)
+  if (StringToUint32 (element, &value))
     {
-      NS_LOG_DEBUG ("Array " << i << " matches " << m_element);
+      m_ranges.push_back (std::make_pair (value, value));
+    }
+}
+bool
+ArrayMatcher::Matches (std::size_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  if (m_all)
+    {
+      NS_LOG_DEBUG ("Array " << i << " matches *");
       return true;
     }
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator it = m_ranges.begin ();
+       it != m_ranges.end (); it++)
+    {
+      if (i >= it->first && i <= it->second)
+        {
+          NS_LOG_DEBUG ("Array " << i << " matches " << m_element);
+          return true;
+        }
+    }
   NS_LOG_DEBUG ("Array " << i << " does not match " << m_element);
   return false;
 }
@@ -294,6 +314,172 @@ ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
   return !iss.bad () && !iss.fail ();
 }
 
+/**
+ * \ingroup config-impl
+ * A Config path parsed into its elements.
+ *
+ * Each element records how it matches an object, whichever
+ * of the roles below it plays on the path, so that a path is parsed once
+ * however many objects it visits.  The attributes an element selects
+ * are also looked up once per TypeId of the objects it visits.  The
+ * objects are not indexed by TypeId: the resolution still visits every
+ * object of the containers along the path to test it.
+ */
+class CompiledPath : public SimpleRefCount<CompiledPath>
+{
+public:
+  /**
+   * Parse a Config path.
+   *
+   * \param [in] path The Config path.
+   */
+  CompiledPath (std::string path);
+
+  /** An attribute of an object selected by an element. */
+  struct Attribute
+  {
+    /** The attribute name. */
+    std::string name;
+    /** The attribute information, looked up by name on the object TypeId. */
+    struct TypeId::AttributeInformation info;
+    /** Whether the attribute is a pointer to an object. */
+    bool pointer;
+    /** Whether the attribute is a container of objects. */
+    bool container;
+  };
+  /** The attributes selected by an element. */
+  typedef std::vector<Attribute> Attributes;
+
+  /** An element of the path, between two slashes. */
+  struct Element
+  {
+    /**
+     * Constructor.
+     *
+     * \param [in] item The element.
+     */
+    Element (std::string item);
+
+    /** The element. */
+    std::string item;
+    /** Whether the remaining path starts with "/Names". */
+    bool names;
+    /** Whether the element is a call to GetObject, i.e.\ starts with a '$'. */
+    bool getObject;
+    /** Whether the TypeId of a call to GetObject was found. */
+    bool tidFound;
+    /** The TypeId of a call to GetObject. */
+    TypeId tid;
+    /** The matcher of the element as an index in a container. */
+    ArrayMatcher matcher;
+    /** The attributes selected by the element, by TypeId of the object. */
+    std::map<TypeId, Attributes> attributes;
+  };
+
+  /**
+   * Get the attributes of an object selected by an element.
+   *
+   * \param [in] element The element.
+   * \param [in] object The object.
+   * \returns The pointer and container attributes named by the element,
+   * in the order of the TypeId hierarchy of the object.
+   */
+  static const Attributes & GetAttributes (Element &element, Ptr<Object> object);
+
+  /** The elements of the path. */
+  std::vector<Element> m_elements;
+
+};  // class CompiledPath
+
+CompiledPath::Element::Element (std::string item)
+  : item (item),
+    names (item.compare (0, 5, "Names") == 0),
+    getObject (item.find ("$") == 0),
+    tidFound (false),
+    matcher (item)
+{
+  if (getObject)
+    {
+      tidFound = TypeId::LookupByNameFailSafe (item.substr (1, item.size () - 1), &tid);
+    }
+}
+
+CompiledPath::CompiledPath (std::string path)
+{
+  NS_LOG_FUNCTION (this << path);
+
+  // ensure that we start and end with a '/'
+  std::string::size_type tmp = path.find ("/");
+  if (tmp != 0)
+    {
+      // no slash at start
+      path = "/" + path;
+    }
+  tmp = path.find_last_of ("/");
+  if (tmp != (path.size () - 1))
+    {
+      // no slash at end
+      path = path + "/";
+    }
+
+  std::string::size_type current = 0;
+  std::string::size_type next;
+  while ((next = path.find ("/", current + 1)) != std::string::npos)
+    {
+      m_elements.push_back (Element (path.substr (current + 1, next - (current + 1))));
+      current = next;
+    }
+}
+
+const CompiledPath::Attributes &
+CompiledPath::GetAttributes (Element &element, Ptr<Object> object)
+{
+  TypeId instanceTid = object->GetInstanceTypeId ();
+  std::map<TypeId, Attributes>::iterator found = element.attributes.find (instanceTid);
+  if (found != element.attributes.end ())
+    {
+      return found->second;
+    }
+
+  Attributes &attributes = element.attributes[instanceTid];
+  TypeId tid;
+  TypeId nextTid = instanceTid;
+  do
+    {
+      tid = nextTid;
+
+      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info;
+          info = tid.GetAttribute (i);
+          if (info.name != element.item && element.item != "*")
+            {
+              continue;
+            }
+          Attribute attribute;
+          attribute.name = info.name;
+          // attempt to cast to a pointer checker.
+          attribute.pointer = dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0;
+          // attempt to cast to an object vector.
+          attribute.container =
+            dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0;
+          // this could be anything else and we don't know what to do with it.
+          // So, we just ignore it.
+          if (attribute.pointer || attribute.container)
+            {
+              // the value is got by name, as an attribute of a derived
+              // class hides the attributes of its parents with the same name
+              instanceTid.LookupAttributeByName (info.name, &attribute.info);
+              attributes.push_back (attribute);
+            }
+        }
+
+      nextTid = tid.GetParent ();
+    }
+  while (nextTid != tid);
+  return attributes;
+}
+
 /**
  * \ingroup config-impl
  * Abstract class to parse Config paths into object references.
@@ -302,11 +488,11 @@ class Resolver
 {
 public:
   /**
-   * Construct from a base Config path.
+   * Construct from a compiled Config path.
    *
    * \param [in] path The Config path.
    */
-  Resolver (std::string path);
+  Resolver (CompiledPath &path);
   /** Destructor. */
   virtual ~Resolver ();
 
@@ -320,23 +506,30 @@ public:
   void Resolve (Ptr<Object> root);
 
 private:
-  /** Ensure the Config path starts and ends with a '/'. */
-  void Canonicalize (void);
   /**
    * Parse the next element in the Config path.
    *
-   * \param [in] path The remaining portion of the Config path.
+   * \param [in] index The index of the next element of the Config path.
    * \param [in] root The object corresponding to the current position
    *                  in the Config path.
    */
-  void DoResolve (std::string path, Ptr<Object> root);
+  void DoResolve (std::size_t index, Ptr<Object> root);
   /**
    * Parse an index on the Config path.
    *
-   * \param [in] path The remaining Config path.
+   * \param [in] index The index of the next element of the Config path.
    * \param [in,out] vector The resulting list of matching objects.
    */
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoArrayResolve (std::size_t index, const ObjectPtrContainerValue &vector);
+  /**
+   * Get an attribute of an object.
+   *
+   * \param [in] object The object.
+   * \param [in] attribute The attribute.
+   * \param [out] value The value of the attribute.
+   */
+  void GetAttribute (Ptr<Object> object, const CompiledPath::Attribute &attribute,
+                     AttributeValue &value) const;
   /**
    * Handle one object found on the path.
    *
@@ -360,46 +553,26 @@ private:
   /** Current list of path tokens. */
   std::vector<std::string> m_workStack;
   /** The Config path. */
-  std::string m_path;
+  CompiledPath &m_path;
 
 };  // class Resolver
 
-Resolver::Resolver (std::string path)
+Resolver::Resolver (CompiledPath &path)
   : m_path (path)
 {
-  NS_LOG_FUNCTION (this << path);
-  Canonicalize ();
+  NS_LOG_FUNCTION (this << &path);
 }
 Resolver::~Resolver ()
 {
   NS_LOG_FUNCTION (this);
 }
-void
-Resolver::Canonicalize (void)
-{
-  NS_LOG_FUNCTION (this);
-
-  // ensure that we start and end with a '/'
-  std::string::size_type tmp = m_path.find ("/");
-  if (tmp != 0)
-    {
-      // no slash at start
-      m_path = "/" + m_path;
-    }
-  tmp = m_path.find_last_of ("/");
-  if (tmp != (m_path.size () - 1))
-    {
-      // no slash at end
-      m_path = m_path + "/";
-    }
-}
 
 void
 Resolver::Resolve (Ptr<Object> root)
 {
   NS_LOG_FUNCTION (this << root);
 
-  DoResolve (m_path, root);
+  DoResolve (0, root);
 }
 
 std::string
@@ -425,13 +598,25 @@ Resolver::DoResolveOne (Ptr<Object> object)
 }
 
 void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+Resolver::GetAttribute (Ptr<Object> object, const CompiledPath::Attribute &attribute,
+                        AttributeValue &value) const
 {
-  NS_LOG_FUNCTION (this << path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  const struct TypeId::AttributeInformation &info = attribute.info;
+  if (!(info.flags & TypeId::ATTR_GET)
+      || !info.accessor->HasGetter ()
+      || !info.accessor->Get (PeekPointer (object), value))
+    {
+      // let ObjectBase::GetAttribute raise any errors
+      object->GetAttribute (attribute.name, value);
+    }
+}
 
-  if (next == std::string::npos)
+void
+Resolver::DoResolve (std::size_t index, Ptr<Object> root)
+{
+  NS_LOG_FUNCTION (this << index << root);
+
+  if (index == m_path.m_elements.size ())
     {
       //
       // If root is zero, we're beginning to see if we can use the object name
@@ -447,8 +632,8 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
         }
       return;
     }
-  std::string item = path.substr (1, next - 1);
-  std::string pathLeft = path.substr (next, path.size () - next);
+  CompiledPath::Element &element = m_path.m_elements[index];
+  const std::string &item = element.item;
 
   //
   // If root is zero, we're beginning to see if we can use the object name
@@ -459,11 +644,10 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   //
   if (root == 0)
     {
-      std::string::size_type offset = path.find ("/Names");
-      if (offset == 0)
+      if (element.names)
         {
           m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
+          DoResolve (index + 1, root);
           m_workStack.pop_back ();
           return;
         }
@@ -480,7 +664,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
       m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
+      DoResolve (index + 1, namedObject);
       m_workStack.pop_back ();
       return;
     }
@@ -496,82 +680,63 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       return;
     }
-  std::string::size_type dollarPos = item.find ("$");
-  if (dollarPos == 0)
+  if (element.getObject)
     {
       // This is a call to GetObject
-      std::string tidString = item.substr (1, item.size () - 1);
-      NS_LOG_DEBUG ("GetObject=" << tidString << " on path=" << GetResolvedPath ());
-      TypeId tid = TypeId::LookupByName (tidString);
-      Ptr<Object> object = root->GetObject<Object> (tid);
+      NS_LOG_DEBUG ("GetObject=" << item.substr (1) << " on path=" << GetResolvedPath ());
+      if (!element.tidFound)
+        {
+          // the TypeId may have been registered since the path was parsed;
+          // if not, let TypeId::LookupByName raise the error
+          element.tid = TypeId::LookupByName (item.substr (1, item.size () - 1));
+          element.tidFound = true;
+        }
+      Ptr<Object> object = root->GetObject<Object> (element.tid);
       if (object == 0)
         {
-          NS_LOG_DEBUG ("GetObject (" << tidString << ") failed on path=" << GetResolvedPath ());
+          NS_LOG_DEBUG ("GetObject (" << item.substr (1) << ") failed on path=" << GetResolvedPath ());
           return;
         }
       m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
+      DoResolve (index + 1, object);
       m_workStack.pop_back ();
     }
   else
     {
       // this is a normal attribute.
-      TypeId tid;
-      TypeId nextTid = root->GetInstanceTypeId ();
+      const CompiledPath::Attributes &attributes = CompiledPath::GetAttributes (element, root);
       bool foundMatch = false;
-
-      do
+      for (CompiledPath::Attributes::const_iterator i = attributes.begin (); i != attributes.end (); i++)
         {
-          tid = nextTid;
-
-          for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+          if (i->pointer)
             {
-              struct TypeId::AttributeInformation info;
-              info = tid.GetAttribute (i);
-              if (info.name != item && item != "*")
+              NS_LOG_DEBUG ("GetAttribute(ptr)=" << i->name << " on path=" << GetResolvedPath ());
+              PointerValue pValue;
+              GetAttribute (root, *i, pValue);
+              Ptr<Object> object = pValue.Get<Object> ();
+              if (object == 0)
                 {
+                  NS_LOG_ERROR ("Requested object name=\"" << item <<
+                                "\" exists on path=\"" << GetResolvedPath () << "\""
+                                " but is null.");
                   continue;
                 }
-              // attempt to cast to a pointer checker.
-              const PointerChecker *pChecker = dynamic_cast<const PointerChecker *> (PeekPointer (info.checker));
-              if (pChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(ptr)=" << info.name << " on path=" << GetResolvedPath ());
-                  PointerValue pValue;
-                  root->GetAttribute (info.name, pValue);
-                  Ptr<Object> object = pValue.Get<Object> ();
-                  if (object == 0)
-                    {
-                      NS_LOG_ERROR ("Requested object name=\"" << item <<
-                                    "\" exists on path=\"" << GetResolvedPath () << "\""
-                                    " but is null.");
-                      continue;
-                    }
-                  foundMatch = true;
-                  m_workStack.push_back (info.name);
-                  DoResolve (pathLeft, object);
-                  m_workStack.pop_back ();
-                }
-              // attempt to cast to an object vector.
-              const ObjectPtrContainerChecker *vectorChecker =
-                dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-              if (vectorChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(vector)=" << info.name << " on path=" << GetResolvedPath () << pathLeft);
-                  foundMatch = true;
-                  ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
-                  m_workStack.push_back (info.name);
-                  DoArrayResolve (pathLeft, vector);
-                  m_workStack.pop_back ();
-                }
-              // this could be anything else and we don't know what to do with it.
-              // So, we just ignore it.
+              foundMatch = true;
+              m_workStack.push_back (i->name);
+              DoResolve (index + 1, object);
+              m_workStack.pop_back ();
+            }
+          if (i->container)
+            {
+              NS_LOG_DEBUG ("GetAttribute(vector)=" << i->name << " on path=" << GetResolvedPath ());
+              foundMatch = true;
+              ObjectPtrContainerValue vector;
+              GetAttribute (root, *i, vector);
+              m_workStack.push_back (i->name);
+              DoArrayResolve (index + 1, vector);
+              m_workStack.pop_back ();
             }
-
-          nextTid = tid.GetParent ();
         }
-      while (nextTid != tid);
 
       if (!foundMatch)
         {
@@ -582,20 +747,15 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
 }
 
 void
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+Resolver::DoArrayResolve (std::size_t index, const ObjectPtrContainerValue &container)
 {
-  NS_LOG_FUNCTION (this << path << &container);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  NS_LOG_FUNCTION (this << index << &container);
+  if (index == m_path.m_elements.size ())
     {
       return;
     }
-  std::string item = path.substr (1, next - 1);
-  std::string pathLeft = path.substr (next, path.size () - next);
 
-  ArrayMatcher matcher = ArrayMatcher (item);
+  const ArrayMatcher &matcher = m_path.m_elements[index].matcher;
   ObjectPtrContainerValue::Iterator it;
   for (it = container.Begin (); it != container.End (); ++it)
     {
@@ -604,7 +764,7 @@ Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &conta
           std::ostringstream oss;
           oss << (*it).first;
           m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
+          DoResolve (index + 1, (*it).second);
           m_workStack.pop_back ();
         }
     }
@@ -654,12 +814,25 @@ private:
    */
   void ParsePath (std::string path, std::string *root, std::string *leaf) const;
 
+  /**
+   * Get a Config path parsed into its elements.
+   * \param [in] path The Config path.
+   * \returns The parsed path.
+   */
+  Ptr<CompiledPath> GetCompiledPath (std::string path);
+
   /** Container type to hold the root Config path tokens. */
   typedef std::vector<Ptr<Object> > Roots;
 
   /** The list of Config path roots. */
   Roots m_roots;
 
+  /** Container type to hold the parsed Config paths, by Config path. */
+  typedef std::map<std::string, Ptr<CompiledPath> > CompiledPaths;
+
+  /** The Config paths already parsed. */
+  CompiledPaths m_compiledPaths;
+
 };  // class ConfigImpl
 
 void
@@ -674,6 +847,27 @@ ConfigImpl::ParsePath (std::string path, std::string *root, std::string *leaf) c
   NS_LOG_FUNCTION (path << *root << *leaf);
 }
 
+Ptr<CompiledPath>
+ConfigImpl::GetCompiledPath (std::string path)
+{
+  NS_LOG_FUNCTION (this << path);
+
+  CompiledPaths::const_iterator it = m_compiledPaths.find (path);
+  if (it != m_compiledPaths.end ())
+    {
+      return it->second;
+    }
+  // the paths naming a single object are seldom used twice: bound the
+  // memory they take
+  if (m_compiledPaths.size () >= MAX_COMPILED_PATHS)
+    {
+      m_compiledPaths.clear ();
+    }
+  Ptr<CompiledPath> compiledPath = Create<CompiledPath> (path);
+  m_compiledPaths[path] = compiledPath;
+  return compiledPath;
+}
+
 void
 ConfigImpl::Set (std::string path, const AttributeValue &value)
 {
@@ -754,7 +948,7 @@ ConfigImpl::LookupMatches (std::string path)
   class LookupMatchesResolver : public Resolver
   {
 public:
-    LookupMatchesResolver (std::string path)
+    LookupMatchesResolver (CompiledPath &path)
       : Resolver (path)
     {
     }
@@ -765,7 +959,9 @@ public:
     }
     std::vector<Ptr<Object> > m_objects;
     std::vector<std::string> m_contexts;
-  } resolver = LookupMatchesResolver (path);
+  };
+  Ptr<CompiledPath> compiledPath = GetCompiledPath (path);
+  LookupMatchesResolver resolver (*compiledPath);
   for (Roots::const_iterator i = m_roots.begin (); i != m_roots.end (); i++)
     {
       resolver.Resolve (*i);
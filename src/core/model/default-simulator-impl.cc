@@ -27,8 +27,29 @@
 #include "pointer.h"
 #include "assert.h"
 #include "log.h"
+#include "uinteger.h"
+#include "string.h"
+#include "ns3/core-config.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <typeinfo>
+#include <vector>
+
+#if (__GNUC__ >= 3)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+#ifdef HAVE_DLFCN_H
+#include <dlfcn.h>
+#endif
 
 
 /**
@@ -53,6 +74,23 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("ProfileSamplingInterval",
+                   "Mean number of events between two events timed by the "
+                   "event profiler, or 0 to disable the profiler.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&DefaultSimulatorImpl::m_profileInterval),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ProfileTopN",
+                   "Number of event targets and contexts printed by the event profiler.",
+                   UintegerValue (20),
+                   MakeUintegerAccessor (&DefaultSimulatorImpl::m_profileTopN),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ProfileFileName",
+                   "File to which the event profile is written in the folded "
+                   "stack format of flamegraph.pl, instead of being printed.",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::m_profileFileName),
+                   MakeStringChecker ())
   ;
   return tid;
 }
@@ -74,6 +112,10 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_eventCount = 0;
   m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self ();
+  m_profileInterval = 0;
+  m_profileCountdown = 0;
+  m_profileRandom = 0x9e3779b9;
+  m_profileTopN = 20;
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
@@ -109,6 +151,10 @@ DefaultSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+  if (!m_profile.empty ())
+    {
+      WriteProfile ();
+    }
 }
 
 void
@@ -148,12 +194,322 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (m_profileCountdown != 0 && --m_profileCountdown == 0)
+    {
+      InvokeProfiled (next.impl);
+    }
+  else
+    {
+      next.impl->Invoke ();
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
 }
 
+void
+DefaultSimulatorImpl::InvokeProfiled (EventImpl *event)
+{
+  std::size_t size;
+  bool function;
+  const char *target = static_cast<const char *> (event->GetTarget (&size, &function));
+  ProfileTarget profileTarget (typeid (*event), function, std::string (target, target != 0 ? size : 0));
+  Profile::key_type key (profileTarget, m_currentContext);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  event->Invoke ();
+  std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now () - start;
+
+  ProfileEntry empty = {0, 0};
+  ProfileEntry &entry = m_profile.insert (std::make_pair (key, empty)).first->second;
+  entry.samples++;
+  entry.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count ();
+
+  // Draw the number of events until the next sample uniformly in
+  // [1, 2 * interval - 1], so that periodic event patterns are not
+  // aliased.  A private xorshift generator is used to leave the
+  // random variable streams of the simulation unchanged.
+  if (m_profileInterval > 1)
+    {
+      m_profileRandom ^= m_profileRandom << 13;
+      m_profileRandom ^= m_profileRandom >> 17;
+      m_profileRandom ^= m_profileRandom << 5;
+      m_profileCountdown = 1 + m_profileRandom % (2 * static_cast<uint64_t> (m_profileInterval) - 1);
+    }
+  else
+    {
+      m_profileCountdown = m_profileInterval;
+    }
+}
+
+/**
+ * \ingroup simulator
+ * Demangle a C++ symbol or type name.
+ *
+ * \param [in] name The mangled name.
+ * \returns The demangled name, or \p name if it can not be demangled.
+ */
+static std::string
+Demangle (const std::string &name)
+{
+#if (__GNUC__ >= 3)
+  int status;
+  char *demangled = abi::__cxa_demangle (name.c_str (), NULL, NULL, &status);
+  if (status == 0)
+    {
+      std::string result = demangled;
+      std::free (demangled);
+      return result;
+    }
+  std::free (demangled);
+#endif
+  return name;
+}
+
+/**
+ * \ingroup simulator
+ * Get the name of the type of an event, for the event profiler.
+ *
+ * The events created by MakeEvent are local classes of the MakeEvent
+ * template instances, so the type of the function pointer passed to
+ * MakeEvent is used, e.g. "void (ns3::WifiPhy::*)()".  The other events
+ * are identified by the name of their class.
+ *
+ * \param [in] type The type of the event.
+ * \returns The name of the type of the event.
+ */
+static std::string
+GetProfileTypeName (const std::type_index &type)
+{
+  std::string name = Demangle (type.name ());
+  std::string::size_type start = name.find ("MakeEvent");
+  if (start == std::string::npos)
+    {
+      return name;
+    }
+  // skip the template arguments, then keep the first function argument
+  start += std::string ("MakeEvent").size ();
+  if (start < name.size () && name[start] == '<')
+    {
+      int depth = 0;
+      for (; start < name.size (); start++)
+        {
+          if (name[start] == '<')
+            {
+              depth++;
+            }
+          else if (name[start] == '>' && --depth == 0)
+            {
+              break;
+            }
+        }
+      start++;
+    }
+  if (start >= name.size () || name[start] != '(')
+    {
+      return name;
+    }
+  start++;
+  std::string::size_type end = start;
+  int depth = 0;
+  for (; end < name.size (); end++)
+    {
+      char c = name[end];
+      if (c == '(' || c == '<' || c == '[')
+        {
+          depth++;
+        }
+      else if ((c == ')' || c == '>' || c == ']') && depth-- == 0)
+        {
+          break;
+        }
+      else if (c == ',' && depth == 0)
+        {
+          break;
+        }
+    }
+  return name.substr (start, end - start);
+}
+
+/**
+ * \ingroup simulator
+ * Get the name of the function invoked by an event, for the event profiler.
+ *
+ * A function is named from the symbol found at its address, e.g.
+ * "ns3::Ipv4L3Protocol::Foo(...)", or, if it is not in a dynamic symbol
+ * table, such as the functions of the main program unless it is linked
+ * with -rdynamic, from the type of the event and its address.  A class
+ * method is named from the type of the event and the bytes of the
+ * pointer to the method, which tell apart the methods of a class with
+ * the same signature.  The events whose function is not known are
+ * named from their type.
+ *
+ * \param [in] type The type of the event.
+ * \param [in] function Whether the event invokes a function, rather
+ *             than a class method.
+ * \param [in] target The bytes of the pointer to the function or method,
+ *             or an empty string if it is not known.
+ * \returns The name of the function invoked by the event.
+ */
+static std::string
+GetProfileTargetName (const std::type_index &type, bool function, const std::string &target)
+{
+  if (target.empty ())
+    {
+      return GetProfileTypeName (type);
+    }
+  std::ostringstream oss;
+  oss << GetProfileTypeName (type);
+  if (function && target.size () == sizeof (void (*)(void)))
+    {
+      void (*f)(void);
+      std::memcpy (&f, target.data (), sizeof (f));
+      const void *address = reinterpret_cast<const void *> (f);
+#ifdef HAVE_DLFCN_H
+      Dl_info info;
+      if (dladdr (address, &info) != 0 && info.dli_sname != 0 && info.dli_saddr == address)
+        {
+          return Demangle (info.dli_sname);
+        }
+#endif
+      oss << " at " << address;
+      return oss.str ();
+    }
+  oss << " [" << std::hex << std::setfill ('0');
+  for (std::string::const_iterator i = target.begin (); i != target.end (); i++)
+    {
+      oss << std::setw (2) << static_cast<unsigned> (static_cast<unsigned char> (*i));
+    }
+  oss << "]";
+  return oss.str ();
+}
+
+/**
+ * \ingroup simulator
+ * Get the name of an event context, for the event profiler.
+ *
+ * \param [in] context The context.
+ * \returns The name of the context.
+ */
+static std::string
+GetProfileContextName (uint32_t context)
+{
+  if (context == Simulator::NO_CONTEXT)
+    {
+      return "no context";
+    }
+  std::ostringstream oss;
+  oss << "node " << context;
+  return oss.str ();
+}
+
+/**
+ * \ingroup simulator
+ * Compare two rows of the event profile by decreasing time.
+ *
+ * \param [in] a The first row.
+ * \param [in] b The second row.
+ * \returns \c true if \p a took more time than \p b.
+ */
+static bool
+CompareProfileRows (const std::pair<std::string, std::pair<uint64_t, int64_t> > &a,
+                    const std::pair<std::string, std::pair<uint64_t, int64_t> > &b)
+{
+  return a.second.second > b.second.second;
+}
+
+void
+DefaultSimulatorImpl::WriteProfile (void)
+{
+  NS_LOG_FUNCTION (this);
+  // the counts and times sampled are scaled by the sampling interval
+  const int64_t scale = m_profileInterval > 0 ? m_profileInterval : 1;
+
+  // name each function once, not once per context
+  std::map<ProfileTarget, std::string> names;
+  for (Profile::const_iterator i = m_profile.begin (); i != m_profile.end (); i++)
+    {
+      std::string &name = names[i->first.first];
+      if (name.empty ())
+        {
+          const ProfileTarget &target = i->first.first;
+          name = GetProfileTargetName (std::get<0> (target), std::get<1> (target), std::get<2> (target));
+        }
+    }
+
+  if (!m_profileFileName.empty ())
+    {
+      std::ofstream os (m_profileFileName.c_str ());
+      if (!os.is_open ())
+        {
+          NS_FATAL_ERROR ("Can not open event profile file " << m_profileFileName);
+        }
+      for (Profile::const_iterator i = m_profile.begin (); i != m_profile.end (); i++)
+        {
+          os << GetProfileContextName (i->first.second) << ";"
+             << names[i->first.first] << " "
+             << i->second.nanoseconds * scale << std::endl;
+        }
+      m_profile.clear ();
+      return;
+    }
+
+  // aggregate the profile by target and by context
+  typedef std::map<std::string, std::pair<uint64_t, int64_t> > Rows;
+  Rows targets;
+  Rows contexts;
+  uint64_t samples = 0;
+  int64_t nanoseconds = 0;
+  for (Profile::const_iterator i = m_profile.begin (); i != m_profile.end (); i++)
+    {
+      std::pair<uint64_t, int64_t> &target = targets[names[i->first.first]];
+      target.first += i->second.samples;
+      target.second += i->second.nanoseconds;
+      std::pair<uint64_t, int64_t> &context = contexts[GetProfileContextName (i->first.second)];
+      context.first += i->second.samples;
+      context.second += i->second.nanoseconds;
+      samples += i->second.samples;
+      nanoseconds += i->second.nanoseconds;
+    }
+  m_profile.clear ();
+
+  std::ostringstream oss;
+  oss << "Event profile: " << samples << " of " << m_eventCount
+      << " events sampled, " << nanoseconds * scale / 1e9
+      << " s of wall clock time estimated" << std::endl;
+  EventImpl::PoolStats pool = EventImpl::GetPoolStats ();
+  oss << "Event allocator: " << pool.allocations << " events allocated, "
+      << pool.recycled << " from the free lists, "
+      << pool.cachedBytes << " bytes cached" << std::endl;
+  Rows *tables[] = { &targets, &contexts };
+  const char *titles[] = { "function", "context" };
+  for (uint32_t t = 0; t < 2; t++)
+    {
+      std::vector<std::pair<std::string, std::pair<uint64_t, int64_t> > > rows (tables[t]->begin (), tables[t]->end ());
+      std::sort (rows.begin (), rows.end (), CompareProfileRows);
+      if (rows.size () > m_profileTopN)
+        {
+          rows.resize (m_profileTopN);
+        }
+      oss << std::setw (12) << "time (s)"
+          << std::setw (8) << "%"
+          << std::setw (14) << "events"
+          << std::setw (12) << "mean (us)"
+          << "  " << titles[t] << std::endl;
+      for (std::vector<std::pair<std::string, std::pair<uint64_t, int64_t> > >::const_iterator i = rows.begin (); i != rows.end (); i++)
+        {
+          oss << std::fixed
+              << std::setw (12) << std::setprecision (6) << i->second.second * scale / 1e9
+              << std::setw (8) << std::setprecision (2)
+              << (nanoseconds > 0 ? 100.0 * i->second.second / nanoseconds : 0.0)
+              << std::setw (14) << i->second.first * scale
+              << std::setw (12) << std::setprecision (3)
+              << i->second.second / 1e3 / i->second.first
+              << "  " << i->first << std::endl;
+        }
+    }
+  std::cout << oss.str ();
+}
+
 bool
 DefaultSimulatorImpl::IsFinished (void) const
 {
@@ -198,6 +554,10 @@ DefaultSimulatorImpl::Run (void)
   m_main = SystemThread::Self ();
   ProcessEventsWithContext ();
   m_stop = false;
+  if (m_profileCountdown == 0)
+    {
+      m_profileCountdown = m_profileInterval;
+    }
 
   while (!m_events->IsEmpty () && !m_stop)
     {
@@ -412,6 +772,12 @@ DefaultSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
+void
+DefaultSimulatorImpl::SetContext (uint32_t context)
+{
+  m_currentContext = context;
+}
+
 uint64_t
 DefaultSimulatorImpl::GetEventCount (void) const
 {
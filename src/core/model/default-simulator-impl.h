@@ -30,6 +30,10 @@
 #include "ptr.h"
 
 #include <list>
+#include <map>
+#include <string>
+#include <tuple>
+#include <typeindex>
 
 /**
  * \file
@@ -43,6 +47,15 @@ namespace ns3 {
  * \ingroup simulator
  *
  * The default single process simulator implementation.
+ *
+ * The simulator can profile the events it processes: when
+ * ProfileSamplingInterval is not 0, one event out of ProfileSamplingInterval
+ * on average is timed with the wall clock, and the time and the
+ * number of events are attributed to the function the event invokes,
+ * given by EventImpl::GetTarget, and to its context (the node ID).  At Simulator::Destroy the
+ * ProfileTopN most expensive functions and contexts are printed, or
+ * the profile is written to ProfileFileName in the folded stack format
+ * read by flamegraph.pl.
  */
 class DefaultSimulatorImpl : public SimulatorImpl
 {
@@ -77,6 +90,7 @@ public:
   virtual void SetScheduler (ObjectFactory schedulerFactory);
   virtual uint32_t GetSystemId (void) const;
   virtual uint32_t GetContext (void) const;
+  virtual void SetContext (uint32_t context);
   virtual uint64_t GetEventCount (void) const;
 
 private:
@@ -86,6 +100,13 @@ private:
   void ProcessOneEvent (void);
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
+  /**
+   * Invoke an event sampled by the profiler and record its duration.
+   * \param [in] event The event.
+   */
+  void InvokeProfiled (EventImpl *event);
+  /** Print or write the event profile, and clear it. */
+  void WriteProfile (void);
 
   /** Wrap an event with its execution context. */
   struct EventWithContext
@@ -136,6 +157,36 @@ private:
 
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
+
+  /** Events sampled by the profiler for an event target and a context. */
+  struct ProfileEntry
+  {
+    /** The number of events sampled. */
+    uint64_t samples;
+    /** The wall clock time spent in the events sampled, in ns. */
+    int64_t nanoseconds;
+  };
+  /**
+   * The function invoked by an event: the type of the event, whether it
+   * invokes a function rather than a class method, and the bytes of the
+   * pointer to the function or method given by EventImpl::GetTarget,
+   * empty if it is not known.
+   */
+  typedef std::tuple<std::type_index, bool, std::string> ProfileTarget;
+  /** Container type for the profile, indexed by event target and context. */
+  typedef std::map<std::pair<ProfileTarget, uint32_t>, ProfileEntry> Profile;
+  /** The events sampled by the profiler. */
+  Profile m_profile;
+  /** Mean number of events between two samples, or 0 if not profiling. */
+  uint32_t m_profileInterval;
+  /** Number of events until the next sample, or 0 if not profiling. */
+  uint32_t m_profileCountdown;
+  /** State of the generator of the number of events between two samples. */
+  uint32_t m_profileRandom;
+  /** Number of functions and contexts printed. */
+  uint32_t m_profileTopN;
+  /** File to which the profile is written, if not empty. */
+  std::string m_profileFileName;
 };
 
 } // namespace ns3
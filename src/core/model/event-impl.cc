@@ -31,13 +31,52 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+/** The state of the event pool of the calling thread. */
+static thread_local BlockPool::State g_eventPoolState = BlockPool::UNUSED;
+/** The event pool of the calling thread. */
+static thread_local BlockPool g_eventPool (&g_eventPoolState);
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  if (g_eventPoolState == BlockPool::DESTROYED)
+    {
+      return ::operator new (size);
+    }
+  return g_eventPool.Allocate (size);
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  if (g_eventPoolState == BlockPool::DESTROYED)
+    {
+      ::operator delete (p);
+      return;
+    }
+  g_eventPool.Deallocate (p, size);
+}
+
+EventImpl::PoolStats
+EventImpl::GetPoolStats (void)
+{
+  if (g_eventPoolState == BlockPool::DESTROYED)
+    {
+      return EventImpl::PoolStats ();
+    }
+  return g_eventPool.GetStats ();
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
 }
 
 EventImpl::EventImpl ()
-  : m_cancel (false)
+  : m_cancel (false),
+    m_targetIsFunction (false),
+    m_targetSize (0),
+    m_target (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -66,4 +105,12 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+const void *
+EventImpl::GetTarget (std::size_t *size, bool *function) const
+{
+  *size = m_targetSize;
+  *function = m_targetIsFunction;
+  return m_target;
+}
+
 } // namespace ns3
@@ -21,7 +21,10 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
+#include <type_traits>
 #include "simple-ref-count.h"
+#include "block-pool.h"
 
 /**
  * \file
@@ -40,10 +43,36 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * Events are allocated from a BlockPool, to which they are returned
+ * when their reference count drops to zero, so scheduling an event does
+ * not call the heap allocator once a block of its size has been
+ * released.  Each thread, hence each simulator, has its own pool.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
 public:
+  /** Statistics of the event allocator of the calling thread. */
+  typedef BlockPool::Stats PoolStats;
+
+  /**
+   * Allocate an event, from a free list if possible.
+   * \param [in] size The size of the event.
+   * \returns The memory allocated.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Release an event to a free list.
+   * \param [in] p The event.
+   * \param [in] size The size of the event.
+   */
+  static void operator delete (void *p, std::size_t size);
+  /**
+   * Get the statistics of the event allocator of the calling thread.
+   * \returns The statistics.
+   */
+  static PoolStats GetPoolStats (void);
+
   /** Default constructor. */
   EventImpl ();
   /** Destructor. */
@@ -65,6 +94,19 @@ public:
    * Checked by the simulation engine before calling Invoke().
    */
   bool IsCancelled (void);
+  /**
+   * Get the function or class method invoked by the event, used by the
+   * event profiler to attribute the time spent in the event.
+   *
+   * The events created by MakeEvent record the pointer to their
+   * function or class method.
+   *
+   * \param [out] size The size of the pointer.
+   * \param [out] function Whether the pointer is a function pointer,
+   *              rather than a pointer to a class method.
+   * \returns The address of the pointer, or 0 if it is not known.
+   */
+  const void * GetTarget (std::size_t *size, bool *function) const;
 
 protected:
   /**
@@ -74,11 +116,40 @@ protected:
    * arguments bound by a call to one of the MakeEvent() functions.
    */
   virtual void Notify (void) = 0;
+  /**
+   * Record the function or class method invoked by the event.
+   *
+   * \tparam F \deduced The function or class method pointer type.
+   * \param [in] target The pointer, which is a member of the event.
+   */
+  template <typename F>
+  void SetTarget (const F *target);
 
 private:
   bool m_cancel;  /**< Has this event been cancelled. */
+  bool m_targetIsFunction; /**< Whether m_target is a function pointer. */
+  uint8_t m_targetSize; /**< The size of the pointer at m_target. */
+  const void *m_target; /**< The function or method pointer, or 0. */
 };
 
 } // namespace ns3
 
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename F>
+void
+EventImpl::SetTarget (const F *target)
+{
+  m_target = target;
+  m_targetSize = sizeof (F);
+  m_targetIsFunction = std::is_pointer<F>::value;
+}
+
+} // namespace ns3
+
 #endif /* EVENT_IMPL_H */
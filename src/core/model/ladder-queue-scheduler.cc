@@ -0,0 +1,310 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-queue-scheduler.h"
+#include "event-impl.h"
+#include "uinteger.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderQueueScheduler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderQueueScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderQueueScheduler);
+
+/**
+ * \ingroup scheduler
+ * Compare two events by EventKey.
+ *
+ * \param [in] a The first event.
+ * \param [in] b The second event.
+ * \returns \c true if \c a is before \c b.
+ */
+static bool
+CompareEvents (const Scheduler::Event &a, const Scheduler::Event &b)
+{
+  return a.key < b.key;
+}
+
+TypeId
+LadderQueueScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderQueueScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderQueueScheduler> ()
+    .AddAttribute ("Threshold",
+                   "Number of events of a bucket from which it is spread "
+                   "over a new rung instead of being sorted.",
+                   UintegerValue (50),
+                   MakeUintegerAccessor (&LadderQueueScheduler::m_threshold),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxRungs",
+                   "Maximum number of rungs of the ladder.",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&LadderQueueScheduler::m_maxRungs),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+LadderQueueScheduler::LadderQueueScheduler ()
+  : m_topMin (0),
+    m_topMax (0),
+    m_topStart (0),
+    m_nRungs (0),
+    m_bottomHead (0),
+    m_size (0),
+    m_threshold (50),
+    m_maxRungs (8)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderQueueScheduler::~LadderQueueScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+LadderQueueScheduler::FindRung (uint64_t ts) const
+{
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      const Rung &rung = m_rungs[i];
+      if (ts >= rung.start + rung.current * rung.width)
+        {
+          return i;
+        }
+    }
+  return m_nRungs;
+}
+
+void
+LadderQueueScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  m_size++;
+  if (ts >= m_topStart)
+    {
+      if (m_top.empty ())
+        {
+          m_topMin = ts;
+          m_topMax = ts;
+        }
+      else
+        {
+          m_topMin = std::min (m_topMin, ts);
+          m_topMax = std::max (m_topMax, ts);
+        }
+      m_top.push_back (ev);
+      return;
+    }
+  uint32_t i = FindRung (ts);
+  if (i < m_nRungs)
+    {
+      Rung &rung = m_rungs[i];
+      rung.buckets[(ts - rung.start) / rung.width].push_back (ev);
+      return;
+    }
+  // drop the events already removed from the Bottom
+  if (m_bottomHead == m_bottom.size ()
+      || (m_bottomHead > m_threshold && 2 * m_bottomHead >= m_bottom.size ()))
+    {
+      m_bottom.erase (m_bottom.begin (), m_bottom.begin () + m_bottomHead);
+      m_bottomHead = 0;
+    }
+  m_bottom.insert (std::upper_bound (m_bottom.begin () + m_bottomHead, m_bottom.end (), ev, CompareEvents),
+                   ev);
+}
+
+bool
+LadderQueueScheduler::IsEmpty (void) const
+{
+  return m_size == 0;
+}
+
+void
+LadderQueueScheduler::AddRung (Events &events, uint64_t start, uint64_t width, uint64_t nBuckets)
+{
+  NS_LOG_FUNCTION (this << events.size () << start << width << nBuckets);
+  NS_ASSERT (m_nRungs < m_rungs.size ());
+  Rung &rung = m_rungs[m_nRungs];
+  rung.start = start;
+  rung.width = width;
+  rung.current = 0;
+  rung.nBuckets = nBuckets;
+  // the buckets of an unused rung are all empty
+  if (rung.buckets.size () < nBuckets)
+    {
+      rung.buckets.resize (nBuckets);
+    }
+  for (Events::const_iterator i = events.begin (); i != events.end (); i++)
+    {
+      rung.buckets[(i->key.m_ts - start) / width].push_back (*i);
+    }
+  events.clear ();
+  m_nRungs++;
+}
+
+void
+LadderQueueScheduler::SetBottom (Events &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  m_bottom.clear ();
+  m_bottomHead = 0;
+  m_bottom.swap (events);
+  std::sort (m_bottom.begin (), m_bottom.end (), CompareEvents);
+}
+
+void
+LadderQueueScheduler::FillBottom (void)
+{
+  NS_ASSERT (!IsEmpty ());
+  while (m_bottomHead == m_bottom.size ())
+    {
+      // make room for a new rung before taking references to the rungs
+      if (m_rungs.size () <= m_nRungs)
+        {
+          m_rungs.resize (m_nRungs + 1);
+        }
+      if (m_nRungs == 0)
+        {
+          NS_ASSERT (!m_top.empty ());
+          if (m_top.size () <= m_threshold || m_topMin == m_topMax)
+            {
+              m_topStart = m_topMax + 1;
+              SetBottom (m_top);
+            }
+          else
+            {
+              uint64_t width = (m_topMax - m_topMin) / m_top.size () + 1;
+              uint64_t nBuckets = (m_topMax - m_topMin) / width + 1;
+              m_topStart = m_topMin + nBuckets * width;
+              AddRung (m_top, m_topMin, width, nBuckets);
+            }
+          continue;
+        }
+
+      Rung &rung = m_rungs[m_nRungs - 1];
+      while (rung.current < rung.nBuckets && rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      if (rung.current == rung.nBuckets)
+        {
+          m_nRungs--;
+          continue;
+        }
+      Events &bucket = rung.buckets[rung.current];
+      uint64_t start = rung.start + rung.current * rung.width;
+      rung.current++;
+      bool spread = false;
+      if (bucket.size () > m_threshold && rung.width > 1 && m_nRungs < m_maxRungs)
+        {
+          // a bucket of simultaneous events can not be spread
+          for (Events::const_iterator i = bucket.begin () + 1; i != bucket.end (); i++)
+            {
+              if (i->key.m_ts != bucket.front ().key.m_ts)
+                {
+                  spread = true;
+                  break;
+                }
+            }
+        }
+      if (spread)
+        {
+          uint64_t width = (rung.width + bucket.size () - 1) / bucket.size ();
+          uint64_t nBuckets = (rung.width + width - 1) / width;
+          AddRung (bucket, start, width, nBuckets);
+        }
+      else
+        {
+          SetBottom (bucket);
+        }
+    }
+}
+
+Scheduler::Event
+LadderQueueScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  // moving the events between the tiers does not change their order
+  const_cast<LadderQueueScheduler *> (this)->FillBottom ();
+  return m_bottom[m_bottomHead];
+}
+
+Scheduler::Event
+LadderQueueScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  FillBottom ();
+  Scheduler::Event ev = m_bottom[m_bottomHead];
+  m_bottomHead++;
+  m_size--;
+  NS_LOG_LOGIC ("remove ts=" << ev.key.m_ts << ", uid=" << ev.key.m_uid);
+  return ev;
+}
+
+void
+LadderQueueScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+  uint64_t ts = ev.key.m_ts;
+  Events *events = &m_top;
+  if (ts < m_topStart)
+    {
+      uint32_t i = FindRung (ts);
+      if (i == m_nRungs)
+        {
+          Events::iterator it = std::lower_bound (m_bottom.begin () + m_bottomHead, m_bottom.end (),
+                                                  ev, CompareEvents);
+          NS_ASSERT (it != m_bottom.end () && it->key.m_uid == ev.key.m_uid);
+          NS_ASSERT (it->impl == ev.impl);
+          m_bottom.erase (it);
+          m_size--;
+          return;
+        }
+      Rung &rung = m_rungs[i];
+      events = &rung.buckets[(ts - rung.start) / rung.width];
+    }
+  for (Events::iterator it = events->begin (); it != events->end (); it++)
+    {
+      if (it->key.m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (it->impl == ev.impl);
+          *it = events->back ();
+          events->pop_back ();
+          m_size--;
+          return;
+        }
+    }
+  NS_ASSERT (false);
+}
+
+} // namespace ns3
@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_QUEUE_SCHEDULER_H
+#define LADDER_QUEUE_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderQueueScheduler declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue described in
+ * ["Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Tang, Goh and Thng][Tang].
+ *
+ * [Tang]: https://doi.org/10.1145/1103323.1103324 "Tang"
+ *
+ * The events are kept in three tiers:
+ *
+ * - Top: an unsorted vector of the events far in the future, which
+ *   only records their minimum and maximum time stamps.
+ * - Ladder: rungs of buckets of events, unsorted within a bucket.
+ *   When the ladder is empty the Top is spread over a first rung, with
+ *   a bucket width adapted to the time span and number of its events.
+ *   When the next bucket of the lowest rung holds more than Threshold
+ *   events, it is spread over a new, finer rung instead of being sorted,
+ *   so a burst of events a few microseconds apart is broken up
+ *   however far it is from the other events.
+ * - Bottom: a sorted vector of the events of the current bucket, from
+ *   which the events are removed.
+ *
+ * Each event is inserted directly in the tier covering its time stamp,
+ * and is sorted only once it reaches the Bottom.  Events with equal
+ * time stamps always share a bucket, so they are removed in the order of
+ * their uid as with the other schedulers.
+ *
+ * \par Time Complexity
+ *
+ * Operation    | Amortized %Time | Reason
+ * :----------- | :-------------- | :-----
+ * Insert()     | ~Constant       | Bucket index; sorted insertion in the small Bottom
+ * IsEmpty()    | Constant        | Explicit queue size
+ * PeekNext()   | ~Constant       | Possible transfer to the Bottom
+ * Remove()     | Linear          | Search within the bucket or the Top
+ * RemoveNext() | ~Constant       | Possible transfer to the Bottom
+ *
+ * \par Memory Complexity
+ *
+ * Category  | Memory                              | Reason
+ * :-------- | :---------------------------------- | :-----
+ * Overhead  | `std::vector` per bucket and rung   | Buckets are reused
+ * Per Event | `sizeof (Event)`                    | `std::vector`
+ */
+class LadderQueueScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderQueueScheduler ();
+  /** Destructor. */
+  virtual ~LadderQueueScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** Container type for the events of a bucket, the Top or the Bottom. */
+  typedef std::vector<Scheduler::Event> Events;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    /** The time stamp at the start of the first bucket. */
+    uint64_t start;
+    /** The duration of a bucket, in dimensionless time units. */
+    uint64_t width;
+    /** The index of the next bucket to transfer. */
+    uint32_t current;
+    /** The number of buckets in use. */
+    uint32_t nBuckets;
+    /** The buckets. */
+    std::vector<Events> buckets;
+  };
+
+  /**
+   * Get the rung covering a time stamp.
+   *
+   * \param [in] ts The dimensionless time stamp, less than m_topStart.
+   * \returns The index of the rung, or m_nRungs if the event
+   * belongs to the Bottom.
+   */
+  uint32_t FindRung (uint64_t ts) const;
+  /**
+   * Fill the Bottom from the Ladder or the Top, if it is empty.
+   *
+   * The queue must not be empty.
+   */
+  void FillBottom (void);
+  /**
+   * Spread events over a new rung.
+   *
+   * \param [in] events The events to move, which are cleared.
+   * \param [in] start The start of the time span covered by the new rung.
+   * \param [in] width The bucket width of the new rung.
+   * \param [in] nBuckets The number of buckets of the new rung.
+   */
+  void AddRung (Events &events, uint64_t start, uint64_t width, uint64_t nBuckets);
+  /**
+   * Sort events into the empty Bottom.
+   *
+   * \param [in] events The events to move, which are cleared.
+   */
+  void SetBottom (Events &events);
+
+  /** The events at or after m_topStart, unsorted. */
+  Events m_top;
+  /** The smallest time stamp in the Top. */
+  uint64_t m_topMin;
+  /** The largest time stamp in the Top. */
+  uint64_t m_topMax;
+  /** The time stamp from which the events are inserted in the Top. */
+  uint64_t m_topStart;
+  /** The rungs, including the unused ones kept for their buckets. */
+  std::vector<Rung> m_rungs;
+  /** The number of rungs in use. */
+  uint32_t m_nRungs;
+  /** The events of the Bottom, sorted from m_bottomHead on. */
+  Events m_bottom;
+  /** The index of the next event of the Bottom. */
+  std::size_t m_bottomHead;
+  /** The number of events in the queue. */
+  uint32_t m_size;
+  /** The number of events of a bucket from which it is spread over a new rung. */
+  uint32_t m_threshold;
+  /** The maximum number of rungs. */
+  uint32_t m_maxRungs;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_QUEUE_SCHEDULER_H */
@@ -42,7 +42,9 @@ EventImpl * MakeEvent (void (*f)(void))
 
     EventFunctionImpl0 (F function)
       : m_function (function)
-    {}
+    {
+      SetTarget (&m_function);
+    }
     virtual ~EventFunctionImpl0 ()
     {}
 
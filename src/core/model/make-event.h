@@ -365,7 +365,9 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj)
     EventMemberImpl0 (OBJ obj, MEM function)
       : m_obj (obj),
         m_function (function)
-    {}
+    {
+      SetTarget (&m_function);
+    }
     virtual ~EventMemberImpl0 ()
     {}
 
@@ -393,7 +395,9 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1)
       : m_obj (obj),
         m_function (function),
         m_a1 (a1)
-    {}
+    {
+      SetTarget (&m_function);
+    }
 
   protected:
     virtual ~EventMemberImpl1 ()
@@ -424,7 +428,9 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2)
         m_function (function),
         m_a1 (a1),
         m_a2 (a2)
-    {}
+    {
+      SetTarget (&m_function);
+    }
 
   protected:
     virtual ~EventMemberImpl2 ()
@@ -457,7 +463,9 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3)
         m_a1 (a1),
         m_a2 (a2),
         m_a3 (a3)
-    {}
+    {
+      SetTarget (&m_function);
+    }
 
   protected:
     virtual ~EventMemberImpl3 ()
@@ -492,7 +500,9 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3, T4 a4)
         m_a2 (a2),
         m_a3 (a3),
         m_a4 (a4)
-    {}
+    {
+      SetTarget (&m_function);
+    }
 
   protected:
     virtual ~EventMemberImpl4 ()
@@ -530,7 +540,9 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj,
         m_a3 (a3),
         m_a4 (a4),
         m_a5 (a5)
-    {}
+    {
+      SetTarget (&m_function);
+    }
 
   protected:
     virtual ~EventMemberImpl5 ()
@@ -570,7 +582,9 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj,
         m_a4 (a4),
         m_a5 (a5),
         m_a6 (a6)
-    {}
+    {
+      SetTarget (&m_function);
+    }
 
   protected:
     virtual ~EventMemberImpl6 ()
@@ -605,7 +619,9 @@ EventImpl * MakeEvent (void (*f)(U1), T1 a1)
     EventFunctionImpl1 (F function, T1 a1)
       : m_function (function),
         m_a1 (a1)
-    {}
+    {
+      SetTarget (&m_function);
+    }
 
   protected:
     virtual ~EventFunctionImpl1 ()
@@ -635,7 +651,9 @@ EventImpl * MakeEvent (void (*f)(U1,U2), T1 a1, T2 a2)
       : m_function (function),
         m_a1 (a1),
         m_a2 (a2)
-    {}
+    {
+      SetTarget (&m_function);
+    }
 
   protected:
     virtual ~EventFunctionImpl2 ()
@@ -668,7 +686,9 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3), T1 a1, T2 a2, T3 a3)
         m_a1 (a1),
         m_a2 (a2),
         m_a3 (a3)
-    {}
+    {
+      SetTarget (&m_function);
+    }
 
   protected:
     virtual ~EventFunctionImpl3 ()
@@ -703,7 +723,9 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3,U4), T1 a1, T2 a2, T3 a3, T4 a4)
         m_a2 (a2),
         m_a3 (a3),
         m_a4 (a4)
-    {}
+    {
+      SetTarget (&m_function);
+    }
 
   protected:
     virtual ~EventFunctionImpl4 ()
@@ -740,7 +762,9 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3,U4,U5), T1 a1, T2 a2, T3 a3, T4 a4, T5
         m_a3 (a3),
         m_a4 (a4),
         m_a5 (a5)
-    {}
+    {
+      SetTarget (&m_function);
+    }
 
   protected:
     virtual ~EventFunctionImpl5 ()
@@ -779,7 +803,9 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3,U4,U5,U6), T1 a1, T2 a2, T3 a3, T4 a4,
         m_a4 (a4),
         m_a5 (a5),
         m_a6 (a6)
-    {}
+    {
+      SetTarget (&m_function);
+    }
 
   protected:
     virtual ~EventFunctionImpl6 ()
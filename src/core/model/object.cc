@@ -101,6 +101,7 @@ Object::Object ()
     m_getObjectCount (0)
 {
   NS_LOG_FUNCTION (this);
+  ClearCache (m_aggregates);
   m_aggregates->n = 1;
   m_aggregates->buffer[0] = this;
 }
@@ -120,6 +121,7 @@ Object::~Object ()
           m_aggregates->n--;
         }
     }
+  ClearCache (m_aggregates);
   // finally, if all objects have been removed from the list,
   // delete the aggregate list
   if (m_aggregates->n == 0)
@@ -135,6 +137,7 @@ Object::Object (const Object &o)
     m_aggregates ((struct Aggregates *) std::malloc (sizeof (struct Aggregates))),
     m_getObjectCount (0)
 {
+  ClearCache (m_aggregates);
   m_aggregates->n = 1;
   m_aggregates->buffer[0] = this;
 }
@@ -151,8 +154,16 @@ Object::DoGetObject (TypeId tid) const
   NS_LOG_FUNCTION (this << tid);
   NS_ASSERT (CheckLoose ());
 
+  struct Aggregates::CacheEntry &entry = m_aggregates->cache[tid.GetUid () % CACHE_SIZE];
+  if (entry.tid == tid)
+    {
+      return entry.object;
+    }
+
   uint32_t n = m_aggregates->n;
   TypeId objectTid = Object::GetTypeId ();
+  entry.tid = tid;
+  entry.object = 0;
   for (uint32_t i = 0; i < n; i++)
     {
       Object *current = m_aggregates->buffer[i];
@@ -173,7 +184,8 @@ Object::DoGetObject (TypeId tid) const
           current->m_getObjectCount++;
           // then, update the sort
           UpdateSortedArray (m_aggregates, i);
-          // finally, return the match
+          // finally, remember and return the match
+          entry.object = current;
           return const_cast<Object *> (current);
         }
     }
@@ -236,6 +248,15 @@ restart:
     }
 }
 void
+Object::ClearCache (struct Aggregates *aggregates)
+{
+  for (uint32_t i = 0; i < CACHE_SIZE; i++)
+    {
+      aggregates->cache[i].tid = TypeId ();
+      aggregates->cache[i].object = 0;
+    }
+}
+void
 Object::UpdateSortedArray (struct Aggregates *aggregates, uint32_t j) const
 {
   NS_LOG_FUNCTION (this << aggregates << j);
@@ -262,6 +283,7 @@ Object::AggregateObject (Ptr<Object> o)
   uint32_t total = m_aggregates->n + other->m_aggregates->n;
   struct Aggregates *aggregates =
     (struct Aggregates *)std::malloc (sizeof(struct Aggregates) + (total - 1) * sizeof(Object*));
+  ClearCache (aggregates);
   aggregates->n = total;
 
   // copy our buffer to the new buffer
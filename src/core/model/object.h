@@ -149,6 +149,10 @@ public:
    * Get a pointer to the requested aggregated Object.  If the type of object
    * requested is ns3::Object, a Ptr to the calling object is returned.
    *
+   * The lookups are cached per aggregation, so repeated calls on a hot
+   * path, such as GetObject<MobilityModel> () for each received packet,
+   * cost a table lookup instead of a walk of the aggregated Objects.
+   *
    * \tparam T \explicit The type of the aggregated Object to retrieve.
    * \returns A pointer to the requested Object, or zero
    *          if it could not be found.
@@ -330,6 +334,9 @@ private:
   friend struct ObjectDeleter;
   /**@}*/
 
+  /** The number of entries of the cache of the aggregate lookups. */
+  static const uint32_t CACHE_SIZE = 8;
+
   /**
    * The list of Objects aggregated to this one.
    *
@@ -344,6 +351,18 @@ private:
    */
   struct Aggregates
   {
+    /** An entry of the cache of the lookups. */
+    struct CacheEntry
+    {
+      TypeId tid;      /**< The TypeId looked up. */
+      Object *object;  /**< The matching Object, or 0 if none matches. */
+    };
+    /**
+     * Direct-mapped cache of the lookups by TypeId, including the
+     * failed ones, indexed by the TypeId uid modulo CACHE_SIZE.
+     * It is cleared whenever the set of Objects changes.
+     */
+    CacheEntry cache[CACHE_SIZE];
     /** The number of entries in \c buffer. */
     uint32_t n;
     /** The array of Objects. */
@@ -357,6 +376,12 @@ private:
    * \return The matching Object, if it is found
    */
   Ptr<Object> DoGetObject (TypeId tid) const;
+  /**
+   * Clear the cache of the lookups of an aggregate list.
+   *
+   * \param [in,out] aggregates The list of aggregated Objects.
+   */
+  static void ClearCache (struct Aggregates *aggregates);
   /**
    * Verify that this Object is still live, by checking it's reference count.
    * \return \c true if the reference count is non zero.
@@ -469,15 +494,25 @@ template <typename T>
 Ptr<T>
 Object::GetObject () const
 {
+  // Hot paths query the same TypeIds over and over: look them up in
+  // the cache first.
+  TypeId tid = T::GetTypeId ();
+  struct Aggregates::CacheEntry &entry = m_aggregates->cache[tid.GetUid () % CACHE_SIZE];
+  if (entry.tid == tid)
+    {
+      return Ptr<T> (static_cast<T *> (entry.object));
+    }
   // This is an optimization: if the cast works (which is likely),
   // things will be pretty fast.
   T *result = dynamic_cast<T *> (m_aggregates->buffer[0]);
   if (result != 0)
     {
+      entry.tid = tid;
+      entry.object = m_aggregates->buffer[0];
       return Ptr<T> (result);
     }
   // if the cast does not work, we try to do a full type check.
-  Ptr<Object> found = DoGetObject (T::GetTypeId ());
+  Ptr<Object> found = DoGetObject (tid);
   if (found != 0)
     {
       return Ptr<T> (static_cast<T *> (PeekPointer (found)));
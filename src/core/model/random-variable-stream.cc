@@ -139,6 +139,16 @@ RandomVariableStream::Peek (void) const
   return m_rng;
 }
 
+void
+RandomVariableStream::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  for (std::size_t i = 0; i < n; i++)
+    {
+      values[i] = GetValue ();
+    }
+}
+
 NS_OBJECT_ENSURE_REGISTERED (UniformRandomVariable);
 
 TypeId
@@ -210,6 +220,30 @@ UniformRandomVariable::GetInteger (void)
   return (uint32_t)GetValue (m_min, m_max + 1);
 }
 
+void
+UniformRandomVariable::GetValues (double min, double max, double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << min << max << values << n);
+  Peek ()->RandU01 (values, n);
+  for (std::size_t i = 0; i < n; i++)
+    {
+      values[i] = min + values[i] * (max - min);
+    }
+  if (IsAntithetic ())
+    {
+      for (std::size_t i = 0; i < n; i++)
+        {
+          values[i] = min + (max - values[i]);
+        }
+    }
+}
+void
+UniformRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  GetValues (m_min, m_max, values, n);
+}
+
 NS_OBJECT_ENSURE_REGISTERED (ConstantRandomVariable);
 
 TypeId
@@ -762,6 +796,66 @@ NormalRandomVariable::GetInteger (void)
   return (uint32_t)GetValue (m_mean, m_variance, m_bound);
 }
 
+void
+NormalRandomVariable::GetValues (double mean, double variance, double bound,
+                                 double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << mean << variance << bound << values << n);
+  double sigma = std::sqrt (variance);
+  std::size_t i = 0;
+  if (n > 0 && m_nextValid)
+    { // use previously generated
+      m_nextValid = false;
+      double x2 = mean + m_v2 * m_y * sigma;
+      if (std::fabs (x2 - mean) <= bound)
+        {
+          values[i++] = x2;
+        }
+    }
+  while (i < n)
+    { // Same Box-Muller transform as GetValue (double, double, double)
+      double u[2];
+      Peek ()->RandU01 (u, 2);
+      if (IsAntithetic ())
+        {
+          u[0] = (1 - u[0]);
+          u[1] = (1 - u[1]);
+        }
+      double v1 = 2 * u[0] - 1;
+      double v2 = 2 * u[1] - 1;
+      double w = v1 * v1 + v2 * v2;
+      if (w > 1.0)
+        {
+          continue;
+        }
+      double y = std::sqrt ((-2 * std::log (w)) / w);
+      double x1 = mean + v1 * y * sigma;
+      double x2 = mean + v2 * y * sigma;
+      if (std::fabs (x1 - mean) <= bound)
+        {
+          values[i++] = x1;
+          if (i == n)
+            {
+              // keep the other value for the next call
+              m_nextValid = true;
+              m_y = y;
+              m_v2 = v2;
+              break;
+            }
+        }
+      if (std::fabs (x2 - mean) <= bound)
+        {
+          values[i++] = x2;
+        }
+    }
+}
+void
+NormalRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  GetValues (m_mean, m_variance, m_bound, values, n);
+}
+
 NS_OBJECT_ENSURE_REGISTERED (LogNormalRandomVariable);
 
 TypeId
@@ -954,10 +1048,15 @@ GammaRandomVariable::GetValue (double alpha, double beta)
       return GetValue (1.0 + alpha, beta) * std::pow (u, 1.0 / alpha);
     }
 
-  double x, v, u;
   double d = alpha - 1.0 / 3.0;
   double c = (1.0 / 3.0) / std::sqrt (d);
+  return GetMarsagliaValue (beta, d, c);
+}
 
+double
+GammaRandomVariable::GetMarsagliaValue (double beta, double d, double c)
+{
+  double x, v, u;
   while (1)
     {
       do
@@ -1012,6 +1111,44 @@ GammaRandomVariable::GetInteger (void)
   return (uint32_t)GetValue (m_alpha, m_beta);
 }
 
+void
+GammaRandomVariable::GetValues (double alpha, double beta, double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << alpha << beta << values << n);
+  if (alpha < 0)
+    {
+      RandomVariableStream::GetValues (values, n);
+      return;
+    }
+  // For alpha < 1, GetValue (alpha, beta) draws u, then a value for
+  // alpha + 1.
+  bool small = alpha < 1;
+  double d = (small ? 1.0 + alpha : alpha) - 1.0 / 3.0;
+  double c = (1.0 / 3.0) / std::sqrt (d);
+  for (std::size_t i = 0; i < n; i++)
+    {
+      if (small)
+        {
+          double u = Peek ()->RandU01 ();
+          if (IsAntithetic ())
+            {
+              u = (1 - u);
+            }
+          values[i] = GetMarsagliaValue (beta, d, c) * std::pow (u, 1.0 / alpha);
+        }
+      else
+        {
+          values[i] = GetMarsagliaValue (beta, d, c);
+        }
+    }
+}
+void
+GammaRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  GetValues (m_alpha, m_beta, values, n);
+}
+
 double
 GammaRandomVariable::GetNormalValue (double mean, double variance, double bound)
 {
@@ -1151,6 +1288,53 @@ ErlangRandomVariable::GetInteger (void)
   return (uint32_t)GetValue (m_k, m_lambda);
 }
 
+void
+ErlangRandomVariable::GetValues (uint32_t k, double lambda, double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << k << lambda << values << n);
+  double mean = lambda;
+  std::fill (values, values + n, 0.0);
+
+  // Each value is the sum of k exponential values, drawn from
+  // consecutive uniforms as in GetValue (uint32_t, double).
+  static const std::size_t BLOCK = 64;
+  double u[BLOCK];
+  std::size_t total = static_cast<std::size_t> (k) * n;
+  std::size_t value = 0;
+  uint32_t left = k;
+  for (std::size_t start = 0; start < total; start += BLOCK)
+    {
+      std::size_t m = std::min (BLOCK, total - start);
+      Peek ()->RandU01 (u, m);
+      if (IsAntithetic ())
+        {
+          for (std::size_t j = 0; j < m; j++)
+            {
+              u[j] = (1 - u[j]);
+            }
+        }
+      for (std::size_t j = 0; j < m; j++)
+        {
+          u[j] = std::log (u[j]);
+        }
+      for (std::size_t j = 0; j < m; j++)
+        {
+          values[value] += -mean * u[j];
+          if (--left == 0)
+            {
+              value++;
+              left = k;
+            }
+        }
+    }
+}
+void
+ErlangRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  GetValues (m_k, m_lambda, values, n);
+}
+
 double
 ErlangRandomVariable::GetExponentialValue (double mean, double bound)
 {
@@ -30,6 +30,7 @@
 #include "object.h"
 #include "attribute-helper.h"
 #include <stdint.h>
+#include <cstddef>
 
 /**
  * \file
@@ -143,6 +144,20 @@ public:
    */
   virtual double GetValue (void) = 0;
 
+  /**
+   * \brief Get the next random values as doubles drawn from the distribution.
+   *
+   * The values are the same as those of \pname{n} successive calls to
+   * GetValue(void), so batches of any size can be drawn from a stream
+   * without changing its sequence.  The default implementation calls
+   * GetValue(void); the distributions drawn from often override it
+   * to draw their uniforms and apply their transform in tight loops.
+   *
+   * \param [out] values The array to fill.
+   * \param [in] n The number of values to draw.
+   */
+  virtual void GetValues (double *values, std::size_t n);
+
   /**
    * \brief Get the next random value as an integer drawn from the distribution.
    * \return  An integer random value.
@@ -295,6 +310,23 @@ public:
    */
   virtual uint32_t GetInteger (void);
 
+  /**
+   * \brief Get the next random values, as doubles in the specified range
+   * \f$[min, max)\f$.
+   *
+   * The values are the same as those of \pname{n} successive calls to
+   * GetValue(double,double).
+   *
+   * \param [in] min Low end of the range (included).
+   * \param [in] max High end of the range (excluded).
+   * \param [out] values The array to fill.
+   * \param [in] n The number of values to draw.
+   */
+  void GetValues (double min, double max, double *values, std::size_t n);
+
+  // Inherited from RandomVariableStream
+  virtual void GetValues (double *values, std::size_t n);
+
 private:
   /** The lower bound on values that can be returned by this RNG stream. */
   double m_min;
@@ -1224,6 +1256,25 @@ public:
    */
   virtual uint32_t GetInteger (void);
 
+  /**
+   * \brief Returns random doubles from a normal distribution with the specified mean, variance, and bound.
+   *
+   * The values are the same as those of \pname{n} successive calls to
+   * GetValue(double,double,double): both values of each pair of
+   * uniforms are used within the batch, and a remaining one is kept
+   * for the next call.
+   *
+   * \param [in] mean Mean value for the normal distribution.
+   * \param [in] variance Variance value for the normal distribution.
+   * \param [in] bound Bound on values returned.
+   * \param [out] values The array to fill.
+   * \param [in] n The number of values to draw.
+   */
+  void GetValues (double mean, double variance, double bound, double *values, std::size_t n);
+
+  // Inherited from RandomVariableStream
+  virtual void GetValues (double *values, std::size_t n);
+
 private:
   /** The mean value for the normal distribution returned by this RNG stream. */
   double m_mean;
@@ -1585,7 +1636,35 @@ public:
    */
   virtual uint32_t GetInteger (void);
 
+  /**
+   * \brief Returns random doubles from a gamma distribution with the specified alpha and beta.
+   *
+   * The values are the same as those of \pname{n} successive calls to
+   * GetValue(double,double).  The constants of the Marsaglia and Tsang
+   * method are computed once for the batch, but each value keeps its
+   * rejection loop, which draws a variable number of uniforms.
+   *
+   * \param [in] alpha Alpha value for the gamma distribution.
+   * \param [in] beta Beta value for the gamma distribution.
+   * \param [out] values The array to fill.
+   * \param [in] n The number of values to draw.
+   */
+  void GetValues (double alpha, double beta, double *values, std::size_t n);
+
+  // Inherited from RandomVariableStream
+  virtual void GetValues (double *values, std::size_t n);
+
 private:
+  /**
+   * \brief Returns a random double from a gamma distribution with
+   * alpha at least 1, by the Marsaglia and Tsang method.
+   * \param [in] beta Beta value for the gamma distribution.
+   * \param [in] d The constant \f$ d = alpha - 1/3 \f$.
+   * \param [in] c The constant \f$ c = 1 / (3 \sqrt{d}) \f$.
+   * \return A floating point random value.
+   */
+  double GetMarsagliaValue (double beta, double d, double c);
+
   /**
    * \brief Returns a random double from a normal distribution with the specified mean, variance, and bound.
    * \param [in] mean Mean value for the normal distribution.
@@ -1764,6 +1843,24 @@ public:
    */
   virtual uint32_t GetInteger (void);
 
+  /**
+   * \brief Returns random doubles from an Erlang distribution with the specified k and lambda.
+   *
+   * The values are the same as those of \pname{n} successive calls to
+   * GetValue(uint32_t,double).  The \f$ k n \f$ uniforms are drawn in
+   * blocks, and their logarithms computed in a separate loop which the
+   * compiler can vectorize.
+   *
+   * \param [in] k K value for the Erlang distribution.
+   * \param [in] lambda Lambda value for the Erlang distribution.
+   * \param [out] values The array to fill.
+   * \param [in] n The number of values to draw.
+   */
+  void GetValues (uint32_t k, double lambda, double *values, std::size_t n);
+
+  // Inherited from RandomVariableStream
+  virtual void GetValues (double *values, std::size_t n);
+
 private:
   /**
    * \brief Returns a random double from an exponential distribution with the specified mean and upper bound.
@@ -21,6 +21,7 @@
 #define RNGSTREAM_H
 #include <string>
 #include <stdint.h>
+#include <cstddef>
 
 /**
  * \file
@@ -70,6 +71,18 @@ public:
    * \returns The next random.
    */
   double RandU01 (void);
+  /**
+   * Generate the next random numbers for this stream.
+   * Uniformly distributed between 0 and 1.
+   *
+   * The numbers are the same as those of \pname{n} successive calls
+   * to RandU01(void), but the state is kept in registers for the
+   * whole batch.
+   *
+   * \param [out] values The array to fill.
+   * \param [in] n The number of values to generate.
+   */
+  void RandU01 (double *values, std::size_t n);
 
 private:
   /**
@@ -302,6 +302,12 @@ Simulator::GetContext (void)
   return GetImpl ()->GetContext ();
 }
 
+void
+Simulator::SetContext (uint32_t context)
+{
+  GetImpl ()->SetContext (context);
+}
+
 uint64_t
 Simulator::GetEventCount (void)
 {
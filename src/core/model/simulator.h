@@ -184,6 +184,20 @@ public:
    */
   static uint32_t GetContext (void);
 
+  /**
+   * Set the context of the event being executed.
+   *
+   * This is only meant for an event acting on behalf of several
+   * contexts, such as a channel delivering one transmission to many
+   * nodes in a single event: it switches to the context of each node
+   * before handing it the transmission, so that the events the node
+   * schedules with Schedule() belong to it, and restores the context
+   * of the event before returning.
+   *
+   * @param [in] context The new context.
+   */
+  static void SetContext (uint32_t context);
+
   /**
    * Context enum values.
    *
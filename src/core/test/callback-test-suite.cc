@@ -595,6 +595,83 @@ NullifyCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (target1.IsNull (), true, "Nullified Callback reports not IsNull()");
 }
 
+// ===========================================================================
+// Test the allocation of the CallbackImpl objects
+// ===========================================================================
+class CallbackPoolTestCase : public TestCase
+{
+public:
+  CallbackPoolTestCase ();
+  virtual ~CallbackPoolTestCase ()
+  {}
+
+  static void Target (double *sum, double b)
+  {
+    *sum += b;
+  }
+
+  /** A functor too large to be pooled. */
+  struct LargeFunctor
+  {
+    /** Call operator, adds up the payload. */
+    void operator() (int a)
+    {
+      m_payload[0] += a;
+    }
+    /**
+     * Inequality operator, required by the CallbackImpl
+     * \param [in] other The other functor
+     * \return \c true if the functors are different objects
+     */
+    bool operator!= (const LargeFunctor &other) const
+    {
+      return this != &other;
+    }
+    double m_payload[64]; //!< payload
+  };
+
+private:
+  virtual void DoRun (void);
+
+  double m_sum;
+};
+
+CallbackPoolTestCase::CallbackPoolTestCase ()
+  : TestCase ("Check that CallbackImpl objects are recycled")
+{}
+
+void
+CallbackPoolTestCase::DoRun (void)
+{
+  m_sum = 0;
+  {
+    // warm up the free list of the bound callbacks
+    Callback<void, double> warm = MakeBoundCallback (&CallbackPoolTestCase::Target, &m_sum);
+    warm (1.5);
+  }
+  BlockPool::Stats before = CallbackImplBase::GetPoolStats ();
+  {
+    Callback<void, double> bound = MakeBoundCallback (&CallbackPoolTestCase::Target, &m_sum);
+    Callback<void, double> copy = bound;
+    copy (2.5);
+  }
+  BlockPool::Stats after = CallbackImplBase::GetPoolStats ();
+  NS_TEST_EXPECT_MSG_EQ (m_sum, 4, "Callback did not fire or binding not correct");
+  NS_TEST_EXPECT_MSG_EQ (after.allocations - before.allocations, 1, "Copying a callback should not allocate");
+  NS_TEST_EXPECT_MSG_EQ (after.recycled - before.recycled, 1, "CallbackImpl not recycled");
+  NS_TEST_EXPECT_MSG_EQ (after.cached, before.cached, "CallbackImpl not released");
+
+  before = after;
+  {
+    Callback<void, int> large (LargeFunctor (), true, true);
+    large (1);
+  }
+  after = CallbackImplBase::GetPoolStats ();
+  NS_TEST_EXPECT_MSG_EQ (after.recycled, before.recycled, "A large CallbackImpl should not be pooled");
+  NS_TEST_EXPECT_MSG_EQ (after.releases - before.releases, 1, "CallbackImpl not released");
+  NS_TEST_EXPECT_MSG_EQ (after.cached, before.cached, "A large CallbackImpl should not be cached");
+}
+
 // ===========================================================================
 // Make sure that various MakeCallback template functions compile and execute.
 // Doesn't check an results of the execution.
@@ -755,6 +832,7 @@ CallbackTestSuite::CallbackTestSuite ()
   AddTestCase (new MakeCallbackTestCase, TestCase::QUICK);
   AddTestCase (new MakeBoundCallbackTestCase, TestCase::QUICK);
   AddTestCase (new NullifyCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new CallbackPoolTestCase, TestCase::QUICK);
   AddTestCase (new MakeCallbackTemplatesTestCase, TestCase::QUICK);
 }
 
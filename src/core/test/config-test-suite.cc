@@ -33,7 +33,9 @@
 #include "ns3/unused.h"
 
 
+#include <algorithm>
 #include <sstream>
+#include <vector>
 
 /**
  * \file
@@ -840,6 +842,93 @@ SearchAttributesOfParentObjectsTestCase::DoRun (void)
 
 }
 
+/**
+ * \ingroup config-tests
+ * Test that the Config paths parsed once still match the objects
+ * present when they are used again.
+ */
+class CompiledPathConfigTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  CompiledPathConfigTestCase ();
+  /** Destructor. */
+  virtual ~CompiledPathConfigTestCase ()
+  {}
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Count the matches of a path among some objects.
+   * \param [in] path The Config path.
+   * \param [in] objects The objects.
+   * \returns The number of matches in \pname{objects}.
+   */
+  std::size_t CountMatches (std::string path, const std::vector<Ptr<Object> > &objects) const;
+};
+
+CompiledPathConfigTestCase::CompiledPathConfigTestCase ()
+  : TestCase ("Check that parsed Config paths match the objects added since")
+{}
+
+std::size_t
+CompiledPathConfigTestCase::CountMatches (std::string path,
+                                          const std::vector<Ptr<Object> > &objects) const
+{
+  // the roots registered by the other test cases may match as well
+  Config::MatchContainer matches = Config::LookupMatches (path);
+  std::size_t n = 0;
+  for (Config::MatchContainer::Iterator i = matches.Begin (); i != matches.End (); ++i)
+    {
+      n += std::count (objects.begin (), objects.end (), *i);
+    }
+  return n;
+}
+
+void
+CompiledPathConfigTestCase::DoRun (void)
+{
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+  Ptr<ConfigTestObject> a = CreateObject<ConfigTestObject> ();
+  root->SetNodeA (a);
+  Ptr<ConfigTestObject> b = CreateObject<ConfigTestObject> ();
+  a->SetNodeB (b);
+
+  std::vector<Ptr<Object> > objects;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      Ptr<ConfigTestObject> obj = CreateObject<ConfigTestObject> ();
+      objects.push_back (obj);
+    }
+
+  std::string path = "/NodeA/NodeB/NodesB/[1-2]|0";
+  NS_TEST_ASSERT_MSG_EQ (CountMatches (path, objects), 0, "Unexpected match on an empty vector");
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      b->AddNodeB (DynamicCast<ConfigTestObject> (objects[i]));
+    }
+  NS_TEST_ASSERT_MSG_EQ (CountMatches (path, objects), 2, "Objects added to the vector not matched");
+  for (uint32_t i = 2; i < 4; i++)
+    {
+      b->AddNodeB (DynamicCast<ConfigTestObject> (objects[i]));
+    }
+  NS_TEST_ASSERT_MSG_EQ (CountMatches (path, objects), 3, "Index range not matched as expected");
+  NS_TEST_ASSERT_MSG_EQ (CountMatches ("/NodeA/NodeB/NodesB/*/", objects), 4, "Wildcard not matched as expected");
+
+  // an object of another type under the same path
+  Ptr<DerivedConfigTestObject> derived = CreateObject<DerivedConfigTestObject> ();
+  Ptr<ConfigTestObject> c = CreateObject<ConfigTestObject> ();
+  derived->SetNodeA (c);
+  root->SetNodeA (derived);
+  objects.clear ();
+  objects.push_back (c);
+  NS_TEST_ASSERT_MSG_EQ (CountMatches ("/NodeA/NodeA", objects), 1, "Attribute of a parent TypeId not matched");
+
+  Config::UnregisterRootNamespaceObject (root);
+}
+
 /**
  * \ingroup config-tests
  * The Test Suite that glues all of the Test Cases together.
@@ -858,6 +947,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase);
   AddTestCase (new ObjectVectorConfigTestCase);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase);
+  AddTestCase (new CompiledPathConfigTestCase);
 }
 
 /**
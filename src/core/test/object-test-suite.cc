@@ -475,6 +475,70 @@ ObjectFactoryTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_NE (a->GetObject<DerivedA> (), 0, "Unexpectedly able to work around C++ type system");
 }
 
+/**
+ * \ingroup object-tests
+ * Test the cache of the GetObject lookups follows the aggregations.
+ */
+class GetObjectCacheTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  GetObjectCacheTestCase ();
+  /** Destructor. */
+  virtual ~GetObjectCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+GetObjectCacheTestCase::GetObjectCacheTestCase ()
+  : TestCase ("Check the cache of the GetObject lookups")
+{}
+
+GetObjectCacheTestCase::~GetObjectCacheTestCase ()
+{}
+
+void
+GetObjectCacheTestCase::DoRun (void)
+{
+  Ptr<BaseA> baseA = CreateObject<BaseA> ();
+  Ptr<BaseB> baseB = CreateObject<BaseB> ();
+  baseA->AggregateObject (baseB);
+
+  //
+  // Repeated lookups, found or not, must keep returning the same answers
+  // whichever Object of the aggregation they start from.
+  //
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseB> (), baseB, "Cached GetObject<BaseB> returns a different Ptr");
+      NS_TEST_ASSERT_MSG_EQ (baseB->GetObject<BaseA> (), baseA, "Cached GetObject<BaseA> returns a different Ptr");
+      NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseA> (), baseA, "Cached GetObject<BaseA> returns a different Ptr");
+      NS_TEST_ASSERT_MSG_EQ (baseB->GetObject<DerivedA> (), 0, "Cached GetObject<DerivedA> unexpectedly succeeds");
+      NS_TEST_ASSERT_MSG_EQ (baseB->GetObject<DerivedB> (), 0, "Cached GetObject<DerivedB> unexpectedly succeeds");
+    }
+
+  //
+  // A failed lookup must not hide an Object aggregated later, neither to the
+  // Object it was made on nor to the Objects of the aggregation it joins.
+  //
+  Ptr<BaseA> otherA = CreateObject<BaseA> ();
+  Ptr<DerivedB> derivedB = CreateObject<DerivedB> ();
+  NS_TEST_ASSERT_MSG_EQ (otherA->GetObject<BaseB> (), 0, "GetObject<BaseB> unexpectedly succeeds");
+  otherA->AggregateObject (derivedB);
+  NS_TEST_ASSERT_MSG_EQ (otherA->GetObject<BaseB> (), derivedB, "GetObject<BaseB> misses an Object aggregated after a failed lookup");
+  NS_TEST_ASSERT_MSG_EQ (otherA->GetObject<DerivedB> (), derivedB, "GetObject<DerivedB> misses an Object aggregated after a failed lookup");
+
+  Ptr<DerivedA> derivedA = CreateObject<DerivedA> ();
+  Ptr<BaseB> otherB = CreateObject<BaseB> ();
+  NS_TEST_ASSERT_MSG_EQ (derivedA->GetObject<BaseB> (), 0, "GetObject<BaseB> unexpectedly succeeds");
+  NS_TEST_ASSERT_MSG_EQ (otherB->GetObject<DerivedA> (), 0, "GetObject<DerivedA> unexpectedly succeeds");
+  otherB->AggregateObject (derivedA);
+  NS_TEST_ASSERT_MSG_EQ (derivedA->GetObject<BaseB> (), otherB, "Stale cached GetObject<BaseB> after an aggregation");
+  NS_TEST_ASSERT_MSG_EQ (otherB->GetObject<DerivedA> (), derivedA, "Stale cached GetObject<DerivedA> after an aggregation");
+  NS_TEST_ASSERT_MSG_EQ (otherB->GetObject<BaseA> (), derivedA, "GetObject<BaseA> misses a DerivedA");
+}
+
 /**
  * \ingroup object-tests
  * The Test Suite that glues the Test Cases together.
@@ -492,6 +556,7 @@ ObjectTestSuite::ObjectTestSuite ()
   AddTestCase (new CreateObjectTestCase);
   AddTestCase (new AggregateObjectTestCase);
   AddTestCase (new ObjectFactoryTestCase);
+  AddTestCase (new GetObjectCacheTestCase);
 }
 
 /**
@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/double.h"
+#include "ns3/integer.h"
+#include "ns3/object-factory.h"
+#include "ns3/random-variable-stream.h"
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup randomvariable
+ * \ingroup randomvariable-tests
+ * Test for the batch interface of the random variable streams.
+ */
+
+namespace ns3 {
+
+namespace tests {
+
+
+/**
+ * \ingroup randomvariable-tests
+ * Test case checking RandomVariableStream::GetValues draws the same
+ * values as successive calls to RandomVariableStream::GetValue.
+ */
+class RandomVariableStreamBatchTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] description The distribution tested.
+   * \param [in] factory The factory of the random variables.
+   */
+  RandomVariableStreamBatchTestCase (std::string description, ObjectFactory factory);
+  /** Destructor. */
+  virtual ~RandomVariableStreamBatchTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /** The factory of the random variables. */
+  ObjectFactory m_factory;
+};
+
+RandomVariableStreamBatchTestCase::RandomVariableStreamBatchTestCase (std::string description,
+                                                                      ObjectFactory factory)
+  : TestCase ("Check batches of " + description + " values"),
+    m_factory (factory)
+{}
+
+RandomVariableStreamBatchTestCase::~RandomVariableStreamBatchTestCase ()
+{}
+
+void
+RandomVariableStreamBatchTestCase::DoRun (void)
+{
+  for (int antithetic = 0; antithetic < 2; antithetic++)
+    {
+      Ptr<RandomVariableStream> single = m_factory.Create<RandomVariableStream> ();
+      Ptr<RandomVariableStream> batch = m_factory.Create<RandomVariableStream> ();
+      single->SetStream (1);
+      batch->SetStream (1);
+      single->SetAntithetic (antithetic);
+      batch->SetAntithetic (antithetic);
+
+      // batches of odd and even sizes, around the block sizes, and mixed
+      // with single values
+      const std::size_t sizes[] = {1, 2, 7, 0, 63, 64, 65, 200, 3};
+      std::vector<double> values;
+      for (std::size_t size : sizes)
+        {
+          values.resize (size);
+          batch->GetValues (values.data (), size);
+          for (std::size_t i = 0; i < size; i++)
+            {
+              NS_TEST_ASSERT_MSG_EQ (values[i], single->GetValue (),
+                                     "Value " << i << " of a batch of " << size << " differs");
+            }
+          NS_TEST_ASSERT_MSG_EQ (batch->GetValue (), single->GetValue (),
+                                 "Value after a batch of " << size << " differs");
+        }
+    }
+}
+
+
+/**
+ * \ingroup randomvariable-tests
+ * RandomVariableStream batch test suite.
+ */
+class RandomVariableStreamBatchTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  RandomVariableStreamBatchTestSuite ();
+};
+
+RandomVariableStreamBatchTestSuite::RandomVariableStreamBatchTestSuite ()
+  : TestSuite ("random-variable-stream-batch", UNIT)
+{
+  ObjectFactory factory ("ns3::UniformRandomVariable");
+  factory.Set ("Min", DoubleValue (-3));
+  factory.Set ("Max", DoubleValue (5));
+  AddTestCase (new RandomVariableStreamBatchTestCase ("uniform", factory));
+
+  factory = ObjectFactory ("ns3::NormalRandomVariable");
+  factory.Set ("Mean", DoubleValue (2));
+  factory.Set ("Variance", DoubleValue (4));
+  AddTestCase (new RandomVariableStreamBatchTestCase ("normal", factory));
+  // with one value of many pairs out of bounds
+  factory.Set ("Bound", DoubleValue (2));
+  AddTestCase (new RandomVariableStreamBatchTestCase ("bounded normal", factory));
+
+  factory = ObjectFactory ("ns3::GammaRandomVariable");
+  factory.Set ("Alpha", DoubleValue (2.5));
+  factory.Set ("Beta", DoubleValue (3));
+  AddTestCase (new RandomVariableStreamBatchTestCase ("gamma", factory));
+  factory.Set ("Alpha", DoubleValue (0.75));
+  AddTestCase (new RandomVariableStreamBatchTestCase ("gamma with alpha < 1", factory));
+
+  factory = ObjectFactory ("ns3::ErlangRandomVariable");
+  factory.Set ("K", IntegerValue (3));
+  factory.Set ("Lambda", DoubleValue (0.5));
+  AddTestCase (new RandomVariableStreamBatchTestCase ("Erlang", factory));
+
+  // the default implementation
+  factory = ObjectFactory ("ns3::ExponentialRandomVariable");
+  AddTestCase (new RandomVariableStreamBatchTestCase ("exponential", factory));
+}
+
+/**
+ * \ingroup randomvariable-tests
+ * RandomVariableStreamBatchTestSuite instance variable.
+ */
+static RandomVariableStreamBatchTestSuite g_randomVariableStreamBatchTestSuite;
+
+
+}  // namespace tests
+
+}  // namespace ns3
@@ -24,6 +24,15 @@
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
 #include "ns3/priority-queue-scheduler.h"
+#include "ns3/ladder-queue-scheduler.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/config.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/core-config.h"
+
+#include <fstream>
+#include <set>
 
 using namespace ns3;
 
@@ -465,6 +474,235 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory, std::string description);
+  virtual void DoRun (void);
+  ObjectFactory m_schedulerFactory;
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory, std::string description)
+  : TestCase ("Check that bursts of events are ordered as by the MapScheduler with " +
+              schedulerFactory.GetTypeId ().GetName () + description),
+    m_schedulerFactory (schedulerFactory)
+{}
+
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  Ptr<Scheduler> reference = CreateObject<MapScheduler> ();
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+
+  std::vector<Scheduler::Event> pending;
+  std::set<uint32_t> removed;
+  uint64_t now = 0;
+  uint32_t uid = 0;
+  for (uint32_t step = 0; step < 5000; step++)
+    {
+      double op = random->GetValue ();
+      if (op < 0.2)
+        {
+          // a broadcast: many deliveries a few microseconds apart,
+          // some of them simultaneous
+          uint32_t n = random->GetInteger (1, 200);
+          for (uint32_t i = 0; i < n; i++)
+            {
+              Scheduler::Event ev;
+              ev.impl = 0;
+              ev.key.m_ts = now + random->GetInteger (0, 3) * random->GetInteger (0, 3000);
+              ev.key.m_uid = uid++;
+              ev.key.m_context = 0;
+              scheduler->Insert (ev);
+              reference->Insert (ev);
+              pending.push_back (ev);
+            }
+        }
+      else if (op < 0.3)
+        {
+          // a periodic timer
+          Scheduler::Event ev;
+          ev.impl = 0;
+          ev.key.m_ts = now + 100000000 + random->GetInteger (0, 5000000);
+          ev.key.m_uid = uid++;
+          ev.key.m_context = 0;
+          scheduler->Insert (ev);
+          reference->Insert (ev);
+          pending.push_back (ev);
+        }
+      else if (op < 0.35 && !pending.empty ())
+        {
+          uint32_t i = random->GetInteger (0, pending.size () - 1);
+          if (removed.count (pending[i].key.m_uid) == 0)
+            {
+              scheduler->Remove (pending[i]);
+              reference->Remove (pending[i]);
+            }
+          pending[i] = pending.back ();
+          pending.pop_back ();
+        }
+      else
+        {
+          for (uint32_t i = random->GetInteger (1, 100); i > 0 && !reference->IsEmpty (); i--)
+            {
+              NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), false, "Scheduler empty");
+              NS_TEST_ASSERT_MSG_EQ (scheduler->PeekNext ().key.m_uid,
+                                     reference->PeekNext ().key.m_uid, "Wrong next event");
+              Scheduler::Event next = scheduler->RemoveNext ();
+              NS_TEST_ASSERT_MSG_EQ (next.key.m_uid, reference->RemoveNext ().key.m_uid,
+                                     "Wrong event removed at step " << step);
+              now = next.key.m_ts;
+              removed.insert (next.key.m_uid);
+            }
+        }
+    }
+  while (!reference->IsEmpty ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (scheduler->RemoveNext ().key.m_uid, reference->RemoveNext ().key.m_uid,
+                             "Wrong event removed");
+    }
+  NS_TEST_EXPECT_MSG_EQ (scheduler->IsEmpty (), true, "Scheduler not empty");
+}
+
+class EventPoolTestCase : public TestCase
+{
+public:
+  EventPoolTestCase ();
+  virtual void DoRun (void);
+  void Event (uint64_t a, uint64_t b, uint64_t c);
+};
+
+EventPoolTestCase::EventPoolTestCase ()
+  : TestCase ("Check that the events are recycled by the event allocator")
+{}
+
+void
+EventPoolTestCase::Event (uint64_t a, uint64_t b, uint64_t c)
+{
+  NS_UNUSED (a);
+  NS_UNUSED (b);
+  NS_UNUSED (c);
+}
+
+void
+EventPoolTestCase::DoRun (void)
+{
+  // release the events of the previous tests and warm up the free lists
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Simulator::Schedule (MicroSeconds (i), &EventPoolTestCase::Event, this, i, i, i);
+    }
+  Simulator::Run ();
+  EventImpl::PoolStats before = EventImpl::GetPoolStats ();
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (before.cached, 100, "Events not released to the free lists");
+
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Simulator::Schedule (MicroSeconds (i), &EventPoolTestCase::Event, this, i, i, i);
+    }
+  EventImpl::PoolStats after = EventImpl::GetPoolStats ();
+  NS_TEST_EXPECT_MSG_EQ (after.allocations - before.allocations, 100, "Unexpected number of events allocated");
+  NS_TEST_EXPECT_MSG_EQ (after.recycled - before.recycled, 100, "Events not recycled");
+  NS_TEST_EXPECT_MSG_EQ (before.cached - after.cached, 100, "Unexpected number of blocks cached");
+
+  Simulator::Run ();
+  after = EventImpl::GetPoolStats ();
+  NS_TEST_EXPECT_MSG_EQ (after.releases - before.releases, 100, "Events not released");
+  NS_TEST_EXPECT_MSG_EQ (after.cached, before.cached, "Events not returned to the free lists");
+  Simulator::Destroy ();
+}
+
+class SimulatorProfileTestCase : public TestCase
+{
+public:
+  SimulatorProfileTestCase ();
+  virtual void DoRun (void);
+  void EventA (int a);
+  void EventB (void);
+  void EventC (void);
+};
+
+/**
+ * A function scheduled by SimulatorProfileTestCase, named from its
+ * symbol by the profiler.
+ */
+void
+SimulatorProfileFunction (void)
+{}
+
+SimulatorProfileTestCase::SimulatorProfileTestCase ()
+  : TestCase ("Check that the event profiler attributes the events to their function and context")
+{}
+
+void
+SimulatorProfileTestCase::EventA (int a)
+{
+  NS_UNUSED (a);
+}
+
+void
+SimulatorProfileTestCase::EventB (void)
+{}
+
+void
+SimulatorProfileTestCase::EventC (void)
+{}
+
+void
+SimulatorProfileTestCase::DoRun (void)
+{
+  std::string fileName = CreateTempDirFilename ("simulator-profile.folded");
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileSamplingInterval", UintegerValue (1));
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileFileName", StringValue (fileName));
+
+  for (int i = 0; i < 3; i++)
+    {
+      Simulator::ScheduleWithContext (7, MicroSeconds (i), &SimulatorProfileTestCase::EventA, this, i);
+    }
+  // same type of event, but distinct methods
+  Simulator::Schedule (MicroSeconds (1), &SimulatorProfileTestCase::EventB, this);
+  Simulator::Schedule (MicroSeconds (2), &SimulatorProfileTestCase::EventC, this);
+  Simulator::Schedule (MicroSeconds (3), &SimulatorProfileFunction);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileSamplingInterval", UintegerValue (0));
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileFileName", StringValue (""));
+
+  std::ifstream is (fileName.c_str ());
+  NS_TEST_ASSERT_MSG_EQ (is.is_open (), true, "Profile not written");
+  std::set<std::string> stacks;
+  std::string line;
+  while (std::getline (is, line))
+    {
+      std::string::size_type space = line.rfind (' ');
+      NS_TEST_ASSERT_MSG_NE (space, std::string::npos, "Invalid line " << line);
+      stacks.insert (line.substr (0, space));
+    }
+  NS_TEST_EXPECT_MSG_EQ (stacks.size (), 4, "Unexpected number of stacks");
+  uint32_t withContext = 0;
+  uint32_t withoutContext = 0;
+  for (std::set<std::string>::const_iterator i = stacks.begin (); i != stacks.end (); i++)
+    {
+      if (i->find ("node 7;void (SimulatorProfileTestCase::*)(int) [") == 0)
+        {
+          withContext++;
+        }
+      if (i->find ("no context;void (SimulatorProfileTestCase::*)() [") == 0)
+        {
+          withoutContext++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (withContext, 1, "Event with context not attributed");
+  NS_TEST_EXPECT_MSG_EQ (withoutContext, 2, "Methods with the same signature not told apart");
+#ifdef HAVE_DLFCN_H
+  NS_TEST_EXPECT_MSG_EQ (stacks.count ("no context;SimulatorProfileFunction()"), 1,
+                         "Function not named from its symbol");
+#endif
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -483,5 +721,13 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (PriorityQueueScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderQueueScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SchedulerOrderTestCase (factory, ""), TestCase::QUICK);
+    factory.Set ("Threshold", UintegerValue (4));
+    factory.Set ("MaxRungs", UintegerValue (3));
+    AddTestCase (new SchedulerOrderTestCase (factory, " and small buckets"), TestCase::QUICK);
+    AddTestCase (new EventPoolTestCase (), TestCase::QUICK);
+    AddTestCase (new SimulatorProfileTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
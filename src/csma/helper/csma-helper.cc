@@ -31,6 +31,7 @@
 #include "ns3/names.h"
 
 #include "ns3/trace-helper.h"
+#include "ns3/pcapng-file-writer.h"
 #include "csma-helper.h"
 
 #include <string>
@@ -113,6 +114,24 @@ CsmaHelper::EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bool prom
     }
 }
 
+void
+CsmaHelper::EnablePcapng (Ptr<PcapngFileWriter> writer, NetDeviceContainer devices, bool promiscuous)
+{
+  for (NetDeviceContainer::Iterator i = devices.Begin (); i != devices.End (); ++i)
+    {
+      Ptr<CsmaNetDevice> device = (*i)->GetObject<CsmaNetDevice> ();
+      if (device == 0)
+        {
+          NS_LOG_INFO ("CsmaHelper::EnablePcapng(): Device " << *i << " not of type ns3::CsmaNetDevice");
+          continue;
+        }
+      uint32_t interface = writer->AddInterface (device, PcapHelper::DLT_EN10MB);
+      bool result = device->TraceConnectWithoutContext (promiscuous ? "PromiscSniffer" : "Sniffer",
+                                                        MakeBoundCallback (&PcapngFileWriter::DefaultSink, writer, interface));
+      NS_ASSERT_MSG (result == true, "CsmaHelper::EnablePcapng(): Unable to hook the sniffer");
+    }
+}
+
 void 
 CsmaHelper::EnableAsciiInternal (
   Ptr<OutputStreamWrapper> stream, 
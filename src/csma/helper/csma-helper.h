@@ -32,6 +32,7 @@
 namespace ns3 {
 
 class Packet;
+class PcapngFileWriter;
 
 /**
  * \ingroup csma
@@ -205,6 +206,17 @@ public:
   */
   int64_t AssignStreams (NetDeviceContainer c, int64_t stream);
 
+  /**
+   * Capture the packets of some devices to a single pcapng file, instead
+   * of one pcap file per device.  Each device is added to the writer as an
+   * interface of data link type DLT_EN10MB.
+   *
+   * \param writer the pcapng writer, open or not yet open
+   * \param devices the devices; those which are not CsmaNetDevices are ignored
+   * \param promiscuous If true capture all possible packets available at the device.
+   */
+  void EnablePcapng (Ptr<PcapngFileWriter> writer, NetDeviceContainer devices, bool promiscuous = false);
+
 private:
 
   /**
@@ -20,8 +20,10 @@
 
 #include "csma-channel.h"
 #include "csma-net-device.h"
+#include <algorithm>
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
+#include "ns3/boolean.h"
 #include "ns3/log.h"
 
 namespace ns3 {
@@ -46,13 +48,22 @@ CsmaChannel::GetTypeId (void)
                    TimeValue (Seconds (0)),
                    MakeTimeAccessor (&CsmaChannel::m_delay),
                    MakeTimeChecker ())
+    .AddAttribute ("BatchDelivery",
+                   "If true, a transmission is delivered to all the devices by a single "
+                   "event instead of one event per device. The devices check the shared "
+                   "packet and only copy it when they accept it, or when trace sinks are "
+                   "connected to them.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&CsmaChannel::m_batchDelivery),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 CsmaChannel::CsmaChannel ()
   :
-    Channel ()
+    Channel (),
+    m_batchDelivery (false)
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_state = IDLE;
@@ -63,6 +74,7 @@ CsmaChannel::~CsmaChannel ()
 {
   NS_LOG_FUNCTION (this);
   m_deviceList.clear ();
+  m_deviceIds.clear ();
 }
 
 int32_t
@@ -73,8 +85,12 @@ CsmaChannel::Attach (Ptr<CsmaNetDevice> device)
 
   CsmaDeviceRec rec (device);
 
+  uint32_t deviceId = m_deviceList.size ();
   m_deviceList.push_back (rec);
-  return (m_deviceList.size () - 1);
+  m_deviceIds[device].push_back (deviceId);
+  // the IDs are increasing, so the index stays sorted
+  m_activeDevices.push_back (deviceId);
+  return deviceId;
 }
 
 bool
@@ -83,23 +99,13 @@ CsmaChannel::Reattach (Ptr<CsmaNetDevice> device)
   NS_LOG_FUNCTION (this << device);
   NS_ASSERT (device != 0);
 
-  std::vector<CsmaDeviceRec>::iterator it;
-  for (it = m_deviceList.begin (); it < m_deviceList.end ( ); it++)
+  DeviceIds::const_iterator it = m_deviceIds.find (device);
+  if (it == m_deviceIds.end () || m_deviceList[it->second.front ()].active)
     {
-      if (it->devicePtr == device) 
-        {
-          if (!it->active) 
-            {
-              it->active = true;
-              return true;
-            } 
-          else 
-            {
-              return false;
-            }
-        }
+      return false;
     }
-  return false;
+  SetActive (it->second.front (), true);
+  return true;
 }
 
 bool
@@ -107,7 +113,7 @@ CsmaChannel::Reattach (uint32_t deviceId)
 {
   NS_LOG_FUNCTION (this << deviceId);
 
-  if (deviceId < m_deviceList.size ())
+  if (deviceId >= m_deviceList.size ())
     {
       return false;
     }
@@ -118,11 +124,29 @@ CsmaChannel::Reattach (uint32_t deviceId)
     } 
   else 
     {
-      m_deviceList[deviceId].active = true;
+      SetActive (deviceId, true);
       return true;
     }
 }
 
+void
+CsmaChannel::SetActive (uint32_t deviceId, bool active)
+{
+  NS_LOG_FUNCTION (this << deviceId << active);
+  NS_ASSERT (m_deviceList[deviceId].active != active);
+  m_deviceList[deviceId].active = active;
+  std::vector<uint32_t>::iterator it = std::lower_bound (m_activeDevices.begin (), m_activeDevices.end (), deviceId);
+  if (active)
+    {
+      m_activeDevices.insert (it, deviceId);
+    }
+  else
+    {
+      NS_ASSERT (it != m_activeDevices.end () && *it == deviceId);
+      m_activeDevices.erase (it);
+    }
+}
+
 bool
 CsmaChannel::Detach (uint32_t deviceId)
 {
@@ -136,7 +160,7 @@ CsmaChannel::Detach (uint32_t deviceId)
           return false;
         }
 
-      m_deviceList[deviceId].active = false;
+      SetActive (deviceId, false);
 
       if ((m_state == TRANSMITTING) && (m_currentSrc == deviceId))
         {
@@ -157,12 +181,17 @@ CsmaChannel::Detach (Ptr<CsmaNetDevice> device)
   NS_LOG_FUNCTION (this << device);
   NS_ASSERT (device != 0);
 
-  std::vector<CsmaDeviceRec>::iterator it;
-  for (it = m_deviceList.begin (); it < m_deviceList.end (); it++) 
+  DeviceIds::const_iterator it = m_deviceIds.find (device);
+  if (it == m_deviceIds.end ())
     {
-      if ((it->devicePtr == device) && (it->active)) 
+      return false;
+    }
+  // the first active attachment of the device, if it was attached several times
+  for (std::vector<uint32_t>::const_iterator id = it->second.begin (); id != it->second.end (); id++)
+    {
+      if (m_deviceList[*id].active)
         {
-          it->active = false;
+          SetActive (*id, false);
           return true;
         }
     }
@@ -222,19 +251,23 @@ CsmaChannel::TransmitEnd ()
 
   NS_LOG_LOGIC ("Receive");
 
-  std::vector<CsmaDeviceRec>::iterator it;
-  uint32_t devId = 0;
-  for (it = m_deviceList.begin (); it < m_deviceList.end (); it++)
+  if (m_batchDelivery)
     {
-      if (it->IsActive ())
-        {
-          // schedule reception events
-          Simulator::ScheduleWithContext (it->devicePtr->GetNode ()->GetId (),
-                                          m_delay,
-                                          &CsmaNetDevice::Receive, it->devicePtr,
-                                          m_currentPkt->Copy (), m_deviceList[m_currentSrc].devicePtr);
-        }
-      devId++;
+      // the receivers are the devices active now, as when an event is
+      // scheduled per device
+      m_receivers = m_activeDevices;
+      Simulator::Schedule (m_delay, &CsmaChannel::ReceiveBatch, this);
+      return retVal;
+    }
+
+  for (std::vector<uint32_t>::const_iterator it = m_activeDevices.begin (); it != m_activeDevices.end (); it++)
+    {
+      Ptr<CsmaNetDevice> device = m_deviceList[*it].devicePtr;
+      // schedule reception events
+      Simulator::ScheduleWithContext (device->GetNode ()->GetId (),
+                                      m_delay,
+                                      &CsmaNetDevice::Receive, device,
+                                      m_currentPkt->Copy (), m_deviceList[m_currentSrc].devicePtr);
     }
 
   // also schedule for the tx side to go back to IDLE
@@ -253,19 +286,32 @@ CsmaChannel::PropagationCompleteEvent ()
   m_state = IDLE;
 }
 
-uint32_t
-CsmaChannel::GetNumActDevices (void)
+void
+CsmaChannel::ReceiveBatch ()
 {
-  int numActDevices = 0;
-  std::vector<CsmaDeviceRec>::iterator it;
-  for (it = m_deviceList.begin (); it < m_deviceList.end (); it++) 
+  NS_LOG_FUNCTION (this << m_currentPkt << m_receivers.size ());
+  NS_ASSERT (m_state == PROPAGATING);
+
+  Ptr<CsmaNetDevice> sender = m_deviceList[m_currentSrc].devicePtr;
+  uint32_t context = Simulator::GetContext ();
+  for (std::vector<uint32_t>::const_iterator it = m_receivers.begin (); it != m_receivers.end (); it++)
     {
-      if (it->active)
+      if (*it == m_currentSrc)
         {
-          numActDevices++;
+          continue; // the sender does not receive its own packets
         }
+      Ptr<CsmaNetDevice> device = m_deviceList[*it].devicePtr;
+      Simulator::SetContext (device->GetNode ()->GetId ());
+      device->ReceiveShared (m_currentPkt, sender);
     }
-  return numActDevices;
+  Simulator::SetContext (context);
+  PropagationCompleteEvent ();
+}
+
+uint32_t
+CsmaChannel::GetNumActDevices (void)
+{
+  return m_activeDevices.size ();
 }
 
 std::size_t
@@ -283,24 +329,16 @@ CsmaChannel::GetCsmaDevice (std::size_t i) const
 int32_t
 CsmaChannel::GetDeviceNum (Ptr<CsmaNetDevice> device)
 {
-  std::vector<CsmaDeviceRec>::iterator it;
-  int i = 0;
-  for (it = m_deviceList.begin (); it < m_deviceList.end (); it++) 
+  DeviceIds::const_iterator it = m_deviceIds.find (device);
+  if (it == m_deviceIds.end ())
     {
-      if (it->devicePtr == device)
-        {
-          if (it->active) 
-            {
-              return i;
-            } 
-          else 
-            {
-              return -2;
-            }
-        }
-      i++;
+      return -1;
+    }
+  if (m_deviceList[it->second.front ()].active)
+    {
+      return it->second.front ();
     }
-  return -1;
+  return -2;
 }
 
 bool
@@ -21,6 +21,8 @@
 #ifndef CSMA_CHANNEL_H
 #define CSMA_CHANNEL_H
 
+#include <map>
+#include <vector>
 #include "ns3/channel.h"
 #include "ns3/ptr.h"
 #include "ns3/nstime.h"
@@ -86,6 +88,12 @@ enum WireState
  * flag to indicate if the channel is currently in use. It does not
  * take into account the distances between stations or the speed of
  * light to determine collisions.
+ *
+ * The channel keeps an index of its devices and of the active ones, so
+ * that attaching, detaching and looking up a device do not scan all the
+ * devices.  When the BatchDelivery attribute is set, a transmission is
+ * delivered to all the active devices by a single event (see
+ * CsmaNetDevice::ReceiveShared), instead of an event per device.
  */
 class CsmaChannel : public Channel 
 {
@@ -211,6 +219,15 @@ public:
    */
   void PropagationCompleteEvent ();
 
+  /**
+   * \brief Deliver the current packet to the devices that were active
+   * at the end of its transmission, in batch delivery mode, then
+   * release the channel.
+   *
+   * Each device is handed the packet in its node context.
+   */
+  void ReceiveBatch ();
+
   /**
    * \return Returns the device number assigned to a net device by the
    * channel
@@ -308,6 +325,15 @@ private:
    */
   CsmaChannel &operator = (CsmaChannel const &o);
 
+  /**
+   * Mark a device as active or inactive, and update the index of the
+   * active devices.
+   *
+   * \param deviceId the device ID
+   * \param active true to mark the device as active
+   */
+  void SetActive (uint32_t deviceId, bool active);
+
   /**
    * The assigned data rate of the channel
    */
@@ -331,6 +357,32 @@ private:
    */
   std::vector<CsmaDeviceRec> m_deviceList;
 
+  /** Container type for the device IDs of each device. */
+  typedef std::map<Ptr<CsmaNetDevice>, std::vector<uint32_t> > DeviceIds;
+
+  /**
+   * Device IDs of each device attached to the channel, in increasing
+   * order: a device may be attached several times.
+   */
+  DeviceIds m_deviceIds;
+
+  /**
+   * IDs of the active devices, in increasing order, which is the order of
+   * the receptions.
+   */
+  std::vector<uint32_t> m_activeDevices;
+
+  /**
+   * IDs of the active devices at the end of the current transmission, to
+   * which it is delivered in batch delivery mode.
+   */
+  std::vector<uint32_t> m_receivers;
+
+  /**
+   * Whether a transmission is delivered to all the devices by one event
+   */
+  bool m_batchDelivery;
+
   /**
    * The Packet that is currently being transmitted on the channel (or last
    * packet to have been transmitted on the channel if the channel is
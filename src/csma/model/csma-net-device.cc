@@ -725,6 +725,58 @@ CsmaNetDevice::Receive (Ptr<Packet> packet, Ptr<CsmaNetDevice> senderDevice)
   // headers.
   //
   Ptr<Packet> originalPacket = packet->Copy ();
+  ReceiveAccepted (packet, originalPacket);
+}
+
+void
+CsmaNetDevice::ReceiveShared (Ptr<const Packet> packet, Ptr<CsmaNetDevice> senderDevice)
+{
+  NS_LOG_FUNCTION (packet << senderDevice);
+  NS_LOG_LOGIC ("UID is " << packet->GetUid ());
+
+  if (senderDevice == this)
+    {
+      return;
+    }
+
+  //
+  // The other receivers get the same packet.  The trace sinks of this device,
+  // which may tag the packet they get, get a copy of their own as from
+  // Receive; without trace sinks, the packet is only copied once accepted.
+  //
+  Ptr<const Packet> tracedPacket = packet;
+  if (!m_phyRxEndTrace.IsEmpty () || !m_phyRxDropTrace.IsEmpty ()
+      || !m_promiscSnifferTrace.IsEmpty () || !m_macPromiscRxTrace.IsEmpty ()
+      || !m_snifferTrace.IsEmpty () || !m_macRxTrace.IsEmpty ())
+    {
+      tracedPacket = packet->Copy ();
+    }
+
+  m_phyRxEndTrace (tracedPacket);
+
+  if (IsReceiveEnabled () == false)
+    {
+      m_phyRxDropTrace (tracedPacket);
+      return;
+    }
+
+  //
+  // The error models do not modify the packets they check.
+  //
+  if (m_receiveErrorModel && m_receiveErrorModel->IsCorrupt (ConstCast<Packet> (packet)))
+    {
+      NS_LOG_LOGIC ("Dropping pkt due to error model ");
+      m_phyRxDropTrace (tracedPacket);
+      return;
+    }
+
+  ReceiveAccepted (packet->Copy (), tracedPacket);
+}
+
+void
+CsmaNetDevice::ReceiveAccepted (Ptr<Packet> packet, Ptr<const Packet> originalPacket)
+{
+  NS_LOG_FUNCTION (packet << originalPacket);
 
   EthernetTrailer trailer;
   packet->RemoveTrailer (trailer);
@@ -168,6 +168,22 @@ public:
    */
   void Receive (Ptr<Packet> p, Ptr<CsmaNetDevice> sender);
 
+  /**
+   * Receive a packet shared with the other devices of a CsmaChannel.
+   *
+   * Used by the channel in batch delivery mode.  The shared packet is
+   * not modified: the device checks it as Receive does, and copies it
+   * only to remove the headers once it is accepted.  If trace sinks are
+   * connected to the receive trace sources of the device, they get a copy
+   * of their own, as from Receive, so that they may tag it without
+   * affecting the other receivers.
+   *
+   * \see CsmaChannel
+   * \param p the packet received, shared by all the receivers
+   * \param sender the CsmaNetDevice that transmitted the packet in the first place
+   */
+  void ReceiveShared (Ptr<const Packet> p, Ptr<CsmaNetDevice> sender);
+
   /**
    * Is the send side of the network device enabled?
    *
@@ -447,6 +463,15 @@ private:
    */
   void NotifyLinkUp (void);
 
+  /**
+   * Remove the headers of a received packet which passed the receive
+   * checks, hit the sniffer trace hooks and forward it up the stack.
+   *
+   * \param packet the packet to forward, owned by this device
+   * \param originalPacket the complete packet, for the trace sinks
+   */
+  void ReceiveAccepted (Ptr<Packet> packet, Ptr<const Packet> originalPacket);
+
   /** 
    * Device ID returned by the attached functions. It is used by the
    * mp-channel to identify each net device to make sure that only
@@ -0,0 +1,301 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include "ns3/node-container.h"
+#include "ns3/csma-helper.h"
+#include "ns3/csma-channel.h"
+#include "ns3/csma-net-device.h"
+#include "ns3/socket.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup csma-test
+ * \ingroup tests
+ *
+ * \brief CsmaChannel delivery test
+ *
+ * Broadcasts packets on a channel of four devices, with and without
+ * batch delivery, and checks that both modes deliver them at the same
+ * times, in the same order and in the same node contexts, that the sender
+ * does not receive its own packets, that a device detached after the
+ * end of a transmission still receives it, and that a tag added to a
+ * packet by a trace sink is not seen by the other receivers.
+ */
+class CsmaChannelDeliveryTestCase : public TestCase
+{
+public:
+  CsmaChannelDeliveryTestCase ();
+  virtual ~CsmaChannelDeliveryTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// A reception
+  struct Reception
+  {
+    Time time;        //!< the time of the reception
+    uint32_t node;    //!< the index of the node of the receiving device
+    uint32_t context; //!< the simulator context of the reception, as a node index
+    uint32_t packet;  //!< the index of the packet
+  };
+
+  /**
+   * Run the scenario
+   * \param batchDelivery the BatchDelivery attribute of the channel
+   * \return the receptions
+   */
+  std::vector<Reception> Run (bool batchDelivery);
+  /**
+   * Record a reception
+   * \param context the node id of the receiving device
+   * \param packet the packet received
+   */
+  void Receive (std::string context, Ptr<const Packet> packet);
+  /**
+   * Send a broadcast packet
+   * \param device the sending device
+   */
+  void Send (Ptr<NetDevice> device);
+
+  std::vector<Reception> m_receptions; ///< the receptions of the current run
+  std::vector<uint64_t> m_uids;        ///< the uids of the packets sent in the current run
+  uint32_t m_tagged;                   ///< the packets received already tagged in the current run
+  uint32_t m_firstNode;                ///< the id of the first node of the current run
+};
+
+CsmaChannelDeliveryTestCase::CsmaChannelDeliveryTestCase ()
+  : TestCase ("Check the receptions of batch and per-device CsmaChannel deliveries"),
+    m_tagged (0),
+    m_firstNode (0)
+{
+}
+
+CsmaChannelDeliveryTestCase::~CsmaChannelDeliveryTestCase ()
+{
+}
+
+void
+CsmaChannelDeliveryTestCase::Receive (std::string context, Ptr<const Packet> packet)
+{
+  uint32_t index = std::find (m_uids.begin (), m_uids.end (), packet->GetUid ()) - m_uids.begin ();
+  uint32_t node = static_cast<uint32_t> (std::stoul (context));
+  Reception reception = {Simulator::Now (), node - m_firstNode, Simulator::GetContext () - m_firstNode, index};
+  m_receptions.push_back (reception);
+
+  // the tag must not be seen by the next receivers of the packet
+  SocketPriorityTag tag;
+  if (packet->FindFirstMatchingByteTag (tag))
+    {
+      m_tagged++;
+    }
+  packet->AddByteTag (tag);
+}
+
+void
+CsmaChannelDeliveryTestCase::Send (Ptr<NetDevice> device)
+{
+  Ptr<Packet> packet = Create<Packet> (100);
+  m_uids.push_back (packet->GetUid ());
+  device->Send (packet, device->GetBroadcast (), 0x800);
+}
+
+std::vector<CsmaChannelDeliveryTestCase::Reception>
+CsmaChannelDeliveryTestCase::Run (bool batchDelivery)
+{
+  m_receptions.clear ();
+  m_uids.clear ();
+  m_tagged = 0;
+  NodeContainer nodes;
+  nodes.Create (4);
+  CsmaHelper csma;
+  csma.SetChannelAttribute ("DataRate", StringValue ("100Mbps"));
+  csma.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  csma.SetChannelAttribute ("BatchDelivery", BooleanValue (batchDelivery));
+  NetDeviceContainer devices = csma.Install (nodes);
+  m_firstNode = nodes.Get (0)->GetId ();
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      devices.Get (i)->TraceConnect ("PhyRxEnd", std::to_string (nodes.Get (i)->GetId ()),
+                                     MakeCallback (&CsmaChannelDeliveryTestCase::Receive, this));
+    }
+  Ptr<CsmaChannel> channel = DynamicCast<CsmaChannel> (devices.Get (0)->GetChannel ());
+
+  Simulator::ScheduleWithContext (nodes.Get (0)->GetId (), Seconds (1),
+                                  &CsmaChannelDeliveryTestCase::Send, this, devices.Get (0));
+  // the transmission ends after about 10 us, the reception after 1 ms more
+  Simulator::ScheduleWithContext (nodes.Get (1)->GetId (), Seconds (2),
+                                  &CsmaChannelDeliveryTestCase::Send, this, devices.Get (1));
+  Simulator::Schedule (Seconds (2) + MicroSeconds (500), static_cast<bool (CsmaChannel::*) (uint32_t)> (&CsmaChannel::Detach),
+                       channel, 3);
+  Simulator::ScheduleWithContext (nodes.Get (2)->GetId (), Seconds (3),
+                                  &CsmaChannelDeliveryTestCase::Send, this, devices.Get (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return m_receptions;
+}
+
+void
+CsmaChannelDeliveryTestCase::DoRun (void)
+{
+  std::vector<Reception> perDevice = Run (false);
+  NS_TEST_EXPECT_MSG_EQ (m_tagged, 0, "Packet tagged by another receiver");
+  std::vector<Reception> batch = Run (true);
+  NS_TEST_EXPECT_MSG_EQ (m_tagged, 0, "Packet tagged by another receiver in batch delivery");
+
+  // packet and receiving node of each reception, in the order of the
+  // device IDs: the senders are nodes 0, 1 and 2, and node 3, detached
+  // during the propagation of the second packet, does not receive the third
+  const uint32_t expected[][2] = {{0, 1}, {0, 2}, {0, 3}, {1, 0}, {1, 2}, {1, 3}, {2, 0}, {2, 1}};
+  const uint32_t n = sizeof (expected) / sizeof (expected[0]);
+  NS_TEST_ASSERT_MSG_EQ (perDevice.size (), n, "Unexpected number of receptions");
+  NS_TEST_ASSERT_MSG_EQ (batch.size (), n, "Unexpected number of batch receptions");
+  for (uint32_t k = 0; k < n; k++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (perDevice[k].packet, expected[k][0], "Unexpected packet at reception " << k);
+      NS_TEST_EXPECT_MSG_EQ (perDevice[k].node, expected[k][1], "Unexpected receiver at reception " << k);
+      NS_TEST_EXPECT_MSG_EQ (perDevice[k].context, perDevice[k].node, "Reception out of the receiver context");
+      NS_TEST_EXPECT_MSG_EQ (batch[k].time, perDevice[k].time, "Different reception times");
+      NS_TEST_EXPECT_MSG_EQ (batch[k].packet, perDevice[k].packet, "Different packets received");
+      NS_TEST_EXPECT_MSG_EQ (batch[k].node, perDevice[k].node, "Different reception order");
+      NS_TEST_EXPECT_MSG_EQ (batch[k].context, perDevice[k].context, "Different reception contexts");
+    }
+  NS_TEST_EXPECT_MSG_GT (perDevice[0].time, Seconds (1) + MilliSeconds (1), "Reception before the propagation delay");
+}
+
+/**
+ * \ingroup csma-test
+ * \ingroup tests
+ *
+ * \brief CsmaChannel attachment test
+ *
+ * Checks Attach, Detach, Reattach, GetDeviceNum and GetNumActDevices,
+ * by pointer and by device ID, including for a device attached twice.
+ */
+class CsmaChannelAttachTestCase : public TestCase
+{
+public:
+  CsmaChannelAttachTestCase ();
+  virtual ~CsmaChannelAttachTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CsmaChannelAttachTestCase::CsmaChannelAttachTestCase ()
+  : TestCase ("Check the attachment of devices to a CsmaChannel")
+{
+}
+
+CsmaChannelAttachTestCase::~CsmaChannelAttachTestCase ()
+{
+}
+
+void
+CsmaChannelAttachTestCase::DoRun (void)
+{
+  Ptr<CsmaChannel> channel = CreateObject<CsmaChannel> ();
+  std::vector<Ptr<CsmaNetDevice> > devices;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      devices.push_back (CreateObject<CsmaNetDevice> ());
+      NS_TEST_ASSERT_MSG_EQ (channel->Attach (devices[i]), static_cast<int32_t> (i), "Unexpected device ID");
+    }
+  Ptr<CsmaNetDevice> other = CreateObject<CsmaNetDevice> ();
+  NS_TEST_EXPECT_MSG_EQ (channel->GetNDevices (), 3, "Unexpected number of devices");
+  NS_TEST_EXPECT_MSG_EQ (channel->GetNumActDevices (), 3, "Unexpected number of active devices");
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (channel->GetCsmaDevice (i), devices[i], "Unexpected device");
+      NS_TEST_EXPECT_MSG_EQ (channel->GetDeviceNum (devices[i]), static_cast<int32_t> (i), "Unexpected device ID");
+    }
+  NS_TEST_EXPECT_MSG_EQ (channel->GetDeviceNum (other), -1, "A device not attached should not be found");
+
+  // by pointer
+  NS_TEST_EXPECT_MSG_EQ (channel->Detach (devices[1]), true, "Device not detached");
+  NS_TEST_EXPECT_MSG_EQ (channel->Detach (devices[1]), false, "Device detached twice");
+  NS_TEST_EXPECT_MSG_EQ (channel->Detach (1), false, "Device detached twice");
+  NS_TEST_EXPECT_MSG_EQ (channel->Detach (other), false, "A device not attached should not be detached");
+  NS_TEST_EXPECT_MSG_EQ (channel->IsActive (1), false, "Detached device still active");
+  NS_TEST_EXPECT_MSG_EQ (channel->GetDeviceNum (devices[1]), -2, "A detached device should be reported as such");
+  NS_TEST_EXPECT_MSG_EQ (channel->GetNumActDevices (), 2, "Unexpected number of active devices");
+  NS_TEST_EXPECT_MSG_EQ (channel->Reattach (devices[1]), true, "Device not reattached");
+  NS_TEST_EXPECT_MSG_EQ (channel->Reattach (devices[1]), false, "Device reattached twice");
+  NS_TEST_EXPECT_MSG_EQ (channel->Reattach (other), false, "A device not attached should not be reattached");
+  NS_TEST_EXPECT_MSG_EQ (channel->GetDeviceNum (devices[1]), 1, "Unexpected device ID after Reattach");
+
+  // by device ID; Reattach (uint32_t) used to reject every valid ID
+  NS_TEST_EXPECT_MSG_EQ (channel->Detach (0), true, "Device not detached");
+  NS_TEST_EXPECT_MSG_EQ (channel->Detach (2), true, "Device not detached");
+  NS_TEST_EXPECT_MSG_EQ (channel->GetNumActDevices (), 1, "Unexpected number of active devices");
+  NS_TEST_EXPECT_MSG_EQ (channel->Reattach (2), true, "Device not reattached");
+  NS_TEST_EXPECT_MSG_EQ (channel->Reattach (2), false, "Device reattached twice");
+  NS_TEST_EXPECT_MSG_EQ (channel->Reattach (0), true, "Device not reattached");
+  NS_TEST_EXPECT_MSG_EQ (channel->Reattach (3), false, "An unknown device ID should not be reattached");
+  NS_TEST_EXPECT_MSG_EQ (channel->Detach (3), false, "An unknown device ID should not be detached");
+  NS_TEST_EXPECT_MSG_EQ (channel->GetNumActDevices (), 3, "Unexpected number of active devices");
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (channel->IsActive (i), true, "Reattached device not active");
+      NS_TEST_EXPECT_MSG_EQ (channel->GetDeviceNum (devices[i]), static_cast<int32_t> (i), "Unexpected device ID");
+    }
+
+  // a new device gets the next ID
+  NS_TEST_EXPECT_MSG_EQ (channel->Attach (other), 3, "Unexpected device ID");
+  NS_TEST_EXPECT_MSG_EQ (channel->GetNumActDevices (), 4, "Unexpected number of active devices");
+
+  // a device attached twice: Detach by pointer detaches its first active
+  // attachment, Reattach and GetDeviceNum use its first one
+  NS_TEST_EXPECT_MSG_EQ (channel->Attach (other), 4, "Unexpected device ID");
+  NS_TEST_EXPECT_MSG_EQ (channel->Detach (other), true, "First attachment not detached");
+  NS_TEST_EXPECT_MSG_EQ (channel->IsActive (3), false, "First attachment still active");
+  NS_TEST_EXPECT_MSG_EQ (channel->IsActive (4), true, "Second attachment detached");
+  NS_TEST_EXPECT_MSG_EQ (channel->Detach (other), true, "Second attachment not detached");
+  NS_TEST_EXPECT_MSG_EQ (channel->IsActive (4), false, "Second attachment still active");
+  NS_TEST_EXPECT_MSG_EQ (channel->Detach (other), false, "Device detached three times");
+  NS_TEST_EXPECT_MSG_EQ (channel->GetNumActDevices (), 3, "Unexpected number of active devices");
+  NS_TEST_EXPECT_MSG_EQ (channel->Reattach (other), true, "Device not reattached");
+  NS_TEST_EXPECT_MSG_EQ (channel->GetDeviceNum (other), 3, "Unexpected device ID after Reattach");
+  NS_TEST_EXPECT_MSG_EQ (channel->IsActive (4), false, "Second attachment reattached");
+}
+
+/**
+ * \ingroup csma-test
+ * \ingroup tests
+ *
+ * \brief CsmaChannel TestSuite
+ */
+class CsmaChannelTestSuite : public TestSuite
+{
+public:
+  CsmaChannelTestSuite ();
+};
+
+CsmaChannelTestSuite::CsmaChannelTestSuite ()
+  : TestSuite ("csma-channel", UNIT)
+{
+  AddTestCase (new CsmaChannelDeliveryTestCase, TestCase::QUICK);
+  AddTestCase (new CsmaChannelAttachTestCase, TestCase::QUICK);
+}
+
+static CsmaChannelTestSuite g_csmaChannelTestSuite; ///< the test suite
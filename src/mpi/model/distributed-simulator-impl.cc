@@ -640,6 +640,12 @@ DistributedSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
+void
+DistributedSimulatorImpl::SetContext (uint32_t context)
+{
+  m_currentContext = context;
+}
+
 uint64_t
 DistributedSimulatorImpl::GetEventCount (void) const
 {
@@ -570,6 +570,12 @@ NullMessageSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
+void
+NullMessageSimulatorImpl::SetContext (uint32_t context)
+{
+  m_currentContext = context;
+}
+
 uint64_t
 NullMessageSimulatorImpl::GetEventCount (void) const
 {
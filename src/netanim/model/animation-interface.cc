@@ -33,6 +33,9 @@
 #include <string>
 #include <iomanip>
 #include <map>
+#if defined (HAVE_ZLIB)
+#include <zlib.h>
+#endif
 
 // ns3 includes
 #include "ns3/animation-interface.h"
@@ -69,11 +72,21 @@ NS_LOG_COMPONENT_DEFINE ("AnimationInterface");
 
 static bool initialized = false; //!< Initialization flag
 
+#if defined (HAVE_ZLIB)
+/// Deflate stream of a compressed trace file, with its output buffer
+struct AnimationInterface::GzipStream
+{
+  z_stream stream; ///< the deflate stream
+  char out[16384]; ///< the compressed bytes to write
+};
+#endif
+
 
 // Public methods
 
 AnimationInterface::AnimationInterface (const std::string fn)
   : m_f (0),
+    m_gzip (0),
     m_routingF (0),
     m_mobilityPollInterval (Seconds (0.25)),
     m_outputFileName (fn),
@@ -88,7 +101,11 @@ AnimationInterface::AnimationInterface (const std::string fn)
     m_routingStopTime (Seconds (0)),
     m_routingFileName (""),
     m_routingPollInterval (Seconds (5)),
-    m_trackPackets (true)
+    m_trackPackets (true),
+    m_packetSampling (1),
+    m_packetSamplingCount (0),
+    m_hasNodeBoundingBox (false),
+    m_mobilityThreshold (0)
 {
   initialized = true;
   StartAnimation ();
@@ -292,6 +309,36 @@ AnimationInterface::SetMobilityPollInterval (Time t)
   m_mobilityPollInterval = t;
 }
 
+void
+AnimationInterface::SetPacketSampling (uint32_t n)
+{
+  NS_ASSERT_MSG (n > 0, "The packet sampling ratio must be at least 1");
+  m_packetSampling = n;
+}
+
+void
+AnimationInterface::SetNodeBoundingBox (Rectangle box)
+{
+  m_hasNodeBoundingBox = true;
+  m_nodeBoundingBox = box;
+}
+
+void
+AnimationInterface::SetMobilityThreshold (double distance)
+{
+  m_mobilityThreshold = distance;
+}
+
+bool
+AnimationInterface::IsCompressionSupported (void)
+{
+#if defined (HAVE_ZLIB)
+  return true;
+#else
+  return false;
+#endif
+}
+
 
 void
 AnimationInterface::SetConstantPosition (Ptr <Node> n, double x, double y, double z)
@@ -421,12 +468,18 @@ AnimationInterface::MobilityCourseChangeTrace (Ptr <const MobilityModel> mobilit
       v = mobility->GetPosition ();
     }
   UpdatePosition (n, v);
-  WriteXmlUpdateNodePosition (n->GetId (), v.x, v.y);
+  ReportNodePosition (n, v);
 }
 
 bool
 AnimationInterface::NodeHasMoved (Ptr <Node> n, Vector newLocation)
 {
+  if (m_mobilityThreshold > 0)
+    {
+      std::map <uint32_t, Vector>::const_iterator it = m_reportedLocation.find (n->GetId ());
+      return (it == m_reportedLocation.end ())
+             || (CalculateDistance (it->second, newLocation) >= m_mobilityThreshold);
+    }
   Vector oldLocation = GetPosition (n);
   bool moved = true;
   if ((ceil (oldLocation.x) == ceil (newLocation.x))
@@ -450,8 +503,7 @@ AnimationInterface::MobilityAutoCheck ()
     {
       Ptr <Node> n = MovedNodes [i];
       NS_ASSERT (n);
-      Vector v = GetPosition (n);
-      WriteXmlUpdateNodePosition (n->GetId (), v.x, v.y);
+      ReportNodePosition (n, GetPosition (n));
     }
   if (!Simulator::IsFinished ())
     {
@@ -496,6 +548,37 @@ AnimationInterface::GetMovedNodes ()
   return movedNodes;
 }
 
+void
+AnimationInterface::ReportNodePosition (Ptr <Node> n, Vector v)
+{
+  if (m_hasNodeBoundingBox && !m_nodeBoundingBox.IsInside (v))
+    {
+      return;
+    }
+  if (m_mobilityThreshold > 0 && !NodeHasMoved (n, v))
+    {
+      return;
+    }
+  m_reportedLocation[n->GetId ()] = v;
+  WriteXmlUpdateNodePosition (n->GetId (), v.x, v.y);
+}
+
+bool
+AnimationInterface::IsInBoundingBox (Ptr <Node> n)
+{
+  return !m_hasNodeBoundingBox || m_nodeBoundingBox.IsInside (GetPosition (n));
+}
+
+bool
+AnimationInterface::IsPacketSampled (Ptr <Node> n)
+{
+  if (!IsInBoundingBox (n))
+    {
+      return false;
+    }
+  return (m_packetSamplingCount++ % m_packetSampling) == 0;
+}
+
 int
 AnimationInterface::WriteN (const std::string& st, FILE * f)
 {
@@ -517,6 +600,10 @@ AnimationInterface::WriteN (const char* data, uint32_t count, FILE * f)
     {
       return 0;
     }
+  if (m_gzip && f == m_f)
+    {
+      return WriteCompressed (data, count);
+    }
   // Write count bytes to h from data
   uint32_t    nLeft   = count;
   const char* p       = data;
@@ -535,6 +622,46 @@ AnimationInterface::WriteN (const char* data, uint32_t count, FILE * f)
   return written;
 }
 
+int
+AnimationInterface::WriteCompressed (const char* data, uint32_t count, bool finish)
+{
+#if defined (HAVE_ZLIB)
+  z_stream &stream = m_gzip->stream;
+  stream.next_in = reinterpret_cast<Bytef *> (const_cast<char *> (data));
+  stream.avail_in = count;
+  // Deflate until zlib no longer fills the whole output buffer, that is
+  // until all the input is consumed (and the stream terminated if finish)
+  do
+    {
+      stream.next_out = reinterpret_cast<Bytef *> (m_gzip->out);
+      stream.avail_out = sizeof (m_gzip->out);
+      int status = deflate (&stream, finish ? Z_FINISH : Z_NO_FLUSH);
+      NS_ASSERT (status != Z_STREAM_ERROR);
+      uint32_t size = sizeof (m_gzip->out) - stream.avail_out;
+      if (size && std::fwrite (m_gzip->out, 1, size, m_f) != size)
+        {
+          return count - stream.avail_in;
+        }
+    }
+  while (stream.avail_out == 0);
+  return count;
+#else
+  NS_FATAL_ERROR ("Compressed trace files require zlib");
+  return 0;
+#endif
+}
+
+void
+AnimationInterface::CloseCompressed ()
+{
+#if defined (HAVE_ZLIB)
+  WriteCompressed (0, 0, true);
+  deflateEnd (&m_gzip->stream);
+  delete m_gzip;
+  m_gzip = 0;
+#endif
+}
+
 void
 AnimationInterface::WriteRoutePath (uint32_t nodeId, std::string destination, Ipv4RoutePathElements rpElements)
 {
@@ -787,6 +914,10 @@ AnimationInterface::DevTxTrace (std::string context,
   CHECK_STARTED_INTIMEWINDOW_TRACKPACKETS;
   NS_ASSERT (tx);
   NS_ASSERT (rx);
+  if (!IsPacketSampled (tx->GetNode ()) || !IsInBoundingBox (rx->GetNode ()))
+    {
+      return;
+    }
   Time now = Simulator::Now ();
   double fbTx = now.GetSeconds ();
   double lbTx = (now + txTime).GetSeconds ();
@@ -811,6 +942,11 @@ AnimationInterface::GenericWirelessTxTrace (std::string context, Ptr<const Packe
   Ptr <NetDevice> ndev = GetNetDeviceFromContext (context);
   NS_ASSERT (ndev);
   UpdatePosition (ndev);
+  if (!IsPacketSampled (ndev->GetNode ()))
+    {
+      AddByteTag (0, p); // So that its receptions are not traced
+      return;
+    }
 
   ++gAnimUid;
   NS_LOG_INFO (ProtocolTypeToString (protocolType).c_str () << " GenericWirelessTxTrace for packet:" << gAnimUid);
@@ -843,6 +979,10 @@ AnimationInterface::GenericWirelessRxTrace (std::string context, Ptr<const Packe
   UpdatePosition (ndev);
   uint64_t animUid = GetAnimUidFromPacket (p);
   NS_LOG_INFO (ProtocolTypeToString (protocolType).c_str () << " for packet:" << animUid);
+  if (animUid == 0 || !IsInBoundingBox (ndev->GetNode ()))
+    {
+      return; // Not sampled
+    }
   if (!IsPacketPending (animUid, protocolType))
     {
       NS_LOG_WARN (ProtocolTypeToString (protocolType).c_str () << " GenericWirelessRxTrace: unknown Uid");
@@ -883,6 +1023,11 @@ AnimationInterface::WifiPhyTxBeginTrace (std::string context, WifiConstPsduMap p
     {
       for (auto& mpdu : *PeekPointer (psdu.second))
         {
+          if (!IsPacketSampled (ndev->GetNode ()))
+            {
+              AddByteTag (0, mpdu->GetPacket ()); // So that its receptions are not traced
+              continue;
+            }
           ++gAnimUid;
           NS_LOG_INFO ("WifiPhyTxTrace for MPDU:" << gAnimUid);
           AddByteTag (gAnimUid, mpdu->GetPacket ()); //the underlying MSDU/A-MSDU should be handed off
@@ -918,6 +1063,10 @@ AnimationInterface::WifiPhyRxBeginTrace (std::string context, Ptr<const Packet>
   UpdatePosition (ndev);
   uint64_t animUid = GetAnimUidFromPacket (p);
   NS_LOG_INFO ("Wifi RxBeginTrace for packet: " << animUid);
+  if (animUid == 0 || !IsInBoundingBox (ndev->GetNode ()))
+    {
+      return; // Not sampled
+    }
   if (!IsPacketPending (animUid, AnimationInterface::WIFI))
     {
       NS_ASSERT_MSG (false, "WifiPhyRxBeginTrace: unknown Uid");
@@ -986,6 +1135,11 @@ AnimationInterface::LrWpanPhyTxBeginTrace (std::string context,
     }
   m_macToNodeIdMap[oss.str ()] = n->GetId ();
   NS_LOG_INFO ("Added Mac" << oss.str () << " node:" << m_macToNodeIdMap[oss.str ()]);
+  if (!IsPacketSampled (n))
+    {
+      AddByteTag (0, p); // So that its receptions are not traced
+      return;
+    }
 
   ++gAnimUid;
   NS_LOG_INFO ("LrWpan TxBeginTrace for packet:" << gAnimUid);
@@ -1022,6 +1176,10 @@ AnimationInterface::LrWpanPhyRxBeginTrace (std::string context,
     }
 
   UpdatePosition (n);
+  if (animUid == 0 || !IsInBoundingBox (n))
+    {
+      return; // Not sampled
+    }
   m_pendingLrWpanPackets[animUid].ProcessRxBegin (ndev, Simulator::Now ().GetSeconds ());
   OutputWirelessPacketRxInfo (p, m_pendingLrWpanPackets[animUid], animUid);
 }
@@ -1043,6 +1201,10 @@ AnimationInterface::WavePhyRxBeginTrace (std::string context, Ptr<const Packet>
   UpdatePosition (ndev);
   uint64_t animUid = GetAnimUidFromPacket (p);
   NS_LOG_INFO ("Wave RxBeginTrace for packet:" << animUid);
+  if (animUid == 0 || !IsInBoundingBox (ndev->GetNode ()))
+    {
+      return; // Not sampled
+    }
   if (!IsPacketPending (animUid, AnimationInterface::WAVE))
     {
       NS_ASSERT_MSG (false, "WavePhyRxBeginTrace: unknown Uid");
@@ -1121,6 +1283,11 @@ AnimationInterface::LteSpectrumPhyTxStart (std::string context, Ptr<const Packet
        ++i)
     {
       Ptr <Packet> p = *i;
+      if (!IsPacketSampled (ndev->GetNode ()))
+        {
+          AddByteTag (0, p); // So that its receptions are not traced
+          continue;
+        }
       ++gAnimUid;
       NS_LOG_INFO ("LteSpectrumPhyTxTrace for packet:" << gAnimUid);
       AnimPacketInfo pktInfo (ndev, Simulator::Now ());
@@ -1153,6 +1320,10 @@ AnimationInterface::LteSpectrumPhyRxStart (std::string context, Ptr<const Packet
       Ptr <Packet> p = *i;
       uint64_t animUid = GetAnimUidFromPacket (p);
       NS_LOG_INFO ("LteSpectrumPhyRxTrace for packet:" << gAnimUid);
+      if (animUid == 0 || !IsInBoundingBox (ndev->GetNode ()))
+        {
+          continue; // Not sampled
+        }
       if (!IsPacketPending (animUid, AnimationInterface::LTE))
         {
           NS_LOG_WARN ("LteSpectrumPhyRxTrace: unknown Uid");
@@ -1172,6 +1343,11 @@ AnimationInterface::CsmaPhyTxBeginTrace (std::string context, Ptr<const Packet>
   Ptr <NetDevice> ndev = GetNetDeviceFromContext (context);
   NS_ASSERT (ndev);
   UpdatePosition (ndev);
+  if (!IsPacketSampled (ndev->GetNode ()))
+    {
+      AddByteTag (0, p); // So that its receptions are not traced
+      return;
+    }
   ++gAnimUid;
   NS_LOG_INFO ("CsmaPhyTxBeginTrace for packet:" << gAnimUid);
   AddByteTag (gAnimUid, p);
@@ -1192,6 +1368,10 @@ AnimationInterface::CsmaPhyTxEndTrace (std::string context, Ptr<const Packet> p)
   UpdatePosition (ndev);
   uint64_t animUid = GetAnimUidFromPacket (p);
   NS_LOG_INFO ("CsmaPhyTxEndTrace for packet:" << animUid);
+  if (animUid == 0)
+    {
+      return; // Not sampled
+    }
   if (!IsPacketPending (animUid, AnimationInterface::CSMA))
     {
       NS_LOG_WARN ("CsmaPhyTxEndTrace: unknown Uid");
@@ -1214,6 +1394,10 @@ AnimationInterface::CsmaPhyRxEndTrace (std::string context, Ptr<const Packet> p)
   NS_ASSERT (ndev);
   UpdatePosition (ndev);
   uint64_t animUid = GetAnimUidFromPacket (p);
+  if (animUid == 0 || !IsInBoundingBox (ndev->GetNode ()))
+    {
+      return; // Not sampled
+    }
   if (!IsPacketPending (animUid, AnimationInterface::CSMA))
     {
       NS_LOG_WARN ("CsmaPhyRxEndTrace: unknown Uid");
@@ -1236,6 +1420,10 @@ AnimationInterface::CsmaMacRxTrace (std::string context,
   Ptr <NetDevice> ndev = GetNetDeviceFromContext (context);
   NS_ASSERT (ndev);
   uint64_t animUid = GetAnimUidFromPacket (p);
+  if (animUid == 0 || !IsInBoundingBox (ndev->GetNode ()))
+    {
+      return; // Not sampled
+    }
   if (!IsPacketPending (animUid, AnimationInterface::CSMA))
     {
       NS_LOG_WARN ("CsmaMacRxTrace: unknown Uid");
@@ -1314,24 +1502,18 @@ AnimationInterface::PurgePendingPackets (AnimationInterface::ProtocolType protoc
     {
       return;
     }
-  std::vector <uint64_t> purgeList;
+  double now = Simulator::Now ().GetSeconds ();
   for (AnimUidPacketInfoMap::iterator i = pendingPackets->begin ();
-       i != pendingPackets->end ();
-       ++i)
+       i != pendingPackets->end (); )
     {
-
-      AnimPacketInfo pktInfo = i->second;
-      double delta = (Simulator::Now ().GetSeconds () - pktInfo.m_fbTx);
-      if (delta > PURGE_INTERVAL)
+      if (now - i->second.m_fbTx > PURGE_INTERVAL)
         {
-          purgeList.push_back (i->first);
+          i = pendingPackets->erase (i);
+        }
+      else
+        {
+          ++i;
         }
-    }
-  for (std::vector <uint64_t>::iterator i = purgeList.begin ();
-       i != purgeList.end ();
-       ++i)
-    {
-      pendingPackets->erase (*i);
     }
 }
 
@@ -1474,6 +1656,10 @@ AnimationInterface::StopAnimation (bool onlyAnimation)
     {
       // Terminate the anim element
       WriteXmlClose ("anim");
+      if (m_gzip)
+        {
+          CloseCompressed ();
+        }
       std::fclose (m_f);
       m_f = 0;
     }
@@ -2042,6 +2228,7 @@ AnimationInterface::WriteNodes ()
       Ptr<Node> n = *i;
       NS_LOG_INFO ("Update Position for Node: " << n->GetId ());
       Vector v = UpdatePosition (n);
+      m_reportedLocation[n->GetId ()] = v;
       WriteXmlNode (n->GetId (), n->GetSystemId (), v.x, v.y);
     }
 }
@@ -2132,6 +2319,25 @@ AnimationInterface::SetOutputFile (const std::string& fn, bool routing)
     {
       m_f = f;
       m_outputFileName = fn;
+      const std::string suffix = ".gz";
+      if (fn.size () > suffix.size ()
+          && fn.compare (fn.size () - suffix.size (), suffix.size (), suffix) == 0)
+        {
+#if defined (HAVE_ZLIB)
+          m_gzip = new GzipStream;
+          m_gzip->stream.zalloc = Z_NULL;
+          m_gzip->stream.zfree = Z_NULL;
+          m_gzip->stream.opaque = Z_NULL;
+          // 15 + 16: maximum window, with a gzip header and trailer
+          if (deflateInit2 (&m_gzip->stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                            15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            {
+              NS_FATAL_ERROR ("Unable to compress output file:" << fn.c_str ());
+            }
+#else
+          NS_FATAL_ERROR ("Compressed output file " << fn.c_str () << " requires zlib");
+#endif
+        }
     }
   return;
 }
@@ -223,6 +223,53 @@ public:
    */
   void SetMobilityPollInterval (Time t);
 
+  /**
+   * \brief Trace only one packet out of n, to reduce the size of the trace
+   * file of large scenarios
+   *
+   * The packets not sampled are neither written nor kept pending until
+   * their reception.
+   *
+   * \param n The sampling ratio. Default: 1, all the packets are traced
+   *
+   * \returns none
+   */
+  void SetPacketSampling (uint32_t n);
+
+  /**
+   * \brief Trace only the nodes inside a box
+   *
+   * The packets sent by a node outside the box are not traced, their
+   * receptions by a node outside the box are not written, nor are the
+   * positions of the nodes outside the box.
+   *
+   * \param box The bounding box of the nodes traced
+   *
+   * \returns none
+   */
+  void SetNodeBoundingBox (Rectangle box);
+
+  /**
+   * \brief Write the position of a node only when it moved by a significant
+   * distance since its last position written
+   *
+   * \param distance The minimum distance, in meters. Default: 0, the
+   * position is written when it changed by more than the 1 m grid
+   *
+   * \returns none
+   */
+  void SetMobilityThreshold (double distance);
+
+  /**
+   * \brief Check if the trace file may be compressed
+   *
+   * A trace file whose name ends with ".gz" is written through a gzip
+   * stream, as the simulation runs, when ns-3 was built with zlib.
+   *
+   * \returns true if zlib is available
+   */
+  static bool IsCompressionSupported (void);
+
   /**
    * \brief Set a callback function to listen to AnimationInterface write events
    *
@@ -606,9 +653,13 @@ private:
 
 
 
+  /// Deflate stream of a compressed trace file
+  struct GzipStream;
+
   // ##### State #####
 
   FILE * m_f; ///< File handle for output (0 if none)
+  GzipStream * m_gzip; ///< Deflate stream of the output (0 if not compressed)
   FILE * m_routingF; ///< File handle for routing table output (0 if None);
   Time m_mobilityPollInterval; ///< mobility poll interval
   std::string m_outputFileName; ///< output file name
@@ -634,6 +685,11 @@ private:
   Time m_wifiPhyCountersPollInterval; ///< wifi Phy counters poll interval
   static Rectangle * userBoundary; ///< user boundary
   bool m_trackPackets; ///< track packets
+  uint32_t m_packetSampling; ///< one packet traced out of m_packetSampling
+  uint64_t m_packetSamplingCount; ///< number of packets considered for sampling
+  bool m_hasNodeBoundingBox; ///< whether the nodes traced are limited to a box
+  Rectangle m_nodeBoundingBox; ///< bounding box of the nodes traced
+  double m_mobilityThreshold; ///< minimum distance between positions written
 
   // Counter ID
   uint32_t m_remainingEnergyCounterId; ///< remaining energy counter ID
@@ -663,6 +719,7 @@ private:
   AnimUidPacketInfoMap m_pendingWavePackets; ///< pending WAVE packets
 
   std::map <uint32_t, Vector> m_nodeLocation; ///< node location
+  std::map <uint32_t, Vector> m_reportedLocation; ///< node location last written
   std::map <std::string, uint32_t> m_macToNodeIdMap; ///< MAC to node ID map
   std::map <std::string, uint32_t> m_ipv4ToNodeIdMap; ///< IPv4 to node ID map
   std::map <std::string, uint32_t> m_ipv6ToNodeIdMap; ///< IPv6 to node ID map
@@ -769,6 +826,18 @@ private:
    * \returns the number of bytes written
    */
   int WriteN (const std::string& st, FILE * f);
+  /**
+   * Write to the deflate stream of the output file
+   * \param data the data to write
+   * \param count the number of bytes to write
+   * \param finish true to terminate the stream
+   * \returns the number of bytes written
+   */
+  int WriteCompressed (const char* data, uint32_t count, bool finish = false);
+  /**
+   * Terminate and release the deflate stream of the output file
+   */
+  void CloseCompressed ();
   /**
    * Get MAC address function
    * \param nd the device
@@ -1260,6 +1329,27 @@ private:
    * \returns the list of moved nodes
    */
   std::vector < Ptr <Node> > GetMovedNodes ();
+  /**
+   * Write the position of a node, if it is inside the bounding box and
+   * moved by more than the mobility threshold
+   * \param n the node
+   * \param v the position of the node
+   */
+  void ReportNodePosition (Ptr <Node> n, Vector v);
+  /**
+   * Is node in bounding box function
+   * \param n the node
+   * \returns true if there is no bounding box, or if the last position
+   * of the node is inside it
+   */
+  bool IsInBoundingBox (Ptr <Node> n);
+  /**
+   * Decide if a packet sent by a node is traced, applying the bounding box
+   * and the packet sampling
+   * \param n the transmitting node
+   * \returns true if the packet is traced
+   */
+  bool IsPacketSampled (Ptr <Node> n);
   /**
    * Mobility course change trace function
    * \param mob the mobility model
@@ -18,7 +18,12 @@
  */
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include "unistd.h"
+#if defined (HAVE_ZLIB)
+#include <zlib.h>
+#endif
 
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
@@ -29,6 +34,7 @@
 #include "ns3/point-to-point-layout-module.h"
 #include "ns3/basic-energy-source.h"
 #include "ns3/simple-device-energy-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
 
 using namespace ns3;
 
@@ -50,8 +56,9 @@ public:
   /**
    * \brief Constructor.
    * \param name testcase name
+   * \param traceFileName trace file name
    */
-  AbstractAnimationInterfaceTestCase (std::string name);
+  AbstractAnimationInterfaceTestCase (std::string name, const char* traceFileName = "netanim-test.xml");
   /**
    * \brief Destructor.
    */
@@ -68,23 +75,25 @@ protected:
 
   NodeContainer m_nodes; ///< the nodes
   AnimationInterface* m_anim; ///< animation
+  const char* m_traceFileName; ///< trace file name
 
 private:
 
   /// Prepare network function
   virtual void PrepareNetwork () = 0;
 
+  /// Configure the animation interface, once created
+  virtual void ConfigureAnimation ();
+
   /// Check logic function
   virtual void CheckLogic () = 0;
 
   /// Check file existence
   virtual void CheckFileExistence ();
-
-  const char* m_traceFileName; ///< trace file name
 };
 
-AbstractAnimationInterfaceTestCase::AbstractAnimationInterfaceTestCase (std::string name) :
-  TestCase (name), m_anim (NULL), m_traceFileName ("netanim-test.xml")
+AbstractAnimationInterfaceTestCase::AbstractAnimationInterfaceTestCase (std::string name, const char* traceFileName) :
+  TestCase (name), m_anim (NULL), m_traceFileName (traceFileName)
 {
 }
 
@@ -99,6 +108,7 @@ AbstractAnimationInterfaceTestCase::DoRun (void)
   PrepareNetwork ();
 
   m_anim = new AnimationInterface (m_traceFileName);
+  ConfigureAnimation ();
 
   Simulator::Run ();
   CheckLogic ();
@@ -106,6 +116,11 @@ AbstractAnimationInterfaceTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+void
+AbstractAnimationInterfaceTestCase::ConfigureAnimation ()
+{
+}
+
 void
 AbstractAnimationInterfaceTestCase::CheckFileExistence ()
 {
@@ -129,11 +144,18 @@ public:
    */
   AnimationInterfaceTestCase ();
 
-private:
+protected:
+  /**
+   * \brief Constructor.
+   * \param name testcase name
+   * \param traceFileName trace file name
+   */
+  AnimationInterfaceTestCase (std::string name, const char* traceFileName);
 
   virtual void
   PrepareNetwork ();
 
+private:
   virtual void
   CheckLogic ();
 
@@ -144,6 +166,11 @@ AnimationInterfaceTestCase::AnimationInterfaceTestCase () :
 {
 }
 
+AnimationInterfaceTestCase::AnimationInterfaceTestCase (std::string name, const char* traceFileName) :
+  AbstractAnimationInterfaceTestCase (name, traceFileName)
+{
+}
+
 void
 AnimationInterfaceTestCase::PrepareNetwork (void)
 {
@@ -188,6 +215,128 @@ AnimationInterfaceTestCase::CheckLogic (void)
   NS_TEST_ASSERT_MSG_EQ (m_anim->GetTracePktCount (), 16, "Expected 16 packets traced");
 }
 
+/**
+ * \ingroup netanim-test
+ * \ingroup tests
+ *
+ * \brief Animation Decimation Test Case
+ *
+ * Traces the echo packets of AnimationInterfaceTestCase, and a third
+ * node moving at 1.2 m/s towards the first one, with a packet sampling, a
+ * bounding box and a mobility threshold of 5 m, into a compressed trace
+ * file when possible, and checks the packets and positions traced and
+ * the trace file.
+ */
+class AnimationDecimationTestCase : public AnimationInterfaceTestCase
+{
+public:
+  /**
+   * \brief Constructor.
+   * \param name testcase name
+   * \param sampling the packet sampling ratio
+   * \param box true to trace only the first node
+   * \param expectedPackets the number of packets expected in the trace
+   * \param expectedPositions the number of position updates expected in the trace
+   */
+  AnimationDecimationTestCase (std::string name, uint32_t sampling, bool box,
+                               uint64_t expectedPackets, uint32_t expectedPositions);
+
+private:
+
+  virtual void
+  PrepareNetwork ();
+
+  virtual void
+  ConfigureAnimation ();
+
+  virtual void
+  CheckLogic ();
+
+  uint32_t m_sampling; ///< packet sampling ratio
+  bool m_box; ///< whether the nodes traced are limited to the first node
+  uint64_t m_expectedPackets; ///< number of packets expected
+  uint32_t m_expectedPositions; ///< number of position updates expected
+};
+
+AnimationDecimationTestCase::AnimationDecimationTestCase (std::string name, uint32_t sampling, bool box,
+                                                          uint64_t expectedPackets, uint32_t expectedPositions) :
+  AnimationInterfaceTestCase (name, AnimationInterface::IsCompressionSupported () ? "netanim-test.xml.gz" : "netanim-test.xml"),
+  m_sampling (sampling),
+  m_box (box),
+  m_expectedPackets (expectedPackets),
+  m_expectedPositions (expectedPositions)
+{
+}
+
+void
+AnimationDecimationTestCase::PrepareNetwork (void)
+{
+  AnimationInterfaceTestCase::PrepareNetwork ();
+
+  // Polled every 0.25 s, it has moved 5 m at 4.25 s, to x = -4.9, then
+  // again at 8.5 s, to x = 0.2.  It is in the bounding box from 8 s, at
+  // x = -0.4, to 8.75 s.
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<ConstantVelocityMobilityModel> mobility = CreateObject<ConstantVelocityMobilityModel> ();
+  mobility->SetPosition (Vector (-10, 10, 0));
+  mobility->SetVelocity (Vector (1.2, 0, 0));
+  node->AggregateObject (mobility);
+
+  // After the last echo
+  Simulator::Stop (Seconds (9.5));
+}
+
+void
+AnimationDecimationTestCase::ConfigureAnimation (void)
+{
+  m_anim->SetPacketSampling (m_sampling);
+  if (m_box)
+    {
+      // Only the first node, at (0, 10)
+      m_anim->SetNodeBoundingBox (Rectangle (-0.5, 0.5, 9.5, 10.5));
+    }
+  m_anim->SetMobilityThreshold (5);
+}
+
+void
+AnimationDecimationTestCase::CheckLogic (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (m_anim->GetTracePktCount (), m_expectedPackets, "Unexpected number of packets traced");
+  // Terminate the trace file
+  delete m_anim;
+  m_anim = 0;
+  std::string xml;
+#if defined (HAVE_ZLIB)
+  gzFile f = gzopen (m_traceFileName, "rb");
+  NS_TEST_ASSERT_MSG_NE (f, 0, "Compressed trace file not opened");
+  NS_TEST_ASSERT_MSG_EQ (gzdirect (f), 0, "Trace file not compressed");
+  char buffer[4096];
+  int n;
+  while ((n = gzread (f, buffer, sizeof (buffer))) > 0)
+    {
+      xml.append (buffer, n);
+    }
+  gzclose (f);
+#else
+  std::ifstream f (m_traceFileName);
+  NS_TEST_ASSERT_MSG_EQ (f.is_open (), true, "Trace file not opened");
+  std::ostringstream oss;
+  oss << f.rdbuf ();
+  xml = oss.str ();
+#endif
+  const std::string end = "</anim>\n";
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (xml.size (), end.size (), "Trace file too short");
+  NS_TEST_ASSERT_MSG_EQ (xml.compare (0, 5, "<anim"), 0, "Unexpected start of trace file");
+  NS_TEST_ASSERT_MSG_EQ (xml.compare (xml.size () - end.size (), end.size (), end), 0, "Trace file not terminated");
+
+  uint32_t positions = 0;
+  for (std::string::size_type i = xml.find ("<nu p=\"p\""); i != std::string::npos; i = xml.find ("<nu p=\"p\"", i + 1))
+    {
+      positions++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (positions, m_expectedPositions, "Unexpected number of position updates");
+}
+
 /**
  * \ingroup netanim-test
  * \ingroup tests
@@ -267,5 +416,9 @@ public:
   {
     AddTestCase (new AnimationInterfaceTestCase (), TestCase::QUICK);
     AddTestCase (new AnimationRemainingEnergyTestCase (), TestCase::QUICK);
+    // the moving node is traced every 5 m
+    AddTestCase (new AnimationDecimationTestCase ("Verify packet sampling", 2, false, 8, 2), TestCase::QUICK);
+    // and once in the box, from the position it was last traced at
+    AddTestCase (new AnimationDecimationTestCase ("Verify node bounding box", 1, true, 0, 1), TestCase::QUICK);
   }
 } g_animationInterfaceTestSuite; ///< the test suite
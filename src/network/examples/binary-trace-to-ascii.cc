@@ -0,0 +1,56 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <iostream>
+#include "ns3/command-line.h"
+#include "ns3/binary-trace-recorder.h"
+
+using namespace ns3;
+
+// Convert a file written by a BinaryTraceRecorder to ascii trace lines,
+// written to the standard output or to a file:
+//
+//   ./waf --run "binary-trace-to-ascii --input=v2x.btr --output=v2x.tr"
+
+int
+main (int argc, char *argv[])
+{
+  std::string input;
+  std::string output;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("input", "The file written by the BinaryTraceRecorder", input);
+  cmd.AddValue ("output", "The ascii trace file, empty for the standard output", output);
+  cmd.Parse (argc, argv);
+
+  bool ok;
+  if (output.empty ())
+    {
+      ok = BinaryTraceRecorder::ConvertToAscii (input, std::cout);
+    }
+  else
+    {
+      std::ofstream os (output.c_str ());
+      ok = os.is_open () && BinaryTraceRecorder::ConvertToAscii (input, os);
+    }
+  if (!ok)
+    {
+      std::cerr << "Unable to convert " << input << std::endl;
+      return 1;
+    }
+  return 0;
+}
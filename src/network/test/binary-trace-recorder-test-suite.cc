@@ -0,0 +1,320 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <sstream>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/traced-callback.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/mac48-address.h"
+#include "ns3/binary-trace-recorder.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * An object with a trace source without packet.
+ */
+class BinaryTraceTestObject : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * Fire the trace source.
+   * \param value the value traced
+   */
+  void Fire (uint32_t value)
+  {
+    m_trace (value, 2 * value);
+  }
+
+private:
+  TracedCallback<uint32_t, double> m_trace; //!< the trace source
+};
+
+TypeId
+BinaryTraceTestObject::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::BinaryTraceTestObject")
+    .SetParent<Object> ()
+    .SetGroupName ("Network")
+    .AddTraceSource ("Value", "A value",
+                     MakeTraceSourceAccessor (&BinaryTraceTestObject::m_trace),
+                     "ns3::BinaryTraceTestObject::TracedCallback")
+  ;
+  return tid;
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief BinaryTraceRecorder records test case
+ *
+ * Records more events than the ring holds, from a trace source without
+ * packet and directly, and checks the records read back and the
+ * ascii lines.
+ */
+class BinaryTraceRecorderRecordsTestCase : public TestCase
+{
+public:
+  BinaryTraceRecorderRecordsTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Record events.
+   * \param recorder the recorder
+   * \param object the object of the traced source
+   * \param n the number of events
+   */
+  void Fire (Ptr<BinaryTraceRecorder> recorder, Ptr<BinaryTraceTestObject> object, uint32_t n);
+};
+
+BinaryTraceRecorderRecordsTestCase::BinaryTraceRecorderRecordsTestCase ()
+  : TestCase ("Check the records of a BinaryTraceRecorder")
+{
+}
+
+void
+BinaryTraceRecorderRecordsTestCase::Fire (Ptr<BinaryTraceRecorder> recorder,
+                                          Ptr<BinaryTraceTestObject> object, uint32_t n)
+{
+  uint16_t code = recorder->GetEventCode ("TxQueue/Enqueue");
+  for (uint32_t i = 0; i < n; i++)
+    {
+      object->Fire (i);
+      Ptr<Packet> packet = Create<Packet> (i);
+      recorder->RecordEvent (code, i, 1, packet);
+    }
+}
+
+void
+BinaryTraceRecorderRecordsTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("binary-trace-recorder.bin");
+  Ptr<BinaryTraceRecorder> recorder = CreateObject<BinaryTraceRecorder> ();
+  recorder->SetAttribute ("BufferSize", UintegerValue (64));
+  recorder->Open (filename);
+  Ptr<BinaryTraceTestObject> object = CreateObject<BinaryTraceTestObject> ();
+  bool ok = recorder->TraceConnect<uint32_t, double> (object, "Value", "Value", 7, 3);
+  NS_TEST_ASSERT_MSG_EQ (ok, true, "Trace source not connected");
+
+  const uint32_t n = 1000;
+  Simulator::Schedule (Seconds (1.5), &BinaryTraceRecorderRecordsTestCase::Fire, this, recorder, object, n);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (recorder->GetRecordCount (), 2 * n, "Unexpected number of records");
+  recorder->Close ();
+
+  std::vector<BinaryTraceRecorder::Record> records;
+  std::vector<std::string> events;
+  ok = BinaryTraceRecorder::Read (filename, records, events);
+  NS_TEST_ASSERT_MSG_EQ (ok, true, "File not read");
+  NS_TEST_ASSERT_MSG_EQ (records.size (), 2 * n, "Unexpected number of records read");
+  NS_TEST_ASSERT_MSG_EQ (events.size (), 2, "Unexpected number of events");
+  NS_TEST_ASSERT_MSG_EQ (events[0], "Value", "Unexpected event name");
+  NS_TEST_ASSERT_MSG_EQ (events[1], "TxQueue/Enqueue", "Unexpected event name");
+  for (uint32_t i = 0; i < n; i++)
+    {
+      const BinaryTraceRecorder::Record &value = records[2 * i];
+      NS_TEST_ASSERT_MSG_EQ (value.time, 1500000000, "Unexpected time");
+      NS_TEST_ASSERT_MSG_EQ (value.event, 0, "Unexpected event code");
+      NS_TEST_ASSERT_MSG_EQ (value.node, 7, "Unexpected node id");
+      NS_TEST_ASSERT_MSG_EQ (value.device, 3, "Unexpected device index");
+      NS_TEST_ASSERT_MSG_EQ (value.flags, 0, "Unexpected packet");
+      const BinaryTraceRecorder::Record &packet = records[2 * i + 1];
+      NS_TEST_ASSERT_MSG_EQ (packet.event, 1, "Unexpected event code");
+      NS_TEST_ASSERT_MSG_EQ (packet.node, i, "Records out of order");
+      NS_TEST_ASSERT_MSG_EQ (packet.size, i, "Unexpected packet size");
+      NS_TEST_ASSERT_MSG_EQ (packet.flags, BinaryTraceRecorder::PACKET, "Packet not recorded");
+    }
+
+  std::ostringstream oss;
+  ok = BinaryTraceRecorder::ConvertToAscii (filename, oss);
+  NS_TEST_ASSERT_MSG_EQ (ok, true, "File not converted");
+  std::istringstream iss (oss.str ());
+  std::string line;
+  std::getline (iss, line);
+  NS_TEST_ASSERT_MSG_EQ (line, "* 1.5 /NodeList/7/DeviceList/3/Value", "Unexpected ascii line");
+  std::getline (iss, line);
+  std::ostringstream expected;
+  expected << "+ 1.5 /NodeList/0/DeviceList/1/TxQueue/Enqueue size=0 uid=" << records[1].uid;
+  NS_TEST_ASSERT_MSG_EQ (line, expected.str (), "Unexpected ascii line");
+  std::remove (filename.c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief BinaryTraceRecorder packet traces test case
+ *
+ * Sends packets between two SimpleNetDevices and checks the events recorded
+ * from the trace sources of the devices and of their queues.
+ */
+class BinaryTraceRecorderPacketTracesTestCase : public TestCase
+{
+public:
+  BinaryTraceRecorderPacketTracesTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BinaryTraceRecorderPacketTracesTestCase::BinaryTraceRecorderPacketTracesTestCase ()
+  : TestCase ("Check the packet traces of devices recorded by a BinaryTraceRecorder")
+{
+}
+
+void
+BinaryTraceRecorderPacketTracesTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper helper;
+  NetDeviceContainer devices = helper.Install (nodes);
+
+  std::string filename = CreateTempDirFilename ("binary-trace-recorder-devices.bin");
+  Ptr<BinaryTraceRecorder> recorder = CreateObject<BinaryTraceRecorder> ();
+  recorder->Open (filename);
+  // PhyRxDrop of the devices and the TxQueue sources
+  uint32_t n = recorder->EnablePacketTraces (devices);
+  NS_TEST_ASSERT_MSG_EQ ((n > 2), true, "Queue trace sources not connected");
+
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Simulator::Schedule (Seconds (i), &NetDevice::Send, devices.Get (0), Create<Packet> (100),
+                           devices.Get (1)->GetAddress (), 0x800);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  recorder->Close ();
+
+  std::vector<BinaryTraceRecorder::Record> records;
+  std::vector<std::string> events;
+  bool ok = BinaryTraceRecorder::Read (filename, records, events);
+  NS_TEST_ASSERT_MSG_EQ (ok, true, "File not read");
+  uint32_t enqueued = 0;
+  uint32_t dequeued = 0;
+  for (std::vector<BinaryTraceRecorder::Record>::const_iterator it = records.begin (); it != records.end (); it++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (it->node, 0, "Event recorded on the wrong node");
+      NS_TEST_ASSERT_MSG_EQ (it->size, 100, "Unexpected packet size");
+      if (events[it->event] == "TxQueue/Enqueue")
+        {
+          enqueued++;
+        }
+      if (events[it->event] == "TxQueue/Dequeue")
+        {
+          dequeued++;
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (enqueued, 3, "Unexpected number of packets enqueued");
+  NS_TEST_ASSERT_MSG_EQ (dequeued, 3, "Unexpected number of packets dequeued");
+  std::remove (filename.c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief BinaryTraceRecorder close test case
+ *
+ * Fires the trace sources after Close, more times than the ring holds,
+ * and after the recorder is deleted, and checks that nothing is recorded.
+ */
+class BinaryTraceRecorderCloseTestCase : public TestCase
+{
+public:
+  BinaryTraceRecorderCloseTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BinaryTraceRecorderCloseTestCase::BinaryTraceRecorderCloseTestCase ()
+  : TestCase ("Check that a closed BinaryTraceRecorder records nothing")
+{
+}
+
+void
+BinaryTraceRecorderCloseTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("binary-trace-recorder-close.bin");
+  Ptr<BinaryTraceRecorder> recorder = CreateObject<BinaryTraceRecorder> ();
+  recorder->SetAttribute ("BufferSize", UintegerValue (64));
+  recorder->Open (filename);
+  Ptr<BinaryTraceTestObject> object = CreateObject<BinaryTraceTestObject> ();
+  bool ok = recorder->TraceConnect<uint32_t, double> (object, "Value", "Value", 0, 0);
+  NS_TEST_ASSERT_MSG_EQ (ok, true, "Trace source not connected");
+  object->Fire (1);
+  recorder->Close ();
+
+  // the ring is not flushed any more, so these would fill it
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      object->Fire (i);
+      recorder->RecordEvent (0, 0, 0, 0);
+    }
+  NS_TEST_ASSERT_MSG_EQ (recorder->GetRecordCount (), 1, "Events recorded after Close");
+
+  std::vector<BinaryTraceRecorder::Record> records;
+  std::vector<std::string> events;
+  ok = BinaryTraceRecorder::Read (filename, records, events);
+  NS_TEST_ASSERT_MSG_EQ (ok, true, "File not read");
+  NS_TEST_ASSERT_MSG_EQ (records.size (), 1, "Unexpected number of records read");
+
+  // the trace source no longer refers to the deleted recorder
+  recorder->Dispose ();
+  recorder = 0;
+  object->Fire (2);
+  std::remove (filename.c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief BinaryTraceRecorder test suite
+ */
+class BinaryTraceRecorderTestSuite : public TestSuite
+{
+public:
+  BinaryTraceRecorderTestSuite ();
+};
+
+BinaryTraceRecorderTestSuite::BinaryTraceRecorderTestSuite ()
+  : TestSuite ("binary-trace-recorder", UNIT)
+{
+  AddTestCase (new BinaryTraceRecorderRecordsTestCase, TestCase::QUICK);
+  AddTestCase (new BinaryTraceRecorderPacketTracesTestCase, TestCase::QUICK);
+  AddTestCase (new BinaryTraceRecorderCloseTestCase, TestCase::QUICK);
+}
+
+static BinaryTraceRecorderTestSuite binaryTraceRecorderTestSuite; ///< the test suite
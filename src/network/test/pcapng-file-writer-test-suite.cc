@@ -0,0 +1,387 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/llc-snap-header.h"
+#include "ns3/pcapng-file-writer.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Blocks of a pcapng file, read back by the tests
+ */
+class PcapngTestFile
+{
+public:
+  /** An interface description block */
+  struct Interface
+  {
+    uint16_t linkType;  //!< the data link type
+    uint32_t snapLen;   //!< the snap length
+    std::string name;   //!< the if_name option
+    uint8_t tsResol;    //!< the if_tsresol option
+  };
+
+  /** An enhanced packet block */
+  struct EnhancedPacket
+  {
+    uint32_t interface;         //!< the interface id
+    uint64_t ts;                //!< the timestamp
+    uint32_t origLen;           //!< the original length
+    std::vector<uint8_t> data;  //!< the captured bytes
+  };
+
+  /**
+   * Read a file.
+   * \param filename the name of the file
+   * \return true if the file is a valid pcapng file
+   */
+  bool Read (std::string filename);
+
+  std::vector<Interface> interfaces;   //!< the interfaces
+  std::vector<EnhancedPacket> packets; //!< the packets
+
+private:
+  /**
+   * \param offset an offset in the file
+   * \return the 16 bits value at the offset
+   */
+  uint16_t U16 (std::size_t offset) const;
+  /**
+   * \param offset an offset in the file
+   * \return the 32 bits value at the offset
+   */
+  uint32_t U32 (std::size_t offset) const;
+
+  std::vector<uint8_t> m_data; //!< the file
+};
+
+uint16_t
+PcapngTestFile::U16 (std::size_t offset) const
+{
+  uint16_t value;
+  std::memcpy (&value, &m_data[offset], sizeof (value));
+  return value;
+}
+
+uint32_t
+PcapngTestFile::U32 (std::size_t offset) const
+{
+  uint32_t value;
+  std::memcpy (&value, &m_data[offset], sizeof (value));
+  return value;
+}
+
+bool
+PcapngTestFile::Read (std::string filename)
+{
+  std::ifstream file (filename.c_str (), std::ios::binary);
+  m_data.assign (std::istreambuf_iterator<char> (file), std::istreambuf_iterator<char> ());
+  if (m_data.size () < 28 || U32 (0) != 0x0A0D0D0A || U32 (8) != 0x1A2B3C4D)
+    {
+      return false;
+    }
+  std::size_t offset = 0;
+  while (offset + 12 <= m_data.size ())
+    {
+      uint32_t type = U32 (offset);
+      uint32_t length = U32 (offset + 4);
+      if (length < 12 || length % 4 != 0 || offset + length > m_data.size ()
+          || U32 (offset + length - 4) != length)
+        {
+          return false;
+        }
+      if (type == 1)
+        {
+          Interface interface;
+          interface.linkType = U16 (offset + 8);
+          interface.snapLen = U32 (offset + 12);
+          interface.tsResol = 6;
+          std::size_t option = offset + 16;
+          while (U16 (option) != 0)
+            {
+              uint16_t code = U16 (option);
+              uint16_t size = U16 (option + 2);
+              if (code == 2)
+                {
+                  interface.name.assign (reinterpret_cast<const char *> (&m_data[option + 4]), size);
+                }
+              else if (code == 9)
+                {
+                  interface.tsResol = m_data[option + 4];
+                }
+              option += 4 + ((size + 3) & ~3U);
+            }
+          interfaces.push_back (interface);
+        }
+      else if (type == 6)
+        {
+          EnhancedPacket packet;
+          packet.interface = U32 (offset + 8);
+          packet.ts = (static_cast<uint64_t> (U32 (offset + 12)) << 32) | U32 (offset + 16);
+          uint32_t capLen = U32 (offset + 20);
+          packet.origLen = U32 (offset + 24);
+          packet.data.assign (&m_data[offset + 28], &m_data[offset + 28] + capLen);
+          packets.push_back (packet);
+        }
+      offset += length;
+    }
+  return offset == m_data.size ();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief PcapngFileWriter blocks test case
+ *
+ * Writes more packets than a buffer holds, on an interface added before
+ * the file is opened and on one added after, with and without header, and
+ * checks the blocks read back.
+ */
+class PcapngFileWriterBlocksTestCase : public TestCase
+{
+public:
+  PcapngFileWriterBlocksTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Write a packet.
+   * \param writer the writer
+   * \param interface the interface id
+   * \param i the packet index
+   */
+  void Write (Ptr<PcapngFileWriter> writer, uint32_t interface, uint32_t i);
+  /**
+   * \param i a packet index
+   * \return the bytes of the packet
+   */
+  static std::vector<uint8_t> GetPayload (uint32_t i);
+};
+
+PcapngFileWriterBlocksTestCase::PcapngFileWriterBlocksTestCase ()
+  : TestCase ("Check the blocks written by a PcapngFileWriter")
+{
+}
+
+std::vector<uint8_t>
+PcapngFileWriterBlocksTestCase::GetPayload (uint32_t i)
+{
+  std::vector<uint8_t> payload (i % 300);
+  for (uint32_t j = 0; j < payload.size (); j++)
+    {
+      payload[j] = static_cast<uint8_t> (i + j);
+    }
+  return payload;
+}
+
+void
+PcapngFileWriterBlocksTestCase::Write (Ptr<PcapngFileWriter> writer, uint32_t interface, uint32_t i)
+{
+  std::vector<uint8_t> payload = GetPayload (i);
+  Ptr<Packet> p = Create<Packet> (payload.data (), static_cast<uint32_t> (payload.size ()));
+  if (i % 2 == 0)
+    {
+      writer->Write (interface, p);
+    }
+  else
+    {
+      LlcSnapHeader llc;
+      llc.SetType (static_cast<uint16_t> (i));
+      writer->Write (interface, llc, p);
+    }
+}
+
+void
+PcapngFileWriterBlocksTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("pcapng-file-writer.pcapng");
+  Ptr<PcapngFileWriter> writer = CreateObject<PcapngFileWriter> ();
+  writer->SetAttribute ("BufferSize", UintegerValue (4096));
+  writer->SetAttribute ("SnapLen", UintegerValue (200));
+  uint32_t first = writer->AddInterface (0, 1, "first");
+  writer->Open (filename);
+  NS_TEST_ASSERT_MSG_EQ (writer->IsOpen (), true, "File not open");
+  Ptr<Node> node = CreateObject<Node> ();
+  SimpleNetDeviceHelper helper;
+  NetDeviceContainer devices = helper.Install (node);
+  uint32_t second = writer->AddInterface (devices.Get (0), 105);
+  NS_TEST_ASSERT_MSG_EQ (first, 0, "Unexpected interface id");
+  NS_TEST_ASSERT_MSG_EQ (second, 1, "Unexpected interface id");
+
+  const uint32_t n = 2000;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Simulator::Schedule (Seconds (1.5) + NanoSeconds (i), &PcapngFileWriterBlocksTestCase::Write,
+                           this, writer, i % 3 == 0 ? second : first, i);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (writer->GetPacketCount (), n, "Unexpected number of packets");
+  writer->Close ();
+  NS_TEST_ASSERT_MSG_EQ (writer->IsOpen (), false, "File not closed");
+
+  PcapngTestFile file;
+  bool ok = file.Read (filename);
+  NS_TEST_ASSERT_MSG_EQ (ok, true, "Invalid pcapng file");
+  NS_TEST_ASSERT_MSG_EQ (file.interfaces.size (), 2, "Unexpected number of interfaces");
+  NS_TEST_ASSERT_MSG_EQ (file.interfaces[0].linkType, 1, "Unexpected data link type");
+  NS_TEST_ASSERT_MSG_EQ (file.interfaces[0].name, "first", "Unexpected interface name");
+  NS_TEST_ASSERT_MSG_EQ (file.interfaces[1].linkType, 105, "Unexpected data link type");
+  std::ostringstream name;
+  name << "/NodeList/" << node->GetId () << "/DeviceList/0";
+  NS_TEST_ASSERT_MSG_EQ (file.interfaces[1].name, name.str (), "Unexpected interface name");
+  NS_TEST_ASSERT_MSG_EQ (file.interfaces[1].snapLen, 200, "Unexpected snap length");
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (file.interfaces[1].tsResol), 9, "Timestamps not in nanoseconds");
+  NS_TEST_ASSERT_MSG_EQ (file.packets.size (), n, "Unexpected number of packets read");
+  for (uint32_t i = 0; i < n; i++)
+    {
+      const PcapngTestFile::EnhancedPacket &packet = file.packets[i];
+      uint32_t interface = (i % 3 == 0) ? second : first;
+      NS_TEST_ASSERT_MSG_EQ (packet.interface, interface, "Unexpected interface");
+      NS_TEST_ASSERT_MSG_EQ (packet.ts, 1500000000 + i, "Unexpected timestamp");
+      std::vector<uint8_t> expected = GetPayload (i);
+      if (i % 2 == 1)
+        {
+          // LLC/SNAP header: aa aa 03 00 00 00, then the type
+          uint8_t llc[] = {0xaa, 0xaa, 0x03, 0, 0, 0, static_cast<uint8_t> ((i >> 8) & 0xff), static_cast<uint8_t> (i & 0xff)};
+          expected.insert (expected.begin (), llc, llc + sizeof (llc));
+        }
+      NS_TEST_ASSERT_MSG_EQ (packet.origLen, expected.size (), "Unexpected original length");
+      expected.resize (std::min<std::size_t> (expected.size (), 200));
+      NS_TEST_ASSERT_MSG_EQ ((packet.data == expected), true, "Unexpected bytes of packet " << i);
+    }
+  std::remove (filename.c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief PcapngFileWriter capture filter test case
+ *
+ * Writes the packets of the devices of two nodes through DefaultSink,
+ * with a capture filter accepting one node, and checks the packets read
+ * back.
+ */
+class PcapngFileWriterFilterTestCase : public TestCase
+{
+public:
+  PcapngFileWriterFilterTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Capture filter accepting the packets of the first node.
+   * \param device the device
+   * \param p the packet
+   * \return true if the packet is accepted
+   */
+  bool Filter (Ptr<NetDevice> device, Ptr<const Packet> p);
+
+  uint32_t m_nodeId;  //!< the node id accepted
+  uint32_t m_calls;   //!< number of calls of the filter
+};
+
+PcapngFileWriterFilterTestCase::PcapngFileWriterFilterTestCase ()
+  : TestCase ("Check the capture filter of a PcapngFileWriter"),
+    m_nodeId (0),
+    m_calls (0)
+{
+}
+
+bool
+PcapngFileWriterFilterTestCase::Filter (Ptr<NetDevice> device, Ptr<const Packet> p)
+{
+  m_calls++;
+  return device->GetNode ()->GetId () == m_nodeId;
+}
+
+void
+PcapngFileWriterFilterTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper helper;
+  NetDeviceContainer devices = helper.Install (nodes);
+  m_nodeId = nodes.Get (1)->GetId ();
+
+  std::string filename = CreateTempDirFilename ("pcapng-file-writer-filter.pcapng");
+  Ptr<PcapngFileWriter> writer = CreateObject<PcapngFileWriter> ();
+  writer->Open (filename);
+  writer->SetCaptureFilter (MakeCallback (&PcapngFileWriterFilterTestCase::Filter, this));
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      writer->AddInterface (devices.Get (i), 1);
+    }
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      PcapngFileWriter::DefaultSink (writer, i % 2, Create<Packet> (100 + i));
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_calls, 10, "Capture filter not called");
+  NS_TEST_ASSERT_MSG_EQ (writer->GetPacketCount (), 5, "Packets not filtered");
+  writer->Dispose ();
+
+  PcapngTestFile file;
+  bool ok = file.Read (filename);
+  NS_TEST_ASSERT_MSG_EQ (ok, true, "Invalid pcapng file");
+  NS_TEST_ASSERT_MSG_EQ (file.packets.size (), 5, "Unexpected number of packets read");
+  for (uint32_t i = 0; i < file.packets.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (file.packets[i].interface, 1, "Packet of a filtered interface");
+      NS_TEST_ASSERT_MSG_EQ (file.packets[i].origLen, 101 + 2 * i, "Unexpected packet");
+    }
+  Simulator::Destroy ();
+  std::remove (filename.c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief PcapngFileWriter test suite
+ */
+class PcapngFileWriterTestSuite : public TestSuite
+{
+public:
+  PcapngFileWriterTestSuite ();
+};
+
+PcapngFileWriterTestSuite::PcapngFileWriterTestSuite ()
+  : TestSuite ("pcapng-file-writer", UNIT)
+{
+  AddTestCase (new PcapngFileWriterBlocksTestCase, TestCase::QUICK);
+  AddTestCase (new PcapngFileWriterFilterTestCase, TestCase::QUICK);
+}
+
+static PcapngFileWriterTestSuite pcapngFileWriterTestSuite; ///< the test suite
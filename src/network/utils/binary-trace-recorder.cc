@@ -0,0 +1,506 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <set>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/pointer.h"
+#include "ns3/node.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/net-device-container.h"
+#include "binary-trace-recorder.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryTraceRecorder");
+
+NS_OBJECT_ENSURE_REGISTERED (BinaryTraceRecorder);
+
+/// Magic number at the start and at the end of a file
+static const char BINARY_TRACE_MAGIC[8] = {'n', 's', '3', 'b', 't', 'r', 'a', 'c'};
+/// Version of the file format
+static const uint32_t BINARY_TRACE_VERSION = 1;
+
+/// Header of a file
+struct BinaryTraceHeader
+{
+  char magic[8];       //!< BINARY_TRACE_MAGIC
+  uint32_t version;    //!< BINARY_TRACE_VERSION
+  uint32_t recordSize; //!< size of a record
+};
+
+/// Trailer of a file, after the records and the event names
+struct BinaryTraceTrailer
+{
+  uint64_t records;    //!< number of records
+  uint32_t events;     //!< number of event names
+  uint32_t reserved;   //!< unused
+  char magic[8];       //!< BINARY_TRACE_MAGIC
+};
+
+TypeId
+BinaryTraceRecorder::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::BinaryTraceRecorder")
+    .SetParent<Object> ()
+    .SetGroupName ("Network")
+    .AddConstructor<BinaryTraceRecorder> ()
+    .AddAttribute ("BufferSize",
+                   "The number of records of the ring flushed by the writer thread, "
+                   "set when the file is opened.",
+                   UintegerValue (65536),
+                   MakeUintegerAccessor (&BinaryTraceRecorder::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> (64))
+  ;
+  return tid;
+}
+
+BinaryTraceRecorder::BinaryTraceRecorder ()
+  : m_bufferSize (65536),
+    m_head (0),
+    m_tail (0),
+    m_closing (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+BinaryTraceRecorder::~BinaryTraceRecorder ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+BinaryTraceRecorder::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  Object::DoDispose ();
+}
+
+void
+BinaryTraceRecorder::Open (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  NS_ABORT_MSG_IF (m_writer.joinable (), "BinaryTraceRecorder::Open(): already open");
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  NS_ABORT_MSG_UNLESS (m_file.is_open (), "BinaryTraceRecorder::Open(): unable to open " << filename);
+
+  BinaryTraceHeader header;
+  std::memcpy (header.magic, BINARY_TRACE_MAGIC, sizeof (header.magic));
+  header.version = BINARY_TRACE_VERSION;
+  header.recordSize = sizeof (Record);
+  m_file.write (reinterpret_cast<const char *> (&header), sizeof (header));
+
+  m_ring.assign (m_bufferSize, Record ());
+  m_head.store (0);
+  m_tail.store (0);
+  m_closing.store (false);
+  m_writer = std::thread (&BinaryTraceRecorder::WriteRecords, this);
+}
+
+void
+BinaryTraceRecorder::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  // the sources point to this recorder, which may be deleted once closed
+  for (std::vector<Ptr<Source> >::const_iterator it = m_sources.begin (); it != m_sources.end (); it++)
+    {
+      (*it)->Disconnect ();
+    }
+  m_sources.clear ();
+  if (!m_writer.joinable ())
+    {
+      return;
+    }
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_closing.store (true);
+  }
+  m_wakeup.notify_one ();
+  m_writer.join ();
+
+  for (std::vector<std::string>::const_iterator it = m_events.begin (); it != m_events.end (); it++)
+    {
+      uint16_t length = static_cast<uint16_t> (it->size ());
+      m_file.write (reinterpret_cast<const char *> (&length), sizeof (length));
+      m_file.write (it->data (), length);
+    }
+  BinaryTraceTrailer trailer;
+  trailer.records = m_head.load ();
+  trailer.events = static_cast<uint32_t> (m_events.size ());
+  trailer.reserved = 0;
+  std::memcpy (trailer.magic, BINARY_TRACE_MAGIC, sizeof (trailer.magic));
+  m_file.write (reinterpret_cast<const char *> (&trailer), sizeof (trailer));
+  if (!m_file)
+    {
+      NS_LOG_WARN ("Error while writing the binary trace file");
+    }
+  m_file.close ();
+}
+
+uint16_t
+BinaryTraceRecorder::GetEventCode (std::string name)
+{
+  NS_LOG_FUNCTION (this << name);
+  std::map<std::string, uint16_t>::const_iterator it = m_eventCodes.find (name);
+  if (it != m_eventCodes.end ())
+    {
+      return it->second;
+    }
+  NS_ABORT_MSG_IF (m_events.size () > 0xffff, "BinaryTraceRecorder: too many events");
+  NS_ABORT_MSG_IF (name.size () > 0xffff, "BinaryTraceRecorder: event name too long");
+  uint16_t code = static_cast<uint16_t> (m_events.size ());
+  m_events.push_back (name);
+  m_eventCodes[name] = code;
+  return code;
+}
+
+void
+BinaryTraceRecorder::RecordEvent (uint16_t event, uint32_t node, uint32_t device, Ptr<const Packet> packet)
+{
+  NS_LOG_FUNCTION (this << event << node << device << packet);
+  if (!m_writer.joinable ())
+    {
+      NS_LOG_LOGIC ("No file open, event ignored");
+      return;
+    }
+  uint64_t size = m_ring.size ();
+  uint64_t head = m_head.load (std::memory_order_relaxed);
+  if (head - m_tail.load (std::memory_order_acquire) == size)
+    {
+      NS_LOG_LOGIC ("Wait for the writer");
+      do
+        {
+          m_wakeup.notify_one ();
+          std::this_thread::yield ();
+        }
+      while (head - m_tail.load (std::memory_order_acquire) == size);
+    }
+
+  Record &record = m_ring[head % size];
+  record.time = Simulator::Now ().GetNanoSeconds ();
+  record.node = node;
+  record.device = device;
+  record.event = event;
+  if (packet)
+    {
+      record.size = packet->GetSize ();
+      record.flags = PACKET;
+      record.uid = packet->GetUid ();
+    }
+  else
+    {
+      record.size = 0;
+      record.flags = 0;
+      record.uid = 0;
+    }
+  m_head.store (head + 1, std::memory_order_release);
+
+  // the writer also wakes up periodically, so a missed notification
+  // only delays the flush
+  if ((head + 1) % (size / 4) == 0)
+    {
+      m_wakeup.notify_one ();
+    }
+}
+
+uint64_t
+BinaryTraceRecorder::GetRecordCount (void) const
+{
+  return m_head.load ();
+}
+
+void
+BinaryTraceRecorder::WriteRecords (void)
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  uint64_t quarter = m_ring.size () / 4;
+  while (!m_closing.load ())
+    {
+      m_wakeup.wait_for (lock, std::chrono::milliseconds (100), [this, quarter] () {
+                           return m_closing.load ()
+                           || m_head.load (std::memory_order_acquire)
+                           - m_tail.load (std::memory_order_relaxed) >= quarter;
+                         });
+      lock.unlock ();
+      Flush ();
+      lock.lock ();
+    }
+  lock.unlock ();
+  Flush ();
+}
+
+void
+BinaryTraceRecorder::Flush (void)
+{
+  uint64_t size = m_ring.size ();
+  uint64_t tail = m_tail.load (std::memory_order_relaxed);
+  uint64_t head = m_head.load (std::memory_order_acquire);
+  while (tail < head)
+    {
+      uint64_t index = tail % size;
+      uint64_t n = std::min (head - tail, size - index);
+      m_file.write (reinterpret_cast<const char *> (&m_ring[index]), n * sizeof (Record));
+      tail += n;
+      m_tail.store (tail, std::memory_order_release);
+    }
+}
+
+BinaryTraceRecorder::Source::Source (BinaryTraceRecorder *recorder, uint16_t event,
+                                     uint32_t node, uint32_t device)
+  : m_recorder (recorder),
+    m_event (event),
+    m_node (node),
+    m_device (device)
+{
+}
+
+void
+BinaryTraceRecorder::Source::Disconnect (void)
+{
+  if (m_object != 0)
+    {
+      m_object->TraceDisconnectWithoutContext (m_source, m_callback);
+      m_object = 0;
+    }
+}
+
+void
+BinaryTraceRecorder::Source::GetPacket (const Ptr<const Packet> &packet, Ptr<const Packet> &found)
+{
+  if (!found)
+    {
+      found = packet;
+    }
+}
+
+void
+BinaryTraceRecorder::Source::GetPacket (const Ptr<Packet> &packet, Ptr<const Packet> &found)
+{
+  if (!found)
+    {
+      found = packet;
+    }
+}
+
+uint32_t
+BinaryTraceRecorder::EnableObjectPacketTraces (Ptr<Object> object, std::string prefix,
+                                               uint32_t node, uint32_t device)
+{
+  NS_LOG_FUNCTION (this << object << prefix << node << device);
+  uint32_t n = 0;
+  std::set<std::string> connected;
+  TypeId tid = object->GetInstanceTypeId ();
+  while (true)
+    {
+      for (std::size_t i = 0; i < tid.GetTraceSourceN (); i++)
+        {
+          struct TypeId::TraceSourceInformation info = tid.GetTraceSource (i);
+          // a trace source of a derived class hides those of its parents
+          if (info.callback != "ns3::Packet::TracedCallback"
+              || info.supportLevel != TypeId::SUPPORTED
+              || !connected.insert (info.name).second)
+            {
+              continue;
+            }
+          if (TraceConnect<Ptr<const Packet> > (object, info.name, prefix + info.name, node, device))
+            {
+              n++;
+            }
+        }
+      TypeId parent = tid.GetParent ();
+      if (parent == tid)
+        {
+          break;
+        }
+      tid = parent;
+    }
+  return n;
+}
+
+uint32_t
+BinaryTraceRecorder::EnablePacketTraces (Ptr<NetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  uint32_t node = device->GetNode ()->GetId ();
+  uint32_t index = device->GetIfIndex ();
+  uint32_t n = EnableObjectPacketTraces (device, "", node, index);
+
+  // the objects of the device, but not the node or the channel shared
+  // with the other devices
+  std::set<Ptr<Object> > objects;
+  TypeId tid = device->GetInstanceTypeId ();
+  while (true)
+    {
+      for (std::size_t i = 0; i < tid.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info = tid.GetAttribute (i);
+          if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) == 0)
+            {
+              continue;
+            }
+          PointerValue value;
+          if (!device->GetAttributeFailSafe (info.name, value))
+            {
+              continue;
+            }
+          Ptr<Object> object = value.Get<Object> ();
+          if (object == 0 || DynamicCast<Node> (object) != 0 || DynamicCast<Channel> (object) != 0
+              || !objects.insert (object).second)
+            {
+              continue;
+            }
+          n += EnableObjectPacketTraces (object, info.name + "/", node, index);
+        }
+      TypeId parent = tid.GetParent ();
+      if (parent == tid)
+        {
+          break;
+        }
+      tid = parent;
+    }
+  return n;
+}
+
+uint32_t
+BinaryTraceRecorder::EnablePacketTraces (NetDeviceContainer devices)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t n = 0;
+  for (NetDeviceContainer::Iterator i = devices.Begin (); i != devices.End (); ++i)
+    {
+      n += EnablePacketTraces (*i);
+    }
+  return n;
+}
+
+bool
+BinaryTraceRecorder::Read (std::string filename, std::vector<Record> &records,
+                           std::vector<std::string> &events)
+{
+  NS_LOG_FUNCTION (filename);
+  std::ifstream file (filename.c_str (), std::ios::in | std::ios::binary);
+  if (!file.is_open ())
+    {
+      NS_LOG_WARN ("Unable to open " << filename);
+      return false;
+    }
+  BinaryTraceHeader header;
+  file.read (reinterpret_cast<char *> (&header), sizeof (header));
+  if (!file || std::memcmp (header.magic, BINARY_TRACE_MAGIC, sizeof (header.magic)) != 0
+      || header.version != BINARY_TRACE_VERSION || header.recordSize != sizeof (Record))
+    {
+      NS_LOG_WARN (filename << " is not a binary trace file of this version");
+      return false;
+    }
+  BinaryTraceTrailer trailer;
+  file.seekg (-static_cast<std::streamoff> (sizeof (trailer)), std::ios::end);
+  file.read (reinterpret_cast<char *> (&trailer), sizeof (trailer));
+  if (!file || std::memcmp (trailer.magic, BINARY_TRACE_MAGIC, sizeof (trailer.magic)) != 0)
+    {
+      NS_LOG_WARN (filename << " was not closed");
+      return false;
+    }
+
+  file.seekg (sizeof (header), std::ios::beg);
+  records.resize (trailer.records);
+  file.read (reinterpret_cast<char *> (records.data ()), trailer.records * sizeof (Record));
+  events.clear ();
+  for (uint32_t i = 0; i < trailer.events; i++)
+    {
+      uint16_t length;
+      file.read (reinterpret_cast<char *> (&length), sizeof (length));
+      std::string name (length, ' ');
+      file.read (&name[0], length);
+      events.push_back (name);
+    }
+  if (!file)
+    {
+      NS_LOG_WARN (filename << " is truncated");
+      return false;
+    }
+  return true;
+}
+
+bool
+BinaryTraceRecorder::ConvertToAscii (std::string filename, std::ostream &os)
+{
+  NS_LOG_FUNCTION (filename << &os);
+  std::vector<Record> records;
+  std::vector<std::string> events;
+  if (!Read (filename, records, events))
+    {
+      return false;
+    }
+
+  std::vector<char> types;
+  for (std::vector<std::string>::const_iterator it = events.begin (); it != events.end (); it++)
+    {
+      const std::string &name = *it;
+      std::string::size_type slash = name.rfind ('/');
+      std::string source = (slash == std::string::npos) ? name : name.substr (slash + 1);
+      char type = '*';
+      if (source.find ("Enqueue") != std::string::npos)
+        {
+          type = '+';
+        }
+      else if (source.find ("Dequeue") != std::string::npos)
+        {
+          type = '-';
+        }
+      else if (source.find ("Drop") != std::string::npos)
+        {
+          type = 'd';
+        }
+      else if (source.find ("Rx") != std::string::npos)
+        {
+          type = 'r';
+        }
+      else if (source.find ("Tx") != std::string::npos)
+        {
+          type = 't';
+        }
+      types.push_back (type);
+    }
+
+  for (std::vector<Record>::const_iterator it = records.begin (); it != records.end (); it++)
+    {
+      if (it->event >= events.size ())
+        {
+          NS_LOG_WARN ("Unknown event " << it->event << " in " << filename);
+          return false;
+        }
+      os << types[it->event] << " " << NanoSeconds (it->time).GetSeconds ()
+         << " /NodeList/" << it->node << "/DeviceList/" << it->device
+         << "/" << events[it->event];
+      if (it->flags & PACKET)
+        {
+          os << " size=" << it->size << " uid=" << it->uid;
+        }
+      os << "\n";
+    }
+  return true;
+}
+
+} // namespace ns3
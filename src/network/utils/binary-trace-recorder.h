@@ -0,0 +1,351 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_TRACE_RECORDER_H
+#define BINARY_TRACE_RECORDER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/callback.h"
+#include "ns3/simple-ref-count.h"
+
+namespace ns3 {
+
+class NetDevice;
+class NetDeviceContainer;
+
+/**
+ * \ingroup network
+ *
+ * \brief Record trace events as fixed-size binary records
+ *
+ * An alternative to the ascii traces of AsciiTraceHelper for large
+ * simulations: each event is stored as a Record of 32 bytes (time, node,
+ * device, event, packet size and uid) in a ring of BufferSize records.
+ * A writer thread flushes the ring to the file whenever a quarter of it is
+ * filled, so the simulation only copies the record.  The ring is lock free,
+ * with the simulation thread as its only producer; when it is full, the
+ * simulation waits for the writer.
+ *
+ * The events are connected with EnablePacketTraces, for the trace sources
+ * of signature ns3::Packet::TracedCallback of a device and of the objects
+ * it points to (e.g. its TxQueue, or the Mac and Phy of a WifiNetDevice),
+ * or with TraceConnect for any other trace source.  Each trace source gets
+ * an event code, and the names of the events are written at the end of the
+ * file by Close.
+ *
+ * The file is written in the byte order of the host.  ConvertToAscii
+ * converts it to lines in the format of the ascii traces, with the packet
+ * size and uid instead of the printed packet:
+ *
+ * \verbatim
+   + 1.50001 /NodeList/0/DeviceList/1/TxQueue/Enqueue size=100 uid=42
+   \endverbatim
+ */
+class BinaryTraceRecorder : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  BinaryTraceRecorder ();
+  virtual ~BinaryTraceRecorder ();
+
+  /** Flags of a Record. */
+  enum RecordFlags
+  {
+    PACKET = 1 //!< the event has a packet
+  };
+
+  /** A trace event. */
+  struct Record
+  {
+    int64_t time;     //!< event time, in nanoseconds
+    uint32_t node;    //!< node id
+    uint32_t device;  //!< device index in the node
+    uint32_t size;    //!< packet size, 0 without packet
+    uint16_t event;   //!< event code
+    uint16_t flags;   //!< PACKET if the event has a packet
+    uint64_t uid;     //!< packet uid, 0 without packet
+  };
+
+  /**
+   * Create the file and start the writer thread.
+   *
+   * \param filename the name of the file
+   */
+  void Open (std::string filename);
+  /**
+   * Flush the records, write the event names and close the file, and
+   * disconnect the trace sources.
+   *
+   * Called by DoDispose and by the destructor if needed.
+   */
+  void Close (void);
+
+  /**
+   * Get the code of an event, allocating it if needed.
+   *
+   * \param name the event name, e.g. the path of its trace source
+   * \return the event code
+   */
+  uint16_t GetEventCode (std::string name);
+  /**
+   * Record an event, unless no file is open, e.g. after Close.
+   *
+   * \param event the event code
+   * \param node the node id
+   * \param device the device index
+   * \param packet the packet, or 0
+   */
+  void RecordEvent (uint16_t event, uint32_t node, uint32_t device, Ptr<const Packet> packet);
+  /**
+   * \return the number of events recorded
+   */
+  uint64_t GetRecordCount (void) const;
+
+  /**
+   * Record the packets of the trace sources of a device of signature
+   * ns3::Packet::TracedCallback, and those of the objects its pointer
+   * attributes refer to.  The events are named after the trace sources,
+   * prefixed by the attribute name, e.g. "MacRx" or "TxQueue/Drop".
+   *
+   * \param device the device
+   * \return the number of trace sources connected
+   */
+  uint32_t EnablePacketTraces (Ptr<NetDevice> device);
+  /**
+   * Record the packets of the trace sources of some devices.
+   *
+   * \param devices the devices
+   * \return the number of trace sources connected
+   */
+  uint32_t EnablePacketTraces (NetDeviceContainer devices);
+
+  /**
+   * Record the calls of any trace source.  The packet size and uid are
+   * those of the first argument of type Ptr<const Packet>, if any.
+   *
+   * \code
+   *   recorder->TraceConnect<Time, Time, WifiPhyState> (phy->GetState (), "State", "Phy/State", nodeId, 0);
+   * \endcode
+   *
+   * \tparam Args the arguments of the trace source
+   * \param object the object of the trace source
+   * \param source the name of the trace source
+   * \param event the event name
+   * \param node the node id
+   * \param device the device index
+   * \return true if the trace source was connected
+   */
+  template <typename... Args>
+  bool TraceConnect (Ptr<Object> object, std::string source, std::string event,
+                     uint32_t node, uint32_t device);
+
+  /**
+   * Read a file written by a BinaryTraceRecorder.
+   *
+   * \param filename the name of the file
+   * \param records the records read
+   * \param events the event names, indexed by event code
+   * \return true if the file was read, false if it is not a complete
+   * BinaryTraceRecorder file
+   */
+  static bool Read (std::string filename, std::vector<Record> &records,
+                    std::vector<std::string> &events);
+  /**
+   * Convert a file written by a BinaryTraceRecorder to ascii trace lines.
+   *
+   * As in the ascii traces, the lines start with '+' for an Enqueue event,
+   * '-' for a Dequeue event, 'd' for a drop and 'r' for a reception; they
+   * start with 't' for a transmission and '*' for any other event.
+   *
+   * \param filename the name of the file
+   * \param os the stream to write the lines to
+   * \return true if the file was converted
+   */
+  static bool ConvertToAscii (std::string filename, std::ostream &os);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /** A connected trace source. */
+  class Source : public SimpleRefCount<Source>
+  {
+public:
+    /**
+     * Constructor
+     *
+     * \param recorder the recorder
+     * \param event the event code
+     * \param node the node id
+     * \param device the device index
+     */
+    Source (BinaryTraceRecorder *recorder, uint16_t event, uint32_t node, uint32_t device);
+    /**
+     * Connect Notify to a trace source.
+     *
+     * \tparam Args the arguments of the trace source
+     * \param object the object of the trace source
+     * \param source the name of the trace source
+     * \return true if the trace source was connected
+     */
+    template <typename... Args>
+    bool Connect (Ptr<Object> object, std::string source);
+    /**
+     * Disconnect the trace source, if connected.
+     */
+    void Disconnect (void);
+    /**
+     * Record a call of the trace source.
+     *
+     * \tparam Args the arguments of the trace source
+     * \param args the arguments
+     */
+    template <typename... Args>
+    void Notify (Args... args);
+
+private:
+    /**
+     * Get the packet of a trace source argument, unless one was found.
+     *
+     * \param packet the argument
+     * \param found the packet
+     */
+    static void GetPacket (const Ptr<const Packet> &packet, Ptr<const Packet> &found);
+    /**
+     * Get the packet of a trace source argument, unless one was found.
+     *
+     * \param packet the argument
+     * \param found the packet
+     */
+    static void GetPacket (const Ptr<Packet> &packet, Ptr<const Packet> &found);
+    /**
+     * Ignore a trace source argument that is not a packet.
+     *
+     * \tparam T the type of the argument
+     * \param value the argument
+     * \param found the packet
+     */
+    template <typename T>
+    static void GetPacket (const T &value, Ptr<const Packet> &found);
+
+    BinaryTraceRecorder *m_recorder; //!< the recorder, valid while connected
+    uint16_t m_event;                //!< the event code
+    uint32_t m_node;                 //!< the node id
+    uint32_t m_device;               //!< the device index
+    Ptr<Object> m_object;            //!< the object of the trace source, 0 if not connected
+    std::string m_source;            //!< the name of the trace source
+    CallbackBase m_callback;         //!< the callback connected to the trace source
+  };
+
+  /**
+   * Connect the packet trace sources of an object.
+   *
+   * \param object the object
+   * \param prefix the prefix of the event names
+   * \param node the node id
+   * \param device the device index
+   * \return the number of trace sources connected
+   */
+  uint32_t EnableObjectPacketTraces (Ptr<Object> object, std::string prefix,
+                                     uint32_t node, uint32_t device);
+  /**
+   * Write the records of the ring, until the recorder is closed.
+   */
+  void WriteRecords (void);
+  /**
+   * Write the records added to the ring since the last call.
+   */
+  void Flush (void);
+
+  uint32_t m_bufferSize;                  //!< capacity of the ring, in records
+  std::vector<Record> m_ring;             //!< the ring
+  std::atomic<uint64_t> m_head;           //!< index of the next record added
+  std::atomic<uint64_t> m_tail;           //!< index of the next record written
+  std::ofstream m_file;                   //!< the file
+  std::thread m_writer;                   //!< the writer thread
+  std::mutex m_mutex;                     //!< mutex of m_wakeup
+  std::condition_variable m_wakeup;       //!< wakes the writer up
+  std::atomic<bool> m_closing;            //!< whether the writer must exit
+  std::map<std::string, uint16_t> m_eventCodes; //!< event codes, by name
+  std::vector<std::string> m_events;      //!< event names, by code
+  std::vector<Ptr<Source> > m_sources;    //!< connected trace sources
+};
+
+template <typename T>
+void
+BinaryTraceRecorder::Source::GetPacket (const T &value, Ptr<const Packet> &found)
+{
+}
+
+template <typename... Args>
+void
+BinaryTraceRecorder::Source::Notify (Args... args)
+{
+  Ptr<const Packet> packet;
+  int unused[] = {0, (GetPacket (args, packet), 0)...};
+  (void) unused;
+  m_recorder->RecordEvent (m_event, m_node, m_device, packet);
+}
+
+template <typename... Args>
+bool
+BinaryTraceRecorder::Source::Connect (Ptr<Object> object, std::string source)
+{
+  Callback<void, Args...> callback = MakeCallback (&Source::template Notify<Args...>, this);
+  if (!object->TraceConnectWithoutContext (source, callback))
+    {
+      return false;
+    }
+  m_object = object;
+  m_source = source;
+  m_callback = callback;
+  return true;
+}
+
+template <typename... Args>
+bool
+BinaryTraceRecorder::TraceConnect (Ptr<Object> object, std::string source, std::string event,
+                                   uint32_t node, uint32_t device)
+{
+  Ptr<Source> s = Create<Source> (this, GetEventCode (event), node, device);
+  if (!s->template Connect<Args...> (object, source))
+    {
+      return false;
+    }
+  m_sources.push_back (s);
+  return true;
+}
+
+} // namespace ns3
+
+#endif /* BINARY_TRACE_RECORDER_H */
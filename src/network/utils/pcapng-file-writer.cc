@@ -0,0 +1,434 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/buffer.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "pcapng-file-writer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapngFileWriter");
+
+NS_OBJECT_ENSURE_REGISTERED (PcapngFileWriter);
+
+/// Block type of a Section Header Block
+static const uint32_t PCAPNG_SECTION_HEADER = 0x0A0D0D0A;
+/// Block type of an Interface Description Block
+static const uint32_t PCAPNG_INTERFACE_DESCRIPTION = 0x00000001;
+/// Block type of an Enhanced Packet Block
+static const uint32_t PCAPNG_ENHANCED_PACKET = 0x00000006;
+/// Byte order magic of a Section Header Block
+static const uint32_t PCAPNG_BYTE_ORDER_MAGIC = 0x1A2B3C4D;
+/// if_name option of an Interface Description Block
+static const uint16_t PCAPNG_IF_NAME = 2;
+/// if_tsresol option of an Interface Description Block
+static const uint16_t PCAPNG_IF_TSRESOL = 9;
+/// Number of buffers filled and not yet written before the simulation waits
+static const uint32_t PCAPNG_MAX_BUFFERS = 4;
+
+/**
+ * Write a 16 bits value in host byte order.
+ * \param p the destination
+ * \param value the value
+ * \return the byte after the value
+ */
+static uint8_t *
+WriteU16 (uint8_t *p, uint16_t value)
+{
+  std::memcpy (p, &value, sizeof (value));
+  return p + sizeof (value);
+}
+
+/**
+ * Write a 32 bits value in host byte order.
+ * \param p the destination
+ * \param value the value
+ * \return the byte after the value
+ */
+static uint8_t *
+WriteU32 (uint8_t *p, uint32_t value)
+{
+  std::memcpy (p, &value, sizeof (value));
+  return p + sizeof (value);
+}
+
+/**
+ * \param size a size, in bytes
+ * \return the size padded to 32 bits
+ */
+static uint32_t
+Pad32 (uint32_t size)
+{
+  return (size + 3) & ~3U;
+}
+
+TypeId
+PcapngFileWriter::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PcapngFileWriter")
+    .SetParent<Object> ()
+    .SetGroupName ("Network")
+    .AddConstructor<PcapngFileWriter> ()
+    .AddAttribute ("BufferSize",
+                   "The size in bytes of the buffers handed to the writer thread.",
+                   UintegerValue (1 << 20),
+                   MakeUintegerAccessor (&PcapngFileWriter::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> (4096))
+    .AddAttribute ("SnapLen",
+                   "The maximum number of bytes captured per packet, "
+                   "set in the interface descriptions.",
+                   UintegerValue (65535),
+                   MakeUintegerAccessor (&PcapngFileWriter::m_snapLen),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+PcapngFileWriter::PcapngFileWriter ()
+  : m_bufferSize (1 << 20),
+    m_snapLen (65535),
+    m_packets (0),
+    m_buffers (0),
+    m_closing (false)
+{
+  NS_LOG_FUNCTION (this);
+  m_current.size = 0;
+}
+
+PcapngFileWriter::~PcapngFileWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+PcapngFileWriter::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  m_interfaces.clear ();
+  m_filter = CaptureFilterCallback ();
+  Object::DoDispose ();
+}
+
+void
+PcapngFileWriter::Open (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  NS_ABORT_MSG_IF (IsOpen (), "PcapngFileWriter::Open(): already open");
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  NS_ABORT_MSG_UNLESS (m_file.is_open (), "PcapngFileWriter::Open(): unable to open " << filename);
+
+  m_pending.clear ();
+  m_free.clear ();
+  m_current.data.assign (m_bufferSize, 0);
+  m_current.size = 0;
+  m_buffers = 1;
+  m_closing = false;
+  m_packets = 0;
+  m_writer = std::thread (&PcapngFileWriter::WriteBuffers, this);
+
+  // section header, without options and of unspecified length
+  uint32_t length = 28;
+  uint8_t *p = Reserve (length);
+  p = WriteU32 (p, PCAPNG_SECTION_HEADER);
+  p = WriteU32 (p, length);
+  p = WriteU32 (p, PCAPNG_BYTE_ORDER_MAGIC);
+  p = WriteU16 (p, 1);
+  p = WriteU16 (p, 0);
+  p = WriteU32 (p, 0xffffffff);
+  p = WriteU32 (p, 0xffffffff);
+  WriteU32 (p, length);
+
+  for (std::vector<Interface>::const_iterator it = m_interfaces.begin (); it != m_interfaces.end (); it++)
+    {
+      WriteInterfaceDescription (*it);
+    }
+}
+
+void
+PcapngFileWriter::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!IsOpen ())
+    {
+      return;
+    }
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    if (m_current.size > 0)
+      {
+        m_pending.push_back (std::move (m_current));
+      }
+    m_closing = true;
+  }
+  m_filled.notify_one ();
+  m_writer.join ();
+
+  if (!m_file)
+    {
+      NS_LOG_WARN ("Error while writing the pcapng file");
+    }
+  m_file.close ();
+  m_pending.clear ();
+  m_free.clear ();
+  m_current.data.clear ();
+  m_current.size = 0;
+}
+
+bool
+PcapngFileWriter::IsOpen (void) const
+{
+  return m_writer.joinable ();
+}
+
+uint32_t
+PcapngFileWriter::AddInterface (Ptr<NetDevice> device, uint32_t dataLinkType, std::string name)
+{
+  NS_LOG_FUNCTION (this << device << dataLinkType << name);
+  Interface interface;
+  interface.device = device;
+  interface.dataLinkType = dataLinkType;
+  interface.name = name;
+  if (name.empty () && device != 0)
+    {
+      std::ostringstream oss;
+      oss << "/NodeList/" << device->GetNode ()->GetId () << "/DeviceList/" << device->GetIfIndex ();
+      interface.name = oss.str ();
+    }
+  m_interfaces.push_back (interface);
+  if (IsOpen ())
+    {
+      WriteInterfaceDescription (interface);
+    }
+  return static_cast<uint32_t> (m_interfaces.size () - 1);
+}
+
+uint32_t
+PcapngFileWriter::GetNInterfaces (void) const
+{
+  return static_cast<uint32_t> (m_interfaces.size ());
+}
+
+uint32_t
+PcapngFileWriter::GetDataLinkType (uint32_t interface) const
+{
+  NS_ASSERT (interface < m_interfaces.size ());
+  return m_interfaces[interface].dataLinkType;
+}
+
+void
+PcapngFileWriter::SetCaptureFilter (CaptureFilterCallback filter)
+{
+  NS_LOG_FUNCTION (this);
+  m_filter = filter;
+}
+
+bool
+PcapngFileWriter::Accept (uint32_t interface, Ptr<const Packet> p) const
+{
+  NS_ASSERT (interface < m_interfaces.size ());
+  return m_filter.IsNull () || m_filter (m_interfaces[interface].device, p);
+}
+
+void
+PcapngFileWriter::Write (uint32_t interface, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << interface << p);
+  NS_ASSERT_MSG (IsOpen (), "PcapngFileWriter: no file open");
+  NS_ASSERT (interface < m_interfaces.size ());
+  uint32_t origLen = p->GetSize ();
+  uint32_t capLen = std::min (origLen, m_snapLen);
+  uint32_t length = 32 + Pad32 (capLen);
+  uint64_t ts = Simulator::Now ().GetNanoSeconds ();
+
+  uint8_t *start = Reserve (length);
+  uint8_t *data = start;
+  data = WriteU32 (data, PCAPNG_ENHANCED_PACKET);
+  data = WriteU32 (data, length);
+  data = WriteU32 (data, interface);
+  data = WriteU32 (data, static_cast<uint32_t> (ts >> 32));
+  data = WriteU32 (data, static_cast<uint32_t> (ts));
+  data = WriteU32 (data, capLen);
+  data = WriteU32 (data, origLen);
+  p->CopyData (data, capLen);
+  std::memset (data + capLen, 0, Pad32 (capLen) - capLen);
+  WriteU32 (start + length - 4, length);
+  m_packets++;
+}
+
+void
+PcapngFileWriter::Write (uint32_t interface, const Header &header, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << interface << &header << p);
+  NS_ASSERT_MSG (IsOpen (), "PcapngFileWriter: no file open");
+  NS_ASSERT (interface < m_interfaces.size ());
+  uint32_t headerSize = header.GetSerializedSize ();
+  uint32_t origLen = headerSize + p->GetSize ();
+  uint32_t capLen = std::min (origLen, m_snapLen);
+  uint32_t length = 32 + Pad32 (capLen);
+  uint64_t ts = Simulator::Now ().GetNanoSeconds ();
+
+  uint8_t *start = Reserve (length);
+  uint8_t *data = start;
+  data = WriteU32 (data, PCAPNG_ENHANCED_PACKET);
+  data = WriteU32 (data, length);
+  data = WriteU32 (data, interface);
+  data = WriteU32 (data, static_cast<uint32_t> (ts >> 32));
+  data = WriteU32 (data, static_cast<uint32_t> (ts));
+  data = WriteU32 (data, capLen);
+  data = WriteU32 (data, origLen);
+  Buffer headerBuffer;
+  headerBuffer.AddAtStart (headerSize);
+  header.Serialize (headerBuffer.Begin ());
+  uint32_t toCopy = std::min (headerSize, capLen);
+  headerBuffer.CopyData (data, toCopy);
+  p->CopyData (data + toCopy, capLen - toCopy);
+  std::memset (data + capLen, 0, Pad32 (capLen) - capLen);
+  WriteU32 (start + length - 4, length);
+  m_packets++;
+}
+
+uint64_t
+PcapngFileWriter::GetPacketCount (void) const
+{
+  return m_packets;
+}
+
+void
+PcapngFileWriter::DefaultSink (Ptr<PcapngFileWriter> writer, uint32_t interface, Ptr<const Packet> p)
+{
+  if (writer->Accept (interface, p))
+    {
+      writer->Write (interface, p);
+    }
+}
+
+void
+PcapngFileWriter::WriteInterfaceDescription (const Interface &interface)
+{
+  NS_LOG_FUNCTION (this << interface.name);
+  NS_ABORT_MSG_IF (interface.name.size () > 0xffff, "PcapngFileWriter: interface name too long");
+  uint16_t nameLength = static_cast<uint16_t> (interface.name.size ());
+  // if_name, if_tsresol and opt_endofopt options
+  uint32_t options = (nameLength > 0 ? 4 + Pad32 (nameLength) : 0) + 8 + 4;
+  uint32_t length = 20 + options;
+
+  uint8_t *start = Reserve (length);
+  std::memset (start, 0, length);
+  uint8_t *p = start;
+  p = WriteU32 (p, PCAPNG_INTERFACE_DESCRIPTION);
+  p = WriteU32 (p, length);
+  p = WriteU16 (p, static_cast<uint16_t> (interface.dataLinkType));
+  p = WriteU16 (p, 0);
+  p = WriteU32 (p, m_snapLen);
+  if (nameLength > 0)
+    {
+      p = WriteU16 (p, PCAPNG_IF_NAME);
+      p = WriteU16 (p, nameLength);
+      std::memcpy (p, interface.name.data (), nameLength);
+      p += Pad32 (nameLength);
+    }
+  // timestamps in nanoseconds
+  p = WriteU16 (p, PCAPNG_IF_TSRESOL);
+  p = WriteU16 (p, 1);
+  *p = 9;
+  p += 4;
+  p = WriteU16 (p, 0);
+  p = WriteU16 (p, 0);
+  WriteU32 (p, length);
+}
+
+uint8_t *
+PcapngFileWriter::Reserve (uint32_t size)
+{
+  if (m_current.size + size > m_current.data.size ())
+    {
+      if (m_current.size > 0)
+        {
+          Submit ();
+        }
+      if (size > m_current.data.size ())
+        {
+          m_current.data.resize (size);
+        }
+    }
+  uint8_t *start = &m_current.data[m_current.size];
+  m_current.size += size;
+  return start;
+}
+
+void
+PcapngFileWriter::Submit (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::unique_lock<std::mutex> lock (m_mutex);
+  m_pending.push_back (std::move (m_current));
+  if (m_free.empty () && m_buffers < PCAPNG_MAX_BUFFERS)
+    {
+      m_buffers++;
+      lock.unlock ();
+      m_filled.notify_one ();
+      m_current.data.assign (m_bufferSize, 0);
+      m_current.size = 0;
+      return;
+    }
+  m_filled.notify_one ();
+  if (m_free.empty ())
+    {
+      NS_LOG_LOGIC ("Wait for the writer");
+      m_written.wait (lock, [this] () {
+                        return !m_free.empty ();
+                      });
+    }
+  m_current = std::move (m_free.back ());
+  m_free.pop_back ();
+  m_current.size = 0;
+}
+
+void
+PcapngFileWriter::WriteBuffers (void)
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (true)
+    {
+      m_filled.wait (lock, [this] () {
+                       return m_closing || !m_pending.empty ();
+                     });
+      if (m_pending.empty ())
+        {
+          break;
+        }
+      OutputBuffer buffer = std::move (m_pending.front ());
+      m_pending.pop_front ();
+      lock.unlock ();
+      m_file.write (reinterpret_cast<const char *> (buffer.data.data ()), buffer.size);
+      lock.lock ();
+      m_free.push_back (std::move (buffer));
+      m_written.notify_one ();
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,227 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAPNG_FILE_WRITER_H
+#define PCAPNG_FILE_WRITER_H
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/header.h"
+#include "ns3/callback.h"
+
+namespace ns3 {
+
+class NetDevice;
+
+/**
+ * \ingroup network
+ *
+ * \brief Write the packets of many devices to a single pcapng file
+ *
+ * Unlike PcapFileWrapper, which writes one classic pcap file per device,
+ * a PcapngFileWriter writes one pcapng file with an Interface Description
+ * Block per device, each with its own data link type and named after the
+ * device (e.g. "/NodeList/3/DeviceList/0"), and an Enhanced Packet Block
+ * per packet, timestamped in nanoseconds.  Wireshark opens such a file
+ * directly.
+ *
+ * The blocks are serialized into a buffer of BufferSize bytes, which is
+ * handed to a writer thread when full, so the simulation only copies the
+ * packet bytes.  When the writer thread falls behind by several buffers,
+ * the simulation waits for it.
+ *
+ * A capture filter restricts the packets written, e.g. to the devices of
+ * some nodes or to some packets.  The packets are written by Write, which
+ * does not apply the filter: the callers check Accept first, so that a
+ * filtered out packet costs only the filter, and not the synthesis of the
+ * link layer headers or the copy of its bytes.  The trace sinks connected
+ * by the helpers (WifiPhyHelper::EnablePcapng, CsmaHelper::EnablePcapng)
+ * do so.
+ */
+class PcapngFileWriter : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PcapngFileWriter ();
+  virtual ~PcapngFileWriter ();
+
+  /**
+   * Capture filter: returns true if a packet of a device is written.  The
+   * device is 0 for an interface without device.
+   */
+  typedef Callback<bool, Ptr<NetDevice>, Ptr<const Packet> > CaptureFilterCallback;
+
+  /**
+   * Create the file, write its section header and the description of the
+   * interfaces already added, and start the writer thread.
+   *
+   * \param filename the name of the file
+   */
+  void Open (std::string filename);
+  /**
+   * Flush the buffers and close the file.
+   *
+   * Called by DoDispose if needed.
+   */
+  void Close (void);
+  /**
+   * \return true if a file is open
+   */
+  bool IsOpen (void) const;
+
+  /**
+   * Add an interface, whose description is written to the file.
+   *
+   * \param device the device captured, or 0
+   * \param dataLinkType the data link type of the packets of the interface,
+   * e.g. PcapHelper::DLT_EN10MB
+   * \param name the name of the interface, by default the path of the device
+   * \return the interface id, to pass to Write
+   */
+  uint32_t AddInterface (Ptr<NetDevice> device, uint32_t dataLinkType, std::string name = "");
+  /**
+   * \return the number of interfaces
+   */
+  uint32_t GetNInterfaces (void) const;
+  /**
+   * \param interface the interface id
+   * \return the data link type of the interface
+   */
+  uint32_t GetDataLinkType (uint32_t interface) const;
+
+  /**
+   * Set the capture filter.  By default, all the packets are accepted.
+   *
+   * \param filter the capture filter
+   */
+  void SetCaptureFilter (CaptureFilterCallback filter);
+  /**
+   * Apply the capture filter to a packet.
+   *
+   * \param interface the interface id
+   * \param p the packet
+   * \return true if the packet must be written
+   */
+  bool Accept (uint32_t interface, Ptr<const Packet> p) const;
+
+  /**
+   * Write a packet captured on an interface now.
+   *
+   * \param interface the interface id
+   * \param p the packet
+   */
+  void Write (uint32_t interface, Ptr<const Packet> p);
+  /**
+   * Write a packet captured on an interface now, preceded by a header
+   * which is not part of the packet (e.g. a RadiotapHeader).
+   *
+   * \param interface the interface id
+   * \param header the header
+   * \param p the packet
+   */
+  void Write (uint32_t interface, const Header &header, Ptr<const Packet> p);
+  /**
+   * \return the number of packets written
+   */
+  uint64_t GetPacketCount (void) const;
+
+  /**
+   * Trace sink writing the packets of a trace source of signature
+   * ns3::Packet::TracedCallback which are accepted by the capture filter.
+   *
+   * \param writer the writer
+   * \param interface the interface id
+   * \param p the packet
+   */
+  static void DefaultSink (Ptr<PcapngFileWriter> writer, uint32_t interface, Ptr<const Packet> p);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /** A captured interface. */
+  struct Interface
+  {
+    Ptr<NetDevice> device;  //!< the device, or 0
+    uint32_t dataLinkType;  //!< the data link type
+    std::string name;       //!< the name of the interface
+  };
+
+  /** A buffer of serialized blocks. */
+  struct OutputBuffer
+  {
+    std::vector<uint8_t> data; //!< the bytes
+    std::size_t size;          //!< the number of bytes used
+  };
+
+  /**
+   * Reserve the space of a block in the current buffer, after handing it
+   * to the writer thread if it is too full.
+   *
+   * \param size the size of the block
+   * \return the start of the block
+   */
+  uint8_t * Reserve (uint32_t size);
+  /**
+   * Hand the current buffer to the writer thread and take a free one,
+   * waiting for the writer thread if needed.
+   */
+  void Submit (void);
+  /**
+   * Write the interface description block of an interface.
+   *
+   * \param interface the interface
+   */
+  void WriteInterfaceDescription (const Interface &interface);
+  /**
+   * Write the buffers handed by Submit, until the writer is closed.
+   */
+  void WriteBuffers (void);
+
+  uint32_t m_bufferSize;               //!< size of a buffer, in bytes
+  uint32_t m_snapLen;                  //!< maximum number of bytes captured per packet
+  std::vector<Interface> m_interfaces; //!< the interfaces, by id
+  CaptureFilterCallback m_filter;      //!< the capture filter
+  uint64_t m_packets;                  //!< number of packets written
+  OutputBuffer m_current;              //!< the buffer being filled
+  std::ofstream m_file;                //!< the file
+  std::thread m_writer;                //!< the writer thread
+  std::mutex m_mutex;                  //!< mutex of the buffer queues
+  std::condition_variable m_filled;    //!< signals a buffer to write
+  std::condition_variable m_written;   //!< signals a free buffer
+  std::deque<OutputBuffer> m_pending;  //!< buffers to write
+  std::vector<OutputBuffer> m_free;    //!< buffers written, to reuse
+  uint32_t m_buffers;                  //!< number of buffers allocated
+  bool m_closing;                      //!< whether the writer must exit
+};
+
+} // namespace ns3
+
+#endif /* PCAPNG_FILE_WRITER_H */
@@ -0,0 +1,185 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include "link-budget-cache.h"
+#include "propagation-loss-model.h"
+#include "propagation-delay-model.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LinkBudgetCache");
+
+LinkBudgetCache::LinkBudgetCache ()
+  : m_capacity (0),
+    m_cacheDelay (false),
+    m_hits (0),
+    m_misses (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LinkBudgetCache::~LinkBudgetCache ()
+{
+  NS_LOG_FUNCTION (this);
+  Clear ();
+}
+
+void
+LinkBudgetCache::Reserve (uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  if (n > m_capacity)
+    {
+      Grow (n);
+    }
+}
+
+uint32_t
+LinkBudgetCache::Add (Ptr<MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+  NS_ASSERT (mobility != 0);
+  uint32_t i = m_mobility.size ();
+  m_mobility.push_back (mobility);
+  m_static.push_back (mobility->GetVelocity ().GetLength () == 0);
+  mobility->TraceConnect ("CourseChange", std::to_string (i),
+                          MakeCallback (&LinkBudgetCache::CourseChanged, this));
+  if (m_mobility.size () > m_capacity)
+    {
+      Grow (std::max<uint32_t> (2 * m_capacity, m_mobility.size ()));
+    }
+  return i;
+}
+
+uint32_t
+LinkBudgetCache::GetN (void) const
+{
+  return m_mobility.size ();
+}
+
+void
+LinkBudgetCache::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_mobility.size (); i++)
+    {
+      m_mobility[i]->TraceDisconnect ("CourseChange", std::to_string (i),
+                                      MakeCallback (&LinkBudgetCache::CourseChanged, this));
+    }
+  m_mobility.clear ();
+  m_static.clear ();
+  m_entries.clear ();
+  m_capacity = 0;
+  m_loss = 0;
+  m_delay = 0;
+  m_next = 0;
+}
+
+double
+LinkBudgetCache::CalcRxPower (uint32_t a, uint32_t b, double txPowerDbm,
+                              Ptr<const PropagationLossModel> loss,
+                              Ptr<const PropagationDelayModel> delayModel,
+                              Time &delay)
+{
+  NS_ASSERT (a < m_mobility.size () && b < m_mobility.size ());
+  if (loss != m_loss || delayModel != m_delay)
+    {
+      NS_LOG_DEBUG ("New propagation models, cache invalidated");
+      Entry invalid = {0, 0, Time (), false};
+      std::fill (m_entries.begin (), m_entries.end (), invalid);
+      m_loss = loss;
+      m_delay = delayModel;
+      m_cacheDelay = delayModel->IsDeterministic ();
+    }
+  Entry &entry = m_entries[a * m_capacity + b];
+  double rxPowerDbm;
+  if (entry.valid && entry.txPowerDbm == txPowerDbm)
+    {
+      m_hits++;
+      rxPowerDbm = entry.rxPowerDbm;
+      delay = m_cacheDelay ? entry.delay : delayModel->GetDelay (m_mobility[a], m_mobility[b]);
+    }
+  else
+    {
+      m_misses++;
+      rxPowerDbm = loss->CalcDeterministicRxPower (txPowerDbm, m_mobility[a], m_mobility[b], m_next);
+      delay = delayModel->GetDelay (m_mobility[a], m_mobility[b]);
+      if (m_static[a] && m_static[b])
+        {
+          entry.txPowerDbm = txPowerDbm;
+          entry.rxPowerDbm = rxPowerDbm;
+          entry.delay = delay;
+          entry.valid = true;
+        }
+    }
+  if (m_next != 0)
+    {
+      rxPowerDbm = m_next->CalcRxPower (rxPowerDbm, m_mobility[a], m_mobility[b]);
+    }
+  return rxPowerDbm;
+}
+
+uint64_t
+LinkBudgetCache::GetNHits (void) const
+{
+  return m_hits;
+}
+
+uint64_t
+LinkBudgetCache::GetNMisses (void) const
+{
+  return m_misses;
+}
+
+void
+LinkBudgetCache::Invalidate (uint32_t i)
+{
+  uint32_t n = m_mobility.size ();
+  for (uint32_t j = 0; j < n; j++)
+    {
+      m_entries[i * m_capacity + j].valid = false;
+      m_entries[j * m_capacity + i].valid = false;
+    }
+}
+
+void
+LinkBudgetCache::Grow (uint32_t capacity)
+{
+  NS_LOG_FUNCTION (this << capacity);
+  Entry invalid = {0, 0, Time (), false};
+  std::vector<Entry> entries (static_cast<std::size_t> (capacity) * capacity, invalid);
+  uint32_t n = std::min<uint32_t> (m_mobility.size (), m_capacity);
+  for (uint32_t a = 0; a < n; a++)
+    {
+      std::copy (m_entries.begin () + a * m_capacity, m_entries.begin () + a * m_capacity + n,
+                 entries.begin () + a * capacity);
+    }
+  m_entries.swap (entries);
+  m_capacity = capacity;
+}
+
+void
+LinkBudgetCache::CourseChanged (std::string context, Ptr<const MobilityModel> mobility)
+{
+  uint32_t i = std::stoul (context);
+  NS_LOG_FUNCTION (this << i);
+  Invalidate (i);
+  m_static[i] = mobility->GetVelocity ().GetLength () == 0;
+}
+
+} // namespace ns3
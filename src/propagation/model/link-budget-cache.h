@@ -0,0 +1,151 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LINK_BUDGET_CACHE_H
+#define LINK_BUDGET_CACHE_H
+
+#include <string>
+#include <vector>
+#include "ns3/mobility-model.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+class PropagationLossModel;
+class PropagationDelayModel;
+
+/**
+ * \ingroup propagation
+ * \brief Caches the deterministic part of the link budget between the
+ * static nodes of a channel.
+ *
+ * The nodes are identified by the index at which they were added, and
+ * the RX power and the delay of every (source, destination) pair are
+ * kept in a dense array addressed by these indices.  Only the
+ * deterministic models at the head of the loss chain (see
+ * PropagationLossModel::CalcDeterministicRxPower) are cached; the models
+ * chained after them, such as NakagamiPropagationLossModel, are still
+ * evaluated, and sample their random variables, on every call.  A
+ * deterministic delay model (see PropagationDelayModel::IsDeterministic)
+ * is cached as well.
+ *
+ * A pair is only cached while both nodes are static, i.e. their mobility
+ * model reports a null velocity.  The entries of a node are invalidated
+ * when its mobility model notifies a course change.
+ *
+ * The array holds one entry per ordered pair of nodes, so that the
+ * memory used grows with the square of the number of nodes.  Its rows
+ * are laid out for a capacity which doubles when it is exceeded, so that
+ * adding N nodes costs O(N^2); Reserve sizes it once when the number of
+ * nodes is known.
+ */
+class LinkBudgetCache
+{
+public:
+  LinkBudgetCache ();
+  ~LinkBudgetCache ();
+
+  /**
+   * Size the array for a number of nodes
+   * \param n the number of nodes
+   */
+  void Reserve (uint32_t n);
+  /**
+   * Add a node to the cache; the entries of the other nodes stay valid
+   * \param mobility the mobility model of the node
+   * \return the index of the node
+   */
+  uint32_t Add (Ptr<MobilityModel> mobility);
+  /**
+   * \return the number of nodes
+   */
+  uint32_t GetN (void) const;
+  /**
+   * Remove all the nodes
+   */
+  void Clear (void);
+
+  /**
+   * Compute the RX power and the delay from one node to another, using
+   * the cached deterministic part when it is valid.
+   *
+   * The models may differ from one call to the other, in which case the
+   * whole cache is invalidated.
+   *
+   * \param a the index of the source
+   * \param b the index of the destination
+   * \param txPowerDbm the transmission power (in dBm)
+   * \param loss the propagation loss model
+   * \param delayModel the propagation delay model
+   * \param [out] delay the propagation delay
+   * \return the reception power (in dBm)
+   */
+  double CalcRxPower (uint32_t a, uint32_t b, double txPowerDbm,
+                      Ptr<const PropagationLossModel> loss,
+                      Ptr<const PropagationDelayModel> delayModel,
+                      Time &delay);
+
+  /**
+   * \return the number of calls served from the cache
+   */
+  uint64_t GetNHits (void) const;
+  /**
+   * \return the number of calls that computed the link budget
+   */
+  uint64_t GetNMisses (void) const;
+
+private:
+  /// The cached link budget of a pair of nodes
+  struct Entry
+  {
+    double txPowerDbm; //!< the TX power of the cached RX power, in dBm
+    double rxPowerDbm; //!< the RX power after the deterministic models, in dBm
+    Time delay;        //!< the propagation delay
+    bool valid;        //!< whether the entry is valid
+  };
+
+  /**
+   * Invalidate the entries of a node
+   * \param i the index of the node
+   */
+  void Invalidate (uint32_t i);
+  /**
+   * Lay the array out again for a new capacity, keeping the entries
+   * \param capacity the number of nodes of a row
+   */
+  void Grow (uint32_t capacity);
+  /**
+   * Invalidate the entries of a node whose mobility model changed course
+   * \param context the index of the node
+   * \param mobility the mobility model
+   */
+  void CourseChanged (std::string context, Ptr<const MobilityModel> mobility);
+
+  std::vector<Ptr<MobilityModel> > m_mobility; //!< mobility model of each node
+  std::vector<bool> m_static;                  //!< whether each node is static
+  std::vector<Entry> m_entries;                //!< entry of each pair, by source then destination
+  uint32_t m_capacity;                         //!< number of entries of a row
+  Ptr<const PropagationLossModel> m_loss;      //!< loss model of the entries
+  Ptr<const PropagationDelayModel> m_delay;    //!< delay model of the entries
+  Ptr<const PropagationLossModel> m_next;      //!< first model of the loss chain that is not cached
+  bool m_cacheDelay;                           //!< whether the delay is cached
+  uint64_t m_hits;                             //!< calls served from the cache
+  uint64_t m_misses;                           //!< calls that computed the link budget
+};
+
+} // namespace ns3
+
+#endif /* LINK_BUDGET_CACHE_H */
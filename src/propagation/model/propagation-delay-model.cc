@@ -41,6 +41,12 @@ PropagationDelayModel::~PropagationDelayModel ()
 {
 }
 
+bool
+PropagationDelayModel::IsDeterministic (void) const
+{
+  return false;
+}
+
 int64_t
 PropagationDelayModel::AssignStreams (int64_t stream)
 {
@@ -113,6 +119,11 @@ ConstantSpeedPropagationDelayModel::GetDelay (Ptr<MobilityModel> a, Ptr<Mobility
   double seconds = distance / m_speed;
   return Seconds (seconds);
 }
+bool
+ConstantSpeedPropagationDelayModel::IsDeterministic (void) const
+{
+  return true;
+}
 void
 ConstantSpeedPropagationDelayModel::SetSpeed (double speed)
 {
@@ -52,6 +52,15 @@ public:
    * source and destination.
    */
   virtual Time GetDelay (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const = 0;
+  /**
+   * \brief Whether the delay only depends on the positions of the source
+   * and of the destination, so that it may be cached between static
+   * nodes.  Models that draw random variables are not deterministic,
+   * which is the default.
+   *
+   * \returns true if the model is deterministic
+   */
+  virtual bool IsDeterministic (void) const;
   /**
    * If this delay model uses objects of type RandomVariableStream,
    * set the stream numbers to the integers starting with the offset
@@ -114,6 +123,7 @@ public:
    */
   ConstantSpeedPropagationDelayModel ();
   virtual Time GetDelay (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  virtual bool IsDeterministic (void) const;
   /**
    * \param speed the new speed (m/s)
    */
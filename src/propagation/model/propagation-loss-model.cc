@@ -26,6 +26,7 @@
 #include "ns3/mobility-model.h"
 #include "ns3/boolean.h"
 #include "ns3/double.h"
+#include "ns3/uinteger.h"
 #include "ns3/string.h"
 #include "ns3/pointer.h"
 #include <cmath>
@@ -82,6 +83,32 @@ PropagationLossModel::CalcRxPower (double txPowerDbm,
   return self;
 }
 
+bool
+PropagationLossModel::IsDeterministic (void) const
+{
+  return false;
+}
+
+double
+PropagationLossModel::CalcDeterministicRxPower (double txPowerDbm,
+                                                Ptr<MobilityModel> a,
+                                                Ptr<MobilityModel> b,
+                                                Ptr<const PropagationLossModel> &next) const
+{
+  if (!IsDeterministic ())
+    {
+      next = this;
+      return txPowerDbm;
+    }
+  double self = DoCalcRxPower (txPowerDbm, a, b);
+  if (m_next != 0)
+    {
+      return m_next->CalcDeterministicRxPower (self, a, b, next);
+    }
+  next = 0;
+  return self;
+}
+
 int64_t
 PropagationLossModel::AssignStreams (int64_t stream)
 {
@@ -271,6 +298,12 @@ FriisPropagationLossModel::DoCalcRxPower (double txPowerDbm,
   return txPowerDbm - std::max (lossDb, m_minLoss);
 }
 
+bool
+FriisPropagationLossModel::IsDeterministic (void) const
+{
+  return true;
+}
+
 int64_t
 FriisPropagationLossModel::DoAssignStreams (int64_t stream)
 {
@@ -445,6 +478,12 @@ TwoRayGroundPropagationLossModel::DoCalcRxPower (double txPowerDbm,
     }
 }
 
+bool
+TwoRayGroundPropagationLossModel::IsDeterministic (void) const
+{
+  return true;
+}
+
 int64_t
 TwoRayGroundPropagationLossModel::DoAssignStreams (int64_t stream)
 {
@@ -534,6 +573,12 @@ LogDistancePropagationLossModel::DoCalcRxPower (double txPowerDbm,
   return txPowerDbm + rxc;
 }
 
+bool
+LogDistancePropagationLossModel::IsDeterministic (void) const
+{
+  return true;
+}
+
 int64_t
 LogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
 {
@@ -636,6 +681,12 @@ ThreeLogDistancePropagationLossModel::DoCalcRxPower (double txPowerDbm,
   return txPowerDbm - pathLossDb;
 }
 
+bool
+ThreeLogDistancePropagationLossModel::IsDeterministic (void) const
+{
+  return true;
+}
+
 int64_t
 ThreeLogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
 {
@@ -687,7 +738,13 @@ NakagamiPropagationLossModel::GetTypeId (void)
                    "Access to the underlying GammaRandomVariable",
                    StringValue ("ns3::GammaRandomVariable"),
                    MakePointerAccessor (&NakagamiPropagationLossModel::m_gammaRandomVariable),
-                   MakePointerChecker<GammaRandomVariable> ());
+                   MakePointerChecker<GammaRandomVariable> ())
+    .AddAttribute ("BatchSize",
+                   "The number of fading values drawn at once from the Erlang "
+                   "or Gamma random variable for each distance field.",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&NakagamiPropagationLossModel::m_batchSize),
+                   MakeUintegerChecker<uint32_t> (1));
   ;
   return tid;
 
@@ -695,6 +752,35 @@ NakagamiPropagationLossModel::GetTypeId (void)
 
 NakagamiPropagationLossModel::NakagamiPropagationLossModel ()
 {
+  for (uint32_t i = 0; i < N_FIELDS; i++)
+    {
+      m_batches[i].m = 0;
+      m_batches[i].next = 0;
+    }
+}
+
+double
+NakagamiPropagationLossModel::GetFadingValue (uint32_t field, double m) const
+{
+  Batch &batch = m_batches[field];
+  if (batch.m != m || batch.next == batch.values.size ())
+    {
+      batch.m = m;
+      batch.values.resize (m_batchSize);
+      batch.next = 0;
+      // switch between Erlang- and Gamma distributions: this is only for
+      // speed. (Gamma is equal to Erlang for any positive integer m.)
+      unsigned int int_m = static_cast<unsigned int>(std::floor (m));
+      if (int_m == m)
+        {
+          m_erlangRandomVariable->GetValues (int_m, 1.0 / m, batch.values.data (), batch.values.size ());
+        }
+      else
+        {
+          m_gammaRandomVariable->GetValues (m, 1.0 / m, batch.values.data (), batch.values.size ());
+        }
+    }
+  return batch.values[batch.next++];
 }
 
 double
@@ -707,17 +793,21 @@ NakagamiPropagationLossModel::DoCalcRxPower (double txPowerDbm,
   double distance = a->GetDistanceFrom (b);
   NS_ASSERT (distance >= 0);
 
+  uint32_t field;
   double m;
   if (distance < m_distance1)
     {
+      field = 0;
       m = m_m0;
     }
   else if (distance < m_distance2)
     {
+      field = 1;
       m = m_m1;
     }
   else
     {
+      field = 2;
       m = m_m2;
     }
 
@@ -725,20 +815,8 @@ NakagamiPropagationLossModel::DoCalcRxPower (double txPowerDbm,
   // Rayleigh distribution.
   double powerW = std::pow (10, (txPowerDbm - 30) / 10);
 
-  double resultPowerW;
-
-  // switch between Erlang- and Gamma distributions: this is only for
-  // speed. (Gamma is equal to Erlang for any positive integer m.)
-  unsigned int int_m = static_cast<unsigned int>(std::floor (m));
-
-  if (int_m == m)
-    {
-      resultPowerW = m_erlangRandomVariable->GetValue (int_m, powerW / m);
-    }
-  else
-    {
-      resultPowerW = m_gammaRandomVariable->GetValue (m, powerW / m);
-    }
+  // the fading values are drawn for a unit mean power
+  double resultPowerW = powerW * GetFadingValue (field, m);
 
   double resultPowerDbm = 10 * std::log10 (resultPowerW) + 30;
 
@@ -754,6 +832,12 @@ NakagamiPropagationLossModel::DoAssignStreams (int64_t stream)
 {
   m_erlangRandomVariable->SetStream (stream);
   m_gammaRandomVariable->SetStream (stream + 1);
+  // draw the next values from the new streams
+  for (uint32_t i = 0; i < N_FIELDS; i++)
+    {
+      m_batches[i].values.clear ();
+      m_batches[i].next = 0;
+    }
   return 2;
 }
 
@@ -924,6 +1008,12 @@ RangePropagationLossModel::DoCalcRxPower (double txPowerDbm,
     }
 }
 
+bool
+RangePropagationLossModel::IsDeterministic (void) const
+{
+  return true;
+}
+
 int64_t
 RangePropagationLossModel::DoAssignStreams (int64_t stream)
 {
@@ -28,6 +28,7 @@
 #include "ns3/object.h"
 #include "ns3/random-variable-stream.h"
 #include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -80,6 +81,19 @@ public:
    */
   Ptr<PropagationLossModel> GetNext ();
 
+  /**
+   * \brief Whether the loss of this model, not considering the models
+   * chained to it, only depends on the transmit power and on the
+   * positions of the source and of the destination.
+   *
+   * The loss of a deterministic model between two static nodes may be
+   * cached, see LinkBudgetCache.  Models that draw random variables or
+   * depend on time are not deterministic, which is the default.
+   *
+   * \returns true if the model is deterministic
+   */
+  virtual bool IsDeterministic (void) const;
+
   /**
    * Returns the Rx Power taking into account all the PropagationLossModel(s)
    * chained to the current one.
@@ -93,6 +107,25 @@ public:
                       Ptr<MobilityModel> a,
                       Ptr<MobilityModel> b) const;
 
+  /**
+   * Returns the Rx Power taking into account the deterministic models at
+   * the head of the chain: the current one, if it is deterministic, and
+   * the models chained to it up to the first model that is not.  The Rx
+   * Power of the whole chain is then that of the first model that is not
+   * deterministic, if any, applied to the returned Rx Power.
+   *
+   * \param txPowerDbm current transmission power (in dBm)
+   * \param a the mobility model of the source
+   * \param b the mobility model of the destination
+   * \param [out] next the first model of the chain that is not
+   * deterministic, or 0 if the whole chain is deterministic
+   * \returns the reception power after the deterministic models (in dBm)
+   */
+  double CalcDeterministicRxPower (double txPowerDbm,
+                                   Ptr<MobilityModel> a,
+                                   Ptr<MobilityModel> b,
+                                   Ptr<const PropagationLossModel> &next) const;
+
   /**
    * If this loss model uses objects of type RandomVariableStream,
    * set the stream numbers to the integers starting with the offset
@@ -267,6 +300,8 @@ public:
    */
   static TypeId GetTypeId (void);
   FriisPropagationLossModel ();
+
+  virtual bool IsDeterministic (void) const;
   /**
    * \param frequency (Hz)
    *
@@ -381,6 +416,8 @@ public:
   static TypeId GetTypeId (void);
   TwoRayGroundPropagationLossModel ();
 
+  virtual bool IsDeterministic (void) const;
+
   /**
    * \param frequency (Hz)
    *
@@ -494,6 +531,8 @@ public:
   static TypeId GetTypeId (void);
   LogDistancePropagationLossModel ();
 
+  virtual bool IsDeterministic (void) const;
+
   /**
    * \param n the path loss exponent.
    * Set the path loss exponent.
@@ -592,6 +631,8 @@ public:
   static TypeId GetTypeId (void);
   ThreeLogDistancePropagationLossModel ();
 
+  virtual bool IsDeterministic (void) const;
+
   // Parameters are all accessible via attributes.
 
 private:
@@ -651,6 +692,12 @@ private:
  *
  * For m = 1 the Nakagami-m distribution equals the Rayleigh distribution. Thus
  * this model also implements Rayleigh distribution based fast fading.
+ *
+ * A packet is faded once per receiver, so the fading values are drawn
+ * BatchSize at a time for a unit mean power, from the batch interface of
+ * the random variables, and scaled to the power of each packet.  The
+ * values used by a simulation only depend on the streams of the random
+ * variables and on BatchSize.
  */
 class NakagamiPropagationLossModel : public PropagationLossModel
 {
@@ -685,6 +732,25 @@ private:
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
 
+  /**
+   * \brief Get the next fading value of a distance field
+   * \param field the index of the distance field
+   * \param m the m parameter of the distance field
+   * \return a power gain drawn from the Nakagami-m distribution of unit mean
+   */
+  double GetFadingValue (uint32_t field, double m) const;
+
+  /// The fading values drawn for a distance field
+  struct Batch
+  {
+    double m;                   //!< m parameter of the values
+    std::vector<double> values; //!< values drawn
+    std::size_t next;           //!< index of the next value to use
+  };
+
+  /// Number of distance fields
+  static const uint32_t N_FIELDS = 3;
+
   double m_distance1; //!< Distance1
   double m_distance2; //!< Distance2
 
@@ -694,6 +760,9 @@ private:
 
   Ptr<ErlangRandomVariable>  m_erlangRandomVariable; //!< Erlang random variable
   Ptr<GammaRandomVariable> m_gammaRandomVariable;    //!< Gamma random variable
+
+  uint32_t m_batchSize;                 //!< number of fading values drawn at once
+  mutable Batch m_batches[N_FIELDS];    //!< fading values of each distance field
 };
 
 /**
@@ -834,6 +903,8 @@ public:
    */
   static TypeId GetTypeId (void);
   RangePropagationLossModel ();
+
+  virtual bool IsDeterministic (void) const;
 private:
   /**
    * \brief Copy constructor
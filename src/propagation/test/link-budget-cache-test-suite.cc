@@ -0,0 +1,178 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/link-budget-cache.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup propagation-test
+ * \ingroup tests
+ *
+ * \brief LinkBudgetCache test
+ *
+ * Checks that the cache gives the same RX powers and delays as the
+ * models, with a stochastic model chained after a deterministic one,
+ * that the pairs of static nodes are served from the cache, that the
+ * entries of a node are invalidated when it moves, and that they survive
+ * the addition of a node and the growth of the array.
+ */
+class LinkBudgetCacheTestCase : public TestCase
+{
+public:
+  LinkBudgetCacheTestCase ();
+  virtual ~LinkBudgetCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Create a LogDistance + Nakagami loss chain
+   * \return the head of the chain
+   */
+  static Ptr<PropagationLossModel> CreateChain (void);
+};
+
+LinkBudgetCacheTestCase::LinkBudgetCacheTestCase ()
+  : TestCase ("Cached link budgets match the propagation models")
+{
+}
+
+LinkBudgetCacheTestCase::~LinkBudgetCacheTestCase ()
+{
+}
+
+Ptr<PropagationLossModel>
+LinkBudgetCacheTestCase::CreateChain (void)
+{
+  Ptr<PropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel> ();
+  loss->SetNext (CreateObject<NakagamiPropagationLossModel> ());
+  loss->AssignStreams (1);
+  return loss;
+}
+
+void
+LinkBudgetCacheTestCase::DoRun (void)
+{
+  Ptr<PropagationLossModel> reference = CreateChain ();
+  Ptr<PropagationLossModel> loss = CreateChain ();
+  Ptr<PropagationDelayModel> delayModel = CreateObject<ConstantSpeedPropagationDelayModel> ();
+  // three static nodes and a moving one
+  const uint32_t n = 4;
+  LinkBudgetCache cache;
+  std::vector<Ptr<MobilityModel> > nodes;
+  for (uint32_t i = 0; i < n - 1; i++)
+    {
+      nodes.push_back (CreateObject<ConstantPositionMobilityModel> ());
+    }
+  Ptr<ConstantVelocityMobilityModel> moving = CreateObject<ConstantVelocityMobilityModel> ();
+  nodes.push_back (moving);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      nodes[i]->SetPosition (Vector (50 * i, 0, 0));
+    }
+  // setting the position stops the node
+  moving->SetVelocity (Vector (10, 0, 0));
+  for (uint32_t i = 0; i < n; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (cache.Add (nodes[i]), i, "Unexpected index");
+    }
+
+  Ptr<const PropagationLossModel> next;
+  reference->CalcDeterministicRxPower (16, nodes[0], nodes[1], next);
+  NS_TEST_ASSERT_MSG_EQ (next, reference->GetNext (), "Nakagami should not be deterministic");
+
+  for (uint32_t round = 0; round < 3; round++)
+    {
+      if (round == 2)
+        {
+          // moving a node invalidates its entries
+          nodes[1]->SetPosition (Vector (20, 10, 0));
+        }
+      for (uint32_t a = 0; a < n; a++)
+        {
+          for (uint32_t b = 0; b < n; b++)
+            {
+              if (a == b)
+                {
+                  continue;
+                }
+              Time delay;
+              double rxPowerDbm = cache.CalcRxPower (a, b, 16, loss, delayModel, delay);
+              NS_TEST_EXPECT_MSG_EQ (rxPowerDbm, reference->CalcRxPower (16, nodes[a], nodes[b]),
+                                     "Wrong RX power from " << a << " to " << b);
+              NS_TEST_EXPECT_MSG_EQ (delay, delayModel->GetDelay (nodes[a], nodes[b]),
+                                     "Wrong delay from " << a << " to " << b);
+            }
+        }
+    }
+  // the 6 static pairs are served from the cache in the second round,
+  // and the 2 not involving node 1 in the third round
+  NS_TEST_EXPECT_MSG_EQ (cache.GetNHits (), 6 + 2, "Unexpected number of cache hits");
+  NS_TEST_EXPECT_MSG_EQ (cache.GetNMisses (), 3 * 12 - 8, "Unexpected number of cache misses");
+
+  // a node which stops is cached
+  moving->SetVelocity (Vector (0, 0, 0));
+  Time delay;
+  cache.CalcRxPower (0, n - 1, 16, loss, delayModel, delay);
+  cache.CalcRxPower (0, n - 1, 16, loss, delayModel, delay);
+  NS_TEST_EXPECT_MSG_EQ (cache.GetNHits (), 9, "A node which stopped should be cached");
+
+  // adding nodes keeps the cached entries, whether the array grows or not
+  Ptr<MobilityModel> added = CreateObject<ConstantPositionMobilityModel> ();
+  added->SetPosition (Vector (0, 80, 0));
+  NS_TEST_ASSERT_MSG_EQ (cache.Add (added), n, "Unexpected index");
+  cache.Reserve (64);
+  cache.Add (CreateObject<ConstantPositionMobilityModel> ());
+  NS_TEST_ASSERT_MSG_EQ (cache.GetN (), n + 2, "Unexpected number of nodes");
+  cache.CalcRxPower (0, n - 1, 16, loss, delayModel, delay);
+  NS_TEST_EXPECT_MSG_EQ (cache.GetNHits (), 10, "Entry lost when adding a node");
+  NS_TEST_EXPECT_MSG_EQ (delay, delayModel->GetDelay (nodes[0], nodes[n - 1]),
+                         "Wrong delay after adding a node");
+  cache.CalcRxPower (n, 0, 16, loss, delayModel, delay);
+  NS_TEST_EXPECT_MSG_EQ (cache.GetNHits (), 10, "A new node should not be cached yet");
+  NS_TEST_EXPECT_MSG_EQ (delay, delayModel->GetDelay (added, nodes[0]),
+                         "Wrong delay from a new node");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup propagation-test
+ * \ingroup tests
+ *
+ * \brief LinkBudgetCache TestSuite
+ */
+class LinkBudgetCacheTestSuite : public TestSuite
+{
+public:
+  LinkBudgetCacheTestSuite ();
+};
+
+LinkBudgetCacheTestSuite::LinkBudgetCacheTestSuite ()
+  : TestSuite ("propagation-link-budget-cache", UNIT)
+{
+  AddTestCase (new LinkBudgetCacheTestCase, TestCase::QUICK);
+}
+
+static LinkBudgetCacheTestSuite g_linkBudgetCacheTestSuite; ///< the test suite
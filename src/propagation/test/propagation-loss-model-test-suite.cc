@@ -21,9 +21,11 @@
 #include "ns3/test.h"
 #include "ns3/config.h"
 #include "ns3/double.h"
+#include "ns3/uinteger.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/constant-position-mobility-model.h"
 #include "ns3/simulator.h"
+#include <cmath>
 
 using namespace ns3;
 
@@ -436,6 +438,77 @@ RangePropagationLossModelTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class NakagamiPropagationLossModelTestCase : public TestCase
+{
+public:
+  NakagamiPropagationLossModelTestCase ();
+  virtual ~NakagamiPropagationLossModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+NakagamiPropagationLossModelTestCase::NakagamiPropagationLossModelTestCase ()
+  : TestCase ("Test NakagamiPropagationLossModel")
+{
+}
+
+NakagamiPropagationLossModelTestCase::~NakagamiPropagationLossModelTestCase ()
+{
+}
+
+void
+NakagamiPropagationLossModelTestCase::DoRun (void)
+{
+  Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0,0,0));
+  Ptr<MobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+
+  // the default m are 1.5 (Gamma), 0.75 (Gamma) and 0.75; use an integer
+  // m (Erlang) in the last distance field
+  Ptr<NakagamiPropagationLossModel> lossModel = CreateObject<NakagamiPropagationLossModel> ();
+  lossModel->SetAttribute ("m2", DoubleValue (2));
+  lossModel->SetAttribute ("BatchSize", UintegerValue (100));
+  lossModel->AssignStreams (1);
+
+  // the fading preserves the mean power, in W, in each distance field
+  double txPwrdBm = 10.0;
+  double distances[] = {10, 100, 300};
+  const uint32_t samples = 20000;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      b->SetPosition (Vector (distances[i],0,0));
+      double sum = 0;
+      for (uint32_t j = 0; j < samples; j++)
+        {
+          double resultdBm = lossModel->CalcRxPower (txPwrdBm, a, b);
+          sum += std::pow (10.0, resultdBm / 10);
+        }
+      NS_TEST_EXPECT_MSG_EQ_TOL (sum / samples, 10.0, 0.5, "Unexpected mean rcv power at " << distances[i] << " m");
+    }
+
+  // the values drawn before the streams are assigned are discarded; use
+  // Erlang values only, since a GammaRandomVariable keeps a normal value
+  // across SetStream
+  Ptr<NakagamiPropagationLossModel> other = CreateObject<NakagamiPropagationLossModel> ();
+  other->SetAttribute ("BatchSize", UintegerValue (100));
+  for (Ptr<NakagamiPropagationLossModel> model : {lossModel, other})
+    {
+      model->SetAttribute ("m0", DoubleValue (1));
+      model->SetAttribute ("m1", DoubleValue (3));
+      model->SetAttribute ("m2", DoubleValue (2));
+    }
+  lossModel->AssignStreams (2);
+  other->AssignStreams (2);
+  for (uint32_t j = 0; j < 300; j++)
+    {
+      b->SetPosition (Vector (distances[j % 3],0,0));
+      NS_TEST_ASSERT_MSG_EQ (lossModel->CalcRxPower (txPwrdBm, a, b), other->CalcRxPower (txPwrdBm, a, b),
+                             "Fading values drawn before AssignStreams are used");
+    }
+  Simulator::Destroy ();
+}
+
 class PropagationLossModelsTestSuite : public TestSuite
 {
 public:
@@ -450,6 +523,7 @@ PropagationLossModelsTestSuite::PropagationLossModelsTestSuite ()
   AddTestCase (new LogDistancePropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new MatrixPropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new RangePropagationLossModelTestCase, TestCase::QUICK);
+  AddTestCase (new NakagamiPropagationLossModelTestCase, TestCase::QUICK);
 }
 
 static PropagationLossModelsTestSuite propagationLossModelsTestSuite;
@@ -0,0 +1,372 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include "ns3/results-sink.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/enum.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+
+#if defined (HAVE_SQLITE3) && defined (HAVE_SEMAPHORE_H)
+#include "ns3/sqlite-output.h"
+#define RESULTS_SINK_HAS_SQLITE
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ResultsSink");
+
+NS_OBJECT_ENSURE_REGISTERED (ResultsSink);
+
+#ifdef RESULTS_SINK_HAS_SQLITE
+/**
+ * \brief Quote an SQL identifier
+ * \param name the table or column name
+ * \return the name between double quotes, with its double quotes doubled
+ */
+static std::string
+QuoteIdentifier (const std::string &name)
+{
+  std::string quoted = "\"";
+  for (std::string::const_iterator c = name.begin (); c != name.end (); c++)
+    {
+      quoted += (*c == '"' ? "\"\"" : std::string (1, *c));
+    }
+  return quoted + "\"";
+}
+#endif
+
+TypeId
+ResultsSink::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ResultsSink")
+    .SetParent<Object> ()
+    .SetGroupName ("Stats")
+    .AddConstructor<ResultsSink> ()
+    .AddAttribute ("FileName",
+                   "The CSV file or the SQLite database written.",
+                   StringValue ("results.csv"),
+                   MakeStringAccessor (&ResultsSink::m_fileName),
+                   MakeStringChecker ())
+    .AddAttribute ("Format",
+                   "The output format.",
+                   EnumValue (ResultsSink::CSV),
+                   MakeEnumAccessor (&ResultsSink::m_format),
+                   MakeEnumChecker (ResultsSink::CSV, "Csv",
+                                    ResultsSink::SQLITE, "Sqlite"))
+    .AddAttribute ("TableName",
+                   "The table written in SQLite format.",
+                   StringValue ("results"),
+                   MakeStringAccessor (&ResultsSink::m_tableName),
+                   MakeStringChecker ())
+    .AddAttribute ("BufferSize",
+                   "The number of rows buffered in memory before they are written.",
+                   UintegerValue (4096),
+                   MakeUintegerAccessor (&ResultsSink::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+ResultsSink::ResultsSink ()
+  : m_nSet (0),
+    m_buffered (0),
+    m_rows (0),
+    m_open (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ResultsSink::~ResultsSink ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ResultsSink::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+  if (m_csv.is_open ())
+    {
+      m_csv.close ();
+    }
+  m_db = 0;
+  Object::DoDispose ();
+}
+
+uint32_t
+ResultsSink::AddColumn (const std::string &name, ColumnType type)
+{
+  NS_LOG_FUNCTION (this << name << type);
+  NS_ABORT_MSG_IF (m_open || m_nSet > 0, "Columns must be added before the first row");
+  Column column;
+  column.name = name;
+  column.type = type;
+  m_columns.push_back (column);
+  m_set.push_back (false);
+  return m_columns.size () - 1;
+}
+
+uint32_t
+ResultsSink::GetNColumns (void) const
+{
+  return m_columns.size ();
+}
+
+void
+ResultsSink::CheckSet (uint32_t column, ColumnType type)
+{
+  NS_ABORT_MSG_IF (column >= m_columns.size (), "No column " << column);
+  NS_ABORT_MSG_IF (m_columns[column].type != type,
+                   "Value of the wrong type for column " << m_columns[column].name);
+  NS_ABORT_MSG_IF (m_set[column], "Column " << m_columns[column].name << " set twice in a row");
+  m_set[column] = true;
+  m_nSet++;
+}
+
+void
+ResultsSink::Set (uint32_t column, double value)
+{
+  CheckSet (column, DOUBLE);
+  m_columns[column].doubles.push_back (value);
+}
+
+void
+ResultsSink::Set (uint32_t column, Time value)
+{
+  Set (column, value.GetSeconds ());
+}
+
+void
+ResultsSink::Set (uint32_t column, int64_t value)
+{
+  CheckSet (column, INTEGER);
+  m_columns[column].integers.push_back (value);
+}
+
+void
+ResultsSink::Set (uint32_t column, int value)
+{
+  Set (column, static_cast<int64_t> (value));
+}
+
+void
+ResultsSink::Set (uint32_t column, uint32_t value)
+{
+  Set (column, static_cast<int64_t> (value));
+}
+
+void
+ResultsSink::Set (uint32_t column, const std::string &value)
+{
+  CheckSet (column, TEXT);
+  m_columns[column].texts.push_back (value);
+}
+
+void
+ResultsSink::CommitRow (void)
+{
+  NS_ABORT_MSG_IF (m_nSet != m_columns.size (),
+                   "Row committed with " << m_nSet << " of " << m_columns.size () << " columns set");
+  std::fill (m_set.begin (), m_set.end (), false);
+  m_nSet = 0;
+  m_rows++;
+  if (++m_buffered >= m_bufferSize)
+    {
+      Flush ();
+    }
+}
+
+uint64_t
+ResultsSink::GetNRows (void) const
+{
+  return m_rows;
+}
+
+void
+ResultsSink::Open (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_open = true;
+  if (m_format == CSV)
+    {
+      m_csv.open (m_fileName.c_str ());
+      NS_ABORT_MSG_UNLESS (m_csv.is_open (), "Could not open " << m_fileName);
+      for (uint32_t i = 0; i < m_columns.size (); i++)
+        {
+          m_csv << (i > 0 ? "," : "") << m_columns[i].name;
+        }
+      m_csv << "\n";
+      return;
+    }
+#ifdef RESULTS_SINK_HAS_SQLITE
+  m_db = Create<SQLiteOutput> (m_fileName, "ns3-results-sink");
+  std::ostringstream cmd;
+  cmd << "CREATE TABLE IF NOT EXISTS " << QuoteIdentifier (m_tableName) << " (";
+  for (uint32_t i = 0; i < m_columns.size (); i++)
+    {
+      static const char *types[] = { "REAL", "INTEGER", "TEXT" };
+      cmd << (i > 0 ? ", " : "") << QuoteIdentifier (m_columns[i].name) << " " << types[m_columns[i].type];
+    }
+  cmd << ");";
+  bool ok = m_db->SpinExec (cmd.str ());
+  NS_ABORT_MSG_UNLESS (ok, "Could not create table " << m_tableName);
+#else
+  NS_FATAL_ERROR ("ResultsSink: ns-3 was built without SQLite support");
+#endif
+}
+
+void
+ResultsSink::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_open && !m_columns.empty ())
+    {
+      Open ();
+    }
+  if (m_buffered == 0)
+    {
+      return;
+    }
+  if (m_format == CSV)
+    {
+      FlushCsv ();
+    }
+  else
+    {
+      FlushSqlite ();
+    }
+  for (std::vector<Column>::iterator it = m_columns.begin (); it != m_columns.end (); it++)
+    {
+      it->doubles.clear ();
+      it->integers.clear ();
+      it->texts.clear ();
+    }
+  m_buffered = 0;
+}
+
+void
+ResultsSink::FlushCsv (void)
+{
+  NS_LOG_FUNCTION (this << m_buffered);
+  // the whole block is formatted in memory and written at once, with
+  // enough digits for the doubles to be read back unchanged
+  std::ostringstream block;
+  block << std::setprecision (std::numeric_limits<double>::max_digits10);
+  for (uint32_t row = 0; row < m_buffered; row++)
+    {
+      for (uint32_t i = 0; i < m_columns.size (); i++)
+        {
+          if (i > 0)
+            {
+              block << ",";
+            }
+          const Column &column = m_columns[i];
+          switch (column.type)
+            {
+            case DOUBLE:
+              block << column.doubles[row];
+              break;
+            case INTEGER:
+              block << column.integers[row];
+              break;
+            case TEXT:
+              if (column.texts[row].find_first_of (",\"\n") == std::string::npos)
+                {
+                  block << column.texts[row];
+                }
+              else
+                {
+                  block << '"';
+                  for (std::string::const_iterator c = column.texts[row].begin (); c != column.texts[row].end (); c++)
+                    {
+                      block << (*c == '"' ? "\"\"" : std::string (1, *c));
+                    }
+                  block << '"';
+                }
+              break;
+            }
+        }
+      block << "\n";
+    }
+  m_csv << block.str ();
+  m_csv.flush ();
+}
+
+void
+ResultsSink::FlushSqlite (void)
+{
+  NS_LOG_FUNCTION (this << m_buffered);
+#ifdef RESULTS_SINK_HAS_SQLITE
+  // one transaction per block, inserting as many rows per statement as
+  // the 999 host parameters guaranteed by every SQLite version allow
+  bool ok = m_db->SpinExec ("BEGIN TRANSACTION;");
+  NS_ABORT_MSG_UNLESS (ok, "Could not begin a transaction");
+  uint32_t rowsPerStatement = std::max<uint32_t> (1, 999 / m_columns.size ());
+  for (uint32_t first = 0; first < m_buffered; first += rowsPerStatement)
+    {
+      uint32_t last = std::min (m_buffered, first + rowsPerStatement);
+      std::ostringstream cmd;
+      cmd << "INSERT INTO " << QuoteIdentifier (m_tableName) << " VALUES ";
+      for (uint32_t row = first; row < last; row++)
+        {
+          cmd << (row > first ? ",(" : "(");
+          for (uint32_t i = 0; i < m_columns.size (); i++)
+            {
+              cmd << (i > 0 ? ",?" : "?");
+            }
+          cmd << ")";
+        }
+      cmd << ";";
+      sqlite3_stmt *stmt;
+      ok = m_db->SpinPrepare (&stmt, cmd.str ());
+      NS_ABORT_MSG_UNLESS (ok, "Could not prepare an insertion into " << m_tableName);
+      int pos = 1;
+      for (uint32_t row = first; row < last; row++)
+        {
+          for (uint32_t i = 0; i < m_columns.size (); i++, pos++)
+            {
+              const Column &column = m_columns[i];
+              switch (column.type)
+                {
+                case DOUBLE:
+                  ok = m_db->Bind (stmt, pos, column.doubles[row]);
+                  break;
+                case INTEGER:
+                  ok = m_db->Bind (stmt, pos, column.integers[row]);
+                  break;
+                case TEXT:
+                  ok = m_db->Bind (stmt, pos, column.texts[row]);
+                  break;
+                }
+              NS_ABORT_MSG_UNLESS (ok, "Could not bind column " << column.name);
+            }
+        }
+      ok = m_db->SpinExec (stmt);
+      NS_ABORT_MSG_UNLESS (ok, "Could not insert rows into " << m_tableName);
+    }
+  ok = m_db->SpinExec ("END TRANSACTION;");
+  NS_ABORT_MSG_UNLESS (ok, "Could not end a transaction");
+#endif
+}
+
+} // namespace ns3
@@ -0,0 +1,197 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RESULTS_SINK_H
+#define RESULTS_SINK_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class SQLiteOutput;
+
+/**
+ * \ingroup stats
+ *
+ * \brief Buffered writer of typed time series rows to a CSV file or an
+ * SQLite table.
+ *
+ * The schema is declared once with AddColumn () before the first row.
+ * A row is then filled column by column with Set () and completed with
+ * CommitRow (); a row missing a column or holding a value of the wrong
+ * type is rejected, so that the output is never ragged.
+ *
+ * Rows are buffered column by column in memory and written in blocks of
+ * BufferSize rows: a CSV file is kept open and receives one write per
+ * block, and an SQLite table (through SQLiteOutput, when ns-3 is built
+ * with SQLite support) receives one transaction per block.  The buffer
+ * is flushed when the sink is disposed, or explicitly with Flush ().
+ *
+ * \code
+ *   Ptr<ResultsSink> sink = CreateObject<ResultsSink> ();
+ *   sink->SetAttribute ("FileName", StringValue ("v2x.csv"));
+ *   uint32_t time = sink->AddColumn ("time", ResultsSink::DOUBLE);
+ *   uint32_t cbr = sink->AddColumn ("cbr", ResultsSink::DOUBLE);
+ *   ...
+ *   sink->Set (time, Simulator::Now ());
+ *   sink->Set (cbr, 0.42);
+ *   sink->CommitRow ();
+ * \endcode
+ */
+class ResultsSink : public Object
+{
+public:
+  /// Type of the values of a column
+  enum ColumnType
+  {
+    DOUBLE,  //!< floating point values; Time values are stored in seconds
+    INTEGER, //!< signed integer values
+    TEXT     //!< strings
+  };
+
+  /// Output format
+  enum Format
+  {
+    CSV,   //!< comma separated values, with a header line
+    SQLITE //!< a table of an SQLite database
+  };
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  ResultsSink ();
+  virtual ~ResultsSink ();
+
+  /**
+   * \brief Add a column to the schema; only allowed before the first row
+   * \param name the column name
+   * \param type the type of its values
+   * \return the index of the column
+   */
+  uint32_t AddColumn (const std::string &name, ColumnType type);
+  /**
+   * \return the number of columns of the schema
+   */
+  uint32_t GetNColumns (void) const;
+
+  /**
+   * \brief Set a DOUBLE value of the current row
+   * \param column the column index
+   * \param value the value
+   */
+  void Set (uint32_t column, double value);
+  /**
+   * \brief Set a DOUBLE value of the current row, in seconds
+   * \param column the column index
+   * \param value the value
+   */
+  void Set (uint32_t column, Time value);
+  /**
+   * \brief Set an INTEGER value of the current row
+   * \param column the column index
+   * \param value the value
+   */
+  void Set (uint32_t column, int64_t value);
+  /**
+   * \brief Set an INTEGER value of the current row
+   * \param column the column index
+   * \param value the value
+   */
+  void Set (uint32_t column, int value);
+  /**
+   * \brief Set an INTEGER value of the current row
+   * \param column the column index
+   * \param value the value
+   */
+  void Set (uint32_t column, uint32_t value);
+  /**
+   * \brief Set a TEXT value of the current row
+   * \param column the column index
+   * \param value the value
+   */
+  void Set (uint32_t column, const std::string &value);
+  /**
+   * \brief Complete the current row; every column must have been set
+   */
+  void CommitRow (void);
+  /**
+   * \return the number of rows committed so far
+   */
+  uint64_t GetNRows (void) const;
+
+  /**
+   * \brief Write the buffered rows
+   */
+  void Flush (void);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /// A column of the schema and its buffered values
+  struct Column
+  {
+    std::string name; //!< column name
+    ColumnType type; //!< type of the values
+    std::vector<double> doubles; //!< buffered DOUBLE values
+    std::vector<int64_t> integers; //!< buffered INTEGER values
+    std::vector<std::string> texts; //!< buffered TEXT values
+  };
+
+  /**
+   * \brief Check that a value of a type may be set in a column
+   * \param column the column index
+   * \param type the type of the value
+   */
+  void CheckSet (uint32_t column, ColumnType type);
+  /**
+   * \brief Open the output and write the header or create the table
+   */
+  void Open (void);
+  /**
+   * \brief Write the buffered rows to the CSV file
+   */
+  void FlushCsv (void);
+  /**
+   * \brief Write the buffered rows to the SQLite table
+   */
+  void FlushSqlite (void);
+
+  std::string m_fileName; //!< output file
+  Format m_format; //!< output format
+  std::string m_tableName; //!< SQLite table name
+  uint32_t m_bufferSize; //!< rows buffered before a write
+
+  std::vector<Column> m_columns; //!< schema and buffered values
+  std::vector<bool> m_set; //!< columns set in the current row
+  uint32_t m_nSet; //!< number of columns set in the current row
+  uint32_t m_buffered; //!< rows buffered
+  uint64_t m_rows; //!< rows committed
+  bool m_open; //!< the output has been opened
+  std::ofstream m_csv; //!< CSV output
+  Ptr<SQLiteOutput> m_db; //!< SQLite output
+};
+
+} // namespace ns3
+
+#endif /* RESULTS_SINK_H */
@@ -0,0 +1,199 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/enum.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/results-sink.h"
+
+#if defined (HAVE_SQLITE3) && defined (HAVE_SEMAPHORE_H)
+#include <sqlite3.h>
+#endif
+
+using namespace ns3;
+
+/**
+ * \ingroup stats-test
+ * \ingroup tests
+ *
+ * \brief ResultsSink CSV test
+ *
+ * Checks the header, the formatting of the typed columns, and that rows
+ * are written by blocks of BufferSize and on disposal.
+ */
+class ResultsSinkCsvTestCase : public TestCase
+{
+public:
+  ResultsSinkCsvTestCase ();
+  virtual ~ResultsSinkCsvTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Read the lines of a file
+   * \param filename the file
+   * \return the lines
+   */
+  static std::vector<std::string> ReadLines (const std::string &filename);
+};
+
+ResultsSinkCsvTestCase::ResultsSinkCsvTestCase ()
+  : TestCase ("Buffered CSV output of typed rows")
+{
+}
+
+ResultsSinkCsvTestCase::~ResultsSinkCsvTestCase ()
+{
+}
+
+std::vector<std::string>
+ResultsSinkCsvTestCase::ReadLines (const std::string &filename)
+{
+  std::vector<std::string> lines;
+  std::ifstream in (filename.c_str ());
+  std::string line;
+  while (std::getline (in, line))
+    {
+      lines.push_back (line);
+    }
+  return lines;
+}
+
+void
+ResultsSinkCsvTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("results.csv");
+  Ptr<ResultsSink> sink = CreateObject<ResultsSink> ();
+  sink->SetAttribute ("FileName", StringValue (filename));
+  sink->SetAttribute ("BufferSize", UintegerValue (3));
+  uint32_t time = sink->AddColumn ("time", ResultsSink::DOUBLE);
+  uint32_t node = sink->AddColumn ("node", ResultsSink::INTEGER);
+  uint32_t label = sink->AddColumn ("label", ResultsSink::TEXT);
+  uint32_t ratio = sink->AddColumn ("ratio", ResultsSink::DOUBLE);
+  NS_TEST_ASSERT_MSG_EQ (sink->GetNColumns (), 4, "Unexpected number of columns");
+
+  for (int i = 0; i < 4; i++)
+    {
+      sink->Set (time, MilliSeconds (500 * i));
+      sink->Set (node, i);
+      sink->Set (label, i == 3 ? std::string ("a,\"b\"") : std::string ("x"));
+      sink->Set (ratio, 1.0 / 3);
+      sink->CommitRow ();
+    }
+  std::vector<std::string> lines = ReadLines (filename);
+  NS_TEST_ASSERT_MSG_EQ (lines.size (), 4, "A block of three rows should have been written");
+  NS_TEST_ASSERT_MSG_EQ (lines[0], "time,node,label,ratio", "Wrong header");
+  std::string row = lines[2];
+  NS_TEST_ASSERT_MSG_EQ (row.substr (0, row.rfind (',')), "0.5,1,x", "Wrong row");
+  NS_TEST_EXPECT_MSG_EQ (std::stod (row.substr (row.rfind (',') + 1)), 1.0 / 3,
+                         "Double not written with full precision");
+
+  sink->Dispose ();
+  lines = ReadLines (filename);
+  NS_TEST_ASSERT_MSG_EQ (lines.size (), 5, "The last row should be written on disposal");
+  NS_TEST_ASSERT_MSG_EQ (lines[4].substr (0, lines[4].rfind (',')), "1.5,3,\"a,\"\"b\"\"\"", "Text not quoted");
+  NS_TEST_ASSERT_MSG_EQ (sink->GetNRows (), 4, "Unexpected number of rows");
+}
+
+#if defined (HAVE_SQLITE3) && defined (HAVE_SEMAPHORE_H)
+/**
+ * \ingroup stats-test
+ * \ingroup tests
+ *
+ * \brief ResultsSink SQLite test
+ *
+ * Writes more rows than fit in one INSERT statement and reads the table
+ * back.
+ */
+class ResultsSinkSqliteTestCase : public TestCase
+{
+public:
+  ResultsSinkSqliteTestCase ();
+  virtual ~ResultsSinkSqliteTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+ResultsSinkSqliteTestCase::ResultsSinkSqliteTestCase ()
+  : TestCase ("Batched SQLite output of typed rows")
+{
+}
+
+ResultsSinkSqliteTestCase::~ResultsSinkSqliteTestCase ()
+{
+}
+
+void
+ResultsSinkSqliteTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("results.db");
+  Ptr<ResultsSink> sink = CreateObject<ResultsSink> ();
+  sink->SetAttribute ("FileName", StringValue (filename));
+  sink->SetAttribute ("Format", EnumValue (ResultsSink::SQLITE));
+  sink->SetAttribute ("TableName", StringValue ("v2x \"run\" 1"));
+  uint32_t time = sink->AddColumn ("time", ResultsSink::DOUBLE);
+  uint32_t node = sink->AddColumn ("node", ResultsSink::INTEGER);
+  uint32_t cbr = sink->AddColumn ("cbr (ratio)", ResultsSink::DOUBLE);
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      sink->Set (time, Seconds (i));
+      sink->Set (node, i % 10);
+      sink->Set (cbr, 0.5);
+      sink->CommitRow ();
+    }
+  sink->Dispose ();
+
+  sqlite3 *db;
+  NS_TEST_ASSERT_MSG_EQ (sqlite3_open (filename.c_str (), &db), SQLITE_OK, "Could not open the database");
+  sqlite3_stmt *stmt;
+  std::string query = "SELECT COUNT(*), SUM(node), SUM(\"cbr (ratio)\") FROM \"v2x \"\"run\"\" 1\";";
+  NS_TEST_ASSERT_MSG_EQ (sqlite3_prepare_v2 (db, query.c_str (), -1, &stmt, nullptr), SQLITE_OK, "Could not query");
+  NS_TEST_ASSERT_MSG_EQ (sqlite3_step (stmt), SQLITE_ROW, "No result");
+  NS_TEST_EXPECT_MSG_EQ (sqlite3_column_int (stmt, 0), 1000, "Unexpected number of rows");
+  NS_TEST_EXPECT_MSG_EQ (sqlite3_column_int (stmt, 1), 4500, "Unexpected node values");
+  NS_TEST_EXPECT_MSG_EQ_TOL (sqlite3_column_double (stmt, 2), 500, 1e-9, "Unexpected cbr values");
+  sqlite3_finalize (stmt);
+  sqlite3_close (db);
+}
+#endif
+
+/**
+ * \ingroup stats-test
+ * \ingroup tests
+ *
+ * \brief ResultsSink TestSuite
+ */
+class ResultsSinkTestSuite : public TestSuite
+{
+public:
+  ResultsSinkTestSuite ();
+};
+
+ResultsSinkTestSuite::ResultsSinkTestSuite ()
+  : TestSuite ("results-sink", UNIT)
+{
+  AddTestCase (new ResultsSinkCsvTestCase, TestCase::QUICK);
+#if defined (HAVE_SQLITE3) && defined (HAVE_SEMAPHORE_H)
+  AddTestCase (new ResultsSinkSqliteTestCase, TestCase::QUICK);
+#endif
+}
+
+static ResultsSinkTestSuite resultsSinkTestSuite; //!< Static variable for test initialization
@@ -20,19 +20,139 @@
  */
 
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include "ns3/wave-bsm-stats.h"
 #include "ns3/integer.h"
+#include "ns3/uinteger.h"
 #include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/mobility-model.h"
+#include "ns3/constant-acceleration-mobility-model.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("WaveBsmStats");
 
+WaveBsmStats::LogHistogram::LogHistogram (double min, double max, uint32_t binsPerDecade)
+  : m_min (min),
+    m_max (max),
+    m_binsPerDecade (binsPerDecade),
+    m_count (0)
+{
+  NS_ASSERT (min > 0 && max > min && binsPerDecade > 0);
+  uint32_t nLogBins = static_cast<uint32_t> (std::ceil (std::log10 (max / min) * binsPerDecade));
+  m_counts.assign (nLogBins + 2, 0);
+}
+
+void
+WaveBsmStats::LogHistogram::Add (double value)
+{
+  uint32_t last = m_counts.size () - 1;
+  uint32_t bin;
+  if (value < m_min)
+    {
+      bin = 0;
+    }
+  else if (value >= m_max)
+    {
+      bin = last;
+    }
+  else
+    {
+      bin = 1 + static_cast<uint32_t> (std::log10 (value / m_min) * m_binsPerDecade);
+      bin = std::min (bin, last - 1);
+    }
+  m_counts[bin]++;
+  m_count++;
+}
+
+void
+WaveBsmStats::LogHistogram::Add (const LogHistogram &other)
+{
+  NS_ASSERT (other.m_counts.size () == m_counts.size ());
+  for (uint32_t bin = 0; bin < m_counts.size (); bin++)
+    {
+      m_counts[bin] += other.m_counts[bin];
+    }
+  m_count += other.m_count;
+}
+
+void
+WaveBsmStats::LogHistogram::Clear (void)
+{
+  std::fill (m_counts.begin (), m_counts.end (), 0);
+  m_count = 0;
+}
+
+uint64_t
+WaveBsmStats::LogHistogram::GetCount (void) const
+{
+  return m_count;
+}
+
+uint32_t
+WaveBsmStats::LogHistogram::GetNBins (void) const
+{
+  return m_counts.size ();
+}
+
+uint64_t
+WaveBsmStats::LogHistogram::GetBinCount (uint32_t bin) const
+{
+  return m_counts.at (bin);
+}
+
+double
+WaveBsmStats::LogHistogram::GetBinEnd (uint32_t bin) const
+{
+  if (bin + 1 >= m_counts.size ())
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  return std::min (m_min * std::pow (10.0, static_cast<double> (bin) / m_binsPerDecade), m_max);
+}
+
+double
+WaveBsmStats::LogHistogram::GetQuantile (double q) const
+{
+  if (m_count == 0)
+    {
+      return 0;
+    }
+  uint64_t target = std::max<uint64_t> (1, static_cast<uint64_t> (std::ceil (q * m_count)));
+  uint64_t count = 0;
+  uint32_t bin = 0;
+  for (; bin + 1 < m_counts.size (); bin++)
+    {
+      count += m_counts[bin];
+      if (count >= target)
+        {
+          break;
+        }
+    }
+  return std::min (GetBinEnd (bin), m_max);
+}
+
 WaveBsmStats::WaveBsmStats ()
   : m_wavePktSendCount (0),
     m_waveByteSendCount (0),
     m_wavePktReceiveCount (0),
-    m_log (0)
+    m_log (0),
+    m_binsDirty (false),
+    m_cellSize (1),
+    m_minX (0),
+    m_minY (0),
+    m_nCols (0),
+    m_nRows (0),
+    m_maxSpeed (0),
+    m_gridTime (Seconds (-1)),
+    m_gridUpdateInterval (Seconds (1)),
+    m_searchAllCells (false),
+    m_windowDuration (MilliSeconds (100)),
+    m_nWindows (10)
 {
   m_wavePktExpectedReceiveCounts.resize (10, 0);
   m_wavePktInCoverageReceiveCounts.resize (10, 0);
@@ -48,6 +168,23 @@ WaveBsmStats::GetTypeId (void)
     .SetParent<Object> ()
     .SetGroupName ("Stats")
     .AddConstructor<WaveBsmStats> ()
+    .AddAttribute ("GridUpdateInterval",
+                   "The maximum age of the grid of node positions used to find "
+                   "the receivers expected in range.  An older grid is searched "
+                   "over a larger radius, since the nodes may have moved further.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&WaveBsmStats::m_gridUpdateInterval),
+                   MakeTimeChecker (Seconds (0)))
+    .AddAttribute ("WindowDuration",
+                   "The duration of a window of the windowed statistics.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&WaveBsmStats::m_windowDuration),
+                   MakeTimeChecker (TimeStep (1)))
+    .AddAttribute ("NumWindows",
+                   "The number of windows kept by the windowed statistics.",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&WaveBsmStats::m_nWindows),
+                   MakeUintegerChecker<uint32_t> (1))
     ;
   return tid;
 }
@@ -93,12 +230,14 @@ WaveBsmStats::GetRxPktCount ()
 int
 WaveBsmStats::GetExpectedRxPktCount (int index)
 {
+  Flush ();
   return m_wavePktExpectedReceiveCounts[index - 1];
 }
 
 int
 WaveBsmStats::GetRxPktInRangeCount (int index)
 {
+  Flush ();
   return m_wavePktInCoverageReceiveCounts[index - 1];
 }
 
@@ -129,6 +268,7 @@ WaveBsmStats::GetTxByteCount ()
 double
 WaveBsmStats::GetBsmPdr (int index)
 {
+  Flush ();
   double pdr = 0.0;
 
   if (m_wavePktExpectedReceiveCounts[index - 1] > 0)
@@ -150,6 +290,7 @@ WaveBsmStats::GetBsmPdr (int index)
 double
 WaveBsmStats::GetCumulativeBsmPdr (int index)
 {
+  Flush ();
   double pdr = 0.0;
 
   if (m_waveTotalPktExpectedReceiveCounts[index - 1] > 0)
@@ -183,20 +324,406 @@ WaveBsmStats::GetLogging ()
 void
 WaveBsmStats::SetExpectedRxPktCount (int index, int count)
 {
+  Flush ();
   m_wavePktExpectedReceiveCounts[index - 1] = count;
 }
 
 void
 WaveBsmStats::SetRxPktInRangeCount (int index, int count)
 {
+  Flush ();
   m_wavePktInCoverageReceiveCounts[index - 1] = count;
 }
 
 void
 WaveBsmStats::ResetTotalRxPktCounts (int index)
 {
+  Flush ();
   m_waveTotalPktInCoverageReceiveCounts[index - 1] = 0;
   m_waveTotalPktExpectedReceiveCounts[index - 1] = 0;
 }
 
+void
+WaveBsmStats::SetRangesSq (std::vector<double> rangesSq)
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+  std::size_t size = rangesSq.size ();
+  if (size > m_wavePktExpectedReceiveCounts.size ())
+    {
+      m_wavePktExpectedReceiveCounts.resize (size, 0);
+      m_wavePktInCoverageReceiveCounts.resize (size, 0);
+      m_waveTotalPktExpectedReceiveCounts.resize (size, 0);
+      m_waveTotalPktInCoverageReceiveCounts.resize (size, 0);
+    }
+  std::vector<std::pair<double, int> > ranges;
+  for (std::size_t i = 0; i < size; i++)
+    {
+      ranges.push_back (std::make_pair (rangesSq[i], i + 1));
+    }
+  std::sort (ranges.begin (), ranges.end ());
+  m_sortedRangesSq.clear ();
+  m_sortedRangeIndex.clear ();
+  for (const auto & range : ranges)
+    {
+      m_sortedRangesSq.push_back (range.first);
+      m_sortedRangeIndex.push_back (range.second);
+    }
+  m_expectedRxBins.assign (size, 0);
+  m_inRangeRxBins.assign (size, 0);
+  // the cell size depends on the largest range
+  m_gridTime = Seconds (-1);
+}
+
+void
+WaveBsmStats::AddNode (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << node);
+  Ptr<MobilityModel> mobility = node->GetObject<MobilityModel> ();
+  NS_ASSERT (mobility != 0);
+  uint32_t i = m_mobility.size ();
+  m_mobility.push_back (mobility);
+  m_nodeIds.push_back (node->GetId ());
+  if (node->GetId () >= m_nodeIndex.size ())
+    {
+      m_nodeIndex.resize (node->GetId () + 1, std::numeric_limits<uint32_t>::max ());
+    }
+  m_nodeIndex[node->GetId ()] = i;
+  mobility->TraceConnect ("CourseChange", std::to_string (i),
+                          MakeCallback (&WaveBsmStats::CourseChanged, this));
+  // the speed of this model changes without any CourseChange, so the
+  // distance travelled since the grid was built is not bounded
+  if (DynamicCast<ConstantAccelerationMobilityModel> (mobility) != 0)
+    {
+      m_searchAllCells = true;
+    }
+  m_gridTime = Seconds (-1);
+}
+
+uint32_t
+WaveBsmStats::GetNNodes (void) const
+{
+  return m_mobility.size ();
+}
+
+void
+WaveBsmStats::IncExpectedRxPktCounts (Ptr<Node> txNode, const std::vector<int> *nodesMoving)
+{
+  NS_LOG_FUNCTION (this << txNode);
+  if (m_sortedRangesSq.empty () || m_mobility.empty ())
+    {
+      return;
+    }
+  Time now = Simulator::Now ();
+  if (m_gridTime.IsNegative () || now - m_gridTime > m_gridUpdateInterval)
+    {
+      BuildGrid ();
+    }
+  Ptr<MobilityModel> txPosition = txNode->GetObject<MobilityModel> ();
+  NS_ASSERT (txPosition != 0);
+  Vector tx = txPosition->GetPosition ();
+  uint32_t txNodeId = txNode->GetId ();
+  std::size_t nBins = m_sortedRangesSq.size ();
+  int *windowBins = &m_windowExpectedRxBins[GetWindowSlot () * nBins];
+
+  // the receivers may have moved away from their cell since the grid
+  // was built; the margin absorbs the rounding errors
+  double radius = std::sqrt (m_sortedRangesSq.back ())
+    + m_maxSpeed * (now - m_gridTime).GetSeconds () + 1e-3;
+  if (m_searchAllCells)
+    {
+      radius = std::numeric_limits<double>::infinity ();
+    }
+  double maxCol = m_nCols - 1;
+  double maxRow = m_nRows - 1;
+  double firstCol = std::floor ((tx.x - radius - m_minX) / m_cellSize);
+  double lastCol = std::floor ((tx.x + radius - m_minX) / m_cellSize);
+  double firstRow = std::floor ((tx.y - radius - m_minY) / m_cellSize);
+  double lastRow = std::floor ((tx.y + radius - m_minY) / m_cellSize);
+  if (!(lastCol >= 0 && firstCol <= maxCol && lastRow >= 0 && firstRow <= maxRow))
+    {
+      return;
+    }
+  uint32_t col0 = static_cast<uint32_t> (std::max (firstCol, 0.0));
+  uint32_t col1 = static_cast<uint32_t> (std::min (lastCol, maxCol));
+  uint32_t row0 = static_cast<uint32_t> (std::max (firstRow, 0.0));
+  uint32_t row1 = static_cast<uint32_t> (std::min (lastRow, maxRow));
+  for (uint32_t row = row0; row <= row1; row++)
+    {
+      for (uint32_t col = col0; col <= col1; col++)
+        {
+          uint32_t cell = row * m_nCols + col;
+          for (uint32_t k = m_cellStart[cell]; k < m_cellStart[cell + 1]; k++)
+            {
+              uint32_t j = m_cellNodes[k];
+              uint32_t rxNodeId = m_nodeIds[j];
+              // if the receiving node has not started moving, then
+              // it is not a candidate to receive a packet
+              if (rxNodeId == txNodeId || nodesMoving->at (rxNodeId) != 1)
+                {
+                  continue;
+                }
+              double dist = CalculateDistance (m_mobility[j]->GetPosition (), tx);
+              double distSq = dist * dist;
+              if (distSq > 0.0)
+                {
+                  std::size_t bin = std::lower_bound (m_sortedRangesSq.begin (), m_sortedRangesSq.end (), distSq)
+                    - m_sortedRangesSq.begin ();
+                  if (bin < nBins)
+                    {
+                      m_expectedRxBins[bin]++;
+                      windowBins[bin]++;
+                      m_binsDirty = true;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void
+WaveBsmStats::IncRxPktInRangeCounts (double distSq)
+{
+  std::size_t bin = std::lower_bound (m_sortedRangesSq.begin (), m_sortedRangesSq.end (), distSq)
+    - m_sortedRangesSq.begin ();
+  if (bin < m_inRangeRxBins.size ())
+    {
+      m_inRangeRxBins[bin]++;
+      m_windowInRangeRxBins[GetWindowSlot () * m_inRangeRxBins.size () + bin]++;
+      m_binsDirty = true;
+    }
+}
+
+void
+WaveBsmStats::RecordRx (Ptr<Node> txNode, Ptr<Node> rxNode, Time generated)
+{
+  NS_LOG_FUNCTION (this << txNode << rxNode << generated);
+  uint32_t tx = m_nodeIndex.at (txNode->GetId ());
+  uint32_t rx = m_nodeIndex.at (rxNode->GetId ());
+  NS_ASSERT (tx < m_mobility.size () && rx < m_mobility.size ());
+  std::size_t n = m_mobility.size ();
+  if (m_lastRxTime.size () != n * n)
+    {
+      m_lastRxTime.assign (n * n, Seconds (-1));
+      m_lastGenerated.assign (n * n, Seconds (0));
+    }
+  std::size_t pair = tx * n + rx;
+  Time now = Simulator::Now ();
+  if (!m_lastRxTime[pair].IsNegative ())
+    {
+      uint32_t slot = GetWindowSlot ();
+      double gap = (now - m_lastRxTime[pair]).GetSeconds ();
+      double age = (now - m_lastGenerated[pair]).GetSeconds ();
+      m_gapHistogram.Add (gap);
+      m_windowGaps[slot].Add (gap);
+      m_ageHistogram.Add (age);
+      m_windowAges[slot].Add (age);
+    }
+  m_lastRxTime[pair] = now;
+  // a BSM older than the last one received does not refresh the information
+  m_lastGenerated[pair] = Max (m_lastGenerated[pair], generated);
+}
+
+double
+WaveBsmStats::GetWindowedBsmPdr (int index)
+{
+  uint32_t current = GetWindowSlot ();
+  int64_t window = m_windowIds[current];
+  std::size_t nBins = m_sortedRangesSq.size ();
+  std::size_t last = std::find (m_sortedRangeIndex.begin (), m_sortedRangeIndex.end (), index)
+    - m_sortedRangeIndex.begin ();
+  NS_ASSERT_MSG (last < nBins, "No range " << index);
+  // a count of a range also counts for every larger range
+  int expected = 0;
+  int inRange = 0;
+  for (uint32_t slot = 0; slot < m_nWindows; slot++)
+    {
+      if (m_windowIds[slot] > window - m_nWindows)
+        {
+          for (std::size_t bin = 0; bin <= last; bin++)
+            {
+              expected += m_windowExpectedRxBins[slot * nBins + bin];
+              inRange += m_windowInRangeRxBins[slot * nBins + bin];
+            }
+        }
+    }
+  if (expected == 0)
+    {
+      return 0.0;
+    }
+  // a packet received may have been sent while out of range, so that
+  // the PDR is bounded, as in GetBsmPdr
+  return std::min ((double) inRange / (double) expected, 1.0);
+}
+
+Time
+WaveBsmStats::GetInterPacketGapQuantile (double q)
+{
+  return Seconds (MergeWindows (m_windowGaps).GetQuantile (q));
+}
+
+Time
+WaveBsmStats::GetAgeQuantile (double q)
+{
+  return Seconds (MergeWindows (m_windowAges).GetQuantile (q));
+}
+
+const WaveBsmStats::LogHistogram &
+WaveBsmStats::GetInterPacketGapHistogram (void) const
+{
+  return m_gapHistogram;
+}
+
+const WaveBsmStats::LogHistogram &
+WaveBsmStats::GetAgeHistogram (void) const
+{
+  return m_ageHistogram;
+}
+
+uint32_t
+WaveBsmStats::GetWindowSlot (void)
+{
+  std::size_t nBins = m_sortedRangesSq.size ();
+  if (m_windowIds.size () != m_nWindows || m_windowExpectedRxBins.size () != m_nWindows * nBins)
+    {
+      m_windowIds.assign (m_nWindows, std::numeric_limits<int64_t>::min ());
+      m_windowExpectedRxBins.assign (m_nWindows * nBins, 0);
+      m_windowInRangeRxBins.assign (m_nWindows * nBins, 0);
+      m_windowGaps.assign (m_nWindows, LogHistogram ());
+      m_windowAges.assign (m_nWindows, LogHistogram ());
+    }
+  int64_t window = Simulator::Now ().GetTimeStep () / m_windowDuration.GetTimeStep ();
+  uint32_t slot = window % m_nWindows;
+  if (m_windowIds[slot] != window)
+    {
+      std::fill_n (m_windowExpectedRxBins.begin () + slot * nBins, nBins, 0);
+      std::fill_n (m_windowInRangeRxBins.begin () + slot * nBins, nBins, 0);
+      m_windowGaps[slot].Clear ();
+      m_windowAges[slot].Clear ();
+      m_windowIds[slot] = window;
+    }
+  return slot;
+}
+
+const WaveBsmStats::LogHistogram &
+WaveBsmStats::MergeWindows (const std::vector<LogHistogram> &windows)
+{
+  uint32_t current = GetWindowSlot ();
+  int64_t window = m_windowIds[current];
+  m_merged.Clear ();
+  for (uint32_t slot = 0; slot < m_nWindows; slot++)
+    {
+      if (m_windowIds[slot] > window - m_nWindows)
+        {
+          m_merged.Add (windows[slot]);
+        }
+    }
+  return m_merged;
+}
+
+void
+WaveBsmStats::Flush (void)
+{
+  if (!m_binsDirty)
+    {
+      return;
+    }
+  // a count of a range also counts for every larger range
+  int expected = 0;
+  int inRange = 0;
+  for (std::size_t bin = 0; bin < m_sortedRangesSq.size (); bin++)
+    {
+      expected += m_expectedRxBins[bin];
+      inRange += m_inRangeRxBins[bin];
+      int i = m_sortedRangeIndex[bin] - 1;
+      m_wavePktExpectedReceiveCounts[i] += expected;
+      m_waveTotalPktExpectedReceiveCounts[i] += expected;
+      m_wavePktInCoverageReceiveCounts[i] += inRange;
+      m_waveTotalPktInCoverageReceiveCounts[i] += inRange;
+      m_expectedRxBins[bin] = 0;
+      m_inRangeRxBins[bin] = 0;
+    }
+  m_binsDirty = false;
+}
+
+void
+WaveBsmStats::BuildGrid (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t n = m_mobility.size ();
+  m_gridPositions.resize (n);
+  m_maxSpeed = 0;
+  double maxX = 0;
+  double maxY = 0;
+  for (uint32_t j = 0; j < n; j++)
+    {
+      Vector position = m_mobility[j]->GetPosition ();
+      m_gridPositions[j] = position;
+      m_maxSpeed = std::max (m_maxSpeed, m_mobility[j]->GetVelocity ().GetLength ());
+      if (j == 0)
+        {
+          m_minX = maxX = position.x;
+          m_minY = maxY = position.y;
+        }
+      m_minX = std::min (m_minX, position.x);
+      m_minY = std::min (m_minY, position.y);
+      maxX = std::max (maxX, position.x);
+      maxY = std::max (maxY, position.y);
+    }
+
+  // cells as large as the largest range, or larger to keep the number of
+  // cells in the order of the number of nodes
+  m_cellSize = std::max (std::sqrt (m_sortedRangesSq.back ()), 1.0);
+  m_cellSize = std::min (m_cellSize, std::max (std::max (maxX - m_minX, maxY - m_minY), 1.0));
+  while ((std::floor ((maxX - m_minX) / m_cellSize) + 1) * (std::floor ((maxY - m_minY) / m_cellSize) + 1) > 4.0 * n)
+    {
+      m_cellSize *= 2;
+    }
+  m_nCols = static_cast<uint32_t> (std::floor ((maxX - m_minX) / m_cellSize)) + 1;
+  m_nRows = static_cast<uint32_t> (std::floor ((maxY - m_minY) / m_cellSize)) + 1;
+
+  // counting sort of the nodes by cell
+  std::vector<uint32_t> cells (n);
+  m_cellStart.assign (m_nCols * m_nRows + 1, 0);
+  for (uint32_t j = 0; j < n; j++)
+    {
+      uint32_t col = std::min (static_cast<uint32_t> ((m_gridPositions[j].x - m_minX) / m_cellSize), m_nCols - 1);
+      uint32_t row = std::min (static_cast<uint32_t> ((m_gridPositions[j].y - m_minY) / m_cellSize), m_nRows - 1);
+      cells[j] = row * m_nCols + col;
+      m_cellStart[cells[j] + 1]++;
+    }
+  for (uint32_t cell = 0; cell < m_nCols * m_nRows; cell++)
+    {
+      m_cellStart[cell + 1] += m_cellStart[cell];
+    }
+  m_cellNodes.resize (n);
+  std::vector<uint32_t> next (m_cellStart.begin (), m_cellStart.end () - 1);
+  for (uint32_t j = 0; j < n; j++)
+    {
+      m_cellNodes[next[cells[j]]++] = j;
+    }
+  m_gridTime = Simulator::Now ();
+}
+
+void
+WaveBsmStats::CourseChanged (std::string context, Ptr<const MobilityModel> mobility)
+{
+  uint32_t j = std::stoul (context);
+  NS_LOG_FUNCTION (this << j);
+  if (m_gridTime.IsNegative () || j >= m_gridPositions.size ())
+    {
+      return;
+    }
+  // a node may only move away from its cell at the highest speed seen
+  // since the grid was built; a node which jumped to a new position
+  // requires a new grid
+  double age = (Simulator::Now () - m_gridTime).GetSeconds ();
+  if (CalculateDistance (mobility->GetPosition (), m_gridPositions[j]) > m_maxSpeed * age)
+    {
+      m_gridTime = Seconds (-1);
+      return;
+    }
+  m_maxSpeed = std::max (m_maxSpeed, mobility->GetVelocity ().GetLength ());
+}
+
 } // namespace ns3
@@ -23,9 +23,16 @@
 #define WAVE_BSM_STATS_H
 
 #include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+#include <string>
 #include <vector>
 
 namespace ns3 {
+
+class Node;
+class MobilityModel;
+
 /**
  * \ingroup wave
  * \brief The WaveBsmStats class implements a stats collector for
@@ -45,6 +52,26 @@ namespace ns3 {
  * However, it seems that for now, moving the data elements
  * or the algorithms separately into different classes could
  * lead to confusion over usage.
+ *
+ * The packets expected to be received are counted by
+ * IncExpectedRxPktCounts, which looks for the receivers in range of a
+ * transmitter in a grid of the node positions.  The grid is rebuilt
+ * every GridUpdateInterval, or sooner if a node jumps to a new position,
+ * and its search radius is widened by the distance the nodes may have
+ * travelled since, at the highest speed notified by their mobility
+ * models, so that the counts are the same as if every node was checked.
+ * This holds for the mobility models which notify every change of speed
+ * with CourseChange; a ConstantAccelerationMobilityModel does not, so the
+ * whole grid is searched as soon as a node uses one.  Other models
+ * changing speed silently are not supported.
+ * Each count is added to the smallest range covering the distance, and
+ * the counts of the larger ranges are only summed up when read.
+ *
+ * For the controllers reacting to the measured freshness of the BSMs,
+ * the PDR, the inter-packet gaps and the ages of information are also
+ * kept over the last NumWindows windows of WindowDuration, in ring
+ * buffers of counters and of LogHistogram allocated once, so that they
+ * can be queried at every control epoch at no cost per packet.
  */
 class WaveBsmStats : public Object
 {
@@ -59,6 +86,67 @@ public:
    * \return The TypeId.
    */
   static TypeId GetTypeId (void);
+
+  /**
+   * \brief A histogram of positive values with logarithmic bins.
+   *
+   * The bins cover [min, max) with a fixed number of bins per decade,
+   * plus one bin below min and one bin from max on.  The bins are
+   * allocated by the constructor only.
+   */
+  class LogHistogram
+  {
+public:
+    /**
+     * \param min the lower bound of the first logarithmic bin
+     * \param max the upper bound of the last logarithmic bin
+     * \param binsPerDecade the number of bins per decade
+     */
+    LogHistogram (double min = 1e-4, double max = 100, uint32_t binsPerDecade = 10);
+    /**
+     * \param value the value to add
+     */
+    void Add (double value);
+    /**
+     * \param other the histogram to add, which must have the same bins
+     */
+    void Add (const LogHistogram &other);
+    /**
+     * Remove all the values
+     */
+    void Clear (void);
+    /**
+     * \return the number of values
+     */
+    uint64_t GetCount (void) const;
+    /**
+     * \return the number of bins
+     */
+    uint32_t GetNBins (void) const;
+    /**
+     * \param bin the index of a bin
+     * \return the number of values in the bin
+     */
+    uint64_t GetBinCount (uint32_t bin) const;
+    /**
+     * \param bin the index of a bin
+     * \return the upper bound of the bin, infinity for the last one
+     */
+    double GetBinEnd (uint32_t bin) const;
+    /**
+     * \param q the quantile, between 0 and 1
+     * \return the upper bound of the bin holding the quantile, bounded
+     * by max, or 0 if the histogram is empty
+     */
+    double GetQuantile (double q) const;
+
+private:
+    double m_min;                   ///< lower bound of the first logarithmic bin
+    double m_max;                   ///< upper bound of the last logarithmic bin
+    uint32_t m_binsPerDecade;       ///< number of bins per decade
+    std::vector<uint64_t> m_counts; ///< number of values in each bin
+    uint64_t m_count;               ///< number of values
+  };
   
   /**
    * \brief Increments the count of transmitted packets
@@ -108,6 +196,91 @@ public:
    */
   void IncExpectedRxPktCount (int index);
 
+  /**
+   * \brief Sets the coverage areas of IncExpectedRxPktCounts and
+   * IncRxPktInRangeCounts
+   * \param rangesSq the squared range of each coverage area, in m ^ 2,
+   * by index for statistics minus one
+   */
+  void SetRangesSq (std::vector<double> rangesSq);
+
+  /**
+   * \brief Adds a node to the receivers of IncExpectedRxPktCounts
+   * \param node the node, which must have a mobility model
+   */
+  void AddNode (Ptr<Node> node);
+
+  /**
+   * \return the number of receivers of IncExpectedRxPktCounts
+   */
+  uint32_t GetNNodes (void) const;
+
+  /**
+   * \brief Increments the count of packets expected to be received
+   * within each coverage area, for a broadcast from a node to the other
+   * nodes that are moving.
+   * \param txNode the transmitting node
+   * \param nodesMoving whether each node is moving, by node id
+   */
+  void IncExpectedRxPktCounts (Ptr<Node> txNode, const std::vector<int> *nodesMoving);
+
+  /**
+   * \brief Increments the count of packets received within each coverage
+   * area covering the given distance.
+   * \param distSq the squared distance between the transmitter and the
+   * receiver, in m ^ 2
+   */
+  void IncRxPktInRangeCounts (double distSq);
+
+  /**
+   * \brief Records the reception of a BSM for the inter-packet gap and
+   * the age of information between its transmitter and its receiver.
+   *
+   * The age of information of a transmitter at a receiver is the time
+   * elapsed since the generation of the last BSM received; its peak,
+   * reached just before a new BSM is received, is the sample recorded.
+   * Both nodes must have been added by AddNode.
+   *
+   * \param txNode the transmitting node
+   * \param rxNode the receiving node
+   * \param generated the time the BSM was generated
+   */
+  void RecordRx (Ptr<Node> txNode, Ptr<Node> rxNode, Time generated);
+
+  /**
+   * \brief Returns the BSM Packet Delivery Ratio (PDR) over the last
+   * NumWindows windows, including the current one
+   * \param index index for statistics
+   * \return the packet delivery ratio (PDR) of BSMs
+   */
+  double GetWindowedBsmPdr (int index);
+
+  /**
+   * \brief Returns a quantile of the inter-packet gaps over the last
+   * NumWindows windows, including the current one
+   * \param q the quantile, between 0 and 1
+   * \return the upper bound of the histogram bin holding the quantile
+   */
+  Time GetInterPacketGapQuantile (double q);
+
+  /**
+   * \brief Returns a quantile of the peak ages of information over the
+   * last NumWindows windows, including the current one
+   * \param q the quantile, between 0 and 1
+   * \return the upper bound of the histogram bin holding the quantile
+   */
+  Time GetAgeQuantile (double q);
+
+  /**
+   * \return the histogram of all the inter-packet gaps, in seconds
+   */
+  const LogHistogram & GetInterPacketGapHistogram (void) const;
+
+  /**
+   * \return the histogram of all the peak ages of information, in seconds
+   */
+  const LogHistogram & GetAgeHistogram (void) const;
+
   /**
    * \brief Increments the count of actual packets received
    * (regardless of coverage area).
@@ -222,6 +395,37 @@ public:
   int GetLogging ();
 
 private:
+  /**
+   * Adds the counts by smallest covering range to the counts by range
+   */
+  void Flush (void);
+
+  /**
+   * Rebuilds the grid from the current node positions
+   */
+  void BuildGrid (void);
+
+  /**
+   * Notifies that the mobility model of a node changed course
+   * \param context the index of the node
+   * \param mobility the mobility model
+   */
+  void CourseChanged (std::string context, Ptr<const MobilityModel> mobility);
+
+  /**
+   * Finds the slot of the current window in the ring buffers, clearing
+   * it if it held an older window
+   * \return the slot of the current window
+   */
+  uint32_t GetWindowSlot (void);
+
+  /**
+   * Merges the histograms of the last windows
+   * \param windows the histogram of each slot
+   * \return the merged histogram
+   */
+  const LogHistogram & MergeWindows (const std::vector<LogHistogram> &windows);
+
   int m_wavePktSendCount; ///< packet sent count
   int m_waveByteSendCount; ///< byte sent count
   int m_wavePktReceiveCount; ///< packet receive count 
@@ -230,6 +434,42 @@ private:
   std::vector <int> m_waveTotalPktInCoverageReceiveCounts; ///< total packet in coverage receive counts
   std::vector <int> m_waveTotalPktExpectedReceiveCounts; ///< total packet expected receive counts
   int m_log; ///< log
+
+  std::vector<double> m_sortedRangesSq; ///< squared ranges, sorted
+  std::vector<int> m_sortedRangeIndex; ///< index for statistics of each sorted range
+  std::vector<int> m_expectedRxBins; ///< expected packets by smallest covering range, not flushed yet
+  std::vector<int> m_inRangeRxBins; ///< received packets by smallest covering range, not flushed yet
+  bool m_binsDirty; ///< whether the bins hold counts not flushed yet
+
+  std::vector<Ptr<MobilityModel> > m_mobility; ///< mobility model of each node
+  std::vector<uint32_t> m_nodeIds; ///< id of each node
+  std::vector<Vector> m_gridPositions; ///< position of each node when the grid was built
+  std::vector<uint32_t> m_cellStart; ///< first entry of each cell in m_cellNodes, plus the end
+  std::vector<uint32_t> m_cellNodes; ///< nodes sorted by cell
+  double m_cellSize; ///< side of a cell, in m
+  double m_minX; ///< x of the first column, in m
+  double m_minY; ///< y of the first row, in m
+  uint32_t m_nCols; ///< number of columns
+  uint32_t m_nRows; ///< number of rows
+  double m_maxSpeed; ///< highest speed since the grid was built, in m/s
+  Time m_gridTime; ///< time the grid was built, negative if it must be rebuilt
+  Time m_gridUpdateInterval; ///< maximum age of the grid
+  bool m_searchAllCells; ///< whether a node may change speed without notifying it
+
+  std::vector<uint32_t> m_nodeIndex; ///< index of each node, by node id
+  std::vector<Time> m_lastRxTime; ///< last reception of each (tx, rx) pair, negative if none
+  std::vector<Time> m_lastGenerated; ///< generation of the last BSM received by each (tx, rx) pair
+  LogHistogram m_gapHistogram; ///< all the inter-packet gaps, in s
+  LogHistogram m_ageHistogram; ///< all the peak ages of information, in s
+
+  Time m_windowDuration; ///< duration of a window
+  uint32_t m_nWindows; ///< number of windows
+  std::vector<int64_t> m_windowIds; ///< window held by each slot
+  std::vector<int> m_windowExpectedRxBins; ///< expected packets by slot, then by smallest covering range
+  std::vector<int> m_windowInRangeRxBins; ///< received packets by slot, then by smallest covering range
+  std::vector<LogHistogram> m_windowGaps; ///< inter-packet gaps by slot
+  std::vector<LogHistogram> m_windowAges; ///< peak ages of information by slot
+  LogHistogram m_merged; ///< histogram merged over the windows
 };
 
 } // namespace ns3
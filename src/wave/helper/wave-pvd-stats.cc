@@ -32,7 +32,9 @@ WavePvdStats::WavePvdStats ()
   : m_wavePktSendCount (0),
     m_waveByteSendCount (0),
     m_wavePktReceiveCount (0),
-    m_log (0)
+    m_log (0),
+    m_deferredCount (0),
+    m_coalescedCount (0)
 {
   m_wavePktExpectedReceiveCounts.resize (10, 0);
   m_wavePktInCoverageReceiveCounts.resize (10, 0);
@@ -180,6 +182,30 @@ WavePvdStats::GetLogging ()
   return m_log;
 }
 
+void
+WavePvdStats::IncDeferredPvdCount ()
+{
+  m_deferredCount++;
+}
+
+int
+WavePvdStats::GetDeferredPvdCount ()
+{
+  return m_deferredCount;
+}
+
+void
+WavePvdStats::IncCoalescedPvdCount ()
+{
+  m_coalescedCount++;
+}
+
+int
+WavePvdStats::GetCoalescedPvdCount ()
+{
+  return m_coalescedCount;
+}
+
 void
 WavePvdStats::SetExpectedRxPktCount (int index, int count)
 {
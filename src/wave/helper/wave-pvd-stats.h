@@ -233,6 +233,32 @@ public:
    */
   int GetLogging ();
 
+  /**
+   * \brief Increments the count of PVD snapshots whose transmission
+   * was deferred because the channel was loaded
+   * \return none
+   */
+  void IncDeferredPvdCount ();
+
+  /**
+   * \brief Returns the count of deferred PVD snapshots
+   * \return the count of PVD snapshots deferred
+   */
+  int GetDeferredPvdCount ();
+
+  /**
+   * \brief Increments the count of PVD snapshots coalesced into the
+   * packet of an earlier, deferred snapshot
+   * \return none
+   */
+  void IncCoalescedPvdCount ();
+
+  /**
+   * \brief Returns the count of coalesced PVD snapshots
+   * \return the count of PVD snapshots coalesced
+   */
+  int GetCoalescedPvdCount ();
+
 private:
   int m_wavePktSendCount; ///< packet sent count
   int m_waveByteSendCount; ///< byte sent count
@@ -242,6 +268,8 @@ private:
   std::vector <int> m_waveTotalPktInCoverageReceiveCounts; ///< total packet in coverage receive counts
   std::vector <int> m_waveTotalPktExpectedReceiveCounts; ///< total packet expected receive counts
   int m_log; ///< log
+  int m_deferredCount; ///< deferred snapshot count
+  int m_coalescedCount; ///< coalesced snapshot count
 };
 
 } // namespace ns3
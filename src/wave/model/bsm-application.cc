@@ -26,11 +26,95 @@
 #include "ns3/wave-helper.h"
 #include "ns3/mobility-model.h"
 #include "ns3/mobility-helper.h"
+#include "ns3/tag.h"
 
 NS_LOG_COMPONENT_DEFINE ("BsmApplication");
 
 namespace ns3 {
 
+/**
+ * \ingroup wave
+ *
+ * \brief Tag carrying the generation time of a WAVE BSM, for the age of
+ * information of the BSM statistics
+ */
+class BsmTimestampTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  BsmTimestampTag ();
+  /**
+   * \brief Constructor
+   * \param generated the generation time of the BSM
+   */
+  BsmTimestampTag (Time generated);
+  /**
+   * \return the generation time of the BSM
+   */
+  Time GetGenerated (void) const;
+private:
+  Time m_generated; //!< generation time of the BSM
+};
+
+TypeId
+BsmTimestampTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::BsmTimestampTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Wave")
+    .AddConstructor<BsmTimestampTag> ()
+  ;
+  return tid;
+}
+TypeId
+BsmTimestampTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+uint32_t
+BsmTimestampTag::GetSerializedSize (void) const
+{
+  return 8;
+}
+void
+BsmTimestampTag::Serialize (TagBuffer buf) const
+{
+  buf.WriteU64 (m_generated.GetTimeStep ());
+}
+void
+BsmTimestampTag::Deserialize (TagBuffer buf)
+{
+  m_generated = TimeStep (buf.ReadU64 ());
+}
+void
+BsmTimestampTag::Print (std::ostream &os) const
+{
+  os << "generated=" << m_generated;
+}
+BsmTimestampTag::BsmTimestampTag ()
+  : Tag ()
+{
+}
+BsmTimestampTag::BsmTimestampTag (Time generated)
+  : Tag (),
+    m_generated (generated)
+{
+}
+Time
+BsmTimestampTag::GetGenerated (void) const
+{
+  return m_generated;
+}
+
 // (Arbitrary) port for establishing socket to transmit WAVE BSMs
 int BsmApplication::wavePort = 9080;
 
@@ -43,6 +127,17 @@ BsmApplication::GetTypeId (void)
     .SetParent<Application> ()
     .SetGroupName ("Wave")
     .AddConstructor<BsmApplication> ()
+    .AddAttribute ("WaveInterval",
+                   "The time between two WAVE BSM transmissions. "
+                   "May be changed while the application is running.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&BsmApplication::SetWaveInterval,
+                                     &BsmApplication::GetWaveInterval),
+                   MakeTimeChecker (NanoSeconds (1)))
+    .AddTraceSource ("WaveIntervalChange",
+                     "The time between two WAVE BSM transmissions has changed.",
+                     MakeTraceSourceAccessor (&BsmApplication::m_waveIntervalChangeTrace),
+                     "ns3::BsmApplication::WaveIntervalChangeTracedCallback")
     ;
   return tid;
 }
@@ -61,7 +156,10 @@ BsmApplication::BsmApplication ()
     m_nodeId (0),
     m_chAccessMode (0),
     m_txMaxDelay (MilliSeconds (10)),
-    m_prevTxDelay (MilliSeconds (0))
+    m_prevTxDelay (MilliSeconds (0)),
+    m_socket (0),
+    m_pktSize (0),
+    m_lastTxBoundary (Seconds (-1))
 {
   NS_LOG_FUNCTION (this);
 }
@@ -76,6 +174,9 @@ BsmApplication::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
 
+  m_sendEvent.Cancel ();
+  m_socket = 0;
+
   // chain up
   Application::DoDispose ();
 }
@@ -169,10 +270,13 @@ void BsmApplication::StartApplication () // Called at time specified by Start
   m_prevTxDelay = txDelay;
 
   Time txTime = startTime + tDrift + txDelay;
-  // schedule transmission of first packet
-  Simulator::ScheduleWithContext (recvSink->GetNode ()->GetId (),
-                                  txTime, &BsmApplication::GenerateWaveTraffic, this,
-                                  recvSink, m_wavePacketSize, m_numWavePackets, waveInterPacketInterval, m_nodeId);
+  m_socket = recvSink;
+  m_pktSize = m_wavePacketSize;
+  m_lastTxBoundary = Seconds (-1);
+  // schedule transmission of first packet; StartApplication already runs
+  // in the context of this node, so the event id can be kept
+  m_sendEvent = Simulator::Schedule (txTime, &BsmApplication::GenerateWaveTraffic, this,
+                                     recvSink, m_wavePacketSize, m_numWavePackets, waveInterPacketInterval, m_nodeId);
 }
 
 void BsmApplication::StopApplication () // Called at time specified by Stop
@@ -217,6 +321,52 @@ BsmApplication::Setup (Ipv4InterfaceContainer & i,
   m_adhocTxInterfaces = &i;
   m_nodeId = nodeId;
   m_txMaxDelay = txMaxDelay;
+
+  // the stats are shared by the applications of all the nodes
+  m_waveBsmStats->SetRangesSq (m_txSafetyRangesSq);
+  if (m_waveBsmStats->GetNNodes () == 0)
+    {
+      for (uint32_t index = 0; index < i.GetN (); index++)
+        {
+          m_waveBsmStats->AddNode (GetNode (index));
+        }
+    }
+}
+
+void
+BsmApplication::SetWaveInterval (Time interval)
+{
+  NS_LOG_FUNCTION (this << interval);
+  Time oldInterval = m_waveInterval;
+  m_waveInterval = interval;
+  if (oldInterval == interval)
+    {
+      return;
+    }
+
+  if (m_sendEvent.IsRunning () && !m_lastTxBoundary.IsNegative ())
+    {
+      // move the pending BSM to one new interval after the previous
+      // interval boundary, keeping its random tx delay, on the same socket
+      Time boundary = m_lastTxBoundary + interval;
+      Time txTime = Max (boundary + m_prevTxDelay, Simulator::Now ());
+      uint32_t pktCount = 0;
+      if (m_TotalSimTime > boundary)
+        {
+          pktCount = (uint32_t) ((m_TotalSimTime - boundary).GetDouble () / interval.GetDouble ());
+        }
+      m_sendEvent.Cancel ();
+      m_sendEvent = Simulator::Schedule (txTime - Simulator::Now (),
+                                         &BsmApplication::GenerateWaveTraffic, this,
+                                         m_socket, m_pktSize, pktCount, interval, m_socket->GetNode ()->GetId ());
+    }
+  m_waveIntervalChangeTrace (oldInterval, interval);
+}
+
+Time
+BsmApplication::GetWaveInterval (void) const
+{
+  return m_waveInterval;
 }
 
 void
@@ -226,6 +376,16 @@ BsmApplication::GenerateWaveTraffic (Ptr<Socket> socket, uint32_t pktSize,
 {
   NS_LOG_FUNCTION (this);
 
+  // interval boundary of this packet (the tx delay is not cumulative)
+  m_lastTxBoundary = Simulator::Now () - m_prevTxDelay;
+  if (pktInterval != m_waveInterval)
+    {
+      // the interval was changed before the first packet was sent
+      pktInterval = m_waveInterval;
+      pktCount = (uint32_t) (Max (m_TotalSimTime - m_lastTxBoundary, Seconds (0)).GetDouble ()
+                             / pktInterval.GetDouble ());
+    }
+
   // more packets to send?
   if (pktCount > 0)
     {
@@ -242,7 +402,9 @@ BsmApplication::GenerateWaveTraffic (Ptr<Socket> socket, uint32_t pktSize,
       if (senderMoving != 0)
         {
           // send it!
-          socket->Send (Create<Packet> (pktSize));
+          Ptr<Packet> packet = Create<Packet> (pktSize);
+          packet->AddByteTag (BsmTimestampTag (Simulator::Now ()));
+          socket->Send (packet);
           // count it
           m_waveBsmStats->IncTxPktCount ();
           m_waveBsmStats->IncTxByteCount (pktSize);
@@ -254,40 +416,7 @@ BsmApplication::GenerateWaveTraffic (Ptr<Socket> socket, uint32_t pktSize,
 
           // find other nodes within range that would be
           // expected to receive this broadbast
-          int nRxNodes = m_adhocTxInterfaces->GetN ();
-          for (int i = 0; i < nRxNodes; i++)
-            {
-              Ptr<Node> rxNode = GetNode (i);
-              int rxNodeId = rxNode->GetId ();
-
-              if (rxNodeId != txNodeId)
-                {
-                  Ptr<MobilityModel> rxPosition = rxNode->GetObject<MobilityModel> ();
-                  NS_ASSERT (rxPosition != 0);
-                  // confirm that the receiving node
-                  // has also started moving in the scenario
-                  // if it has not started moving, then
-                  // it is not a candidate to receive a packet
-                  int receiverMoving = m_nodesMoving->at (rxNodeId);
-                  if (receiverMoving == 1)
-                    {
-                      double distSq = MobilityHelper::GetDistanceSquaredBetween (txNode, rxNode);
-                      if (distSq > 0.0)
-                        {
-                          // dest node within range?
-                          int rangeCount = m_txSafetyRangesSq.size ();
-                          for (int index = 1; index <= rangeCount; index++)
-                            {
-                              if (distSq <= m_txSafetyRangesSq[index - 1])
-                                {
-                                  // we should expect dest node to receive broadcast pkt
-                                  m_waveBsmStats->IncExpectedRxPktCount (index);
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+          m_waveBsmStats->IncExpectedRxPktCounts (txNode, m_nodesMoving);
         }
 
       // every BSM must be scheduled with a tx time delay
@@ -304,9 +433,8 @@ BsmApplication::GenerateWaveTraffic (Ptr<Socket> socket, uint32_t pktSize,
       Time txTime = pktInterval - m_prevTxDelay + txDelay;
       m_prevTxDelay = txDelay;
 
-      Simulator::ScheduleWithContext (socket->GetNode ()->GetId (),
-                                      txTime, &BsmApplication::GenerateWaveTraffic, this,
-                                      socket, pktSize, pktCount - 1, pktInterval,  socket->GetNode ()->GetId ());
+      m_sendEvent = Simulator::Schedule (txTime, &BsmApplication::GenerateWaveTraffic, this,
+                                         socket, pktSize, pktCount - 1, pktInterval,  socket->GetNode ()->GetId ());
     }
   else
     {
@@ -333,7 +461,13 @@ void BsmApplication::ReceiveWavePacket (Ptr<Socket> socket)
               if (addr.GetIpv4 () == m_adhocTxInterfaces->GetAddress (i) )
                 {
                   Ptr<Node> txNode = GetNode (i);
-                  HandleReceivedBsmPacket (txNode, rxNode);
+                  BsmTimestampTag tag;
+                  Time generated = Seconds (-1);
+                  if (packet->FindFirstMatchingByteTag (tag))
+                    {
+                      generated = tag.GetGenerated ();
+                    }
+                  HandleReceivedBsmPacket (txNode, rxNode, generated);
                 }
             }
         }
@@ -341,11 +475,16 @@ void BsmApplication::ReceiveWavePacket (Ptr<Socket> socket)
 }
 
 void BsmApplication::HandleReceivedBsmPacket (Ptr<Node> txNode,
-                                              Ptr<Node> rxNode)
+                                              Ptr<Node> rxNode,
+                                              Time generated)
 {
   NS_LOG_FUNCTION (this);
 
   m_waveBsmStats->IncRxPktCount ();
+  if (!generated.IsNegative ())
+    {
+      m_waveBsmStats->RecordRx (txNode, rxNode, generated);
+    }
 
   Ptr<MobilityModel> rxPosition = rxNode->GetObject<MobilityModel> ();
   NS_ASSERT (rxPosition != 0);
@@ -360,14 +499,7 @@ void BsmApplication::HandleReceivedBsmPacket (Ptr<Node> txNode,
       double rxDistSq = MobilityHelper::GetDistanceSquaredBetween (rxNode, txNode);
       if (rxDistSq > 0.0)
         {
-          int rangeCount = m_txSafetyRangesSq.size ();
-          for (int index = 1; index <= rangeCount; index++)
-            {
-              if (rxDistSq <= m_txSafetyRangesSq[index - 1])
-                {
-                  m_waveBsmStats->IncRxPktInRangeCount (index);
-                }
-            }
+          m_waveBsmStats->IncRxPktInRangeCounts (rxDistSq);
         }
     }
 }
@@ -23,6 +23,8 @@
 #define BSM_APPLICATION_H
 
 #include "ns3/application.h"
+#include "ns3/event-id.h"
+#include "ns3/traced-callback.h"
 #include "ns3/wave-bsm-stats.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/internet-stack-helper.h"
@@ -93,6 +95,29 @@ public:
   */
   int64_t AssignStreams (int64_t streamIndex);
 
+  /**
+   * \brief Set the time between two WAVE BSM transmissions
+   *
+   * May be called while the application is running, e.g. by a congestion
+   * controller adapting the ITT.  The pending BSM is moved to one new
+   * interval after the previous one, on the same socket.
+   *
+   * \param interval the time between two WAVE BSM transmissions
+   */
+  void SetWaveInterval (Time interval);
+  /**
+   * \return the time between two WAVE BSM transmissions
+   */
+  Time GetWaveInterval (void) const;
+
+  /**
+   * TracedCallback signature for changes of the time between two WAVE BSMs
+   *
+   * \param [in] oldInterval the previous interval
+   * \param [in] newInterval the new interval
+   */
+  typedef void (* WaveIntervalChangeTracedCallback)(Time oldInterval, Time newInterval);
+
   /**
   * (Arbitrary) port number that is used to create a socket for transmitting WAVE BSMs.
   */
@@ -129,9 +154,11 @@ private:
    * \brief Handle the receipt of a WAVE BSM packet from sender to receiver
    * \param txNode the sending node
    * \param rxNode the receiving node
+   * \param generated the generation time of the packet, negative if unknown
    */
   void HandleReceivedBsmPacket (Ptr<Node> txNode,
-                                Ptr<Node> rxNode);
+                                Ptr<Node> rxNode,
+                                Time generated);
 
   /**
    * \brief Get the node for the desired id
@@ -171,6 +198,12 @@ private:
    * max transmit delay (default 10ms) */
   Time m_txMaxDelay;
   Time m_prevTxDelay; ///< previous transmit delay
+  Ptr<Socket> m_socket; ///< socket used for transmission
+  uint32_t m_pktSize; ///< size of the pending WAVE BSM
+  Time m_lastTxBoundary; ///< interval boundary of the last WAVE BSM, negative if none yet
+  EventId m_sendEvent; ///< pending WAVE BSM transmission
+  /// Traced Callback: changes of the time between two WAVE BSMs
+  TracedCallback<Time, Time> m_waveIntervalChangeTrace;
 };
 
 } // namespace ns3
@@ -0,0 +1,271 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/channel-busy-ratio-monitor.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/wifi-phy-state-helper.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wave-net-device.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ChannelBusyRatioMonitor");
+
+NS_OBJECT_ENSURE_REGISTERED (ChannelBusyRatioMonitor);
+
+TypeId
+ChannelBusyRatioMonitor::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ChannelBusyRatioMonitor")
+    .SetParent<Object> ()
+    .SetGroupName ("Wave")
+    .AddConstructor<ChannelBusyRatioMonitor> ()
+    .AddAttribute ("Window",
+                   "The length of the sliding window over which the CBR is measured.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&ChannelBusyRatioMonitor::m_window),
+                   MakeTimeChecker (NanoSeconds (1)))
+    .AddAttribute ("Slots",
+                   "The number of slots the window is divided into. "
+                   "The CBR is updated at the end of every slot.",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&ChannelBusyRatioMonitor::m_numSlots),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddTraceSource ("ChannelBusyRatio",
+                     "The CBR measured at the end of each slot.",
+                     MakeTraceSourceAccessor (&ChannelBusyRatioMonitor::m_cbr),
+                     "ns3::TracedValueCallback::Double")
+  ;
+  return tid;
+}
+
+ChannelBusyRatioMonitor::ChannelBusyRatioMonitor ()
+  : m_numSlots (10),
+    m_currentSlot (0),
+    m_windowBusy (Seconds (0)),
+    m_lastLogEnd (Seconds (0)),
+    m_startTime (Seconds (0)),
+    m_lastBusy (Seconds (0)),
+    m_state (0),
+    m_context (Simulator::NO_CONTEXT),
+    m_cbr (0.0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ChannelBusyRatioMonitor::~ChannelBusyRatioMonitor ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ChannelBusyRatioMonitor::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_slotEvent.Cancel ();
+  if (m_state != 0)
+    {
+      m_state->TraceDisconnectWithoutContext ("State", MakeCallback (&ChannelBusyRatioMonitor::NotifyState, this));
+      m_state = 0;
+    }
+  Object::DoDispose ();
+}
+
+void
+ChannelBusyRatioMonitor::Attach (Ptr<NetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  Ptr<WaveNetDevice> wave = DynamicCast<WaveNetDevice> (device);
+  if (wave != 0)
+    {
+      Attach (wave->GetPhy (0));
+      return;
+    }
+  Ptr<WifiNetDevice> wifi = DynamicCast<WifiNetDevice> (device);
+  if (wifi != 0)
+    {
+      Attach (wifi->GetPhy ());
+      return;
+    }
+  NS_FATAL_ERROR ("ChannelBusyRatioMonitor requires a WifiNetDevice or a WaveNetDevice");
+}
+
+void
+ChannelBusyRatioMonitor::Attach (Ptr<WifiPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  uint32_t context = Simulator::NO_CONTEXT;
+  if (phy->GetDevice () != 0 && phy->GetDevice ()->GetNode () != 0)
+    {
+      context = phy->GetDevice ()->GetNode ()->GetId ();
+    }
+  Attach (phy->GetState (), context);
+}
+
+void
+ChannelBusyRatioMonitor::Attach (Ptr<WifiPhyStateHelper> state, uint32_t context)
+{
+  NS_LOG_FUNCTION (this << state << context);
+  NS_ASSERT_MSG (m_state == 0, "ChannelBusyRatioMonitor is already attached to a PHY");
+  NS_ASSERT (state != 0);
+
+  m_slotDuration = TimeStep (m_window.GetTimeStep () / m_numSlots);
+  NS_ASSERT_MSG (m_slotDuration.IsStrictlyPositive (), "Window is too short for " << m_numSlots << " slots");
+
+  // the ring holds the slots of the window plus as many slots ahead of
+  // the current one, since a TX is logged with its (future) end time
+  m_slotBusy.assign (2 * m_numSlots, Seconds (0));
+  m_slotNumber.assign (2 * m_numSlots, -1);
+
+  Time now = Simulator::Now ();
+  m_startTime = now;
+  m_lastLogEnd = now;
+  m_windowBusy = Seconds (0);
+  m_currentSlot = now.GetTimeStep () / m_slotDuration.GetTimeStep ();
+
+  m_state = state;
+  m_context = context;
+  m_state->TraceConnectWithoutContext ("State", MakeCallback (&ChannelBusyRatioMonitor::NotifyState, this));
+
+  // the first slot event cannot be cancelled (it is scheduled with a
+  // context), so it holds a reference and EndSlot ignores it once disposed
+  Time slotEnd = TimeStep ((m_currentSlot + 1) * m_slotDuration.GetTimeStep ());
+  Simulator::ScheduleWithContext (m_context, slotEnd - now,
+                                  &ChannelBusyRatioMonitor::EndSlot,
+                                  Ptr<ChannelBusyRatioMonitor> (this));
+}
+
+double
+ChannelBusyRatioMonitor::GetChannelBusyRatio (void) const
+{
+  return m_cbr;
+}
+
+Time
+ChannelBusyRatioMonitor::GetBusyTime (void) const
+{
+  return m_lastBusy;
+}
+
+void
+ChannelBusyRatioMonitor::NotifyState (Time start, Time duration, WifiPhyState state)
+{
+  NS_LOG_FUNCTION (this << start << duration << state);
+  Time end = start + duration;
+  if (end > m_lastLogEnd)
+    {
+      m_lastLogEnd = end;
+    }
+  if (state == WifiPhyState::RX
+      || state == WifiPhyState::TX
+      || state == WifiPhyState::CCA_BUSY)
+    {
+      AddBusyTime (Max (start, m_startTime), end);
+    }
+}
+
+void
+ChannelBusyRatioMonitor::AddBusyTime (Time start, Time end)
+{
+  NS_LOG_FUNCTION (this << start << end);
+  if (start >= end)
+    {
+      return;
+    }
+  int64_t slotTs = m_slotDuration.GetTimeStep ();
+  int64_t first = start.GetTimeStep () / slotTs;
+  int64_t last = (end.GetTimeStep () - 1) / slotTs;
+  // only the slots held by the ring can be credited
+  first = std::max<int64_t> (first, m_currentSlot - m_numSlots);
+  last = std::min<int64_t> (last, m_currentSlot + m_numSlots - 1);
+  for (int64_t slot = first; slot <= last; slot++)
+    {
+      Time slotStart = TimeStep (slot * slotTs);
+      Time slotEnd = slotStart + m_slotDuration;
+      AddSlotBusyTime (slot, Min (end, slotEnd) - Max (start, slotStart));
+    }
+}
+
+void
+ChannelBusyRatioMonitor::AddSlotBusyTime (int64_t slot, Time busy)
+{
+  uint32_t index = slot % m_slotBusy.size ();
+  if (m_slotNumber[index] != slot)
+    {
+      m_slotNumber[index] = slot;
+      m_slotBusy[index] = Seconds (0);
+    }
+  m_slotBusy[index] += busy;
+  if (slot < m_currentSlot)
+    {
+      // late log of a state that started in an already completed slot
+      m_windowBusy += busy;
+    }
+}
+
+void
+ChannelBusyRatioMonitor::EndSlot (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_state == 0)
+    {
+      return;
+    }
+  uint32_t ringSize = m_slotBusy.size ();
+
+  // the slot in progress joins the window ...
+  uint32_t index = m_currentSlot % ringSize;
+  if (m_slotNumber[index] == m_currentSlot)
+    {
+      m_windowBusy += m_slotBusy[index];
+    }
+  // ... and the oldest slot leaves it
+  int64_t expired = m_currentSlot - m_numSlots;
+  if (expired >= 0)
+    {
+      index = expired % ringSize;
+      if (m_slotNumber[index] == expired)
+        {
+          m_windowBusy -= m_slotBusy[index];
+        }
+    }
+  m_currentSlot++;
+
+  Time now = Simulator::Now ();
+  Time busy = m_windowBusy;
+  // the state in progress has not been logged by the PHY yet
+  if (m_lastLogEnd < now
+      && (m_state->IsStateRx () || m_state->IsStateTx () || m_state->IsStateCcaBusy ()))
+    {
+      busy += now - Max (m_lastLogEnd, now - m_window);
+    }
+  Time span = Min (m_window, now - m_startTime);
+  m_lastBusy = busy;
+  if (span.IsStrictlyPositive ())
+    {
+      m_cbr = std::min (1.0, static_cast<double> (busy.GetTimeStep ()) / span.GetTimeStep ());
+    }
+  NS_LOG_DEBUG ("CBR " << m_cbr << " busy " << busy << " over " << span);
+
+  m_slotEvent = Simulator::Schedule (m_slotDuration, &ChannelBusyRatioMonitor::EndSlot, this);
+}
+
+} // namespace ns3
@@ -0,0 +1,133 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CHANNEL_BUSY_RATIO_MONITOR_H
+#define CHANNEL_BUSY_RATIO_MONITOR_H
+
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/traced-value.h"
+#include "ns3/wifi-phy-state.h"
+
+namespace ns3 {
+
+class NetDevice;
+class WifiPhy;
+class WifiPhyStateHelper;
+
+/**
+ * \ingroup wave
+ * \brief Measures the Channel Busy Ratio (CBR) seen by a single PHY.
+ *
+ * The monitor listens to the "State" trace source of a WifiPhyStateHelper
+ * and accumulates the time spent in the RX, TX and CCA_BUSY states.  The
+ * CBR is the busy fraction of a sliding window (100 ms by default) that
+ * advances in fixed slots; every state change costs O(1) and the window
+ * is re-evaluated once per slot, at which point the "ChannelBusyRatio"
+ * trace source fires.
+ *
+ * Busy time of the state in progress at a slot boundary is included in
+ * the reported value even though the PHY only logs it once the state
+ * ends.  A CCA_BUSY period that ended while the PHY was otherwise idle is
+ * logged retroactively by the PHY and is therefore credited (to the slots
+ * it really covered) at the next state change only.
+ */
+class ChannelBusyRatioMonitor : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  ChannelBusyRatioMonitor ();
+  virtual ~ChannelBusyRatioMonitor ();
+
+  /**
+   * \brief Monitor the first PHY of a WifiNetDevice or WaveNetDevice
+   * \param device the device to monitor
+   */
+  void Attach (Ptr<NetDevice> device);
+  /**
+   * \brief Monitor a PHY
+   * \param phy the PHY to monitor
+   */
+  void Attach (Ptr<WifiPhy> phy);
+  /**
+   * \brief Monitor a PHY state helper directly
+   * \param state the state helper to monitor
+   * \param context the context (node id) of the periodic slot events
+   */
+  void Attach (Ptr<WifiPhyStateHelper> state, uint32_t context);
+
+  /**
+   * \return the CBR, in [0, 1], computed at the last slot boundary
+   */
+  double GetChannelBusyRatio (void) const;
+  /**
+   * \return the busy time credited to the window ending at the last slot boundary
+   */
+  Time GetBusyTime (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Sink of the WifiPhyStateHelper "State" trace source
+   * \param start the time the state started
+   * \param duration the duration of the state
+   * \param state the state
+   */
+  void NotifyState (Time start, Time duration, WifiPhyState state);
+  /**
+   * \brief Credit the interval [start, end) as busy time
+   * \param start start of the busy interval
+   * \param end end of the busy interval
+   */
+  void AddBusyTime (Time start, Time end);
+  /**
+   * \brief Credit busy time to a single slot
+   * \param slot absolute slot number
+   * \param busy the busy time to credit
+   */
+  void AddSlotBusyTime (int64_t slot, Time busy);
+  /**
+   * \brief Close the current slot, slide the window and update the CBR
+   */
+  void EndSlot (void);
+
+  Time m_window;                       ///< sliding window length
+  uint32_t m_numSlots;                 ///< number of slots per window
+  Time m_slotDuration;                 ///< m_window / m_numSlots
+  std::vector<Time> m_slotBusy;        ///< ring of busy time per slot
+  std::vector<int64_t> m_slotNumber;   ///< absolute slot number held in each ring entry
+  int64_t m_currentSlot;               ///< absolute number of the slot in progress
+  Time m_windowBusy;                   ///< busy time credited to the completed slots of the window
+  Time m_lastLogEnd;                   ///< end of the last state logged by the PHY
+  Time m_startTime;                    ///< time at which monitoring started
+  Time m_lastBusy;                     ///< busy time of the window at the last slot boundary
+  Ptr<WifiPhyStateHelper> m_state;     ///< monitored state helper
+  uint32_t m_context;                  ///< context of the slot events
+  EventId m_slotEvent;                 ///< next slot boundary
+  TracedValue<double> m_cbr;           ///< CBR at the last slot boundary
+};
+
+} // namespace ns3
+
+#endif /* CHANNEL_BUSY_RATIO_MONITOR_H */
@@ -0,0 +1,359 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include "ns3/congestion-controller.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CongestionController");
+
+NS_OBJECT_ENSURE_REGISTERED (CongestionController);
+
+TypeId
+CongestionController::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CongestionController")
+    .SetParent<Object> ()
+    .SetGroupName ("Wave")
+    .AddAttribute ("InitialItt",
+                   "The ITT in use before the first update.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&CongestionController::SetInitialItt,
+                                     &CongestionController::GetItt),
+                   MakeTimeChecker (NanoSeconds (1)))
+    .AddTraceSource ("Itt",
+                     "The ITT selected at each update.",
+                     MakeTraceSourceAccessor (&CongestionController::m_itt),
+                     "ns3::TracedValueCallback::Time")
+  ;
+  return tid;
+}
+
+CongestionController::CongestionController ()
+  : m_itt (MilliSeconds (100))
+{
+  NS_LOG_FUNCTION (this);
+}
+
+CongestionController::~CongestionController ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Time
+CongestionController::Update (double cbr, double density)
+{
+  NS_LOG_FUNCTION (this << cbr << density);
+  m_itt = DoUpdate (cbr, density);
+  NS_LOG_DEBUG ("cbr " << cbr << " density " << density << " itt " << m_itt.Get ());
+  return m_itt;
+}
+
+Time
+CongestionController::GetItt (void) const
+{
+  return m_itt;
+}
+
+void
+CongestionController::SetInitialItt (Time itt)
+{
+  NS_LOG_FUNCTION (this << itt);
+  m_itt = itt;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (TableCongestionController);
+
+TypeId
+TableCongestionController::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TableCongestionController")
+    .SetParent<CongestionController> ()
+    .SetGroupName ("Wave")
+    .AddConstructor<TableCongestionController> ()
+    .AddAttribute ("Table",
+                   "The table as \"bound:itt\" pairs separated by commas, "
+                   "bound the upper CBR bound of the row and itt in seconds.",
+                   StringValue ("0.40:0.080,0.47:0.084,0.53:0.089,0.60:0.094,0.67:0.100,"
+                                "0.73:0.107,0.80:0.114,0.87:0.123,0.93:0.133,1.0:0.145,"
+                                "1.0:0.160"),
+                   MakeStringAccessor (&TableCongestionController::SetTable),
+                   MakeStringChecker ())
+    .AddAttribute ("TableFile",
+                   "A CSV file of \"bound,itt\" rows replacing the table, if not empty.",
+                   StringValue (""),
+                   MakeStringAccessor (&TableCongestionController::LoadTable),
+                   MakeStringChecker ())
+  ;
+  return tid;
+}
+
+TableCongestionController::TableCongestionController ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TableCongestionController::~TableCongestionController ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TableCongestionController::AddRow (double bound, Time itt)
+{
+  Row row;
+  row.bound = bound;
+  row.itt = itt;
+  // stable: of two rows with the same bound, the last one covers the CBRs above it
+  std::vector<Row>::iterator it = std::upper_bound (m_rows.begin (), m_rows.end (), bound,
+                                                    [] (double b, const Row &r) { return b < r.bound; });
+  m_rows.insert (it, row);
+}
+
+void
+TableCongestionController::SetTable (std::string table)
+{
+  NS_LOG_FUNCTION (this << table);
+  m_rows.clear ();
+  std::istringstream iss (table);
+  std::string entry;
+  while (std::getline (iss, entry, ','))
+    {
+      std::string::size_type colon = entry.find (':');
+      NS_ABORT_MSG_IF (colon == std::string::npos, "Malformed table entry \"" << entry << "\"");
+      double bound = std::stod (entry.substr (0, colon));
+      double itt = std::stod (entry.substr (colon + 1));
+      AddRow (bound, Seconds (itt));
+    }
+}
+
+void
+TableCongestionController::LoadTable (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  if (filename.empty ())
+    {
+      return;
+    }
+  std::ifstream in (filename.c_str ());
+  NS_ABORT_MSG_UNLESS (in.is_open (), "Could not open " << filename);
+  m_rows.clear ();
+  std::string line;
+  while (std::getline (in, line))
+    {
+      if (line.empty () || line[0] == '#')
+        {
+          continue;
+        }
+      std::string::size_type comma = line.find (',');
+      NS_ABORT_MSG_IF (comma == std::string::npos, "Malformed line \"" << line << "\" in " << filename);
+      double bound = std::stod (line.substr (0, comma));
+      double itt = std::stod (line.substr (comma + 1));
+      AddRow (bound, Seconds (itt));
+    }
+}
+
+uint32_t
+TableCongestionController::GetNRows (void) const
+{
+  return m_rows.size ();
+}
+
+Time
+TableCongestionController::DoUpdate (double cbr, double density)
+{
+  NS_ABORT_MSG_IF (m_rows.empty (), "Empty congestion control table");
+  // first row whose bound is above the CBR, the last row otherwise
+  std::vector<Row>::const_iterator it = std::upper_bound (m_rows.begin (), m_rows.end (), cbr,
+                                                          [] (double c, const Row &r) { return c < r.bound; });
+  if (it == m_rows.end ())
+    {
+      return m_rows.back ().itt;
+    }
+  return it->itt;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (LimericCongestionController);
+
+TypeId
+LimericCongestionController::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LimericCongestionController")
+    .SetParent<CongestionController> ()
+    .SetGroupName ("Wave")
+    .AddConstructor<LimericCongestionController> ()
+    .AddAttribute ("Alpha",
+                   "The weight of the previous duty cycle is 1 - Alpha.",
+                   DoubleValue (0.016),
+                   MakeDoubleAccessor (&LimericCongestionController::m_alpha),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("Beta",
+                   "The gain applied to the CBR error.",
+                   DoubleValue (0.0012),
+                   MakeDoubleAccessor (&LimericCongestionController::m_beta),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("TargetCbr",
+                   "The CBR the channel converges to.",
+                   DoubleValue (0.68),
+                   MakeDoubleAccessor (&LimericCongestionController::m_targetCbr),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("GPlus",
+                   "The largest duty cycle increase per update.",
+                   DoubleValue (0.0005),
+                   MakeDoubleAccessor (&LimericCongestionController::m_gPlus),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("GMinus",
+                   "The largest duty cycle decrease per update (a negative value).",
+                   DoubleValue (-0.00025),
+                   MakeDoubleAccessor (&LimericCongestionController::m_gMinus),
+                   MakeDoubleChecker<double> (-1, 0))
+    .AddAttribute ("MinDutyCycle",
+                   "The lowest duty cycle.",
+                   DoubleValue (0.0006),
+                   MakeDoubleAccessor (&LimericCongestionController::m_minDutyCycle),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("MaxDutyCycle",
+                   "The highest duty cycle.",
+                   DoubleValue (0.03),
+                   MakeDoubleAccessor (&LimericCongestionController::m_maxDutyCycle),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("Airtime",
+                   "The airtime of one message; 312 us is a 200-byte BSM at 6 Mb/s on a 10 MHz channel.",
+                   TimeValue (MicroSeconds (312)),
+                   MakeTimeAccessor (&LimericCongestionController::m_airtime),
+                   MakeTimeChecker (NanoSeconds (1)))
+    .AddAttribute ("MinItt",
+                   "The lowest ITT.",
+                   TimeValue (MilliSeconds (80)),
+                   MakeTimeAccessor (&LimericCongestionController::m_minItt),
+                   MakeTimeChecker (NanoSeconds (1)))
+    .AddAttribute ("MaxItt",
+                   "The highest ITT.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&LimericCongestionController::m_maxItt),
+                   MakeTimeChecker (NanoSeconds (1)))
+  ;
+  return tid;
+}
+
+LimericCongestionController::LimericCongestionController ()
+  : m_dutyCycle (-1)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LimericCongestionController::~LimericCongestionController ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+double
+LimericCongestionController::GetDutyCycle (void) const
+{
+  return m_dutyCycle;
+}
+
+Time
+LimericCongestionController::DoUpdate (double cbr, double density)
+{
+  if (m_dutyCycle < 0)
+    {
+      // start from the current ITT
+      m_dutyCycle = m_airtime.GetSeconds () / m_itt.Get ().GetSeconds ();
+    }
+  double delta = m_beta * (m_targetCbr - cbr);
+  delta = std::min (m_gPlus, std::max (m_gMinus, delta));
+  m_dutyCycle = (1 - m_alpha) * m_dutyCycle + delta;
+  m_dutyCycle = std::min (m_maxDutyCycle, std::max (m_minDutyCycle, m_dutyCycle));
+
+  Time itt = Seconds (m_airtime.GetSeconds () / m_dutyCycle);
+  return Min (m_maxItt, Max (m_minItt, itt));
+}
+
+NS_OBJECT_ENSURE_REGISTERED (J2945CongestionController);
+
+TypeId
+J2945CongestionController::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::J2945CongestionController")
+    .SetParent<CongestionController> ()
+    .SetGroupName ("Wave")
+    .AddConstructor<J2945CongestionController> ()
+    .AddAttribute ("DensityCoefficient",
+                   "The number of vehicles within range sharing the minimum ITT.",
+                   DoubleValue (25),
+                   MakeDoubleAccessor (&J2945CongestionController::m_densityCoefficient),
+                   MakeDoubleChecker<double> (1))
+    .AddAttribute ("DensityWeight",
+                   "The weight of a new vehicle density sample in the smoothed density.",
+                   DoubleValue (0.05),
+                   MakeDoubleAccessor (&J2945CongestionController::m_densityWeight),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("MinItt",
+                   "The lowest ITT.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&J2945CongestionController::m_minItt),
+                   MakeTimeChecker (NanoSeconds (1)))
+    .AddAttribute ("MaxItt",
+                   "The highest ITT.",
+                   TimeValue (MilliSeconds (600)),
+                   MakeTimeAccessor (&J2945CongestionController::m_maxItt),
+                   MakeTimeChecker (NanoSeconds (1)))
+  ;
+  return tid;
+}
+
+J2945CongestionController::J2945CongestionController ()
+  : m_density (-1)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+J2945CongestionController::~J2945CongestionController ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+double
+J2945CongestionController::GetSmoothedDensity (void) const
+{
+  return m_density;
+}
+
+Time
+J2945CongestionController::DoUpdate (double cbr, double density)
+{
+  if (m_density < 0)
+    {
+      m_density = density;
+    }
+  else
+    {
+      m_density = m_densityWeight * density + (1 - m_densityWeight) * m_density;
+    }
+  double factor = std::max (1.0, m_density / m_densityCoefficient);
+  Time itt = Seconds (m_minItt.GetSeconds () * factor);
+  return Min (m_maxItt, itt);
+}
+
+} // namespace ns3
@@ -0,0 +1,225 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CONGESTION_CONTROLLER_H
+#define CONGESTION_CONTROLLER_H
+
+#include <string>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-value.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup wave
+ * \brief Base class of the decentralized congestion control (DCC) policies
+ * selecting the inter-transmit time (ITT) of safety messages.
+ *
+ * A controller is meant to run on every OBU against the CBR measured by
+ * its own PHY (see ChannelBusyRatioMonitor), so that no decision has to go
+ * through an RSU.  Update () is called once per control period and
+ * returns the ITT to use until the next call; the "Itt" trace source
+ * reports every decision.  The ITT in use before the first update is
+ * given by the "InitialItt" attribute.
+ */
+class CongestionController : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  CongestionController ();
+  virtual ~CongestionController ();
+
+  /**
+   * \brief Run one control period
+   * \param cbr the channel busy ratio measured by this node, in [0, 1]
+   * \param density the number of vehicles within the density range of this node
+   * \return the ITT to use until the next update
+   */
+  Time Update (double cbr, double density);
+  /**
+   * \return the ITT selected by the last update
+   */
+  Time GetItt (void) const;
+  /**
+   * \brief Set the ITT in use before the first update
+   * \param itt the initial ITT
+   */
+  void SetInitialItt (Time itt);
+
+protected:
+  /**
+   * \brief Select the next ITT
+   * \param cbr the channel busy ratio measured by this node, in [0, 1]
+   * \param density the number of vehicles within the density range of this node
+   * \return the ITT to use until the next update
+   */
+  virtual Time DoUpdate (double cbr, double density) = 0;
+
+  TracedValue<Time> m_itt; ///< ITT selected by the last update
+};
+
+/**
+ * \ingroup wave
+ * \brief Reactive DCC: the ITT is looked up in a table of CBR ranges.
+ *
+ * Each row maps the CBR range ending at its upper bound to an ITT.  The
+ * ranges are half-open, [previous bound, bound), and the last row also
+ * covers every CBR above its bound, so that every measurement maps to
+ * exactly one ITT.  The table is given either inline through the "Table"
+ * attribute, as "bound:itt" pairs separated by commas with the ITT in
+ * seconds, or as a CSV file of "bound,itt" lines through "TableFile".
+ *
+ * The default table is the ladder of the original V2X drivers, whose CBR
+ * thresholds from 60 % to 150 % are rescaled to [0.4, 1], the range of
+ * the CBR measured by ChannelBusyRatioMonitor: the ITT of the busiest
+ * range, 0.160 s, is reached on a saturated channel.
+ */
+class TableCongestionController : public CongestionController
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  TableCongestionController ();
+  virtual ~TableCongestionController ();
+
+  /**
+   * \brief Replace the table by the rows of a CSV file
+   * \param filename the file holding one "bound,itt" row per line;
+   * empty lines and lines starting with '#' are ignored
+   */
+  void LoadTable (std::string filename);
+  /**
+   * \brief Replace the table
+   * \param table "bound:itt" pairs separated by commas, the ITT in seconds
+   */
+  void SetTable (std::string table);
+  /**
+   * \return the number of rows of the table
+   */
+  uint32_t GetNRows (void) const;
+
+private:
+  virtual Time DoUpdate (double cbr, double density);
+  /**
+   * \brief Add a row, keeping the rows sorted by bound
+   * \param bound the upper CBR bound of the row
+   * \param itt the ITT of the row
+   */
+  void AddRow (double bound, Time itt);
+
+  /// a row of the table
+  struct Row
+  {
+    double bound; ///< upper CBR bound (excluded)
+    Time itt;     ///< ITT selected below the bound
+  };
+  std::vector<Row> m_rows; ///< rows, sorted by bound
+};
+
+/**
+ * \ingroup wave
+ * \brief Adaptive DCC: LIMERIC linear control of the duty cycle.
+ *
+ * The duty cycle d (the fraction of time the node transmits) converges
+ * to a fair share of the target CBR following
+ *
+ *   d = (1 - Alpha) d + clamp (Beta (TargetCbr - cbr), GMinus, GPlus)
+ *
+ * with d kept within [MinDutyCycle, MaxDutyCycle], as in ETSI
+ * TS 102 687.  The ITT is the message airtime divided by d, clamped to
+ * [MinItt, MaxItt].
+ */
+class LimericCongestionController : public CongestionController
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  LimericCongestionController ();
+  virtual ~LimericCongestionController ();
+
+  /**
+   * \return the current duty cycle
+   */
+  double GetDutyCycle (void) const;
+
+private:
+  virtual Time DoUpdate (double cbr, double density);
+
+  double m_alpha; ///< weight of the previous duty cycle
+  double m_beta; ///< gain on the CBR error
+  double m_targetCbr; ///< CBR the channel converges to
+  double m_gPlus; ///< largest duty cycle increase per update
+  double m_gMinus; ///< largest duty cycle decrease per update (negative)
+  double m_minDutyCycle; ///< lowest duty cycle
+  double m_maxDutyCycle; ///< highest duty cycle
+  Time m_airtime; ///< airtime of one message
+  Time m_minItt; ///< lowest ITT
+  Time m_maxItt; ///< highest ITT
+  double m_dutyCycle; ///< current duty cycle
+};
+
+/**
+ * \ingroup wave
+ * \brief SAE J2945/1 rate control: the ITT grows with the vehicle density.
+ *
+ * The density is smoothed with weight DensityWeight and the ITT is
+ *
+ *   ITT = MinItt * max (1, min (MaxItt / MinItt, density / DensityCoefficient))
+ *
+ * i.e. 100 ms up to 25 vehicles within range and up to 600 ms with the
+ * default attributes.  The CBR is not used by this rule.
+ */
+class J2945CongestionController : public CongestionController
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  J2945CongestionController ();
+  virtual ~J2945CongestionController ();
+
+  /**
+   * \return the smoothed vehicle density
+   */
+  double GetSmoothedDensity (void) const;
+
+private:
+  virtual Time DoUpdate (double cbr, double density);
+
+  double m_densityCoefficient; ///< vehicles per minimum ITT
+  double m_densityWeight; ///< weight of the new density sample
+  Time m_minItt; ///< lowest ITT
+  Time m_maxItt; ///< highest ITT
+  double m_density; ///< smoothed vehicle density, negative before the first sample
+};
+
+} // namespace ns3
+
+#endif /* CONGESTION_CONTROLLER_H */
@@ -26,6 +26,12 @@
 #include "ns3/wave-helper.h"
 #include "ns3/mobility-model.h"
 #include "ns3/mobility-helper.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/wifi-phy-state-helper.h"
+#include "ns3/channel-busy-ratio-monitor.h"
 
 NS_LOG_COMPONENT_DEFINE ("PvdApplication");
 
@@ -44,6 +50,28 @@ PvdApplication::GetTypeId (void)
     .SetParent<Application> ()
     .SetGroupName ("Wave")
     .AddConstructor<PvdApplication> ()
+    .AddAttribute ("DeferCbrThreshold",
+                   "The Channel Busy Ratio from which the PVD transmissions are "
+                   "deferred.  Above 1, the CBR is not measured and only a CCA busy "
+                   "PHY defers the transmissions.",
+                   DoubleValue (0.6),
+                   MakeDoubleAccessor (&PvdApplication::m_deferCbrThreshold),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("DeferInterval",
+                   "The time between two attempts of a deferred PVD transmission.",
+                   TimeValue (MilliSeconds (5)),
+                   MakeTimeAccessor (&PvdApplication::m_deferInterval),
+                   MakeTimeChecker (NanoSeconds (1)))
+    .AddAttribute ("MaxDeferral",
+                   "The maximum time a PVD snapshot may be deferred.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&PvdApplication::m_maxDeferral),
+                   MakeTimeChecker (Seconds (0)))
+    .AddAttribute ("MaxBatch",
+                   "The maximum number of PVD snapshots coalesced into one packet.",
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&PvdApplication::m_maxBatch),
+                   MakeUintegerChecker<uint32_t> (1))
     ;
   return tid;
 }
@@ -63,7 +91,15 @@ PvdApplication::PvdApplication ()
     m_nodeId (0),
     m_chAccessMode (0),
     m_txMaxDelay (MilliSeconds (10)),
-    m_prevTxDelay (MilliSeconds (0))
+    m_prevTxDelay (MilliSeconds (0)),
+    m_deferCbrThreshold (0.6),
+    m_deferInterval (MilliSeconds (5)),
+    m_maxDeferral (MilliSeconds (100)),
+    m_maxBatch (4),
+    m_socket (0),
+    m_phy (0),
+    m_cbrMonitor (0),
+    m_pendingSnapshots (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -78,6 +114,15 @@ PvdApplication::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
 
+  m_retryEvent.Cancel ();
+  m_socket = 0;
+  m_phy = 0;
+  if (m_cbrMonitor != 0)
+    {
+      m_cbrMonitor->Dispose ();
+      m_cbrMonitor = 0;
+    }
+
   // chain up
   Application::DoDispose ();
 }
@@ -171,6 +216,14 @@ void PvdApplication::StartApplication () // Called at time specified by Start
   m_prevTxDelay = txDelay;
 
   Time txTime = startTime + tDrift + txDelay;
+  m_socket = recvSink;
+  m_pendingSnapshots = 0;
+  m_phy = GetPhy (m_nodeId);
+  if (m_phy != 0 && m_deferCbrThreshold <= 1 && m_cbrMonitor == 0)
+    {
+      m_cbrMonitor = CreateObject<ChannelBusyRatioMonitor> ();
+      m_cbrMonitor->Attach (m_phy);
+    }
   // schedule transmission of first packet
   Simulator::ScheduleWithContext (recvSink->GetNode ()->GetId (),
                                   txTime, &PvdApplication::GenerateWaveTraffic, this,
@@ -245,59 +298,22 @@ PvdApplication::GenerateWaveTraffic (Ptr<Socket> socket, uint32_t pktSize,
       Ptr<MobilityModel> txPosition = txNode->GetObject<MobilityModel> ();
       NS_ASSERT (txPosition != 0);
 
-      /* 사용하지 않는 내용 삭제
-      int senderMoving = m_nodesMoving->at (txNodeId);
-      if (senderMoving != 0)
+      // take a snapshot, coalesced with the pending ones if the
+      // channel was loaded when they were taken
+      if (m_pendingSnapshots == 0)
         {
-          // send it!
-          socket->Send (Create<Packet> (pktSize));
-          // count it
-          m_wavePvdStats->IncTxPktCount ();
-          m_wavePvdStats->IncTxByteCount (pktSize);
-          int wavePktsSent = m_wavePvdStats->GetTxPktCount ();
-          if ((m_wavePvdStats->GetLogging () != 0) && ((wavePktsSent % 1000) == 0))
-            {
-              NS_LOG_UNCOND ("Sending WAVE pkt # " << wavePktsSent );
-            }
-
-          // find other nodes within range that would be
-          // expected to receive this broadbast
-          int nRxNodes = m_adhocTxInterfaces->GetN ();
-          for (int i = 0; i < nRxNodes; i++)
-            {
-              Ptr<Node> rxNode = GetNode (i);
-              int rxNodeId = rxNode->GetId ();
-
-              if (rxNodeId != txNodeId)
-                {
-                  Ptr<MobilityModel> rxPosition = rxNode->GetObject<MobilityModel> ();
-                  NS_ASSERT (rxPosition != 0);
-                  // confirm that the receiving node
-                  // has also started moving in the scenario
-                  // if it has not started moving, then
-                  // it is not a candidate to receive a packet
-                  int receiverMoving = m_nodesMoving->at (rxNodeId);
-                  if (receiverMoving == 1)
-                    {
-                      double distSq = MobilityHelper::GetDistanceSquaredBetween (txNode, rxNode);
-                      if (distSq > 0.0)
-                        {
-                          // dest node within range?
-                          int rangeCount = m_txSafetyRangesSq.size ();
-                          for (int index = 1; index <= rangeCount; index++)
-                            {
-                              if (distSq <= m_txSafetyRangesSq[index - 1])
-                                {
-                                  // we should expect dest node to receive broadcast pkt
-                                  m_wavePvdStats->IncExpectedRxPktCount (index);
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+          m_firstPendingTime = Simulator::Now ();
+        }
+      else
+        {
+          m_wavePvdStats->IncCoalescedPvdCount ();
+        }
+      m_pendingSnapshots++;
+      SendPending (false);
+      if (m_pendingSnapshots > 0)
+        {
+          m_wavePvdStats->IncDeferredPvdCount ();
         }
-      */
 
       // every PVD must be scheduled with a tx time delay
       // of +/- (5) ms.  See comments in StartApplication().
@@ -319,10 +335,61 @@ PvdApplication::GenerateWaveTraffic (Ptr<Socket> socket, uint32_t pktSize,
     }
   else
     {
+      SendPending (true);
       socket->Close ();
     }
 }
 
+bool
+PvdApplication::ifCCAbusy (uint32_t nodeID)
+{
+  NS_LOG_FUNCTION (this << nodeID);
+  Ptr<WifiPhy> phy = (static_cast<int> (nodeID) == m_nodeId) ? m_phy : GetPhy (nodeID);
+  if (phy == 0)
+    {
+      return false;
+    }
+  if (phy->GetState ()->IsStateCcaBusy ())
+    {
+      return true;
+    }
+  return phy == m_phy && m_cbrMonitor != 0
+         && m_cbrMonitor->GetChannelBusyRatio () >= m_deferCbrThreshold;
+}
+
+void
+PvdApplication::SendPending (bool force)
+{
+  NS_LOG_FUNCTION (this << force);
+  if (m_pendingSnapshots == 0)
+    {
+      return;
+    }
+  if (!force && m_pendingSnapshots < m_maxBatch
+      && Simulator::Now () - m_firstPendingTime < m_maxDeferral
+      && ifCCAbusy (m_nodeId))
+    {
+      if (!m_retryEvent.IsRunning ())
+        {
+          m_retryEvent = Simulator::Schedule (m_deferInterval, &PvdApplication::SendPending, this, false);
+        }
+      return;
+    }
+  m_retryEvent.Cancel ();
+  uint32_t pktSize = m_wavePacketSize * m_pendingSnapshots;
+  NS_LOG_DEBUG ("Sending " << m_pendingSnapshots << " PVD snapshots");
+  m_pendingSnapshots = 0;
+  m_socket->Send (Create<Packet> (pktSize));
+  // count it
+  m_wavePvdStats->IncTxPktCount ();
+  m_wavePvdStats->IncTxByteCount (pktSize);
+  int wavePktsSent = m_wavePvdStats->GetTxPktCount ();
+  if ((m_wavePvdStats->GetLogging () != 0) && ((wavePktsSent % 1000) == 0))
+    {
+      NS_LOG_UNCOND ("Sending WAVE pkt # " << wavePktsSent );
+    }
+}
+
 void PvdApplication::ReceiveWavePacket (Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION (this);
@@ -420,4 +487,24 @@ PvdApplication::GetNetDevice (int id)
 
   return device;
 }
+
+Ptr<WifiPhy>
+PvdApplication::GetPhy (int id)
+{
+  NS_LOG_FUNCTION (this << id);
+
+  std::pair<Ptr<Ipv4>, uint32_t> interface = m_adhocTxInterfaces->Get (id);
+  Ptr<NetDevice> device = interface.first->GetNetDevice (interface.second);
+  Ptr<WaveNetDevice> wave = DynamicCast<WaveNetDevice> (device);
+  if (wave != 0)
+    {
+      return wave->GetPhy (0);
+    }
+  Ptr<WifiNetDevice> wifi = DynamicCast<WifiNetDevice> (device);
+  if (wifi != 0)
+    {
+      return wifi->GetPhy ();
+    }
+  return 0;
+}
 } // namespace ns3
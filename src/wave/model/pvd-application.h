@@ -23,11 +23,16 @@
 #define PVD_APPLICATION_H
 
 #include "ns3/application.h"
+#include "ns3/event-id.h"
 #include "ns3/wave-pvd-stats.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/internet-stack-helper.h"
 
 namespace ns3 {
+
+class WifiPhy;
+class ChannelBusyRatioMonitor;
+
 /**
  * \ingroup wave
  * \brief The PvdApplication class sends and receives the
@@ -36,6 +41,14 @@ namespace ns3 {
  * to manage statistics about PVDs transmitted and received
  * The PVD is a ~200-byte packet that is
  * generally broadcast from every vehicle at a nominal rate of 10 Hz.
+ *
+ * Probe vehicle data is not urgent, so a PVD snapshot is not sent while
+ * the channel is loaded, i.e. while the PHY is CCA busy or the Channel
+ * Busy Ratio it measures is at least DeferCbrThreshold.  The transmission
+ * is retried every DeferInterval, and the snapshots generated meanwhile
+ * are coalesced into the same packet.  The pending snapshots are sent
+ * anyway once MaxBatch snapshots are pending or the oldest one has
+ * waited for MaxDeferral.
  */
 class PvdApplication : public Application
 {
@@ -153,11 +166,28 @@ private:
   Ptr<NetDevice> GetNetDevice (int id);
 
   /**
-   * \brief call every 100ms and record if the channel was CCA busy or not using the IsStateCcaBusy method. 
-   * \param nodeID the id of the desired net device
-   * \return ptr to the desired net device
+   * \brief Check whether the channel of a node is loaded, i.e. whether its
+   * PHY is CCA busy (see WifiPhyStateHelper::IsStateCcaBusy) or the
+   * measured Channel Busy Ratio is at least DeferCbrThreshold
+   * \param nodeID the identifier of the node (index into container)
+   * \return true if the PVD transmissions should be deferred
+   */
+  bool ifCCAbusy (uint32_t nodeID);
+
+  /**
+   * \brief Send the pending PVD snapshots in one packet, unless the
+   * channel is loaded and they may still be deferred
+   * \param force whether to send even if the channel is loaded
+   * \return none
+   */
+  void SendPending (bool force);
+
+  /**
+   * \brief Get the PHY of the interface of a node
+   * \param id the identifier of the node (index into container)
+   * \return the PHY, or 0 if the device is not a WifiNetDevice or a WaveNetDevice
    */
-  void ifCCAbusy(uint32_t nodeID);
+  Ptr<WifiPhy> GetPhy (int id);
 
   // pvd-application.cc의 header파일 부분
   Ptr<WavePvdStats> m_wavePvdStats; ///< PVD stats
@@ -184,6 +214,17 @@ private:
    * max transmit delay (default 10ms) */
   Time m_txMaxDelay;
   Time m_prevTxDelay; ///< previous transmit delay
+
+  double m_deferCbrThreshold; ///< CBR from which the transmissions are deferred
+  Time m_deferInterval; ///< time between two attempts of a deferred transmission
+  Time m_maxDeferral; ///< maximum time a snapshot may be deferred
+  uint32_t m_maxBatch; ///< maximum number of snapshots in one packet
+  Ptr<Socket> m_socket; ///< socket used for transmission
+  Ptr<WifiPhy> m_phy; ///< PHY of the node
+  Ptr<ChannelBusyRatioMonitor> m_cbrMonitor; ///< CBR measured by the PHY of the node
+  uint32_t m_pendingSnapshots; ///< snapshots not sent yet
+  Time m_firstPendingTime; ///< generation time of the oldest pending snapshot
+  EventId m_retryEvent; ///< next attempt of a deferred transmission
 };
 
 } // namespace ns3
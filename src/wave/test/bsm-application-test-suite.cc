@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/wifi-80211p-helper.h"
+#include "ns3/wave-mac-helper.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-mac.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/wave-bsm-helper.h"
+#include "ns3/bsm-application.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup wave-test
+ * \ingroup tests
+ *
+ * \brief BSM interval change test case
+ *
+ * Two vehicles send a BSM every 100 ms from 1 s to 2 s, without GPS
+ * drift nor transmit delay.  The WaveInterval attribute of the first
+ * one is set to 200 ms at 1.25 s, then to 200 ms again at 1.26 s.
+ * Checks that the pending BSM is moved to 200 ms after the previous
+ * one, that the next ones are 200 ms apart, and that the
+ * WaveIntervalChange trace fires once, with the old and new intervals.
+ */
+class BsmIntervalChangeTestCase : public TestCase
+{
+public:
+  BsmIntervalChangeTestCase ();
+  virtual ~BsmIntervalChangeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Record a BSM handed to the MAC of the first vehicle
+   * \param p the packet
+   */
+  void MacTx (Ptr<const Packet> p);
+  /**
+   * Record a change of the interval of the first vehicle
+   * \param oldInterval the previous interval
+   * \param newInterval the new interval
+   */
+  void IntervalChange (Time oldInterval, Time newInterval);
+
+  std::vector<Time> m_txTimes; ///< transmission times of the first vehicle
+  uint32_t m_intervalChanges; ///< number of interval changes traced
+  Time m_oldInterval; ///< previous interval of the last change traced
+  Time m_newInterval; ///< new interval of the last change traced
+};
+
+BsmIntervalChangeTestCase::BsmIntervalChangeTestCase ()
+  : TestCase ("Change the interval of a running BsmApplication"),
+    m_intervalChanges (0)
+{
+}
+
+BsmIntervalChangeTestCase::~BsmIntervalChangeTestCase ()
+{
+}
+
+void
+BsmIntervalChangeTestCase::MacTx (Ptr<const Packet> p)
+{
+  m_txTimes.push_back (Simulator::Now ());
+}
+
+void
+BsmIntervalChangeTestCase::IntervalChange (Time oldInterval, Time newInterval)
+{
+  m_intervalChanges++;
+  m_oldInterval = oldInterval;
+  m_newInterval = newInterval;
+}
+
+void
+BsmIntervalChangeTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  MobilityHelper mobility;
+  mobility.Install (nodes);
+
+  YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper wifiPhy;
+  wifiPhy.SetChannel (wifiChannel.Create ());
+  NqosWaveMacHelper wifi80211pMac = NqosWaveMacHelper::Default ();
+  Wifi80211pHelper wifi80211p = Wifi80211pHelper::Default ();
+  NetDeviceContainer devices = wifi80211p.Install (wifiPhy, wifi80211pMac, nodes);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  // only the moving vehicles send BSMs
+  WaveBsmHelper::GetNodesMoving ().assign (nodes.GetN (), 1);
+  WaveBsmHelper bsmHelper;
+  std::vector<double> ranges = {100};
+  bsmHelper.Install (interfaces, Seconds (2), 200, MilliSeconds (100), 0, ranges, 0, Seconds (0));
+
+  Ptr<BsmApplication> app = DynamicCast<BsmApplication> (nodes.Get (0)->GetApplication (0));
+  app->TraceConnectWithoutContext ("WaveIntervalChange",
+                                   MakeCallback (&BsmIntervalChangeTestCase::IntervalChange, this));
+  DynamicCast<WifiNetDevice> (devices.Get (0))->GetMac ()
+    ->TraceConnectWithoutContext ("MacTx", MakeCallback (&BsmIntervalChangeTestCase::MacTx, this));
+
+  // between the BSMs sent at 1.2 s and due at 1.3 s
+  Simulator::Schedule (MilliSeconds (1250), &BsmApplication::SetAttribute, app,
+                       "WaveInterval", TimeValue (MilliSeconds (200)));
+  // setting the same interval again is not a change
+  Simulator::Schedule (MilliSeconds (1260), &BsmApplication::SetAttribute, app,
+                       "WaveInterval", TimeValue (MilliSeconds (200)));
+
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_intervalChanges, 1, "Unexpected number of interval changes");
+  NS_TEST_EXPECT_MSG_EQ (m_oldInterval, MilliSeconds (100), "Unexpected previous interval traced");
+  NS_TEST_EXPECT_MSG_EQ (m_newInterval, MilliSeconds (200), "Unexpected new interval traced");
+  NS_TEST_EXPECT_MSG_EQ (app->GetWaveInterval (), MilliSeconds (200), "Interval not changed");
+
+  Time expected[] = {MilliSeconds (1000), MilliSeconds (1100), MilliSeconds (1200),
+                     MilliSeconds (1400), MilliSeconds (1600), MilliSeconds (1800)};
+  uint32_t nExpected = sizeof (expected) / sizeof (expected[0]);
+  NS_TEST_ASSERT_MSG_EQ (m_txTimes.size (), nExpected, "Unexpected number of BSMs sent");
+  for (uint32_t k = 0; k < nExpected; k++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_txTimes[k], expected[k], "Unexpected time of BSM " << k);
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup wave-test
+ * \ingroup tests
+ *
+ * \brief BSM application test suite
+ */
+class BsmApplicationTestSuite : public TestSuite
+{
+public:
+  BsmApplicationTestSuite ();
+};
+
+BsmApplicationTestSuite::BsmApplicationTestSuite ()
+  : TestSuite ("wave-bsm-application", UNIT)
+{
+  AddTestCase (new BsmIntervalChangeTestCase, TestCase::QUICK);
+}
+
+static BsmApplicationTestSuite bsmApplicationTestSuite; ///< the test suite
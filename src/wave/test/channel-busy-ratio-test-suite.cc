@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-phy-state-helper.h"
+#include "ns3/channel-busy-ratio-monitor.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup wave-test
+ * \ingroup tests
+ *
+ * \brief Channel Busy Ratio Monitor Test Case
+ *
+ * Drives a WifiPhyStateHelper through CCA_BUSY periods and checks the
+ * busy time and CBR reported at slot boundaries, including a busy state
+ * still in progress and a busy state that the PHY logs retroactively.
+ */
+class ChannelBusyRatioTestCase : public TestCase
+{
+public:
+  ChannelBusyRatioTestCase ();
+  virtual ~ChannelBusyRatioTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the values reported by the monitor
+   * \param busy the expected busy time
+   * \param cbr the expected CBR
+   */
+  void Check (Time busy, double cbr);
+
+  Ptr<ChannelBusyRatioMonitor> m_monitor; ///< the monitor under test
+};
+
+ChannelBusyRatioTestCase::ChannelBusyRatioTestCase ()
+  : TestCase ("Channel busy ratio measured from the PHY state trace")
+{
+}
+
+ChannelBusyRatioTestCase::~ChannelBusyRatioTestCase ()
+{
+}
+
+void
+ChannelBusyRatioTestCase::Check (Time busy, double cbr)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_monitor->GetBusyTime (), busy, "unexpected busy time at " << Simulator::Now ());
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_monitor->GetChannelBusyRatio (), cbr, 1e-9, "unexpected CBR at " << Simulator::Now ());
+}
+
+void
+ChannelBusyRatioTestCase::DoRun (void)
+{
+  Ptr<WifiPhyStateHelper> state = CreateObject<WifiPhyStateHelper> ();
+  m_monitor = CreateObject<ChannelBusyRatioMonitor> ();
+  m_monitor->SetAttribute ("Window", TimeValue (MilliSeconds (100)));
+  m_monitor->SetAttribute ("Slots", UintegerValue (10));
+  m_monitor->Attach (state, 0);
+
+  // busy [10, 30) ms, logged at 50 ms
+  Simulator::Schedule (MilliSeconds (10), &WifiPhyStateHelper::SwitchMaybeToCcaBusy, state, MilliSeconds (20));
+  // busy [50, 60) ms, logged at 95 ms
+  Simulator::Schedule (MilliSeconds (50), &WifiPhyStateHelper::SwitchMaybeToCcaBusy, state, MilliSeconds (10));
+  // busy [95, 110) ms, in progress at the 100 ms boundary, logged at 120 ms
+  Simulator::Schedule (MilliSeconds (95), &WifiPhyStateHelper::SwitchMaybeToCcaBusy, state, MilliSeconds (15));
+  Simulator::Schedule (MilliSeconds (120), &WifiPhyStateHelper::SwitchMaybeToCcaBusy, state, Seconds (0));
+
+  // only 50 ms of the window have elapsed
+  Simulator::Schedule (MilliSeconds (51), &ChannelBusyRatioTestCase::Check, this,
+                       MilliSeconds (20), 0.4);
+  Simulator::Schedule (MilliSeconds (101), &ChannelBusyRatioTestCase::Check, this,
+                       MilliSeconds (35), 0.35);
+  // window [50, 150) ms
+  Simulator::Schedule (MilliSeconds (151), &ChannelBusyRatioTestCase::Check, this,
+                       MilliSeconds (25), 0.25);
+  // window [150, 250) ms
+  Simulator::Schedule (MilliSeconds (251), &ChannelBusyRatioTestCase::Check, this,
+                       Seconds (0), 0.0);
+
+  Simulator::Stop (MilliSeconds (300));
+  Simulator::Run ();
+  m_monitor->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup wave-test
+ * \ingroup tests
+ *
+ * \brief Channel Busy Ratio Test Suite
+ */
+class ChannelBusyRatioTestSuite : public TestSuite
+{
+public:
+  ChannelBusyRatioTestSuite ();
+};
+
+ChannelBusyRatioTestSuite::ChannelBusyRatioTestSuite ()
+  : TestSuite ("wave-channel-busy-ratio", UNIT)
+{
+  AddTestCase (new ChannelBusyRatioTestCase, TestCase::QUICK);
+}
+
+static ChannelBusyRatioTestSuite channelBusyRatioTestSuite; ///< the test suite
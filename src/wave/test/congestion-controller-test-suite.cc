@@ -0,0 +1,202 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include "ns3/test.h"
+#include "ns3/string.h"
+#include "ns3/congestion-controller.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup wave-test
+ * \ingroup tests
+ *
+ * \brief Table congestion controller test case
+ *
+ * Checks that the default table has no gap at the row bounds, that the
+ * last row covers every CBR above it, and that a table can be given
+ * inline or loaded from a CSV file.
+ */
+class TableCongestionControllerTestCase : public TestCase
+{
+public:
+  TableCongestionControllerTestCase ();
+  virtual ~TableCongestionControllerTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TableCongestionControllerTestCase::TableCongestionControllerTestCase ()
+  : TestCase ("ITT selected from a table of CBR ranges")
+{
+}
+
+TableCongestionControllerTestCase::~TableCongestionControllerTestCase ()
+{
+}
+
+void
+TableCongestionControllerTestCase::DoRun (void)
+{
+  Ptr<TableCongestionController> controller = CreateObject<TableCongestionController> ();
+  NS_TEST_ASSERT_MSG_EQ (controller->GetNRows (), 11, "Unexpected default table");
+  NS_TEST_ASSERT_MSG_EQ (controller->Update (0.3, 0), MilliSeconds (80), "Wrong ITT below the first bound");
+  NS_TEST_ASSERT_MSG_EQ (controller->Update (0.4, 0), MilliSeconds (84), "A bound belongs to the next row");
+  NS_TEST_ASSERT_MSG_EQ (controller->Update (0.66, 0), MilliSeconds (100), "Wrong ITT below a bound");
+  NS_TEST_ASSERT_MSG_EQ (controller->Update (0.67, 0), MilliSeconds (107), "Gap at an exact bound");
+  NS_TEST_ASSERT_MSG_EQ (controller->Update (0.73, 0), MilliSeconds (114), "Gap at an exact bound");
+  NS_TEST_ASSERT_MSG_EQ (controller->Update (0.95, 0), MilliSeconds (145), "Busiest range below saturation unreachable");
+  NS_TEST_ASSERT_MSG_EQ (controller->Update (1.0, 0), MilliSeconds (160), "Wrong ITT on a saturated channel");
+  NS_TEST_ASSERT_MSG_EQ (controller->Update (3.0, 0), MilliSeconds (160), "Wrong ITT above the last bound");
+  NS_TEST_ASSERT_MSG_EQ (controller->GetItt (), MilliSeconds (160), "ITT of the last update not kept");
+
+  controller->SetAttribute ("Table", StringValue ("0.6:0.2,0.3:0.1"));
+  NS_TEST_ASSERT_MSG_EQ (controller->GetNRows (), 2, "Inline table not parsed");
+  NS_TEST_ASSERT_MSG_EQ (controller->Update (0.2, 0), MilliSeconds (100), "Inline table not sorted");
+  NS_TEST_ASSERT_MSG_EQ (controller->Update (0.7, 0), MilliSeconds (200), "Wrong ITT above the last bound");
+
+  std::string filename = CreateTempDirFilename ("table.csv");
+  std::ofstream out (filename.c_str ());
+  out << "# bound,itt" << std::endl
+      << "0.4,0.05" << std::endl
+      << std::endl
+      << "0.8,0.5" << std::endl;
+  out.close ();
+  controller->SetAttribute ("TableFile", StringValue (filename));
+  NS_TEST_ASSERT_MSG_EQ (controller->GetNRows (), 2, "Table file not loaded");
+  NS_TEST_ASSERT_MSG_EQ (controller->Update (0.3, 0), MilliSeconds (50), "Wrong ITT from the table file");
+  NS_TEST_ASSERT_MSG_EQ (controller->Update (0.4, 0), MilliSeconds (500), "Wrong ITT from the table file");
+}
+
+/**
+ * \ingroup wave-test
+ * \ingroup tests
+ *
+ * \brief LIMERIC congestion controller test case
+ *
+ * Checks one update against the control law, then that the duty cycle
+ * saturates on an idle and on a saturated channel.
+ */
+class LimericCongestionControllerTestCase : public TestCase
+{
+public:
+  LimericCongestionControllerTestCase ();
+  virtual ~LimericCongestionControllerTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+LimericCongestionControllerTestCase::LimericCongestionControllerTestCase ()
+  : TestCase ("ITT from the LIMERIC duty cycle")
+{
+}
+
+LimericCongestionControllerTestCase::~LimericCongestionControllerTestCase ()
+{
+}
+
+void
+LimericCongestionControllerTestCase::DoRun (void)
+{
+  Ptr<LimericCongestionController> controller = CreateObject<LimericCongestionController> ();
+  // at the target CBR only the (1 - Alpha) decay applies to the initial
+  // duty cycle, 312 us / 100 ms
+  Time itt = controller->Update (0.68, 0);
+  NS_TEST_ASSERT_MSG_EQ_TOL (controller->GetDutyCycle (), 0.984 * 0.00312, 1e-9, "Wrong duty cycle");
+  NS_TEST_ASSERT_MSG_EQ_TOL (itt.GetSeconds (), 0.1 / 0.984, 1e-6, "Wrong ITT");
+
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      itt = controller->Update (0, 0);
+    }
+  NS_TEST_ASSERT_MSG_EQ_TOL (controller->GetDutyCycle (), 0.03, 1e-9, "Duty cycle above the maximum");
+  NS_TEST_ASSERT_MSG_EQ (itt, MilliSeconds (80), "ITT below the minimum");
+
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      itt = controller->Update (1, 0);
+    }
+  NS_TEST_ASSERT_MSG_EQ_TOL (controller->GetDutyCycle (), 0.0006, 1e-9, "Duty cycle below the minimum");
+  NS_TEST_ASSERT_MSG_EQ_TOL (itt.GetSeconds (), 0.52, 1e-6, "Wrong ITT at the minimum duty cycle");
+}
+
+/**
+ * \ingroup wave-test
+ * \ingroup tests
+ *
+ * \brief J2945/1 congestion controller test case
+ *
+ * Checks the ITT computed from the smoothed vehicle density.
+ */
+class J2945CongestionControllerTestCase : public TestCase
+{
+public:
+  J2945CongestionControllerTestCase ();
+  virtual ~J2945CongestionControllerTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+J2945CongestionControllerTestCase::J2945CongestionControllerTestCase ()
+  : TestCase ("ITT from the J2945-1 vehicle density rule")
+{
+}
+
+J2945CongestionControllerTestCase::~J2945CongestionControllerTestCase ()
+{
+}
+
+void
+J2945CongestionControllerTestCase::DoRun (void)
+{
+  Ptr<J2945CongestionController> controller = CreateObject<J2945CongestionController> ();
+  // the first sample is taken as is
+  NS_TEST_ASSERT_MSG_EQ (controller->Update (1, 10), MilliSeconds (100), "Wrong ITT at low density");
+
+  controller = CreateObject<J2945CongestionController> ();
+  NS_TEST_ASSERT_MSG_EQ (controller->Update (0, 100), MilliSeconds (400), "Wrong ITT at 100 vehicles");
+  // 0.05 * 1000 + 0.95 * 100 = 145 vehicles
+  Time itt = controller->Update (0, 1000);
+  NS_TEST_ASSERT_MSG_EQ_TOL (controller->GetSmoothedDensity (), 145, 1e-9, "Wrong smoothed density");
+  NS_TEST_ASSERT_MSG_EQ_TOL (itt.GetSeconds (), 0.58, 1e-9, "Wrong ITT at 145 vehicles");
+  NS_TEST_ASSERT_MSG_EQ (controller->Update (0, 1000), MilliSeconds (600), "ITT above the maximum");
+}
+
+/**
+ * \ingroup wave-test
+ * \ingroup tests
+ *
+ * \brief Congestion controller test suite
+ */
+class CongestionControllerTestSuite : public TestSuite
+{
+public:
+  CongestionControllerTestSuite ();
+};
+
+CongestionControllerTestSuite::CongestionControllerTestSuite ()
+  : TestSuite ("wave-congestion-controller", UNIT)
+{
+  AddTestCase (new TableCongestionControllerTestCase, TestCase::QUICK);
+  AddTestCase (new LimericCongestionControllerTestCase, TestCase::QUICK);
+  AddTestCase (new J2945CongestionControllerTestCase, TestCase::QUICK);
+}
+
+static CongestionControllerTestSuite congestionControllerTestSuite; ///< the test suite
@@ -0,0 +1,149 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/wifi-80211p-helper.h"
+#include "ns3/wave-mac-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/wave-pvd-helper.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup wave-test
+ * \ingroup tests
+ *
+ * \brief PVD transmission deferral test case
+ *
+ * Two vehicles send a PVD snapshot every second for 5 s.  Checks the
+ * number of PVDs sent and coalesced, and the number of
+ * snapshots deferred, for a CBR threshold that always defers the
+ * transmissions and for one that never does.
+ */
+class PvdDeferralTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param name the name of the test case
+   * \param cbrThreshold the CBR from which the transmissions are deferred
+   * \param txCount the expected number of PVDs sent
+   * \param coalescedCount the expected number of snapshots coalesced
+   * \param deferredCount the expected number of snapshots deferred, or -1 if not checked
+   */
+  PvdDeferralTestCase (std::string name, double cbrThreshold, int txCount,
+                       int coalescedCount, int deferredCount);
+  virtual ~PvdDeferralTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  double m_cbrThreshold; ///< CBR from which the transmissions are deferred
+  int m_txCount; ///< expected number of PVDs sent
+  int m_coalescedCount; ///< expected number of snapshots coalesced
+  int m_deferredCount; ///< expected number of snapshots deferred
+};
+
+PvdDeferralTestCase::PvdDeferralTestCase (std::string name, double cbrThreshold, int txCount,
+                                          int coalescedCount, int deferredCount)
+  : TestCase (name),
+    m_cbrThreshold (cbrThreshold),
+    m_txCount (txCount),
+    m_coalescedCount (coalescedCount),
+    m_deferredCount (deferredCount)
+{
+}
+
+PvdDeferralTestCase::~PvdDeferralTestCase ()
+{
+}
+
+void
+PvdDeferralTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  MobilityHelper mobility;
+  mobility.Install (nodes);
+
+  YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper wifiPhy;
+  wifiPhy.SetChannel (wifiChannel.Create ());
+  NqosWaveMacHelper wifi80211pMac = NqosWaveMacHelper::Default ();
+  Wifi80211pHelper wifi80211p = Wifi80211pHelper::Default ();
+  NetDeviceContainer devices = wifi80211p.Install (wifiPhy, wifi80211pMac, nodes);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  WavePvdHelper pvdHelper;
+  pvdHelper.SetAttribute ("DeferCbrThreshold", DoubleValue (m_cbrThreshold));
+  pvdHelper.SetAttribute ("MaxBatch", UintegerValue (3));
+  pvdHelper.SetAttribute ("MaxDeferral", TimeValue (Seconds (10)));
+  std::vector<double> ranges = {100};
+  pvdHelper.Install (interfaces, Seconds (6), 448, Seconds (1), 40, ranges, 0, MilliSeconds (10));
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  Ptr<WavePvdStats> stats = pvdHelper.GetWavePvdStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats->GetTxPktCount (), m_txCount, "Unexpected number of PVDs sent");
+  NS_TEST_EXPECT_MSG_EQ (stats->GetTxByteCount (), 448 * (m_txCount + m_coalescedCount),
+                         "Snapshots lost or duplicated");
+  NS_TEST_EXPECT_MSG_EQ (stats->GetCoalescedPvdCount (), m_coalescedCount, "Unexpected number of snapshots coalesced");
+  if (m_deferredCount >= 0)
+    {
+      NS_TEST_EXPECT_MSG_EQ (stats->GetDeferredPvdCount (), m_deferredCount, "Unexpected number of snapshots deferred");
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup wave-test
+ * \ingroup tests
+ *
+ * \brief PVD application test suite
+ */
+class PvdApplicationTestSuite : public TestSuite
+{
+public:
+  PvdApplicationTestSuite ();
+};
+
+PvdApplicationTestSuite::PvdApplicationTestSuite ()
+  : TestSuite ("wave-pvd-application", UNIT)
+{
+  // each vehicle sends snapshots 1 to 3 when the third one fills the
+  // batch, then 4 and 5 at the end; snapshot 3 is not deferred
+  AddTestCase (new PvdDeferralTestCase ("PVD snapshots deferred and coalesced on a loaded channel",
+                                        0, 2 * 2, 2 * 3, 2 * 4), TestCase::QUICK);
+  // the snapshots may only be deferred while the other vehicle transmits
+  AddTestCase (new PvdDeferralTestCase ("PVD snapshots sent as taken on an idle channel",
+                                        2, 2 * 5, 0, -1), TestCase::QUICK);
+}
+
+static PvdApplicationTestSuite pvdApplicationTestSuite; ///< the test suite
@@ -0,0 +1,301 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/uinteger.h"
+#include "ns3/node-container.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/constant-acceleration-mobility-model.h"
+#include "ns3/wave-bsm-stats.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup wave-test
+ * \ingroup tests
+ *
+ * \brief WaveBsmStats expected receivers test case
+ *
+ * Checks that the receivers found in the grid of node positions give the
+ * same expected and in range counts as checking every node, while the
+ * nodes move, speed up and jump to a new position between two grid
+ * updates, and while a node speeds up without notifying it.
+ */
+class WaveBsmStatsExpectedRxTestCase : public TestCase
+{
+public:
+  WaveBsmStatsExpectedRxTestCase ();
+  virtual ~WaveBsmStatsExpectedRxTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// Count a broadcast from every node, in the stats and by checking every node
+  void Broadcast (void);
+
+  NodeContainer m_nodes; ///< the nodes
+  std::vector<int> m_nodesMoving; ///< whether each node is moving
+  std::vector<double> m_rangesSq; ///< squared ranges
+  std::vector<int> m_expected; ///< expected counts by index for statistics minus one
+  Ptr<WaveBsmStats> m_stats; ///< the stats
+};
+
+WaveBsmStatsExpectedRxTestCase::WaveBsmStatsExpectedRxTestCase ()
+  : TestCase ("Expected receivers found in a grid of node positions")
+{
+}
+
+WaveBsmStatsExpectedRxTestCase::~WaveBsmStatsExpectedRxTestCase ()
+{
+}
+
+void
+WaveBsmStatsExpectedRxTestCase::Broadcast (void)
+{
+  for (uint32_t tx = 0; tx < m_nodes.GetN (); tx++)
+    {
+      m_stats->IncExpectedRxPktCounts (m_nodes.Get (tx), &m_nodesMoving);
+      Ptr<MobilityModel> txPosition = m_nodes.Get (tx)->GetObject<MobilityModel> ();
+      for (uint32_t rx = 0; rx < m_nodes.GetN (); rx++)
+        {
+          if (rx == tx || m_nodesMoving[rx] != 1)
+            {
+              continue;
+            }
+          double dist = m_nodes.Get (rx)->GetObject<MobilityModel> ()->GetDistanceFrom (txPosition);
+          double distSq = dist * dist;
+          for (uint32_t index = 0; index < m_rangesSq.size (); index++)
+            {
+              if (distSq > 0.0 && distSq <= m_rangesSq[index])
+                {
+                  m_expected[index]++;
+                }
+            }
+        }
+    }
+  for (uint32_t index = 0; index < m_rangesSq.size (); index++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_stats->GetExpectedRxPktCount (index + 1), m_expected[index],
+                             "Wrong expected count for range " << index + 1
+                             << " at " << Simulator::Now ().As (Time::S));
+    }
+}
+
+void
+WaveBsmStatsExpectedRxTestCase::DoRun (void)
+{
+  m_stats = CreateObject<WaveBsmStats> ();
+  m_stats->SetAttribute ("GridUpdateInterval", TimeValue (Seconds (10)));
+  // unsorted ranges, with a duplicate
+  m_rangesSq = {100 * 100, 50 * 50, 300 * 300, 50 * 50};
+  m_expected.assign (m_rangesSq.size (), 0);
+  m_stats->SetRangesSq (m_rangesSq);
+
+  const uint32_t n = 40;
+  m_nodes.Create (n);
+  std::vector<Ptr<ConstantVelocityMobilityModel> > mobility;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<ConstantVelocityMobilityModel> model = CreateObject<ConstantVelocityMobilityModel> ();
+      model->SetPosition (Vector ((i * 137) % 2000, (i * 31) % 60, 0));
+      model->SetVelocity (Vector (i % 3 == 0 ? 0 : 10 + i, i % 5 == 0 ? -2 : 0, 0));
+      m_nodes.Get (i)->AggregateObject (model);
+      mobility.push_back (model);
+      m_nodesMoving.push_back (i % 7 == 0 ? 0 : 1);
+      m_stats->AddNode (m_nodes.Get (i));
+    }
+  // a node accelerating from rest, whose speed is never notified
+  Ptr<Node> accelerating = CreateObject<Node> ();
+  Ptr<ConstantAccelerationMobilityModel> acceleration = CreateObject<ConstantAccelerationMobilityModel> ();
+  acceleration->SetPosition (Vector (0, 30, 0));
+  acceleration->SetVelocityAndAcceleration (Vector (0, 0, 0), Vector (1000, 0, 0));
+  accelerating->AggregateObject (acceleration);
+  m_nodes.Add (accelerating);
+  m_nodesMoving.push_back (1);
+  m_stats->AddNode (accelerating);
+  NS_TEST_ASSERT_MSG_EQ (m_stats->GetNNodes (), n + 1, "Nodes not added");
+
+  for (double t : {0.0, 0.5, 1.5, 2.5, 3.0})
+    {
+      Simulator::Schedule (Seconds (t), &WaveBsmStatsExpectedRxTestCase::Broadcast, this);
+    }
+  // a node faster than any other, then a node jumping into a crowd
+  Simulator::Schedule (Seconds (1), &ConstantVelocityMobilityModel::SetVelocity, mobility[5], Vector (-100, 0, 0));
+  Simulator::Schedule (Seconds (2), &MobilityModel::SetPosition, mobility[8], Vector (1500, 10, 0));
+  Simulator::Run ();
+
+  // a received packet counts for every range covering its distance
+  m_stats->IncRxPktInRangeCounts (60 * 60);
+  m_stats->IncRxPktInRangeCounts (50 * 50);
+  m_stats->IncRxPktInRangeCounts (400 * 400);
+  NS_TEST_EXPECT_MSG_EQ (m_stats->GetRxPktInRangeCount (1), 2, "Wrong in range count");
+  NS_TEST_EXPECT_MSG_EQ (m_stats->GetRxPktInRangeCount (2), 1, "Wrong in range count");
+  NS_TEST_EXPECT_MSG_EQ (m_stats->GetRxPktInRangeCount (3), 2, "Wrong in range count");
+  NS_TEST_EXPECT_MSG_EQ (m_stats->GetRxPktInRangeCount (4), 1, "Wrong in range count");
+
+  m_stats->SetRxPktInRangeCount (1, 0);
+  m_stats->IncRxPktInRangeCounts (10 * 10);
+  NS_TEST_EXPECT_MSG_EQ (m_stats->GetRxPktInRangeCount (1), 1, "Pending counts lost by a reset");
+
+  Simulator::Destroy ();
+  m_stats = 0;
+}
+
+/**
+ * \ingroup wave-test
+ * \ingroup tests
+ *
+ * \brief WaveBsmStats windowed statistics test case
+ *
+ * Checks the log-scale histogram bins, then the windowed PDR,
+ * inter-packet gap and age of information quantiles as the windows
+ * holding the samples expire.
+ */
+class WaveBsmStatsWindowTestCase : public TestCase
+{
+public:
+  WaveBsmStatsWindowTestCase ();
+  virtual ~WaveBsmStatsWindowTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Count a BSM from the first node to the second one
+   * \param received whether the BSM is received
+   */
+  void Send (bool received);
+  /**
+   * Check the windowed statistics
+   * \param pdr the expected PDR
+   * \param gap the expected median inter-packet gap, in s
+   * \param age the expected median peak age of information, in s
+   */
+  void Check (double pdr, double gap, double age);
+
+  NodeContainer m_nodes; ///< the nodes
+  std::vector<int> m_nodesMoving; ///< whether each node is moving
+  Ptr<WaveBsmStats> m_stats; ///< the stats
+};
+
+WaveBsmStatsWindowTestCase::WaveBsmStatsWindowTestCase ()
+  : TestCase ("Windowed PDR, inter-packet gap and age of information")
+{
+}
+
+WaveBsmStatsWindowTestCase::~WaveBsmStatsWindowTestCase ()
+{
+}
+
+void
+WaveBsmStatsWindowTestCase::Send (bool received)
+{
+  m_stats->IncExpectedRxPktCounts (m_nodes.Get (0), &m_nodesMoving);
+  if (received)
+    {
+      m_stats->IncRxPktInRangeCounts (50 * 50);
+    }
+}
+
+void
+WaveBsmStatsWindowTestCase::Check (double pdr, double gap, double age)
+{
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_stats->GetWindowedBsmPdr (1), pdr, 1e-9,
+                             "Wrong windowed PDR at " << Simulator::Now ().As (Time::S));
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_stats->GetInterPacketGapQuantile (0.5).GetSeconds (), gap, 1e-6,
+                             "Wrong inter-packet gap at " << Simulator::Now ().As (Time::S));
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_stats->GetAgeQuantile (0.5).GetSeconds (), age, 1e-6,
+                             "Wrong age of information at " << Simulator::Now ().As (Time::S));
+}
+
+void
+WaveBsmStatsWindowTestCase::DoRun (void)
+{
+  WaveBsmStats::LogHistogram histogram;
+  NS_TEST_EXPECT_MSG_EQ (histogram.GetNBins (), 6 * 10 + 2, "Unexpected number of bins");
+  NS_TEST_EXPECT_MSG_EQ (histogram.GetQuantile (0.5), 0, "Quantile of an empty histogram");
+  histogram.Add (5e-5);
+  histogram.Add (1.2e-3);
+  histogram.Add (200);
+  NS_TEST_EXPECT_MSG_EQ (histogram.GetBinCount (0), 1, "Value below the first bin");
+  NS_TEST_EXPECT_MSG_EQ (histogram.GetBinCount (11), 1, "Value in the wrong bin");
+  NS_TEST_EXPECT_MSG_EQ (histogram.GetBinCount (histogram.GetNBins () - 1), 1, "Value above the last bin");
+  NS_TEST_EXPECT_MSG_EQ_TOL (histogram.GetQuantile (0), 1e-4, 1e-12, "Wrong minimum");
+  NS_TEST_EXPECT_MSG_EQ_TOL (histogram.GetQuantile (0.5), 1e-4 * std::pow (10, 1.1), 1e-12, "Wrong median");
+  NS_TEST_EXPECT_MSG_EQ_TOL (histogram.GetQuantile (1), 100, 1e-12, "Wrong maximum");
+
+  m_stats = CreateObject<WaveBsmStats> ();
+  m_stats->SetAttribute ("WindowDuration", TimeValue (MilliSeconds (100)));
+  m_stats->SetAttribute ("NumWindows", UintegerValue (5));
+  m_stats->SetRangesSq ({100 * 100});
+  m_nodes.Create (2);
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<ConstantVelocityMobilityModel> model = CreateObject<ConstantVelocityMobilityModel> ();
+      model->SetPosition (Vector (50 * i, 0, 0));
+      m_nodes.Get (i)->AggregateObject (model);
+      m_nodesMoving.push_back (1);
+      m_stats->AddNode (m_nodes.Get (i));
+    }
+
+  // BSMs generated every 120 ms, received 10 ms later: the gaps are
+  // 120 ms and the peak ages 130 ms
+  Simulator::Schedule (Seconds (0.05), &WaveBsmStatsWindowTestCase::Send, this, true);
+  Simulator::Schedule (Seconds (0.17), &WaveBsmStatsWindowTestCase::Send, this, false);
+  Simulator::Schedule (Seconds (0.05), &WaveBsmStats::RecordRx, m_stats, m_nodes.Get (0), m_nodes.Get (1), Seconds (0.04));
+  Simulator::Schedule (Seconds (0.17), &WaveBsmStats::RecordRx, m_stats, m_nodes.Get (0), m_nodes.Get (1), Seconds (0.16));
+  Simulator::Schedule (Seconds (0.29), &WaveBsmStats::RecordRx, m_stats, m_nodes.Get (0), m_nodes.Get (1), Seconds (0.28));
+  // the bins of 120 ms and 130 ms end at 10^-0.9 and 10^-0.8 s
+  Simulator::Schedule (Seconds (0.3), &WaveBsmStatsWindowTestCase::Check, this,
+                       0.5, std::pow (10, -0.9), std::pow (10, -0.8));
+  // the windows of the BSMs expired, not the one of the last reception
+  Simulator::Schedule (Seconds (0.62), &WaveBsmStatsWindowTestCase::Check, this,
+                       0, std::pow (10, -0.9), std::pow (10, -0.8));
+  Simulator::Schedule (Seconds (1), &WaveBsmStatsWindowTestCase::Check, this, 0, 0, 0);
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_stats->GetInterPacketGapHistogram ().GetCount (), 2, "Gaps not all kept");
+  NS_TEST_EXPECT_MSG_EQ (m_stats->GetAgeHistogram ().GetCount (), 2, "Ages not all kept");
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_stats->GetCumulativeBsmPdr (1), 0.5, 1e-9, "Wrong cumulative PDR");
+
+  Simulator::Destroy ();
+  m_stats = 0;
+}
+
+/**
+ * \ingroup wave-test
+ * \ingroup tests
+ *
+ * \brief WaveBsmStats test suite
+ */
+class WaveBsmStatsTestSuite : public TestSuite
+{
+public:
+  WaveBsmStatsTestSuite ();
+};
+
+WaveBsmStatsTestSuite::WaveBsmStatsTestSuite ()
+  : TestSuite ("wave-bsm-stats", UNIT)
+{
+  AddTestCase (new WaveBsmStatsExpectedRxTestCase, TestCase::QUICK);
+  AddTestCase (new WaveBsmStatsWindowTestCase, TestCase::QUICK);
+}
+
+static WaveBsmStatsTestSuite waveBsmStatsTestSuite; ///< the test suite
@@ -27,6 +27,7 @@
 #include "ns3/log.h"
 #include "ns3/pointer.h"
 #include "ns3/radiotap-header.h"
+#include "ns3/pcapng-file-writer.h"
 #include "ns3/config.h"
 #include "ns3/names.h"
 #include "ns3/net-device-queue-interface.h"
@@ -239,9 +240,8 @@ WifiPhyHelper::PcapSniffTxEvent (
       }
     case PcapHelper::DLT_IEEE802_11_RADIO:
       {
-        Ptr<Packet> p = packet->Copy ();
         RadiotapHeader header;
-        GetRadiotapHeader (header, p, channelFreqMhz, txVector, aMpdu, staId);
+        Ptr<Packet> p = GetRadiotapHeader (header, packet, channelFreqMhz, txVector, aMpdu, staId)->Copy ();
         p->AddHeader (header);
         file->Write (Simulator::Now (), p);
         return;
@@ -274,9 +274,8 @@ WifiPhyHelper::PcapSniffRxEvent (
       }
     case PcapHelper::DLT_IEEE802_11_RADIO:
       {
-        Ptr<Packet> p = packet->Copy ();
         RadiotapHeader header;
-        GetRadiotapHeader (header, p, channelFreqMhz, txVector, aMpdu, staId, signalNoise);
+        Ptr<Packet> p = GetRadiotapHeader (header, packet, channelFreqMhz, txVector, aMpdu, staId, signalNoise)->Copy ();
         p->AddHeader (header);
         file->Write (Simulator::Now (), p);
         return;
@@ -287,9 +286,76 @@ WifiPhyHelper::PcapSniffRxEvent (
 }
 
 void
+WifiPhyHelper::PcapngSniffTxEvent (
+  Ptr<PcapngFileWriter> writer,
+  uint32_t             interface,
+  Ptr<const Packet>    packet,
+  uint16_t             channelFreqMhz,
+  WifiTxVector         txVector,
+  MpduInfo             aMpdu,
+  uint16_t             staId)
+{
+  if (!writer->Accept (interface, packet))
+    {
+      return;
+    }
+  uint32_t dlt = writer->GetDataLinkType (interface);
+  switch (dlt)
+    {
+    case PcapHelper::DLT_IEEE802_11:
+      writer->Write (interface, packet);
+      return;
+    case PcapHelper::DLT_IEEE802_11_RADIO:
+      {
+        // the packet is only copied to remove the delimiter of an A-MPDU subframe
+        RadiotapHeader header;
+        Ptr<const Packet> p = GetRadiotapHeader (header, packet, channelFreqMhz, txVector, aMpdu, staId);
+        writer->Write (interface, header, p);
+        return;
+      }
+    default:
+      NS_ABORT_MSG ("PcapngSniffTxEvent(): Unexpected data link type " << dlt);
+    }
+}
+
+void
+WifiPhyHelper::PcapngSniffRxEvent (
+  Ptr<PcapngFileWriter> writer,
+  uint32_t              interface,
+  Ptr<const Packet>     packet,
+  uint16_t              channelFreqMhz,
+  WifiTxVector          txVector,
+  MpduInfo              aMpdu,
+  SignalNoiseDbm        signalNoise,
+  uint16_t              staId)
+{
+  if (!writer->Accept (interface, packet))
+    {
+      return;
+    }
+  uint32_t dlt = writer->GetDataLinkType (interface);
+  switch (dlt)
+    {
+    case PcapHelper::DLT_IEEE802_11:
+      writer->Write (interface, packet);
+      return;
+    case PcapHelper::DLT_IEEE802_11_RADIO:
+      {
+        // the packet is only copied to remove the delimiter of an A-MPDU subframe
+        RadiotapHeader header;
+        Ptr<const Packet> p = GetRadiotapHeader (header, packet, channelFreqMhz, txVector, aMpdu, staId, signalNoise);
+        writer->Write (interface, header, p);
+        return;
+      }
+    default:
+      NS_ABORT_MSG ("PcapngSniffRxEvent(): Unexpected data link type " << dlt);
+    }
+}
+
+Ptr<const Packet>
 WifiPhyHelper::GetRadiotapHeader (
   RadiotapHeader       &header,
-  Ptr<Packet>          packet,
+  Ptr<const Packet>    packet,
   uint16_t             channelFreqMhz,
   WifiTxVector         txVector,
   MpduInfo             aMpdu,
@@ -298,13 +364,13 @@ WifiPhyHelper::GetRadiotapHeader (
 {
   header.SetAntennaSignalPower (signalNoise.signal);
   header.SetAntennaNoisePower (signalNoise.noise);
-  GetRadiotapHeader (header, packet, channelFreqMhz, txVector, aMpdu, staId);
+  return GetRadiotapHeader (header, packet, channelFreqMhz, txVector, aMpdu, staId);
 }
 
-void
+Ptr<const Packet>
 WifiPhyHelper::GetRadiotapHeader (
   RadiotapHeader       &header,
-  Ptr<Packet>          packet,
+  Ptr<const Packet>    packet,
   uint16_t             channelFreqMhz,
   WifiTxVector         txVector,
   MpduInfo             aMpdu,
@@ -412,10 +478,9 @@ WifiPhyHelper::GetRadiotapHeader (
       ampduStatusFlags |= RadiotapHeader::A_MPDU_STATUS_LAST_KNOWN;
       /* For PCAP file, MPDU Delimiter and Padding should be removed by the MAC Driver */
       AmpduSubframeHeader hdr;
-      uint32_t extractedLength;
-      packet->RemoveHeader (hdr);
-      extractedLength = hdr.GetLength ();
-      packet = packet->CreateFragment (0, static_cast<uint32_t> (extractedLength));
+      Ptr<Packet> mpdu = packet->Copy ();
+      mpdu->RemoveHeader (hdr);
+      packet = mpdu;
       if (aMpdu.type == LAST_MPDU_IN_AGGREGATE || (hdr.GetEof () == true && hdr.GetLength () > 0))
         {
           ampduStatusFlags |= RadiotapHeader::A_MPDU_STATUS_LAST;
@@ -567,6 +632,8 @@ WifiPhyHelper::GetRadiotapHeader (
       header.SetHeMuFields (0, 0, ruChannel1, ruChannel2);
       header.SetHeMuPerUserFields (0, 0, 0, 0);
     }
+
+  return packet;
 }
 
 void
@@ -630,6 +697,31 @@ WifiPhyHelper::EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bool p
   phy->TraceConnectWithoutContext ("MonitorSnifferRx", MakeBoundCallback (&WifiPhyHelper::PcapSniffRxEvent, file));
 }
 
+void
+WifiPhyHelper::EnablePcapng (Ptr<PcapngFileWriter> writer, NetDeviceContainer devices)
+{
+  NS_LOG_FUNCTION (this << writer);
+  NS_ABORT_MSG_IF (m_pcapDlt == PcapHelper::DLT_PRISM_HEADER,
+                   "WifiPhyHelper::EnablePcapng(): DLT_PRISM_HEADER not implemented");
+  for (NetDeviceContainer::Iterator i = devices.Begin (); i != devices.End (); ++i)
+    {
+      Ptr<WifiNetDevice> device = (*i)->GetObject<WifiNetDevice> ();
+      if (device == 0)
+        {
+          NS_LOG_INFO ("WifiHelper::EnablePcapng(): Device " << *i << " not of type ns3::WifiNetDevice");
+          continue;
+        }
+      Ptr<WifiPhy> phy = device->GetPhy ();
+      NS_ABORT_MSG_IF (phy == 0, "WifiPhyHelper::EnablePcapng(): Phy layer in WifiNetDevice must be set");
+
+      uint32_t interface = writer->AddInterface (device, m_pcapDlt);
+      phy->TraceConnectWithoutContext ("MonitorSnifferTx",
+                                       MakeBoundCallback (&WifiPhyHelper::PcapngSniffTxEvent, writer, interface));
+      phy->TraceConnectWithoutContext ("MonitorSnifferRx",
+                                       MakeBoundCallback (&WifiPhyHelper::PcapngSniffRxEvent, writer, interface));
+    }
+}
+
 void
 WifiPhyHelper::EnableAsciiInternal (
   Ptr<OutputStreamWrapper> stream,
@@ -36,6 +36,7 @@ class WifiNetDevice;
 class Node;
 class RadiotapHeader;
 class QueueItem;
+class PcapngFileWriter;
 
 /**
  * \brief create PHY objects
@@ -200,6 +201,18 @@ public:
    */
   PcapHelper::DataLinkType GetPcapDataLinkType (void) const;
 
+  /**
+   * Capture the frames sent and received by the PHYs of some devices to a
+   * single pcapng file, instead of one pcap file per device.  Each device
+   * is added to the writer as an interface of the data link type set by
+   * SetPcapDataLinkType.  The frames rejected by the capture filter of the
+   * writer are dropped before the synthesis of their radiotap header.
+   *
+   * \param writer the pcapng writer, open or not yet open
+   * \param devices the devices; those which are not WifiNetDevices are ignored
+   */
+  void EnablePcapng (Ptr<PcapngFileWriter> writer, NetDeviceContainer devices);
+
 
 protected:
   /**
@@ -237,6 +250,45 @@ protected:
                                 SignalNoiseDbm signalNoise,
                                 uint16_t staId = SU_STA_ID);
 
+  /**
+   * \param writer the pcapng writer
+   * \param interface the interface id of the device
+   * \param packet the packet
+   * \param channelFreqMhz the channel frequency
+   * \param txVector the TXVECTOR
+   * \param aMpdu the A-MPDU information
+   * \param staId the STA-ID (only used for MU)
+   *
+   * Handle TX pcapng.
+   */
+  static void PcapngSniffTxEvent (Ptr<PcapngFileWriter> writer,
+                                  uint32_t interface,
+                                  Ptr<const Packet> packet,
+                                  uint16_t channelFreqMhz,
+                                  WifiTxVector txVector,
+                                  MpduInfo aMpdu,
+                                  uint16_t staId = SU_STA_ID);
+  /**
+   * \param writer the pcapng writer
+   * \param interface the interface id of the device
+   * \param packet the packet
+   * \param channelFreqMhz the channel frequency
+   * \param txVector the TXVECTOR
+   * \param aMpdu the A-MPDU information
+   * \param signalNoise the RX signal and noise information
+   * \param staId the STA-ID (only used for MU)
+   *
+   * Handle RX pcapng.
+   */
+  static void PcapngSniffRxEvent (Ptr<PcapngFileWriter> writer,
+                                  uint32_t interface,
+                                  Ptr<const Packet> packet,
+                                  uint16_t channelFreqMhz,
+                                  WifiTxVector txVector,
+                                  MpduInfo aMpdu,
+                                  SignalNoiseDbm signalNoise,
+                                  uint16_t staId = SU_STA_ID);
+
   ObjectFactory m_phy; ///< PHY object
   ObjectFactory m_errorRateModel; ///< error rate model
   ObjectFactory m_frameCaptureModel; ///< frame capture model
@@ -253,13 +305,15 @@ private:
    * \param txVector the TXVECTOR
    * \param aMpdu the A-MPDU information
    * \param staId the STA-ID
+   * \return the packet to capture after the header: the packet itself or,
+   *         for an A-MPDU subframe, a copy without the MPDU delimiter
    */
-  static void GetRadiotapHeader (RadiotapHeader &header,
-                                 Ptr<Packet> packet,
-                                 uint16_t channelFreqMhz,
-                                 WifiTxVector txVector,
-                                 MpduInfo aMpdu,
-                                 uint16_t staId);
+  static Ptr<const Packet> GetRadiotapHeader (RadiotapHeader &header,
+                                              Ptr<const Packet> packet,
+                                              uint16_t channelFreqMhz,
+                                              WifiTxVector txVector,
+                                              MpduInfo aMpdu,
+                                              uint16_t staId);
 
   /**
    * Get the Radiotap header for a received packet.
@@ -271,14 +325,16 @@ private:
    * \param aMpdu the A-MPDU information
    * \param staId the STA-ID
    * \param signalNoise the rx signal and noise information
+   * \return the packet to capture after the header: the packet itself or,
+   *         for an A-MPDU subframe, a copy without the MPDU delimiter
    */
-  static void GetRadiotapHeader (RadiotapHeader &header,
-                                 Ptr<Packet> packet,
-                                 uint16_t channelFreqMhz,
-                                 WifiTxVector txVector,
-                                 MpduInfo aMpdu,
-                                 uint16_t staId,
-                                 SignalNoiseDbm signalNoise);
+  static Ptr<const Packet> GetRadiotapHeader (RadiotapHeader &header,
+                                              Ptr<const Packet> packet,
+                                              uint16_t channelFreqMhz,
+                                              WifiTxVector txVector,
+                                              MpduInfo aMpdu,
+                                              uint16_t staId,
+                                              SignalNoiseDbm signalNoise);
 
   /**
    * \brief Enable pcap output the indicated net device.
@@ -145,11 +145,6 @@ InterferenceHelper::NiChange::NiChange (double power, Ptr<Event> event)
 {
 }
 
-InterferenceHelper::NiChange::~NiChange ()
-{
-  m_event = 0;
-}
-
 double
 InterferenceHelper::NiChange::GetPower (void) const
 {
@@ -168,6 +163,95 @@ InterferenceHelper::NiChange::GetEvent (void) const
   return m_event;
 }
 
+InterferenceHelper::NiChanges::NiChanges ()
+  : m_head (0)
+{
+}
+
+std::size_t
+InterferenceHelper::NiChanges::GetSize (void) const
+{
+  return m_times.size () - m_head;
+}
+
+std::size_t
+InterferenceHelper::NiChanges::GetCapacity (void) const
+{
+  return m_times.size ();
+}
+
+Time
+InterferenceHelper::NiChanges::GetTime (std::size_t i) const
+{
+  return m_times[m_head + i];
+}
+
+InterferenceHelper::NiChange &
+InterferenceHelper::NiChanges::Get (std::size_t i)
+{
+  return m_changes[m_head + i];
+}
+
+const InterferenceHelper::NiChange &
+InterferenceHelper::NiChanges::Get (std::size_t i) const
+{
+  return m_changes[m_head + i];
+}
+
+std::size_t
+InterferenceHelper::NiChanges::LowerBound (Time moment) const
+{
+  return std::lower_bound (m_times.begin () + m_head, m_times.end (), moment) - m_times.begin () - m_head;
+}
+
+std::size_t
+InterferenceHelper::NiChanges::UpperBound (Time moment) const
+{
+  if (m_times.size () == m_head || m_times.back () <= moment)
+    {
+      return GetSize ();
+    }
+  return std::upper_bound (m_times.begin () + m_head, m_times.end (), moment) - m_times.begin () - m_head;
+}
+
+std::size_t
+InterferenceHelper::NiChanges::Insert (Time moment, const NiChange &change)
+{
+  std::size_t i = UpperBound (moment);
+  m_times.insert (m_times.begin () + m_head + i, moment);
+  m_changes.insert (m_changes.begin () + m_head + i, change);
+  return i;
+}
+
+void
+InterferenceHelper::NiChanges::Prune (std::size_t last)
+{
+  NS_ASSERT (last < GetSize ());
+  if (last == 0)
+    {
+      return;
+    }
+  // the first change takes the place of the last one erased
+  m_times[m_head + last] = m_times[m_head];
+  m_changes[m_head + last] = m_changes[m_head];
+  m_changes[m_head] = NiChange (0.0, 0);
+  m_head += last;
+  if (m_head > GetSize ())
+    {
+      m_times.erase (m_times.begin (), m_times.begin () + m_head);
+      m_changes.erase (m_changes.begin (), m_changes.begin () + m_head);
+      m_head = 0;
+    }
+}
+
+void
+InterferenceHelper::NiChanges::Clear (void)
+{
+  m_times.clear ();
+  m_changes.clear ();
+  m_head = 0;
+}
+
 
 /****************************************************************
  *       The actual InterferenceHelper
@@ -176,7 +260,8 @@ InterferenceHelper::NiChange::GetEvent (void) const
 InterferenceHelper::InterferenceHelper ()
   : m_errorRateModel (0),
     m_numRxAntennas (1),
-    m_rxing (false)
+    m_rxing (false),
+    m_rxStart (Seconds (0))
 {
 }
 
@@ -211,9 +296,9 @@ void
 InterferenceHelper::RemoveBands(void)
 {
   NS_LOG_FUNCTION (this);
-  for (auto it : m_niChangesPerBand)
+  for (auto & it : m_niChangesPerBand)
     {
-      it.second.clear ();
+      it.second.Clear ();
     }
   m_niChangesPerBand.clear();
   m_firstPowerPerBand.clear();
@@ -256,18 +341,27 @@ InterferenceHelper::SetNumberOfReceiveAntennas (uint8_t rx)
   m_numRxAntennas = rx;
 }
 
+const InterferenceHelper::NiChanges &
+InterferenceHelper::GetNiChanges (WifiSpectrumBand band) const
+{
+  auto niIt = m_niChangesPerBand.find (band);
+  NS_ASSERT (niIt != m_niChangesPerBand.end ());
+  return niIt->second;
+}
+
 Time
 InterferenceHelper::GetEnergyDuration (double energyW, WifiSpectrumBand band)
 {
   Time now = Simulator::Now ();
   auto niIt = m_niChangesPerBand.find (band);
   NS_ASSERT (niIt != m_niChangesPerBand.end ());
-  auto i = GetPreviousPosition (now, niIt);
-  Time end = i->first;
-  for (; i != niIt->second.end (); ++i)
+  const NiChanges &changes = niIt->second;
+  std::size_t i = GetPreviousPosition (now, niIt);
+  Time end = changes.GetTime (i);
+  for (; i < changes.GetSize (); ++i)
     {
-      double noiseInterferenceW = i->second.GetPower ();
-      end = i->first;
+      double noiseInterferenceW = changes.Get (i).GetPower ();
+      end = changes.GetTime (i);
       if (noiseInterferenceW < energyW)
         {
           break;
@@ -287,27 +381,40 @@ InterferenceHelper::AppendEvent (Ptr<Event> event, bool isStartOfdmaRxing)
       NS_ASSERT (niIt != m_niChangesPerBand.end ());
       double previousPowerStart = 0;
       double previousPowerEnd = 0;
-      auto previousPowerPosition = GetPreviousPosition (event->GetStartTime (), niIt);
-      previousPowerStart = previousPowerPosition->second.GetPower ();
-      previousPowerEnd = GetPreviousPosition (event->GetEndTime (), niIt)->second.GetPower ();
+      std::size_t previousPowerPosition = GetPreviousPosition (event->GetStartTime (), niIt);
+      previousPowerStart = niIt->second.Get (previousPowerPosition).GetPower ();
+      previousPowerEnd = niIt->second.Get (GetPreviousPosition (event->GetEndTime (), niIt)).GetPower ();
       if (!m_rxing)
         {
           m_firstPowerPerBand.find (band)->second = previousPowerStart;
+          m_rxStart = event->GetStartTime ();
           // Always leave the first zero power noise event in the list
-          niIt->second.erase (++(niIt->second.begin ()), ++previousPowerPosition);
+          niIt->second.Prune (previousPowerPosition);
         }
-      else if (isStartOfdmaRxing)
+      else
         {
-          //When the first UL-OFDMA payload is received, we need to set m_firstPowerPerBand
-          //so that it takes into account interferences that arrived between the start of the
-          //UL MU transmission and the start of UL-OFDMA payload.
-          m_firstPowerPerBand.find (band)->second = previousPowerStart;
+          if (isStartOfdmaRxing)
+            {
+              //When the first UL-OFDMA payload is received, we need to set m_firstPowerPerBand
+              //so that it takes into account interferences that arrived between the start of the
+              //UL MU transmission and the start of UL-OFDMA payload.
+              m_firstPowerPerBand.find (band)->second = previousPowerStart;
+            }
+          //The changes are only read from the start of the oldest ongoing reception on,
+          //and from the change preceding it, whose power is the total power before that
+          //start: the older changes are erased.
+          std::size_t rxStartPosition = niIt->second.LowerBound (m_rxStart);
+          if (rxStartPosition > 2)
+            {
+              niIt->second.Prune (rxStartPosition - 2);
+            }
         }
-      auto first = AddNiChangeEvent (event->GetStartTime (), NiChange (previousPowerStart, event), niIt);
-      auto last = AddNiChangeEvent (event->GetEndTime (), NiChange (previousPowerEnd, event), niIt);
-      for (auto i = first; i != last; ++i)
+      // the end change is inserted after the start change, which keeps its index
+      std::size_t first = AddNiChangeEvent (event->GetStartTime (), NiChange (previousPowerStart, event), niIt);
+      std::size_t last = AddNiChangeEvent (event->GetEndTime (), NiChange (previousPowerEnd, event), niIt);
+      for (std::size_t i = first; i != last; ++i)
         {
-          i->second.AddPower (it.second);
+          niIt->second.Get (i).AddPower (it.second);
         }
     }
 }
@@ -322,11 +429,11 @@ InterferenceHelper::UpdateEvent (Ptr<Event> event, const RxPowerWattPerChannelBa
       WifiSpectrumBand band = it.first;
       auto niIt = m_niChangesPerBand.find (band);
       NS_ASSERT (niIt != m_niChangesPerBand.end ());
-      auto first = GetPreviousPosition (event->GetStartTime (), niIt);
-      auto last = GetPreviousPosition (event->GetEndTime (), niIt);
-      for (auto i = first; i != last; ++i)
+      std::size_t first = GetPreviousPosition (event->GetStartTime (), niIt);
+      std::size_t last = GetPreviousPosition (event->GetEndTime (), niIt);
+      for (std::size_t i = first; i != last; ++i)
         {
-          i->second.AddPower (it.second);
+          niIt->second.Get (i).AddPower (it.second);
         }
     }
     event->UpdateRxPowerW (rxPower);
@@ -367,22 +474,22 @@ InterferenceHelper::CalculateNoiseInterferenceW (Ptr<Event> event, NiChangesPerB
   double noiseInterferenceW = firstPower_it->second;
   auto niIt = m_niChangesPerBand.find (band);
   NS_ASSERT (niIt != m_niChangesPerBand.end ());
-  auto it = niIt->second.find (event->GetStartTime ());
-  for (; it != niIt->second.end () && it->first < Simulator::Now (); ++it)
+  const NiChanges &changes = niIt->second;
+  std::size_t start = changes.LowerBound (event->GetStartTime ());
+  NS_ASSERT (start < changes.GetSize () && changes.GetTime (start) == event->GetStartTime ());
+  std::size_t i = start;
+  for (; i < changes.GetSize () && changes.GetTime (i) < Simulator::Now (); ++i)
     {
-      noiseInterferenceW = it->second.GetPower () - event->GetRxPowerW (band);
+      noiseInterferenceW = changes.Get (i).GetPower () - event->GetRxPowerW (band);
     }
-  it = niIt->second.find (event->GetStartTime ());
-  NS_ASSERT (it != niIt->second.end ());
-  for (; it != niIt->second.end () && it->second.GetEvent () != event; ++it);
-  NiChanges ni;
-  ni.emplace (event->GetStartTime (), NiChange (0, event));
-  while (++it != niIt->second.end () && it->second.GetEvent () != event)
+  for (i = start; i < changes.GetSize () && changes.Get (i).GetEvent () != event; ++i);
+  NiChanges &ni = (*nis)[band];
+  ni.Insert (event->GetStartTime (), NiChange (0, event));
+  while (++i < changes.GetSize () && changes.Get (i).GetEvent () != event)
     {
-      ni.insert (*it);
+      ni.Insert (changes.GetTime (i), changes.Get (i));
     }
-  ni.emplace (event->GetEndTime (), NiChange (0, event));
-  nis->insert ({band, ni});
+  ni.Insert (event->GetEndTime (), NiChange (0, event));
   NS_ASSERT_MSG (noiseInterferenceW >= 0, "CalculateNoiseInterferenceW returns negative value " << noiseInterferenceW);
   return noiseInterferenceW;
 }
@@ -422,22 +529,22 @@ InterferenceHelper::CalculatePayloadPer (Ptr<const Event> event, uint16_t channe
 {
   NS_LOG_FUNCTION (this << channelWidth << band.first << band.second << staId << window.first << window.second);
   double psr = 1.0; /* Packet Success Rate */
-  auto niIt = nis->find (band)->second;
-  auto j = niIt.begin ();
-  Time previous = j->first;
+  const NiChanges &ni = nis->find (band)->second;
+  std::size_t j = 0;
+  Time previous = ni.GetTime (j);
   WifiMode payloadMode = event->GetTxVector ().GetMode (staId);
-  Time phyPayloadStart = j->first;
-  if (event->GetPpdu ()->GetType () != WIFI_PPDU_TYPE_UL_MU) //j->first corresponds to the start of the UL-OFDMA payload
+  Time phyPayloadStart = ni.GetTime (j);
+  if (event->GetPpdu ()->GetType () != WIFI_PPDU_TYPE_UL_MU) //the first change corresponds to the start of the UL-OFDMA payload
     {
-      phyPayloadStart = j->first + WifiPhy::CalculatePhyPreambleAndHeaderDuration (event->GetTxVector ());
+      phyPayloadStart = ni.GetTime (j) + WifiPhy::CalculatePhyPreambleAndHeaderDuration (event->GetTxVector ());
     }
   Time windowStart = phyPayloadStart + window.first;
   Time windowEnd = phyPayloadStart + window.second;
   double noiseInterferenceW = m_firstPowerPerBand.find (band)->second;
   double powerW = event->GetRxPowerW (band);
-  while (++j != niIt.end ())
+  while (++j < ni.GetSize ())
     {
-      Time current = j->first;
+      Time current = ni.GetTime (j);
       NS_LOG_DEBUG ("previous= " << previous << ", current=" << current);
       NS_ASSERT (current >= previous);
       double snr = CalculateSnr (powerW, noiseInterferenceW, channelWidth, event->GetTxVector ().GetNss (staId));
@@ -453,8 +560,8 @@ InterferenceHelper::CalculatePayloadPer (Ptr<const Event> event, uint16_t channe
           psr *= CalculatePayloadChunkSuccessRate (snr, Min (windowEnd, current) - windowStart, event->GetTxVector (), staId);
           NS_LOG_DEBUG ("previous is before windowed payload and current is in the windowed payload: mode=" << payloadMode << ", psr=" << psr);
         }
-      noiseInterferenceW = j->second.GetPower () - powerW;
-      previous = j->first;
+      noiseInterferenceW = ni.Get (j).GetPower () - powerW;
+      previous = ni.GetTime (j);
       if (previous > windowEnd)
         {
           NS_LOG_DEBUG ("Stop: new previous=" << previous << " after time window end=" << windowEnd);
@@ -472,8 +579,8 @@ InterferenceHelper::CalculatePhyHeaderSectionPsr (Ptr<const Event> event, NiChan
 {
   NS_LOG_FUNCTION (this << band.first << band.second);
   double psr = 1.0; /* Packet Success Rate */
-  auto niIt = nis->find (band)->second;
-  auto j = niIt.begin ();
+  const NiChanges &ni = nis->find (band)->second;
+  std::size_t j = 0;
 
   NS_ASSERT (!phyHeaderSections.empty ());
   Time stopLastSection = Seconds (0);
@@ -482,12 +589,12 @@ InterferenceHelper::CalculatePhyHeaderSectionPsr (Ptr<const Event> event, NiChan
       stopLastSection = Max (stopLastSection, section.second.first.second);
     }
 
-  Time previous = j->first;
+  Time previous = ni.GetTime (j);
   double noiseInterferenceW = m_firstPowerPerBand.find (band)->second;
   double powerW = event->GetRxPowerW (band);
-  while (++j != niIt.end ())
+  while (++j < ni.GetSize ())
     {
-      Time current = j->first;
+      Time current = ni.GetTime (j);
       NS_LOG_DEBUG ("previous= " << previous << ", current=" << current);
       NS_ASSERT (current >= previous);
       double snr = CalculateSnr (powerW, noiseInterferenceW, channelWidth, 1);
@@ -507,8 +614,8 @@ InterferenceHelper::CalculatePhyHeaderSectionPsr (Ptr<const Event> event, NiChan
                 }
             }
         }
-      noiseInterferenceW = j->second.GetPower () - powerW;
-      previous = j->first;
+      noiseInterferenceW = ni.Get (j).GetPower () - powerW;
+      previous = ni.GetTime (j);
       if (previous > stopLastSection)
         {
           NS_LOG_DEBUG ("Stop: new previous=" << previous << " after stop of last section=" << stopLastSection);
@@ -524,11 +631,11 @@ InterferenceHelper::CalculatePhyHeaderPer (Ptr<const Event> event, NiChangesPerB
                                            WifiPpduField header) const
 {
   NS_LOG_FUNCTION (this << band.first << band.second << header);
-  auto niIt = nis->find (band)->second;
+  const NiChanges &ni = nis->find (band)->second;
   auto phyEntity = WifiPhy::GetStaticPhyEntity (event->GetTxVector ().GetModulationClass ());
 
   PhyEntity::PhyHeaderSections sections;
-  for (const auto & section : phyEntity->GetPhyHeaderSections (event->GetTxVector (), niIt.begin ()->first))
+  for (const auto & section : phyEntity->GetPhyHeaderSections (event->GetTxVector (), ni.GetTime (0)))
     {
       if (section.first == header)
         {
@@ -601,34 +708,33 @@ InterferenceHelper::EraseEvents (void)
 {
   for (auto niIt = m_niChangesPerBand.begin(); niIt != m_niChangesPerBand.end(); ++niIt)
     {
-      niIt->second.clear ();
+      niIt->second.Clear ();
       // Always have a zero power noise event in the list
       AddNiChangeEvent (Time (0), NiChange (0.0, 0), niIt);
       m_firstPowerPerBand.at (niIt->first) = 0.0;
     }
   m_rxing = false;
+  m_rxStart = Seconds (0);
 }
 
-InterferenceHelper::NiChanges::iterator
+std::size_t
 InterferenceHelper::GetNextPosition (Time moment, NiChangesPerBand::iterator niIt)
 {
-  return niIt->second.upper_bound (moment);
+  return niIt->second.UpperBound (moment);
 }
 
-InterferenceHelper::NiChanges::iterator
+std::size_t
 InterferenceHelper::GetPreviousPosition (Time moment, NiChangesPerBand::iterator niIt)
 {
-  auto it = GetNextPosition (moment, niIt);
   // This is safe since there is always an NiChange at time 0,
   // before moment.
-  --it;
-  return it;
+  return GetNextPosition (moment, niIt) - 1;
 }
 
-InterferenceHelper::NiChanges::iterator
+std::size_t
 InterferenceHelper::AddNiChangeEvent (Time moment, NiChange change, NiChangesPerBand::iterator niIt)
 {
-  return niIt->second.insert (GetNextPosition (moment, niIt), std::make_pair (moment, change));
+  return niIt->second.Insert (moment, change);
 }
 
 void
@@ -643,13 +749,15 @@ InterferenceHelper::NotifyRxEnd (Time endTime)
 {
   NS_LOG_FUNCTION (this << endTime);
   m_rxing = false;
+  //A reception restarted from here is that of the signal starting at endTime
+  m_rxStart = endTime;
   //Update m_firstPowerPerBand for frame capture
   for (auto niIt = m_niChangesPerBand.begin(); niIt != m_niChangesPerBand.end(); ++niIt)
     {
-      NS_ASSERT (niIt->second.size () > 1);
-      auto it = GetPreviousPosition (endTime, niIt);
-      it--;
-      m_firstPowerPerBand.find (niIt->first)->second = it->second.GetPower ();
+      NS_ASSERT (niIt->second.GetSize () > 1);
+      std::size_t i = GetPreviousPosition (endTime, niIt);
+      NS_ASSERT (i > 0);
+      m_firstPowerPerBand.find (niIt->first)->second = niIt->second.Get (i - 1).GetPower ();
     }
 }
 
@@ -21,6 +21,7 @@
 #ifndef INTERFERENCE_HELPER_H
 #define INTERFERENCE_HELPER_H
 
+#include <vector>
 #include "phy-entity.h"
 
 namespace ns3 {
@@ -307,7 +308,6 @@ protected:
    */
   double CalculatePayloadChunkSuccessRate (double snir, Time duration, const WifiTxVector& txVector, uint16_t staId = SU_STA_ID) const;
 
-private:
   /**
    * Noise and Interference (thus Ni) event.
    */
@@ -321,7 +321,6 @@ public:
      * \param event causes this NI change
      */
     NiChange (double power, Ptr<Event> event);
-    ~NiChange ();
     /**
      * Return the power
      *
@@ -348,15 +347,92 @@ private:
   };
 
   /**
-   * typedef for a multimap of NiChange
+   * The NI changes of a band, sorted by time in contiguous buffers.
+   *
+   * A change is inserted after the changes at the same time, at a position
+   * found by binary search; since signals mostly arrive in time order, it
+   * is usually appended.  The oldest changes are erased by moving the head
+   * of the buffers, which are only compacted once the erased changes
+   * outnumber the others, so that pruning takes amortized constant time
+   * and the memory used is bounded by twice the number of live changes.
    */
-  typedef std::multimap<Time, NiChange> NiChanges;
+  class NiChanges
+  {
+public:
+    NiChanges ();
+    /**
+     * \return the number of changes
+     */
+    std::size_t GetSize (void) const;
+    /**
+     * \return the number of changes held by the buffers, including the
+     *         erased changes which are not compacted yet
+     */
+    std::size_t GetCapacity (void) const;
+    /**
+     * \param i the index of a change
+     * \return the time of the change
+     */
+    Time GetTime (std::size_t i) const;
+    /**
+     * \param i the index of a change
+     * \return the change
+     */
+    NiChange & Get (std::size_t i);
+    /**
+     * \param i the index of a change
+     * \return the change
+     */
+    const NiChange & Get (std::size_t i) const;
+    /**
+     * \param moment the time
+     * \return the index of the first change at or after the given time
+     */
+    std::size_t LowerBound (Time moment) const;
+    /**
+     * \param moment the time
+     * \return the index of the first change after the given time
+     */
+    std::size_t UpperBound (Time moment) const;
+    /**
+     * Insert a change after the changes at the same time
+     *
+     * \param moment the time of the change
+     * \param change the change
+     * \return the index of the change
+     */
+    std::size_t Insert (Time moment, const NiChange &change);
+    /**
+     * Erase the changes from the second one up to the given index
+     * included, keeping the first change (the zero power noise change)
+     *
+     * \param last the index of the last change erased
+     */
+    void Prune (std::size_t last);
+    /**
+     * Erase all the changes
+     */
+    void Clear (void);
+
+private:
+    std::vector<Time> m_times;       ///< time of each change, from m_head on
+    std::vector<NiChange> m_changes; ///< changes, from m_head on
+    std::size_t m_head;              ///< index of the first change in the buffers
+  };
 
   /**
    * Map of NiChanges per band
    */
   typedef std::map <WifiSpectrumBand, NiChanges> NiChangesPerBand;
 
+  /**
+   * \param band the band
+   * \return the NI changes of the band
+   */
+  const NiChanges & GetNiChanges (WifiSpectrumBand band) const;
+
+private:
+
   /**
    * Append the given Event.
    *
@@ -427,34 +503,35 @@ private:
   NiChangesPerBand m_niChangesPerBand;                     //!< NI Changes for each band
   std::map <WifiSpectrumBand, double> m_firstPowerPerBand; //!< first power of each band in watts
   bool m_rxing;                                            //!< flag whether it is in receiving state
+  Time m_rxStart;                                          //!< start of the oldest ongoing reception
 
   /**
-   * Returns an iterator to the first NiChange that is later than moment
+   * Returns the index of the first NiChange that is later than moment
    *
    * \param moment time to check from
    * \param niIt iterator of the band to check
-   * \returns an iterator to the list of NiChanges
+   * \returns an index in the list of NiChanges
    */
-  NiChanges::iterator GetNextPosition (Time moment, NiChangesPerBand::iterator niIt);
+  std::size_t GetNextPosition (Time moment, NiChangesPerBand::iterator niIt);
   /**
-   * Returns an iterator to the last NiChange that is before than moment
+   * Returns the index of the last NiChange that is before than moment
    *
    * \param moment time to check from
    * \param niIt iterator of the band to check
-   * \returns an iterator to the list of NiChanges
+   * \returns an index in the list of NiChanges
    */
-  NiChanges::iterator GetPreviousPosition (Time moment, NiChangesPerBand::iterator niIt);
+  std::size_t GetPreviousPosition (Time moment, NiChangesPerBand::iterator niIt);
 
   /**
    * Add NiChange to the list at the appropriate position and
-   * return the iterator of the new event.
+   * return the index of the new event.
    *
    * \param moment time to check from
    * \param change the NiChange to add
    * \param niIt iterator of the band to check
-   * \returns the iterator of the new event
+   * \returns the index of the new event
    */
-  NiChanges::iterator AddNiChangeEvent (Time moment, NiChange change, NiChangesPerBand::iterator niIt);
+  std::size_t AddNiChangeEvent (Time moment, NiChange change, NiChangesPerBand::iterator niIt);
 };
 
 } //namespace ns3
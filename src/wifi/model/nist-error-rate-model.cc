@@ -21,14 +21,26 @@
 
 #include <cmath>
 #include <bitset>
+#include <fstream>
+#include <iomanip>
 #include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
 #include "nist-error-rate-model.h"
 #include "wifi-tx-vector.h"
+#include "wifi-utils.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("NistErrorRateModel");
 
+static const double TABLE_MIN_SNR = -10.0; //!< SNR of the first table entry, in dB
+static const double TABLE_SNR_STEP = 0.02; //!< SNR step of the tables, in dB
+static const uint32_t TABLE_SIZE = 3001;   //!< number of table entries, up to 50 dB
+static const double TABLE_MIN_VALUE = -700.0; //!< table value for a null error probability
+static const double TABLE_MAX_VALUE = 6.7; //!< table value for an error probability of 1
+static const uint32_t TABLE_FILE_VERSION = 1; //!< version of the table file format
+
 NS_OBJECT_ENSURE_REGISTERED (NistErrorRateModel);
 
 TypeId
@@ -38,11 +50,25 @@ NistErrorRateModel::GetTypeId (void)
     .SetParent<ErrorRateModel> ()
     .SetGroupName ("Wifi")
     .AddConstructor<NistErrorRateModel> ()
+    .AddAttribute ("UseTables",
+                   "Interpolate the chunk success rates of the OFDM modes in tables "
+                   "built once per constellation and coding rate, instead of "
+                   "evaluating the model for each chunk.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&NistErrorRateModel::m_useTables),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TableFile",
+                   "File from which the tables are loaded and to which they are "
+                   "saved, to build them once across runs. Empty to disable.",
+                   StringValue (""),
+                   MakeStringAccessor (&NistErrorRateModel::m_tableFile),
+                   MakeStringChecker ())
   ;
   return tid;
 }
 
 NistErrorRateModel::NistErrorRateModel ()
+  : m_useTables (false)
 {
 }
 
@@ -195,6 +221,161 @@ NistErrorRateModel::GetFecQamBer (uint16_t constellationSize, double snr, uint64
   return pms;
 }
 
+double
+NistErrorRateModel::GetCodedPe (uint16_t constellationSize, double snr, uint8_t bValue) const
+{
+  NS_LOG_FUNCTION (this << constellationSize << snr << +bValue);
+  double ber;
+  if (constellationSize == 2)
+    {
+      ber = GetBpskBer (snr);
+    }
+  else if (constellationSize == 4)
+    {
+      ber = GetQpskBer (snr);
+    }
+  else
+    {
+      ber = GetQamBer (constellationSize, snr);
+    }
+  if (ber == 0.0)
+    {
+      return 0.0;
+    }
+  return std::min (CalculatePe (ber, bValue), 1.0);
+}
+
+NistErrorRateModel::Tables &
+NistErrorRateModel::GetTables (void)
+{
+  static Tables tables;
+  return tables;
+}
+
+const double *
+NistErrorRateModel::GetTable (WifiMode mode) const
+{
+  uint32_t uid = mode.GetUid ();
+  if (uid < m_modeTables.size () && m_modeTables[uid] != 0)
+    {
+      return m_modeTables[uid];
+    }
+
+  uint16_t constellationSize = mode.GetConstellationSize ();
+  uint8_t bValue = GetBValue (mode.GetCodeRate ());
+  std::pair<uint16_t, uint8_t> key = std::make_pair (constellationSize, bValue);
+  Tables &tables = GetTables ();
+  if (tables.find (key) == tables.end () && !m_tableFile.empty ())
+    {
+      LoadTables ();
+    }
+  Tables::iterator it = tables.find (key);
+  if (it == tables.end ())
+    {
+      NS_LOG_DEBUG ("Build table for " << constellationSize << " points and bValue " << +bValue);
+      std::vector<double> table (TABLE_SIZE + 1);
+      for (uint32_t i = 0; i < TABLE_SIZE; i++)
+        {
+          double pe = GetCodedPe (constellationSize, DbToRatio (TABLE_MIN_SNR + i * TABLE_SNR_STEP), bValue);
+          table[i] = std::min (std::max (std::log (-std::log1p (-pe)), TABLE_MIN_VALUE), TABLE_MAX_VALUE);
+        }
+      // the last value is repeated so that the interpolation never reads past the table
+      table[TABLE_SIZE] = table[TABLE_SIZE - 1];
+      it = tables.insert (std::make_pair (key, table)).first;
+      if (!m_tableFile.empty ())
+        {
+          SaveTables ();
+        }
+    }
+
+  if (uid >= m_modeTables.size ())
+    {
+      m_modeTables.resize (uid + 1, 0);
+    }
+  m_modeTables[uid] = it->second.data ();
+  return m_modeTables[uid];
+}
+
+double
+NistErrorRateModel::GetTableChunkSuccessRate (const double *table, double snr, uint64_t nbits) const
+{
+  // the SNR is clamped to the table, with std::max first so that a NaN maps to 0
+  double x = (RatioToDb (snr) - TABLE_MIN_SNR) / TABLE_SNR_STEP;
+  x = std::min (std::max (x, 0.0), static_cast<double> (TABLE_SIZE - 1));
+  uint32_t i = static_cast<uint32_t> (x);
+  double f = x - i;
+  double value = table[i] + f * (table[i + 1] - table[i]);
+  return std::exp (-static_cast<double> (nbits) * std::exp (value));
+}
+
+void
+NistErrorRateModel::LoadTables (void) const
+{
+  NS_LOG_FUNCTION (this << m_tableFile);
+  std::ifstream file (m_tableFile.c_str ());
+  if (!file.is_open ())
+    {
+      return;
+    }
+  std::string magic;
+  uint32_t version = 0;
+  double minSnr = 0;
+  double snrStep = 0;
+  uint32_t size = 0;
+  file >> magic >> version >> minSnr >> snrStep >> size;
+  if (!file || magic != "NistErrorRateModel" || version != TABLE_FILE_VERSION
+      || minSnr != TABLE_MIN_SNR || snrStep != TABLE_SNR_STEP || size != TABLE_SIZE)
+    {
+      NS_LOG_WARN ("Ignore the tables of " << m_tableFile << ", built for another format");
+      return;
+    }
+  Tables &tables = GetTables ();
+  uint32_t constellationSize;
+  uint32_t bValue;
+  while (file >> constellationSize >> bValue)
+    {
+      std::vector<double> table (TABLE_SIZE + 1);
+      for (uint32_t i = 0; i < TABLE_SIZE; i++)
+        {
+          file >> table[i];
+        }
+      if (!file)
+        {
+          NS_LOG_WARN ("Truncated table in " << m_tableFile);
+          return;
+        }
+      table[TABLE_SIZE] = table[TABLE_SIZE - 1];
+      tables.insert (std::make_pair (std::make_pair (static_cast<uint16_t> (constellationSize),
+                                                     static_cast<uint8_t> (bValue)),
+                                     table));
+    }
+}
+
+void
+NistErrorRateModel::SaveTables (void) const
+{
+  NS_LOG_FUNCTION (this << m_tableFile);
+  std::ofstream file (m_tableFile.c_str ());
+  if (!file.is_open ())
+    {
+      NS_LOG_WARN ("Unable to write the tables to " << m_tableFile);
+      return;
+    }
+  file << "NistErrorRateModel " << TABLE_FILE_VERSION << " " << TABLE_MIN_SNR
+       << " " << TABLE_SNR_STEP << " " << TABLE_SIZE << std::endl;
+  file << std::setprecision (17);
+  const Tables &tables = GetTables ();
+  for (Tables::const_iterator it = tables.begin (); it != tables.end (); it++)
+    {
+      file << it->first.first << " " << +it->first.second;
+      for (uint32_t i = 0; i < TABLE_SIZE; i++)
+        {
+          file << " " << it->second[i];
+        }
+      file << std::endl;
+    }
+}
+
 uint8_t
 NistErrorRateModel::GetBValue (WifiCodeRate codeRate) const
 {
@@ -222,6 +403,10 @@ NistErrorRateModel::DoGetChunkSuccessRate (WifiMode mode, const WifiTxVector& tx
   NS_LOG_FUNCTION (this << mode << snr << nbits << +numRxAntennas << field << staId);
   if (mode.GetModulationClass () >= WIFI_MOD_CLASS_ERP_OFDM)
     {
+      if (m_useTables)
+        {
+          return GetTableChunkSuccessRate (GetTable (mode), snr, nbits);
+        }
       if (mode.GetConstellationSize () == 2)
         {
           return GetFecBpskBer (snr, nbits, GetBValue (mode.GetCodeRate ()));
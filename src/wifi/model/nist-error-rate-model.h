@@ -21,6 +21,8 @@
 #ifndef NIST_ERROR_RATE_MODEL_H
 #define NIST_ERROR_RATE_MODEL_H
 
+#include <map>
+#include <vector>
 #include "error-rate-model.h"
 #include "wifi-mode.h"
 
@@ -33,6 +35,16 @@ namespace ns3 {
  * the model description and validation can be found in
  * http://www.nsnam.org/~pei/80211ofdm.pdf.  For DSSS modulations (802.11b),
  * the model uses the DsssErrorRateModel.
+ *
+ * The success rate of a chunk of n bits is \f$ (1 - p_e)^n \f$, where the
+ * coded bit error probability \f$ p_e \f$ only depends on the SNR, the
+ * constellation and the coding rate.  When UseTables is true,
+ * \f$ \ln(-\ln(1 - p_e)) \f$ is tabulated once per process for each
+ * constellation and coding rate, from -10 dB to 50 dB by steps of 0.02 dB,
+ * and interpolated linearly in dB, so a chunk costs a logarithm and two
+ * exponentials instead of the evaluation of the model.  The chunk success
+ * rates differ from those of the model by less than 1e-4.  The tables can
+ * be kept in a TableFile between runs.
  */
 class NistErrorRateModel : public ErrorRateModel
 {
@@ -49,6 +61,50 @@ public:
 private:
   double DoGetChunkSuccessRate (WifiMode mode, const WifiTxVector& txVector, double snr, uint64_t nbits,
                                 uint8_t numRxAntennas, WifiPpduField field, uint16_t staId) const override;
+  /// Tables of ln(-ln(1 - pe)), indexed by constellation size and bValue
+  typedef std::map<std::pair<uint16_t, uint8_t>, std::vector<double> > Tables;
+  /**
+   * Return the tables shared by all the instances.
+   *
+   * \return the tables
+   */
+  static Tables & GetTables (void);
+  /**
+   * Return the table of a mode, building or loading it if needed.
+   *
+   * \param mode the Wi-Fi mode
+   *
+   * \return the values of the table
+   */
+  const double * GetTable (WifiMode mode) const;
+  /**
+   * Return the chunk success rate interpolated in a table.
+   *
+   * \param table the values of the table
+   * \param snr SNR ratio (in linear scale)
+   * \param nbits the number of bits in the chunk
+   *
+   * \return probability of successfully receiving the chunk
+   */
+  double GetTableChunkSuccessRate (const double *table, double snr, uint64_t nbits) const;
+  /**
+   * Add the tables of TableFile which are not built yet.
+   */
+  void LoadTables (void) const;
+  /**
+   * Write all the tables to TableFile.
+   */
+  void SaveTables (void) const;
+  /**
+   * Return the coded bit error probability at the given SNR.
+   *
+   * \param constellationSize the constellation size (M)
+   * \param snr SNR ratio (in linear scale)
+   * \param bValue the bValue such that coding rate = bValue / (bValue + 1)
+   *
+   * \return the coded bit error probability, at most 1
+   */
+  double GetCodedPe (uint16_t constellationSize, double snr, uint8_t bValue) const;
   /**
    * Return the bValue such that coding rate = bValue / (bValue + 1).
    *
@@ -121,6 +177,10 @@ private:
    * \return BER of QAM for a given constellation size at the given SNR after applying FEC
    */
   double GetFecQamBer (uint16_t constellationSize, double snr, uint64_t nbits, uint8_t bValue) const;
+
+  bool m_useTables;          ///< whether to interpolate in the tables
+  std::string m_tableFile;   ///< file caching the tables, if not empty
+  mutable std::vector<const double *> m_modeTables; ///< tables of the modes, indexed by WifiMode UID
 };
 
 } //namespace ns3
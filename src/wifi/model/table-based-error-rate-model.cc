@@ -163,47 +163,31 @@ TableBasedErrorRateModel::DoGetChunkSuccessRate (WifiMode mode, const WifiTxVect
     }
 
   auto errorTable = (ldpc ? AwgnErrorTableLdpc1458 : (size < m_threshold ? AwgnErrorTableBcc32 : AwgnErrorTableBcc1458));
-  auto itVector = errorTable[mcs];
-  auto itTable = std::find_if (itVector.begin(), itVector.end(),
-      [&roundedSnr](const std::pair<double, double>& element) {
-          return element.first == roundedSnr;
+  const SnrPerTable &table = errorTable[mcs];
+  // the tables are sorted by SNR: find the first entry not below the SNR
+  auto itTable = std::lower_bound (table.begin (), table.end (), roundedSnr,
+      [](const std::pair<double, double>& element, double snr) {
+          return element.first < snr;
       });
-  double minSnr = itVector.begin ()->first;
-  double maxSnr = (--itVector.end ())->first;
   double per;
-  if (itTable == itVector.end ())
+  if (itTable != table.end () && itTable->first == roundedSnr)
     {
-      if (roundedSnr < minSnr)
-        {
-          per = 1.0;
-        }
-      else if (roundedSnr > maxSnr)
-        {
-          per = 0.0;
-        }
-      else
-        {
-          double a = 0.0, b = 0.0, previousSnr = 0.0, nextSnr = 0.0;
-          for (auto i = itVector.begin (); i != itVector.end (); ++i)
-            {
-              if (i->first < roundedSnr)
-                {
-                  previousSnr = i->first;
-                  a = i->second;
-                }
-              else
-                {
-                  nextSnr = i->first;
-                  b = i->second;
-                  break;
-                }
-            }
-          per = a + (roundedSnr - previousSnr) * (b - a) / (nextSnr - previousSnr);
-        }
+      per = itTable->second;
+    }
+  else if (itTable == table.begin ())
+    {
+      per = 1.0;
+    }
+  else if (itTable == table.end ())
+    {
+      per = 0.0;
     }
   else
     {
-      per = itTable->second;
+      auto previous = itTable - 1;
+      double a = previous->second;
+      double b = itTable->second;
+      per = a + (roundedSnr - previous->first) * (b - a) / (itTable->first - previous->first);
     }
 
   uint16_t tableSize = (ldpc ? ERROR_TABLE_LDPC_FRAME_SIZE : (size < m_threshold ? ERROR_TABLE_BCC_SMALL_FRAME_SIZE : ERROR_TABLE_BCC_LARGE_FRAME_SIZE));
@@ -542,7 +542,7 @@ WifiPhy::GetTypeId (void)
                      "Trace source indicating a packet "
                      "has been dropped by the device during reception",
                      MakeTraceSourceAccessor (&WifiPhy::m_phyRxDropTrace),
-                     "ns3::Packet::TracedCallback")
+                     "ns3::WifiPhy::PhyRxDropTracedCallback")
     .AddTraceSource ("MonitorSnifferRx",
                      "Trace source simulating a wifi device in monitor mode "
                      "sniffing all received frames",
@@ -703,6 +703,14 @@ public:
    */
   typedef void (* PhyRxBeginTracedCallback) (Ptr<const Packet> packet, RxPowerWattPerChannelBand rxPowersW);
 
+  /**
+   * TracedCallback signature for PhyRxDrop trace source.
+   *
+   * \param packet the packet dropped
+   * \param reason the reason of the drop
+   */
+  typedef void (* PhyRxDropTracedCallback) (Ptr<const Packet> packet, WifiPhyRxfailureReason reason);
+
   /**
    * TracedCallback signature for start of PSDU reception events.
    *
@@ -18,14 +18,19 @@
  * Author: Mathieu Lacage, <mathieu.lacage@sophia.inria.fr>
  */
 
+#include <algorithm>
+#include <cmath>
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
 #include "ns3/net-device.h"
 #include "ns3/node.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/propagation-delay-model.h"
 #include "ns3/mobility-model.h"
+#include "ns3/constant-position-mobility-model.h"
 #include "yans-wifi-channel.h"
 #include "yans-wifi-phy.h"
 #include "wifi-utils.h"
@@ -53,11 +58,44 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("MaxRange",
+                   "The distance, in meters, beyond which no PHY is considered as a "
+                   "receiver, or 0 to consider every PHY. Receivers are then looked up "
+                   "in a grid of MaxRange-wide cells.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("BatchDelivery",
+                   "If true, the receptions of a transmission with the same propagation "
+                   "delay are delivered by a single event and share one copy of the PPDU.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::m_batchDelivery),
+                   MakeBooleanChecker ())
+    .AddAttribute ("DelayResolution",
+                   "The propagation delays are rounded to this resolution in batch delivery "
+                   "mode. A coarser resolution groups more receivers in a batch, at the "
+                   "expense of the accuracy of the reception times.",
+                   TimeValue (NanoSeconds (1)),
+                   MakeTimeAccessor (&YansWifiChannel::m_delayResolution),
+                   MakeTimeChecker (TimeStep (1)))
+    .AddAttribute ("CacheLinkBudget",
+                   "If true, the RX power and the delay between static PHYs are cached, "
+                   "and only the stochastic models of the loss chain are evaluated for "
+                   "each transmission.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::m_cacheLinkBudget),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_maxRange (0),
+    m_batchDelivery (false),
+    m_cacheLinkBudget (false),
+    m_linkBudgetIndexed (false),
+    m_indexed (false),
+    m_maxSpeed (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -68,6 +106,23 @@ YansWifiChannel::~YansWifiChannel ()
   m_phyList.clear ();
 }
 
+void
+YansWifiChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_phyMobility.size (); i++)
+    {
+      m_phyMobility[i]->TraceDisconnect ("CourseChange", std::to_string (i),
+                                         MakeCallback (&YansWifiChannel::CourseChanged, this));
+    }
+  m_phyMobility.clear ();
+  m_grid.clear ();
+  m_indexed = false;
+  m_linkBudget.Clear ();
+  m_linkBudgetIndexed = false;
+  Channel::DoDispose ();
+}
+
 void
 YansWifiChannel::SetPropagationLossModel (const Ptr<PropagationLossModel> loss)
 {
@@ -88,38 +143,280 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const WifiPpdu> ppdu, double
   NS_LOG_FUNCTION (this << sender << ppdu << txPowerDbm);
   Ptr<MobilityModel> senderMobility = sender->GetMobility ();
   NS_ASSERT (senderMobility != 0);
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+  std::unordered_map<const YansWifiPhy *, uint32_t>::const_iterator index = m_phyIndex.find (PeekPointer (sender));
+  NS_ASSERT (index != m_phyIndex.end ());
+  uint32_t senderIndex = index->second;
+  if (m_cacheLinkBudget && !m_linkBudgetIndexed)
     {
-      if (sender != (*i))
+      m_linkBudget.Clear ();
+      m_linkBudget.Reserve (m_phyList.size ());
+      for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+        {
+          m_linkBudget.Add ((*i)->GetMobility ()->GetObject<MobilityModel> ());
+        }
+      m_linkBudgetIndexed = true;
+    }
+  if (m_maxRange <= 0)
+    {
+      for (uint32_t i = 0; i < m_phyList.size (); i++)
         {
           //For now don't account for inter channel interference nor channel bonding
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
+          if (sender != m_phyList[i] && m_phyList[i]->GetChannelNumber () == sender->GetChannelNumber ())
             {
-              continue;
+              SendTo (sender, senderIndex, senderMobility,
+                      m_phyList[i], i, m_phyList[i]->GetMobility ()->GetObject<MobilityModel> (),
+                      ppdu, txPowerDbm);
             }
+        }
+      ScheduleBatches (ppdu);
+      return;
+    }
 
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
-          Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
-          double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
-          NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
-                        "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<WifiPpdu> copy = ppdu->Copy ();
-          Ptr<NetDevice> dstNetDevice = (*i)->GetDevice ();
-          uint32_t dstNode;
-          if (dstNetDevice == 0)
-            {
-              dstNode = 0xffffffff;
-            }
-          else
+  if (!m_indexed)
+    {
+      BuildIndex ();
+    }
+  // a moving PHY may have left its cell since it was indexed; widen the
+  // search by the distance it may have covered, or re-index the moving
+  // PHYs once that distance grows too large
+  double drift = m_maxSpeed * (Simulator::Now () - m_lastRefresh).GetSeconds ();
+  if (drift > m_maxRange / 2)
+    {
+      RefreshIndex ();
+      drift = 0;
+    }
+  double searchRange = m_maxRange + drift;
+  Vector position = senderMobility->GetPosition ();
+  int32_t reach = static_cast<int32_t> (std::ceil (searchRange / m_maxRange));
+  int32_t cx = GetCellIndex (position.x);
+  int32_t cy = GetCellIndex (position.y);
+  std::vector<uint32_t> candidates;
+  for (int32_t x = cx - reach; x <= cx + reach; x++)
+    {
+      for (int32_t y = cy - reach; y <= cy + reach; y++)
+        {
+          Grid::const_iterator cell = m_grid.find (GetCellKey (x, y));
+          if (cell != m_grid.end ())
             {
-              dstNode = dstNetDevice->GetNode ()->GetId ();
+              candidates.insert (candidates.end (), cell->second.begin (), cell->second.end ());
             }
+        }
+    }
+  // same order as the PHY list, so that simultaneous receptions are
+  // scheduled as without the grid
+  std::sort (candidates.begin (), candidates.end ());
+  for (std::vector<uint32_t>::const_iterator i = candidates.begin (); i != candidates.end (); i++)
+    {
+      Ptr<YansWifiPhy> receiver = m_phyList[*i];
+      if (sender == receiver
+          || receiver->GetChannelNumber () != sender->GetChannelNumber ()
+          || senderMobility->GetDistanceFrom (m_phyMobility[*i]) > m_maxRange)
+        {
+          continue;
+        }
+      SendTo (sender, senderIndex, senderMobility, receiver, *i, m_phyMobility[*i], ppdu, txPowerDbm);
+    }
+  ScheduleBatches (ppdu);
+}
+
+void
+YansWifiChannel::SendTo (Ptr<YansWifiPhy> sender, uint32_t senderIndex, Ptr<MobilityModel> senderMobility,
+                         Ptr<YansWifiPhy> receiver, uint32_t receiverIndex, Ptr<MobilityModel> receiverMobility,
+                         Ptr<const WifiPpdu> ppdu, double txPowerDbm) const
+{
+  Time delay;
+  double rxPowerDbm;
+  if (m_cacheLinkBudget)
+    {
+      rxPowerDbm = m_linkBudget.CalcRxPower (senderIndex, receiverIndex, txPowerDbm, m_loss, m_delay, delay);
+    }
+  else
+    {
+      delay = m_delay->GetDelay (senderMobility, receiverMobility);
+      rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+    }
+  NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
+                "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+  Ptr<NetDevice> dstNetDevice = receiver->GetDevice ();
+  uint32_t dstNode;
+  if (dstNetDevice == 0)
+    {
+      dstNode = 0xffffffff;
+    }
+  else
+    {
+      dstNode = dstNetDevice->GetNode ()->GetId ();
+    }
+
+  if (m_batchDelivery)
+    {
+      int64_t resolution = m_delayResolution.GetTimeStep ();
+      int64_t steps = (delay.GetTimeStep () + resolution / 2) / resolution * resolution;
+      m_pending.push_back (std::make_pair (steps, Delivery {receiver, dstNode, rxPowerDbm}));
+      return;
+    }
+  Ptr<WifiPpdu> copy = ppdu->Copy ();
+  Simulator::ScheduleWithContext (dstNode,
+                                  delay, &YansWifiChannel::Receive,
+                                  receiver, copy, rxPowerDbm);
+}
+
+void
+YansWifiChannel::ScheduleBatches (Ptr<const WifiPpdu> ppdu) const
+{
+  if (m_pending.empty ())
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this << ppdu << m_pending.size ());
+  // the receivers were added in PHY list order, which a stable sort keeps
+  // within each delay
+  std::stable_sort (m_pending.begin (), m_pending.end (),
+                    [] (const PendingDelivery &a, const PendingDelivery &b) { return a.first < b.first; });
+  Ptr<WifiPpdu> copy = ppdu->Copy ();
+  std::vector<PendingDelivery>::const_iterator first = m_pending.begin ();
+  while (first != m_pending.end ())
+    {
+      std::vector<PendingDelivery>::const_iterator last = first;
+      Ptr<Batch> batch = Create<Batch> ();
+      batch->ppdu = copy;
+      while (last != m_pending.end () && last->first == first->first)
+        {
+          batch->deliveries.push_back (last->second);
+          last++;
+        }
+      Simulator::ScheduleWithContext (first->second.node, TimeStep (first->first),
+                                      &YansWifiChannel::ReceiveBatch, Ptr<const Batch> (batch));
+      first = last;
+    }
+  m_pending.clear ();
+}
+
+int32_t
+YansWifiChannel::GetCellIndex (double x) const
+{
+  return static_cast<int32_t> (std::floor (x / m_maxRange));
+}
+
+uint64_t
+YansWifiChannel::GetCellKey (int32_t cx, int32_t cy)
+{
+  return (static_cast<uint64_t> (static_cast<uint32_t> (cx)) << 32) | static_cast<uint32_t> (cy);
+}
+
+void
+YansWifiChannel::BuildIndex (void) const
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_phyMobility.size (); i++)
+    {
+      m_phyMobility[i]->TraceDisconnect ("CourseChange", std::to_string (i),
+                                         MakeCallback (&YansWifiChannel::CourseChanged, this));
+    }
+  m_grid.clear ();
+  m_phyCell.clear ();
+  m_phyMobility.clear ();
+  m_phyMoving.clear ();
+  m_maxSpeed = 0;
+  for (uint32_t i = 0; i < m_phyList.size (); i++)
+    {
+      Ptr<MobilityModel> mobility = m_phyList[i]->GetMobility ()->GetObject<MobilityModel> ();
+      NS_ASSERT (mobility != 0);
+      Vector position = mobility->GetPosition ();
+      uint64_t key = GetCellKey (GetCellIndex (position.x), GetCellIndex (position.y));
+      m_grid[key].push_back (i);
+      m_phyCell.push_back (key);
+      m_phyMobility.push_back (mobility);
+      double speed = mobility->GetVelocity ().GetLength ();
+      m_phyMoving.push_back (speed > 0);
+      m_maxSpeed = std::max (m_maxSpeed, speed);
+      mobility->TraceConnect ("CourseChange", std::to_string (i),
+                              MakeCallback (&YansWifiChannel::CourseChanged, this));
+    }
+  m_lastRefresh = Simulator::Now ();
+  m_indexed = true;
+}
+
+void
+YansWifiChannel::IndexPhy (uint32_t i) const
+{
+  Vector position = m_phyMobility[i]->GetPosition ();
+  uint64_t key = GetCellKey (GetCellIndex (position.x), GetCellIndex (position.y));
+  if (key == m_phyCell[i])
+    {
+      return;
+    }
+  std::vector<uint32_t> &cell = m_grid[m_phyCell[i]];
+  cell.erase (std::find (cell.begin (), cell.end (), i));
+  if (cell.empty ())
+    {
+      m_grid.erase (m_phyCell[i]);
+    }
+  m_grid[key].push_back (i);
+  m_phyCell[i] = key;
+}
+
+void
+YansWifiChannel::RefreshIndex (void) const
+{
+  NS_LOG_FUNCTION (this);
+  m_maxSpeed = 0;
+  for (uint32_t i = 0; i < m_phyMobility.size (); i++)
+    {
+      if (m_phyMoving[i])
+        {
+          IndexPhy (i);
+          double speed = m_phyMobility[i]->GetVelocity ().GetLength ();
+          m_phyMoving[i] = speed > 0;
+          m_maxSpeed = std::max (m_maxSpeed, speed);
+        }
+    }
+  m_lastRefresh = Simulator::Now ();
+}
+
+void
+YansWifiChannel::CourseChanged (std::string context, Ptr<const MobilityModel> mobility) const
+{
+  uint32_t i = std::stoul (context);
+  IndexPhy (i);
+  double speed = mobility->GetVelocity ().GetLength ();
+  if (speed > 0)
+    {
+      // the drift allowance assumes every moving PHY was indexed at the
+      // last refresh, which is conservative for this one
+      m_phyMoving[i] = true;
+      m_maxSpeed = std::max (m_maxSpeed, speed);
+    }
+}
 
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive,
-                                          (*i), copy, rxPowerDbm);
+double
+YansWifiChannel::ComputeMaxRange (double txPowerDbm, double thresholdDbm, double maxDistance) const
+{
+  NS_LOG_FUNCTION (this << txPowerDbm << thresholdDbm << maxDistance);
+  Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<MobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  b->SetPosition (Vector (maxDistance, 0, 0));
+  if (m_loss->CalcRxPower (txPowerDbm, a, b) >= thresholdDbm)
+    {
+      return maxDistance;
+    }
+  double low = 0;
+  double high = maxDistance;
+  while (high - low > 0.01)
+    {
+      double middle = (low + high) / 2;
+      b->SetPosition (Vector (middle, 0, 0));
+      if (m_loss->CalcRxPower (txPowerDbm, a, b) >= thresholdDbm)
+        {
+          low = middle;
+        }
+      else
+        {
+          high = middle;
         }
     }
+  // the upper bound, so that the range stays conservative
+  return high;
 }
 
 void
@@ -138,6 +435,19 @@ YansWifiChannel::Receive (Ptr<YansWifiPhy> phy, Ptr<WifiPpdu> ppdu, double rxPow
   phy->StartReceivePreamble (ppdu, rxPowerW, ppdu->GetTxDuration ());
 }
 
+void
+YansWifiChannel::ReceiveBatch (Ptr<const Batch> batch)
+{
+  NS_LOG_FUNCTION (batch->ppdu << batch->deliveries.size ());
+  uint32_t context = Simulator::GetContext ();
+  for (std::vector<Delivery>::const_iterator i = batch->deliveries.begin (); i != batch->deliveries.end (); i++)
+    {
+      Simulator::SetContext (i->node);
+      Receive (i->phy, batch->ppdu, i->rxPowerDbm);
+    }
+  Simulator::SetContext (context);
+}
+
 std::size_t
 YansWifiChannel::GetNDevices (void) const
 {
@@ -154,7 +464,10 @@ void
 YansWifiChannel::Add (Ptr<YansWifiPhy> phy)
 {
   NS_LOG_FUNCTION (this << phy);
+  m_phyIndex[PeekPointer (phy)] = m_phyList.size ();
   m_phyList.push_back (phy);
+  m_indexed = false;
+  m_linkBudgetIndexed = false;
 }
 
 int64_t
@@ -21,13 +21,19 @@
 #ifndef YANS_WIFI_CHANNEL_H
 #define YANS_WIFI_CHANNEL_H
 
+#include <unordered_map>
+#include <vector>
 #include "ns3/channel.h"
+#include "ns3/nstime.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/link-budget-cache.h"
 
 namespace ns3 {
 
 class NetDevice;
 class PropagationLossModel;
 class PropagationDelayModel;
+class MobilityModel;
 class YansWifiPhy;
 class Packet;
 class Time;
@@ -41,6 +47,30 @@ class WifiPpdu;
  * class and supports an ns3::PropagationLossModel and an
  * ns3::PropagationDelayModel.  By default, no propagation models are set;
  * it is the caller's responsibility to set them before using the channel.
+ *
+ * By default every transmission is scheduled at every other PHY, and the
+ * PHYs that receive it below their sensitivity drop it.  When the
+ * MaxRange attribute is set, the receivers are kept in a uniform grid of
+ * MaxRange-wide cells and Send only considers the PHYs within MaxRange of
+ * the sender.  The grid follows the CourseChange trace of the mobility
+ * models; between two course changes a moving receiver is assumed to keep
+ * the velocity its model reports, and the search is widened accordingly.
+ * A MaxRange beyond which no signal reaches the sensitivity of any
+ * receiver (see ComputeMaxRange) leaves the results unchanged.
+ *
+ * By default every reception is a separate event carrying a separate
+ * copy of the PPDU.  When the BatchDelivery attribute is set, the
+ * receptions of a transmission are grouped by propagation delay, rounded
+ * to DelayResolution, and each group is delivered by a single event; all
+ * the receivers share one copy of the PPDU, which they must not modify.
+ * Each receiver is still handed the PPDU in its own node context and in
+ * the order of the PHY list, so that with the default resolution, that
+ * of the simulation time, the results are unchanged.
+ *
+ * When the CacheLinkBudget attribute is set, the RX power and the delay
+ * between static PHYs are kept in a LinkBudgetCache: only the stochastic
+ * models of the loss chain, such as Nakagami, are evaluated again for
+ * each transmission.
  */
 class YansWifiChannel : public Channel
 {
@@ -96,6 +126,26 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * Compute the distance beyond which the propagation loss model brings a
+   * signal below a threshold, e.g. the lowest RX sensitivity minus the
+   * highest RX gain of the PHYs, for use as MaxRange.
+   *
+   * The distance is found by bisection over CalcRxPower, which must
+   * therefore be deterministic and decrease with distance: stochastic
+   * models such as Nakagami must not be part of the loss chain, or their
+   * largest gain must be included in the threshold.
+   *
+   * \param txPowerDbm the highest TX power, in dBm
+   * \param thresholdDbm the lowest RX power of interest, in dBm
+   * \param maxDistance the largest distance searched, in meters
+   * \return the range, in meters, or maxDistance if the signal is still
+   * above the threshold at that distance
+   */
+  double ComputeMaxRange (double txPowerDbm, double thresholdDbm, double maxDistance = 100000) const;
+
+protected:
+  void DoDispose (void) override;
 
 private:
   /**
@@ -114,9 +164,108 @@ private:
    */
   static void Receive (Ptr<YansWifiPhy> receiver, Ptr<WifiPpdu> ppdu, double txPowerDbm);
 
+  /// A reception of a batch
+  struct Delivery
+  {
+    Ptr<YansWifiPhy> phy; //!< the receiving PHY
+    uint32_t node;        //!< the node of the receiving PHY, the context of the reception
+    double rxPowerDbm;    //!< the RX power, in dBm
+  };
+
+  /// The receptions of a transmission with the same propagation delay
+  struct Batch : public SimpleRefCount<Batch>
+  {
+    Ptr<WifiPpdu> ppdu;               //!< the PPDU shared by the receivers
+    std::vector<Delivery> deliveries; //!< the receptions, in PHY list order
+  };
+
+  /**
+   * This method is scheduled by Send for each batch of receptions.  It
+   * calls Receive for each receiver, in the context of its node.
+   *
+   * \param batch the batch of receptions
+   */
+  static void ReceiveBatch (Ptr<const Batch> batch);
+
+  /**
+   * Schedule the reception of a PPDU at a PHY on the same channel, or
+   * add it to the pending receptions in batch delivery mode
+   *
+   * \param sender the PHY object from which the packet is originating
+   * \param senderIndex the index of the sender in the PHY list
+   * \param senderMobility the mobility model of the sender
+   * \param receiver the receiving PHY
+   * \param receiverIndex the index of the receiver in the PHY list
+   * \param receiverMobility the mobility model of the receiver
+   * \param ppdu the PPDU to send
+   * \param txPowerDbm the TX power associated to the packet, in dBm
+   */
+  void SendTo (Ptr<YansWifiPhy> sender, uint32_t senderIndex, Ptr<MobilityModel> senderMobility,
+               Ptr<YansWifiPhy> receiver, uint32_t receiverIndex, Ptr<MobilityModel> receiverMobility,
+               Ptr<const WifiPpdu> ppdu, double txPowerDbm) const;
+  /**
+   * Schedule the pending receptions, one event per propagation delay
+   *
+   * \param ppdu the PPDU sent
+   */
+  void ScheduleBatches (Ptr<const WifiPpdu> ppdu) const;
+  /**
+   * \param x the coordinate
+   * \return the index of the grid cell containing the coordinate
+   */
+  int32_t GetCellIndex (double x) const;
+  /**
+   * \param cx the cell index along x
+   * \param cy the cell index along y
+   * \return the key of the grid cell
+   */
+  static uint64_t GetCellKey (int32_t cx, int32_t cy);
+  /**
+   * Build the grid of receivers and connect to their CourseChange traces
+   */
+  void BuildIndex (void) const;
+  /**
+   * Move a PHY to the grid cell of its current position
+   *
+   * \param i the index of the PHY in the PHY list
+   */
+  void IndexPhy (uint32_t i) const;
+  /**
+   * Re-index all the moving PHYs at their current position
+   */
+  void RefreshIndex (void) const;
+  /**
+   * Re-index a PHY whose mobility model changed course
+   *
+   * \param context the index of the PHY in the PHY list
+   * \param mobility the mobility model
+   */
+  void CourseChanged (std::string context, Ptr<const MobilityModel> mobility) const;
+
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+  double m_maxRange;                   //!< range of the receiver search, 0 to disable it
+  bool m_batchDelivery;                //!< whether receptions are delivered by batches
+  bool m_cacheLinkBudget;              //!< whether link budgets are cached
+  std::unordered_map<const YansWifiPhy *, uint32_t> m_phyIndex; //!< index of each PHY in the PHY list
+  mutable LinkBudgetCache m_linkBudget; //!< link budgets between the PHYs
+  mutable bool m_linkBudgetIndexed;     //!< whether every PHY is in the link budget cache
+  Time m_delayResolution;              //!< resolution of the delays of a batch
+
+  /// A pending reception and its delay, in time steps
+  typedef std::pair<int64_t, Delivery> PendingDelivery;
+  mutable std::vector<PendingDelivery> m_pending; //!< receptions of the transmission being sent
+
+  /// PHY indices per grid cell
+  typedef std::unordered_map<uint64_t, std::vector<uint32_t> > Grid;
+  mutable bool m_indexed;                                 //!< whether the grid is built
+  mutable Grid m_grid;                                    //!< grid of receivers
+  mutable std::vector<uint64_t> m_phyCell;                //!< grid cell of each PHY
+  mutable std::vector<Ptr<MobilityModel> > m_phyMobility; //!< mobility model of each PHY
+  mutable std::vector<bool> m_phyMoving;                  //!< whether each PHY moves
+  mutable double m_maxSpeed;                              //!< highest speed of the moving PHYs
+  mutable Time m_lastRefresh;                             //!< last time the moving PHYs were indexed
 };
 
 } //namespace ns3
@@ -0,0 +1,238 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/interference-helper.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief InterferenceHelper exposing its NI changes
+ */
+class NiChangesInterferenceHelper : public InterferenceHelper
+{
+public:
+  using InterferenceHelper::NiChange;
+  using InterferenceHelper::NiChanges;
+  using InterferenceHelper::GetNiChanges;
+};
+
+/// The NI changes of a band
+typedef NiChangesInterferenceHelper::NiChanges NiChanges;
+/// A NI change
+typedef NiChangesInterferenceHelper::NiChange NiChange;
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief InterferenceHelper NI changes test
+ *
+ * Checks the order in which the NI changes are inserted, the append fast
+ * path, the pruning and compaction of the buffers, and that the changes
+ * of a PHY receiving signals back to back stay bounded while the NI
+ * power read from them is unchanged.
+ */
+class InterferenceHelperNiChangesTest : public TestCase
+{
+public:
+  InterferenceHelperNiChangesTest ();
+  virtual ~InterferenceHelperNiChangesTest ();
+
+private:
+  virtual void DoRun (void);
+
+  /// Check the insertion order of changes at the same time
+  void TestInsertionOrder (void);
+  /// Check that changes later than the last one are appended
+  void TestAppend (void);
+  /// Check the pruning and the compaction of the buffers
+  void TestPrune (void);
+  /// Check the number of changes of a PHY receiving signals back to back
+  void TestBackToBack (void);
+
+  /**
+   * Receive a signal overlapping the previous one, and switch the
+   * reception to it, as frame capture does
+   * \param helper the interference helper
+   * \param duration the duration of the signal
+   */
+  void ReceiveSignal (NiChangesInterferenceHelper *helper, Time duration);
+
+  WifiSpectrumBand m_band; ///< the band of the signals
+  double m_powerW;         ///< the power of each signal, in watts
+  std::size_t m_maxSize;   ///< largest number of changes seen
+};
+
+InterferenceHelperNiChangesTest::InterferenceHelperNiChangesTest ()
+  : TestCase ("Insertion, pruning and size of the InterferenceHelper NI changes"),
+    m_band (std::make_pair (0, 0)),
+    m_powerW (1e-9),
+    m_maxSize (0)
+{
+}
+
+InterferenceHelperNiChangesTest::~InterferenceHelperNiChangesTest ()
+{
+}
+
+void
+InterferenceHelperNiChangesTest::TestInsertionOrder (void)
+{
+  NiChanges changes;
+  std::vector<Ptr<Event> > events;
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      RxPowerWattPerChannelBand rxPower;
+      events.push_back (Create<Event> (Ptr<const WifiPpdu> (), WifiTxVector (), Seconds (1), std::move (rxPower)));
+    }
+  changes.Insert (Seconds (0), NiChange (0, 0));
+  NS_TEST_EXPECT_MSG_EQ (changes.Insert (Seconds (2), NiChange (1, events[0])), 1, "Wrong index");
+  NS_TEST_EXPECT_MSG_EQ (changes.Insert (Seconds (2), NiChange (2, events[1])), 2, "Wrong index");
+  // by binary search, before the changes at a later time
+  NS_TEST_EXPECT_MSG_EQ (changes.Insert (Seconds (1), NiChange (3, events[2])), 1, "Wrong index");
+  NS_TEST_EXPECT_MSG_EQ (changes.Insert (Seconds (1), NiChange (4, events[3])), 2, "Wrong index");
+  // after the changes at the same time, before the later ones
+  NS_TEST_EXPECT_MSG_EQ (changes.Insert (Seconds (1), NiChange (5, events[4])), 3, "Wrong index");
+
+  NS_TEST_ASSERT_MSG_EQ (changes.GetSize (), 6, "Wrong number of changes");
+  const uint32_t order[] = {2, 3, 4, 0, 1};
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (changes.Get (i + 1).GetEvent (), events[order[i]], "Wrong order at index " << i + 1);
+      NS_TEST_EXPECT_MSG_EQ (changes.GetTime (i + 1), Seconds (i < 3 ? 1 : 2), "Wrong time at index " << i + 1);
+    }
+  NS_TEST_EXPECT_MSG_EQ (changes.LowerBound (Seconds (1)), 1, "Wrong lower bound");
+  NS_TEST_EXPECT_MSG_EQ (changes.UpperBound (Seconds (1)), 4, "Wrong upper bound");
+  NS_TEST_EXPECT_MSG_EQ (changes.LowerBound (Seconds (3)), 6, "Wrong lower bound after the last change");
+}
+
+void
+InterferenceHelperNiChangesTest::TestAppend (void)
+{
+  NiChanges changes;
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      // a change at the time of the last one is appended as well
+      Time moment = MicroSeconds (i / 2);
+      NS_TEST_EXPECT_MSG_EQ (changes.UpperBound (moment), i, "Change not appended");
+      NS_TEST_EXPECT_MSG_EQ (changes.Insert (moment, NiChange (i, 0)), i, "Change not appended");
+    }
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (changes.Get (i).GetPower (), i, "Wrong order of the appended changes");
+    }
+}
+
+void
+InterferenceHelperNiChangesTest::TestPrune (void)
+{
+  NiChanges changes;
+  changes.Insert (Seconds (0), NiChange (0, 0));
+  for (uint32_t i = 1; i <= 10; i++)
+    {
+      changes.Insert (Seconds (i), NiChange (i, 0));
+    }
+  changes.Prune (3);
+  NS_TEST_ASSERT_MSG_EQ (changes.GetSize (), 8, "Wrong number of changes after pruning");
+  NS_TEST_EXPECT_MSG_EQ (changes.GetTime (0), Seconds (0), "The first change should be kept");
+  NS_TEST_EXPECT_MSG_EQ (changes.Get (0).GetPower (), 0, "The first change should be kept");
+  NS_TEST_EXPECT_MSG_EQ (changes.GetTime (1), Seconds (4), "Wrong change after the first one");
+  NS_TEST_EXPECT_MSG_EQ (changes.Get (1).GetPower (), 4, "Wrong change after the first one");
+  // the erased changes are not compacted while they are fewer than the others
+  NS_TEST_EXPECT_MSG_EQ (changes.GetCapacity (), 11, "Unexpected compaction");
+
+  changes.Prune (3);
+  NS_TEST_ASSERT_MSG_EQ (changes.GetSize (), 5, "Wrong number of changes after pruning");
+  NS_TEST_EXPECT_MSG_EQ (changes.GetCapacity (), 5, "The buffers should be compacted");
+  NS_TEST_EXPECT_MSG_EQ (changes.Get (0).GetPower (), 0, "The first change should be kept");
+  for (uint32_t i = 1; i < 5; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (changes.GetTime (i), Seconds (6 + i), "Wrong change after compaction");
+      NS_TEST_EXPECT_MSG_EQ (changes.Get (i).GetPower (), 6 + i, "Wrong change after compaction");
+    }
+  // changes are still inserted at the right place after compaction
+  NS_TEST_EXPECT_MSG_EQ (changes.Insert (Seconds (8), NiChange (0, 0)), 3, "Wrong index after compaction");
+  NS_TEST_EXPECT_MSG_EQ (changes.Insert (Seconds (11), NiChange (0, 0)), 6, "Wrong index after compaction");
+}
+
+void
+InterferenceHelperNiChangesTest::ReceiveSignal (NiChangesInterferenceHelper *helper, Time duration)
+{
+  RxPowerWattPerChannelBand rxPower;
+  rxPower.insert ({m_band, m_powerW});
+  helper->AddForeignSignal (duration, rxPower);
+  // the previous signal is still on the air for half of the duration
+  NS_TEST_EXPECT_MSG_EQ (helper->GetEnergyDuration (1.5 * m_powerW, m_band), duration / 2,
+                         "Wrong NI power at " << Simulator::Now ().As (Time::US));
+  helper->NotifyRxEnd (Simulator::Now ());
+  helper->NotifyRxStart ();
+  m_maxSize = std::max (m_maxSize, helper->GetNiChanges (m_band).GetSize ());
+}
+
+void
+InterferenceHelperNiChangesTest::TestBackToBack (void)
+{
+  NiChangesInterferenceHelper helper;
+  helper.AddBand (m_band);
+  const Time duration = MicroSeconds (100);
+  RxPowerWattPerChannelBand rxPower;
+  rxPower.insert ({m_band, m_powerW});
+  helper.AddForeignSignal (duration, rxPower);
+  helper.NotifyRxStart ();
+  for (uint32_t i = 1; i <= 1000; i++)
+    {
+      Simulator::Schedule (i * duration / 2, &InterferenceHelperNiChangesTest::ReceiveSignal, this, &helper, duration);
+    }
+  Simulator::Run ();
+  // the first change, and the changes from the one preceding the start of
+  // the signal received on, whatever the number of signals received
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (m_maxSize, 8, "The NI changes of a receiving PHY should stay bounded");
+  Simulator::Destroy ();
+}
+
+void
+InterferenceHelperNiChangesTest::DoRun (void)
+{
+  TestInsertionOrder ();
+  TestAppend ();
+  TestPrune ();
+  TestBackToBack ();
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief InterferenceHelper TestSuite
+ */
+class InterferenceHelperTestSuite : public TestSuite
+{
+public:
+  InterferenceHelperTestSuite ();
+};
+
+InterferenceHelperTestSuite::InterferenceHelperTestSuite ()
+  : TestSuite ("wifi-interference-helper", UNIT)
+{
+  AddTestCase (new InterferenceHelperNiChangesTest, TestCase::QUICK);
+}
+
+static InterferenceHelperTestSuite g_interferenceHelperTestSuite; ///< the test suite
@@ -26,8 +26,12 @@
 #include "ns3/dsss-error-rate-model.h"
 #include "ns3/wifi-phy.h"
 #include "ns3/wifi-utils.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
 #include "ns3/table-based-error-rate-model.h"
 #include "ns3/he-phy.h" //includes HT and VHT
+#include <fstream>
+#include <cstdio>
 
 using namespace ns3;
 
@@ -1527,6 +1531,80 @@ TableBasedErrorRateTestCase::DoRun (void)
     }
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Wifi NIST Error Rate Model Tables Test Case
+ *
+ * Checks that the chunk success rates interpolated in the tables of
+ * NistErrorRateModel match those of the model for the 10 MHz OFDM modes.
+ */
+class NistErrorRateTablesTestCase : public TestCase
+{
+public:
+  NistErrorRateTablesTestCase ();
+  virtual ~NistErrorRateTablesTestCase ();
+
+private:
+  void DoRun (void) override;
+};
+
+NistErrorRateTablesTestCase::NistErrorRateTablesTestCase ()
+  : TestCase ("WifiErrorRateModel test case NIST tables")
+{
+}
+
+NistErrorRateTablesTestCase::~NistErrorRateTablesTestCase ()
+{
+}
+
+void
+NistErrorRateTablesTestCase::DoRun (void)
+{
+  Ptr<NistErrorRateModel> nist = CreateObject<NistErrorRateModel> ();
+  Ptr<NistErrorRateModel> tables = CreateObject<NistErrorRateModel> ();
+  tables->SetAttribute ("UseTables", BooleanValue (true));
+  WifiTxVector txVector;
+
+  const WifiMode modes[] = {OfdmPhy::GetOfdmRate3MbpsBW10MHz (), OfdmPhy::GetOfdmRate4_5MbpsBW10MHz (),
+                            OfdmPhy::GetOfdmRate6MbpsBW10MHz (), OfdmPhy::GetOfdmRate9MbpsBW10MHz (),
+                            OfdmPhy::GetOfdmRate12MbpsBW10MHz (), OfdmPhy::GetOfdmRate18MbpsBW10MHz (),
+                            OfdmPhy::GetOfdmRate24MbpsBW10MHz (), OfdmPhy::GetOfdmRate27MbpsBW10MHz ()};
+  const uint64_t sizes[] = {24, 200, 1600, 8000, 12000};
+  for (const WifiMode &mode : modes)
+    {
+      txVector.SetMode (mode);
+      for (uint64_t nbits : sizes)
+        {
+          // beyond both ends of the tables, and between their entries
+          for (double snr = -15; snr <= 55; snr += 0.13)
+            {
+              double expected = nist->GetChunkSuccessRate (mode, txVector, DbToRatio (snr), nbits);
+              double ps = tables->GetChunkSuccessRate (mode, txVector, DbToRatio (snr), nbits);
+              NS_TEST_ASSERT_MSG_EQ_TOL (ps, expected, 1e-4, mode << " snr=" << snr << "dB nbits=" << nbits);
+            }
+        }
+    }
+
+  // the tables are shared with the models created later
+  std::string tableFile = CreateTempDirFilename ("nist-error-rate-tables.txt");
+  Ptr<NistErrorRateModel> saved = CreateObject<NistErrorRateModel> ();
+  saved->SetAttribute ("UseTables", BooleanValue (true));
+  saved->SetAttribute ("TableFile", StringValue (tableFile));
+  txVector.SetMode (HtPhy::GetHtMcs7 ());
+  double expected = nist->GetChunkSuccessRate (HtPhy::GetHtMcs7 (), txVector, DbToRatio (25), 8000);
+  double ps = saved->GetChunkSuccessRate (HtPhy::GetHtMcs7 (), txVector, DbToRatio (25), 8000);
+  NS_TEST_ASSERT_MSG_EQ_TOL (ps, expected, 1e-4, "Not equal within tolerance");
+  std::ifstream file (tableFile.c_str ());
+  NS_TEST_ASSERT_MSG_EQ (file.is_open (), true, "Tables not saved to " << tableFile);
+  std::string magic;
+  file >> magic;
+  NS_TEST_ASSERT_MSG_EQ (magic, "NistErrorRateModel", "Unexpected table file format");
+  file.close ();
+  std::remove (tableFile.c_str ());
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -1544,6 +1622,7 @@ WifiErrorRateModelsTestSuite::WifiErrorRateModelsTestSuite ()
 {
   AddTestCase (new WifiErrorRateModelsTestCaseDsss, TestCase::QUICK);
   AddTestCase (new WifiErrorRateModelsTestCaseNist, TestCase::QUICK);
+  AddTestCase (new NistErrorRateTablesTestCase, TestCase::QUICK);
   AddTestCase (new WifiErrorRateModelsTestCaseMimo, TestCase::QUICK);
   AddTestCase (new TableBasedErrorRateTestCase ("DefaultTableBasedHtMcs0-1458bytes", HtPhy::GetHtMcs0 (), 1458), TestCase::QUICK);
   AddTestCase (new TableBasedErrorRateTestCase ("DefaultTableBasedHtMcs0-32bytes", HtPhy::GetHtMcs0 (), 32), TestCase::QUICK);
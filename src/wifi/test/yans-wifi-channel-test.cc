@@ -0,0 +1,346 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/packet-socket-helper.h"
+#include "ns3/packet-socket-address.h"
+#include "ns3/packet-socket-client.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-phy.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief YansWifiChannel broadcast scenario
+ *
+ * A line of nodes, some of them fast moving, broadcasting frames over a
+ * channel configured by the test cases.
+ */
+class YansWifiChannelBroadcastTest : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param name the test case name
+   */
+  YansWifiChannelBroadcastTest (std::string name);
+
+protected:
+  /// Frames received and dropped by each node
+  struct Counts
+  {
+    std::vector<uint32_t> rx;   ///< frames received
+    std::vector<uint32_t> drop; ///< frames dropped
+    uint64_t events;            ///< events executed
+  };
+
+  /**
+   * Run the scenario
+   * \param maxRange the MaxRange of the channel, 0 to disable culling,
+   * or a negative value for the range returned by ComputeMaxRange
+   * \param batch whether receptions are delivered by batches
+   * \param resolution the resolution of the delays of a batch
+   * \param cache whether link budgets are cached
+   * \return the frames received and dropped by each node
+   */
+  Counts Run (double maxRange, bool batch = false, Time resolution = NanoSeconds (1), bool cache = false);
+
+private:
+  /**
+   * Count a frame received
+   * \param counts the counters
+   * \param node the receiving node
+   * \param p the frame
+   */
+  static void RxEnd (std::vector<uint32_t> *counts, uint32_t node, Ptr<const Packet> p);
+  /**
+   * Count a frame dropped
+   * \param counts the counters
+   * \param node the receiving node
+   * \param p the frame
+   * \param reason the reason of the drop
+   */
+  static void RxDrop (std::vector<uint32_t> *counts, uint32_t node, Ptr<const Packet> p,
+                      WifiPhyRxfailureReason reason);
+};
+
+YansWifiChannelBroadcastTest::YansWifiChannelBroadcastTest (std::string name)
+  : TestCase (name)
+{
+}
+
+void
+YansWifiChannelBroadcastTest::RxEnd (std::vector<uint32_t> *counts, uint32_t node, Ptr<const Packet> p)
+{
+  (*counts)[node]++;
+}
+
+void
+YansWifiChannelBroadcastTest::RxDrop (std::vector<uint32_t> *counts, uint32_t node, Ptr<const Packet> p,
+                                      WifiPhyRxfailureReason reason)
+{
+  (*counts)[node]++;
+}
+
+YansWifiChannelBroadcastTest::Counts
+YansWifiChannelBroadcastTest::Run (double maxRange, bool batch, Time resolution, bool cache)
+{
+  const uint32_t nNodes = 40;
+  RngSeedManager::SetSeed (1);
+  RngSeedManager::SetRun (1);
+
+  NodeContainer nodes;
+  nodes.Create (nNodes);
+
+  YansWifiChannelHelper channelHelper = YansWifiChannelHelper::Default ();
+  Ptr<YansWifiChannel> channel = channelHelper.Create ();
+  if (maxRange < 0)
+    {
+      // no signal above the default sensitivity at the default TX power
+      maxRange = channel->ComputeMaxRange (16.0206, -101);
+    }
+  channel->SetAttribute ("MaxRange", DoubleValue (maxRange));
+  channel->SetAttribute ("BatchDelivery", BooleanValue (batch));
+  channel->SetAttribute ("DelayResolution", TimeValue (resolution));
+  channel->SetAttribute ("CacheLinkBudget", BooleanValue (cache));
+  YansWifiPhyHelper phy;
+  phy.SetChannel (channel);
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_STANDARD_80211a);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("OfdmRate6Mbps"));
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+  wifi.AssignStreams (devices, 100);
+
+  // a line of nodes 40 m apart; every fourth one drives along the line
+  // fast enough for the grid to be refreshed during the run
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "DeltaX", DoubleValue (40),
+                                 "GridWidth", UintegerValue (nNodes));
+  mobility.SetMobilityModel ("ns3::ConstantVelocityMobilityModel");
+  mobility.Install (nodes);
+  for (uint32_t i = 0; i < nNodes; i += 4)
+    {
+      nodes.Get (i)->GetObject<ConstantVelocityMobilityModel> ()->SetVelocity (Vector (i % 8 ? 150 : -150, 0, 0));
+    }
+
+  PacketSocketHelper packetSocket;
+  packetSocket.Install (nodes);
+  Counts counts;
+  counts.rx.assign (nNodes, 0);
+  counts.drop.assign (nNodes, 0);
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      Ptr<WifiPhy> wifiPhy = DynamicCast<WifiNetDevice> (devices.Get (i))->GetPhy ();
+      wifiPhy->TraceConnectWithoutContext ("PhyRxEnd", MakeBoundCallback (&RxEnd, &counts.rx, i));
+      wifiPhy->TraceConnectWithoutContext ("PhyRxDrop", MakeBoundCallback (&RxDrop, &counts.drop, i));
+      if (i % 3 == 0)
+        {
+          PacketSocketAddress socket;
+          socket.SetSingleDevice (devices.Get (i)->GetIfIndex ());
+          socket.SetPhysicalAddress (devices.Get (i)->GetBroadcast ());
+          socket.SetProtocol (1);
+          Ptr<PacketSocketClient> client = CreateObject<PacketSocketClient> ();
+          client->SetAttribute ("PacketSize", UintegerValue (200));
+          client->SetAttribute ("MaxPackets", UintegerValue (0));
+          client->SetAttribute ("Interval", TimeValue (MilliSeconds (20 + i)));
+          client->SetRemote (socket);
+          nodes.Get (i)->AddApplication (client);
+          client->SetStartTime (MilliSeconds (i));
+          client->SetStopTime (Seconds (2));
+        }
+    }
+
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+  counts.events = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+  return counts;
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief YansWifiChannel receiver culling test
+ *
+ * Runs the broadcast scenario over a channel considering every PHY and
+ * over channels restricted to the range returned by ComputeMaxRange, and
+ * checks that every node receives and drops the same frames while fewer
+ * events are executed.
+ */
+class YansWifiChannelCullingTest : public YansWifiChannelBroadcastTest
+{
+public:
+  YansWifiChannelCullingTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+YansWifiChannelCullingTest::YansWifiChannelCullingTest ()
+  : YansWifiChannelBroadcastTest ("Receivers out of MaxRange are skipped without changing the results")
+{
+}
+
+void
+YansWifiChannelCullingTest::DoRun (void)
+{
+  Counts all = Run (0);
+  Counts culled = Run (-1);
+  // a range well beyond the sensitivity range
+  Counts wide = Run (1000);
+
+  uint32_t received = 0;
+  for (uint32_t i = 0; i < all.rx.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (culled.rx[i], all.rx[i], "Different receptions at node " << i);
+      NS_TEST_EXPECT_MSG_EQ (culled.drop[i], all.drop[i], "Different drops at node " << i);
+      NS_TEST_EXPECT_MSG_EQ (wide.rx[i], all.rx[i], "Different receptions at node " << i);
+      NS_TEST_EXPECT_MSG_EQ (wide.drop[i], all.drop[i], "Different drops at node " << i);
+      received += all.rx[i];
+    }
+  NS_TEST_ASSERT_MSG_GT (received, 0, "Nothing received");
+  NS_TEST_EXPECT_MSG_LT (culled.events, all.events, "No receiver culled");
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief YansWifiChannel batch delivery test
+ *
+ * Runs the broadcast scenario with one event per reception and with one
+ * event per batch of receptions with the same delay, and checks that
+ * every node receives and drops the same frames while fewer events are
+ * executed; then checks that a coarser delay resolution groups more
+ * receptions.
+ */
+class YansWifiChannelBatchTest : public YansWifiChannelBroadcastTest
+{
+public:
+  YansWifiChannelBatchTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+YansWifiChannelBatchTest::YansWifiChannelBatchTest ()
+  : YansWifiChannelBroadcastTest ("Receptions with the same delay are delivered by one event")
+{
+}
+
+void
+YansWifiChannelBatchTest::DoRun (void)
+{
+  Counts single = Run (0);
+  Counts batched = Run (0, true);
+  // nodes at the same distance on both sides of a sender share a batch
+  for (uint32_t i = 0; i < single.rx.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (batched.rx[i], single.rx[i], "Different receptions at node " << i);
+      NS_TEST_EXPECT_MSG_EQ (batched.drop[i], single.drop[i], "Different drops at node " << i);
+    }
+  NS_TEST_EXPECT_MSG_LT (batched.events, single.events, "No reception batched");
+
+  // with a resolution above the delay to the farthest node, a
+  // transmission is delivered by a single event
+  Counts coarse = Run (0, true, MicroSeconds (10));
+  NS_TEST_EXPECT_MSG_LT (coarse.events, batched.events, "Coarser batches expected");
+  uint32_t received = 0;
+  for (uint32_t i = 0; i < coarse.rx.size (); i++)
+    {
+      received += coarse.rx[i];
+    }
+  NS_TEST_EXPECT_MSG_GT (received, 0, "Nothing received");
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief YansWifiChannel link budget cache test
+ *
+ * Runs the broadcast scenario with and without the link budget cache,
+ * alone and together with receiver culling and batch delivery, and
+ * checks that every node receives and drops the same frames.
+ */
+class YansWifiChannelLinkBudgetTest : public YansWifiChannelBroadcastTest
+{
+public:
+  YansWifiChannelLinkBudgetTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+YansWifiChannelLinkBudgetTest::YansWifiChannelLinkBudgetTest ()
+  : YansWifiChannelBroadcastTest ("Cached link budgets give the same receptions")
+{
+}
+
+void
+YansWifiChannelLinkBudgetTest::DoRun (void)
+{
+  Counts computed = Run (0);
+  Counts cached = Run (0, false, NanoSeconds (1), true);
+  Counts combined = Run (-1, true, NanoSeconds (1), true);
+  for (uint32_t i = 0; i < computed.rx.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (cached.rx[i], computed.rx[i], "Different receptions at node " << i);
+      NS_TEST_EXPECT_MSG_EQ (cached.drop[i], computed.drop[i], "Different drops at node " << i);
+      NS_TEST_EXPECT_MSG_EQ (combined.rx[i], computed.rx[i], "Different receptions at node " << i);
+      NS_TEST_EXPECT_MSG_EQ (combined.drop[i], computed.drop[i], "Different drops at node " << i);
+    }
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief YansWifiChannel Test Suite
+ */
+class YansWifiChannelTestSuite : public TestSuite
+{
+public:
+  YansWifiChannelTestSuite ();
+};
+
+YansWifiChannelTestSuite::YansWifiChannelTestSuite ()
+  : TestSuite ("wifi-yans-channel", UNIT)
+{
+  AddTestCase (new YansWifiChannelCullingTest, TestCase::QUICK);
+  AddTestCase (new YansWifiChannelBatchTest, TestCase::QUICK);
+  AddTestCase (new YansWifiChannelLinkBudgetTest, TestCase::QUICK);
+}
+
+static YansWifiChannelTestSuite g_yansWifiChannelTestSuite; ///< the test suite
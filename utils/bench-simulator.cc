@@ -51,7 +51,8 @@ public:
   Bench (const uint32_t population, const uint32_t total)
     : m_population (population),
       m_total (total),
-      m_count (0)
+      m_count (0),
+      m_receivers (0)
   {
   }
 
@@ -82,16 +83,45 @@ public:
     m_total = total;
   }
 
+  /**
+   * Use a V2X-like event pattern instead of the random stream.
+   *
+   * Each of the population vehicles broadcasts a BSM every 100 ms,
+   * with up to 5 ms of jitter, and each BSM starts and ends a reception
+   * on \p receivers vehicles, with a few microseconds of propagation
+   * and processing delay spread.
+   *
+   * \param receivers the number of vehicles receiving each BSM,
+   * or 0 to use the random stream
+   */
+  void SetV2x (const uint32_t receivers)
+  {
+    m_receivers = receivers;
+    m_jitter = CreateObject<UniformRandomVariable> ();
+    m_jitter->SetAttribute ("Max", DoubleValue (5000000));
+    m_spread = CreateObject<UniformRandomVariable> ();
+    m_spread->SetAttribute ("Max", DoubleValue (3000));
+  }
+
   /// Run function
   void RunBench (void);
 private:
   /// callback function
   void Cb (void);
+  /// BSM transmission callback function
+  void BsmCb (void);
+  /// BSM reception start callback function
+  void RxStartCb (void);
+  /// BSM reception end callback function
+  void RxEndCb (void);
 
   Ptr<RandomVariableStream> m_rand; ///< random variable
   uint32_t m_population; ///< population
   uint32_t m_total; ///< total
   uint32_t m_count; ///< count
+  uint32_t m_receivers; ///< number of vehicles receiving each BSM
+  Ptr<UniformRandomVariable> m_jitter; ///< BSM transmission jitter, in ns
+  Ptr<UniformRandomVariable> m_spread; ///< BSM reception delay spread, in ns
 };
 
 void
@@ -107,8 +137,17 @@ Bench::RunBench (void)
   time.Start ();
   for (uint32_t i = 0; i < m_population; ++i)
     {
-      Time at = NanoSeconds (m_rand->GetValue ());
-      Simulator::Schedule (at, &Bench::Cb, this);
+      if (m_receivers > 0)
+        {
+          // spread the first BSMs over the 100 ms period
+          Time at = NanoSeconds (m_jitter->GetValue () * 20);
+          Simulator::Schedule (at, &Bench::BsmCb, this);
+        }
+      else
+        {
+          Time at = NanoSeconds (m_rand->GetValue ());
+          Simulator::Schedule (at, &Bench::Cb, this);
+        }
     }
   init = time.End ();
   init /= 1000;
@@ -144,6 +183,46 @@ Bench::Cb (void)
   ++m_count;
 }
 
+void
+Bench::BsmCb (void)
+{
+  if (m_count >= m_total)
+    {
+      return;
+    }
+  DEB ("BSM at " << Simulator::Now ().GetSeconds () << "s");
+
+  for (uint32_t i = 0; i < m_receivers; ++i)
+    {
+      Simulator::Schedule (NanoSeconds (m_spread->GetValue ()), &Bench::RxStartCb, this);
+    }
+  Time after = MilliSeconds (100) + NanoSeconds (m_jitter->GetValue ());
+  Simulator::Schedule (after, &Bench::BsmCb, this);
+  ++m_count;
+}
+
+void
+Bench::RxStartCb (void)
+{
+  if (m_count >= m_total)
+    {
+      return;
+    }
+  // airtime of a BSM at 6 Mb/s
+  Simulator::Schedule (MicroSeconds (400), &Bench::RxEndCb, this);
+  ++m_count;
+}
+
+void
+Bench::RxEndCb (void)
+{
+  if (m_count >= m_total)
+    {
+      return;
+    }
+  ++m_count;
+}
+
 
 Ptr<RandomVariableStream>
 GetRandomStream (std::string filename)
@@ -205,6 +284,7 @@ int main (int argc, char *argv[])
 
   bool schedCal           = false;
   bool schedHeap          = false;
+  bool schedLadder        = false;
   bool schedList          = false;
   bool schedMap           = true;
   bool schedPriorityQueue = false;
@@ -214,6 +294,7 @@ int main (int argc, char *argv[])
   uint32_t runs  =       1;
   std::string filename = "";
   bool calRev = false;
+  uint32_t v2x = 0;
 
   CommandLine cmd (__FILE__);
   cmd.Usage ("Benchmark the simulator scheduler.\n"
@@ -223,10 +304,15 @@ int main (int argc, char *argv[])
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
-             "to be ascii, giving the relative event times in ns.");
+             "to be ascii, giving the relative event times in ns.\n"
+             "\n"
+             "Alternatively --v2x=\"<receivers>\" generates the events of\n"
+             "--pop vehicles broadcasting a BSM every 100 ms, each received\n"
+             "by <receivers> vehicles a few microseconds apart.");
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
   cmd.AddValue ("calrev", "reverse ordering in the CalendarScheduler", calRev);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
+  cmd.AddValue ("ladder", "use LadderQueueScheduler",     schedLadder);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
   cmd.AddValue ("pri",   "use PriorityQueue",             schedPriorityQueue);
@@ -235,6 +321,7 @@ int main (int argc, char *argv[])
   cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
   cmd.AddValue ("runs",  "number of runs (default 1)",    runs);
   cmd.AddValue ("file",  "file of relative event times",  filename);
+  cmd.AddValue ("v2x",   "number of receivers of a BSM in the V2X event pattern", v2x);
   cmd.AddValue ("prec",  "printed output precision",      g_fwidth);
   cmd.Parse (argc, argv);
   g_me = cmd.GetName () + ": ";
@@ -250,6 +337,10 @@ int main (int argc, char *argv[])
     {
       factory.SetTypeId ("ns3::HeapScheduler");
     }
+  if (schedLadder)
+    {
+      factory.SetTypeId ("ns3::LadderQueueScheduler");
+    }
   if (schedList)
     {
       factory.SetTypeId ("ns3::ListScheduler");
@@ -275,7 +366,15 @@ int main (int argc, char *argv[])
   LOGME ("runs: " << runs);
 
   Bench *bench = new Bench (pop, total);
-  bench->SetRandomStream (GetRandomStream (filename));
+  if (v2x > 0)
+    {
+      LOGME ("using V2X event pattern with " << v2x << " receivers per BSM");
+      bench->SetV2x (v2x);
+    }
+  else
+    {
+      bench->SetRandomStream (GetRandomStream (filename));
+    }
 
   // table header
   LOG ("");
@@ -0,0 +1,183 @@
+#!/usr/bin/env python3
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License version 2 as
+# published by the Free Software Foundation;
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+"""
+Run a parameter sweep of an ns-3 program and merge the results.
+
+Every point of the grid (the cartesian product of the --grid values) is
+run --runs times, each run with its own RngRun, as parallel local
+processes.  Each run writes its CSV to the work directory through the
+program's --outputFile argument; the rows of all the runs are then merged
+into a single CSV whose first columns tag the parameter values, the run
+index and the RngRun of each row.
+
+Example, 3 densities x 2 initial ITTs x 5 seeds on every core:
+
+  ./utils/v2x-sweep.py --grid obuNodes=100,200,500 --grid initItt=0.08,0.145 \\
+      --runs 5 --output sweep.csv -- --totalTime=20
+
+Arguments after "--" are passed unchanged to every run.  The program is
+built once before the sweep unless --no-build is given.
+"""
+
+import argparse
+import csv
+import itertools
+import os
+import subprocess
+import sys
+from concurrent.futures import ThreadPoolExecutor
+
+
+def read_waf_config():
+    """Return the top and out directories of the configured build."""
+    top_dir = out_dir = None
+    for name in (".lock-waf_" + sys.platform + "_build", ".lock-waf_linux2_build"):
+        try:
+            with open(name, "rt") as f:
+                for line in f:
+                    if line.startswith("top_dir ="):
+                        top_dir = eval(line.split('=', 1)[1].strip())
+                    if line.startswith("out_dir ="):
+                        out_dir = eval(line.split('=', 1)[1].strip())
+            return top_dir, out_dir
+        except FileNotFoundError:
+            continue
+    sys.exit("The .lock-waf ... file was not found.  Run ./waf configure first.")
+
+
+def parse_grid(specs):
+    """Turn ["name=v1,v2", ...] into [(name, [v1, v2]), ...]."""
+    grid = []
+    for spec in specs:
+        name, sep, values = spec.partition('=')
+        if not sep or not name or not values:
+            sys.exit("Malformed grid parameter \"%s\", expected name=v1,v2,..." % spec)
+        grid.append((name, values.split(',')))
+    return grid
+
+
+def expand(grid, runs, first_rng_run):
+    """Yield (index, tags, rng_run) for every run of every grid point."""
+    names = [name for name, _ in grid]
+    index = 0
+    for values in itertools.product(*[values for _, values in grid]):
+        for run in range(runs):
+            tags = list(zip(names, values)) + [("run", str(run))]
+            # distinct across the whole sweep, not only within a point
+            yield index, tags, first_rng_run + index
+            index += 1
+
+
+def run_one(binary, env, workdir, index, tags, rng_run, extra_args, dry_run):
+    """Run one point and return its output file and exit status."""
+    label = "-".join("%s_%s" % (name, value) for name, value in tags)
+    output = os.path.join(workdir, label + ".csv")
+    args = [binary]
+    args += ["--%s=%s" % (name, value) for name, value in tags if name != "run"]
+    args += ["--RngRun=%d" % rng_run, "--outputFile=%s" % output]
+    args += extra_args
+    if dry_run:
+        print(" ".join(args))
+        return output, 0
+    with open(os.path.join(workdir, label + ".log"), "w") as log:
+        status = subprocess.call(args, env=env, stdout=log, stderr=subprocess.STDOUT)
+    print("[%d] %s: %s" % (index, label, "ok" if status == 0 else "FAILED (%d)" % status))
+    return output, status
+
+
+def merge(results, output):
+    """Concatenate the run CSVs, prepending the tag columns to each row."""
+    header = None
+    with open(output, "w", newline='') as out:
+        writer = csv.writer(out)
+        for tags, rng_run, filename in results:
+            with open(filename, newline='') as f:
+                reader = csv.reader(f)
+                columns = next(reader, None)
+                if columns is None:
+                    continue
+                if header is None:
+                    header = [name for name, _ in tags] + ["rngRun"] + columns
+                    writer.writerow(header)
+                for row in reader:
+                    if row:
+                        writer.writerow([value for _, value in tags] + [rng_run] + row)
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--program", default="v2x-congestion-scenario",
+                        help="scratch program to run (default: %(default)s)")
+    parser.add_argument("--grid", action="append", default=[], metavar="NAME=V1,V2,...",
+                        help="program argument and the values it takes; may be repeated")
+    parser.add_argument("--runs", type=int, default=1,
+                        help="runs per grid point, each with its own RngRun (default: %(default)s)")
+    parser.add_argument("--rng-run", type=int, default=1,
+                        help="RngRun of the first run (default: %(default)s)")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count() or 1,
+                        help="parallel processes (default: the number of cores, %(default)s)")
+    parser.add_argument("--workdir", default="sweep",
+                        help="directory of the per-run CSVs and logs (default: %(default)s)")
+    parser.add_argument("--output", default="sweep.csv",
+                        help="merged CSV (default: %(default)s)")
+    parser.add_argument("--no-build", action="store_true",
+                        help="do not build the program before the sweep")
+    parser.add_argument("--dry-run", action="store_true",
+                        help="print the commands instead of running them")
+    parser.add_argument("extra", nargs="*",
+                        help="arguments passed to every run, after \"--\"")
+    options = parser.parse_args(argv)
+
+    top_dir, out_dir = read_waf_config()
+    if not options.no_build and not options.dry_run:
+        if subprocess.call([os.path.join(top_dir, "waf"), "build"], cwd=top_dir) != 0:
+            sys.exit("Build failed")
+
+    binary = os.path.join(out_dir, "scratch", options.program)
+    if not options.dry_run and not os.path.exists(binary):
+        binary = os.path.join(out_dir, "scratch", options.program, options.program)
+        if not os.path.exists(binary):
+            sys.exit("Program %s not found in %s" % (options.program, out_dir))
+
+    env = dict(os.environ)
+    env["LD_LIBRARY_PATH"] = os.path.join(out_dir, "lib") + \
+        (":" + env["LD_LIBRARY_PATH"] if env.get("LD_LIBRARY_PATH") else "")
+    os.makedirs(options.workdir, exist_ok=True)
+
+    points = list(expand(parse_grid(options.grid), options.runs, options.rng_run))
+    print("%d runs on %d processes" % (len(points), options.jobs))
+    with ThreadPoolExecutor(max_workers=options.jobs) as pool:
+        futures = [(tags, rng_run,
+                    pool.submit(run_one, binary, env, options.workdir, index, tags, rng_run,
+                                options.extra, options.dry_run))
+                   for index, tags, rng_run in points]
+        results = [(tags, rng_run, future.result()) for tags, rng_run, future in futures]
+    if options.dry_run:
+        return 0
+
+    failed = [filename for _, _, (filename, status) in results if status != 0]
+    merge([(tags, rng_run, filename) for tags, rng_run, (filename, status) in results
+           if status == 0 and os.path.exists(filename)], options.output)
+    print("Merged %d runs into %s" % (len(results) - len(failed), options.output))
+    if failed:
+        print("%d runs failed, see the logs in %s" % (len(failed), options.workdir))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))